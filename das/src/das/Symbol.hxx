@@ -15,6 +15,11 @@
     /* Name */                                                  \
                                                                 \
     static std::string name()                                   \
+    {                                                           \
+      return #Name;                                             \
+    }                                                           \
+                                                                \
+    static constexpr char const* literal()                      \
     {                                                           \
       return #Name;                                             \
     }                                                           \
@@ -1,6 +1,13 @@
 #pragma once
 
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <tuple>
 #include <type_traits>
+#include <utility>
+
+#include <boost/optional.hpp>
 
 #include <elle/serialization/SerializerIn.hh>
 #include <elle/serialization/SerializerOut.hh>
@@ -21,48 +28,247 @@ namespace das
     {
       return T(std::move(args)...);
     }
-  }
 
-  template <typename O, typename M = typename DefaultModel<O>::type>
-  struct Serializer
-  {
-    template <typename T>
-    struct Serialize
+    /*------------.
+    | Field table |
+    `------------*/
+
+    constexpr
+    std::size_t
+    field_length(char const* name)
     {
-      using type = int;
+      std::size_t res = 0;
+      while (name[res])
+        ++res;
+      return res;
+    }
+
+    /// FNV-1a of \a name from a basis perturbed by \a seed, folded so the
+    /// low bits depend on every bit of every character.
+    constexpr
+    std::uint32_t
+    field_hash(char const* name, std::size_t size, std::uint32_t seed)
+    {
+      std::uint32_t res = 2166136261u ^ seed;
+      for (std::size_t i = 0; i < size; ++i)
+      {
+        res ^= static_cast<unsigned char>(name[i]);
+        res *= 16777619u;
+      }
+      return res ^ (res >> 16);
+    }
+
+    template <std::size_t Slots>
+    struct FieldSlots
+    {
+      std::uint32_t seed;
+      /// Index of the field hashed to each slot, -1 if none.
+      int index[Slots];
+    };
+
+    /// Smallest power of two at least four times \a size, keeping the
+    /// seed search short.
+    constexpr
+    std::size_t
+    field_slots(std::size_t size)
+    {
+      std::size_t res = 1;
+      while (res < size * 4)
+        res *= 2;
+      return res;
+    }
+
+    /// The first seed hashing all \a Fields names to distinct slots.
+    template <std::size_t Slots, typename ... Fields>
+    constexpr
+    FieldSlots<Slots>
+    field_perfect_hash()
+    {
+      char const* const names[] = {Fields::literal()..., nullptr};
+      for (std::uint32_t seed = 0; seed < (1u << 16); ++seed)
+      {
+        FieldSlots<Slots> res{seed, {}};
+        for (auto& index: res.index)
+          index = -1;
+        bool collision = false;
+        for (std::size_t f = 0; f < sizeof ... (Fields) && !collision; ++f)
+        {
+          auto& index = res.index[
+            field_hash(names[f], field_length(names[f]), seed) & (Slots - 1)];
+          if (index == -1)
+            index = static_cast<int>(f);
+          else
+            collision = true;
+        }
+        if (!collision)
+          return res;
+      }
+      throw std::logic_error("duplicate field names");
+    }
+
+    /// Perfect hash of a model field names, computed at compile time.
+    template <typename ... Fields>
+    struct FieldTable
+    {
+      static constexpr std::size_t slots = field_slots(sizeof ... (Fields));
+      static constexpr FieldSlots<slots> table =
+        field_perfect_hash<slots, Fields...>();
+
+      /// The index of the field named \a key, -1 if none.
       static
       int
-      value(O const& o, elle::serialization::SerializerOut& s)
+      index(elle::ConstWeakBuffer const& key)
       {
-        s.serialize(T::name(), M::template FieldType<T>::get(o));
-        return 0;
+        static constexpr char const* names[] = {Fields::literal()..., nullptr};
+        static constexpr std::size_t lengths[] =
+          {field_length(Fields::literal())..., 0};
+        auto const data = reinterpret_cast<char const*>(key.contents());
+        auto const res = table.index[
+          field_hash(data, key.size(), table.seed) & (slots - 1)];
+        if (res >= 0 &&
+            lengths[res] == key.size() &&
+            std::memcmp(names[res], data, key.size()) == 0)
+          return res;
+        else
+          return -1;
       }
     };
 
-    template <typename T>
-    struct Deserialize
+    template <typename ... Fields>
+    constexpr FieldSlots<FieldTable<Fields...>::slots>
+    FieldTable<Fields...>::table;
+
+    /*-----.
+    | Plan |
+    `-----*/
+
+    template <typename O, typename M, typename Fields = typename M::Fields>
+    struct Plan;
+
+    /// Compile-time deserialization of the fields of model \a M.
+    ///
+    /// Keyed formats are read in one pass over the input object, each key
+    /// being looked up in the FieldTable.  Fields missing from the input
+    /// are then deserialized by name, yielding the usual MissingKey error
+    /// or empty option.  Other formats read all fields in model order,
+    /// without names.
+    template <typename O, typename M, typename ... Fields>
+    struct Plan<O, M, elle::meta::List<Fields...>>
     {
-      using type = typename M::template FieldType<T>::type;
-      //typename T::template attr_type<O>;
+      using Table = FieldTable<Fields...>;
+      template <std::size_t I>
+      using Field = std::tuple_element_t<I, std::tuple<Fields...>>;
+      template <std::size_t I>
+      using Type = typename M::template FieldType<Field<I>>::type;
+      /// Fields deserialized ahead of construction.
+      using Values = std::tuple<
+        boost::optional<typename M::template FieldType<Fields>::type>...>;
+
+      /// Store fields in Values, to construct the object from.
+      struct Construct
+      {
+        template <std::size_t I>
+        static
+        void
+        anonymous(elle::serialization::SerializerIn& s, Values& values)
+        {
+          std::get<I>(values).emplace(s.deserialize<Type<I>>());
+        }
+
+        template <std::size_t I>
+        static
+        void
+        named(elle::serialization::SerializerIn& s, Values& values)
+        {
+          std::get<I>(values).emplace(
+            s.deserialize<Type<I>>(Field<I>::name()));
+        }
+      };
+
+      /// Assign fields of a default-constructed object.
+      struct Assign
+      {
+        template <std::size_t I>
+        using Attribute = typename Field<I>::template attr_type<O>;
+
+        template <std::size_t I>
+        static
+        void
+        anonymous(elle::serialization::SerializerIn& s, O& o)
+        {
+          Field<I>::attr_get(o) = s.deserialize<Attribute<I>>();
+        }
+
+        template <std::size_t I>
+        static
+        void
+        named(elle::serialization::SerializerIn& s, O& o)
+        {
+          Field<I>::attr_get(o) =
+            s.deserialize<Attribute<I>>(Field<I>::name());
+        }
+      };
+
+      template <typename Store, typename Target>
       static
-      type
-      value(elle::serialization::SerializerIn& s)
+      void
+      deserialize(elle::serialization::SerializerIn& s, Target& target)
       {
-        return s.deserialize<type>(T::name());
+        _deserialize<Store>(
+          s, target, std::make_index_sequence<sizeof ... (Fields)>());
+      }
+
+    private:
+      template <typename Store, typename Target, std::size_t ... I>
+      static
+      void
+      _deserialize(elle::serialization::SerializerIn& s,
+                   Target& target,
+                   std::index_sequence<I...>)
+      {
+        using Deserialize =
+          void (*)(elle::serialization::SerializerIn&, Target&);
+        static Deserialize const fields[] =
+          {&Store::template anonymous<I>..., nullptr};
+        bool seen[sizeof ... (Fields) + 1] = {};
+        auto const keyed = s.deserialize_members(
+          [&] (elle::ConstWeakBuffer const& key)
+          {
+            auto const index = Table::index(key);
+            if (index >= 0)
+            {
+              fields[index](s, target);
+              seen[index] = true;
+            }
+          });
+        using expand = int[];
+        (void) expand{
+          0,
+          (seen[I] ? 0 :
+           (keyed ?
+            Store::template named<I>(s, target) :
+            Store::template anonymous<I>(s, target), 0))...};
       }
     };
+  }
 
+  template <typename O, typename M = typename DefaultModel<O>::type>
+  struct Serializer
+  {
     template <typename T>
-    struct DeserializeAssign
+    struct Serialize
     {
-      using type = bool;
+      using type = int;
       static
-      bool
-      value(elle::serialization::SerializerIn& s, O& o)
+      int
+      value(O const& o, elle::serialization::SerializerOut& s)
       {
-        T::attr_get(o) =
-          s.deserialize<typename T::template attr_type<O>>(T::name());
-        return false;
+        // Binary serialization is anonymous, skip names altogether.
+        if (s.text())
+          s.serialize(T::name(), M::template FieldType<T>::get(o));
+        else
+          s.serialize_forward(M::template FieldType<T>::get(o));
+        return 0;
       }
     };
 
@@ -90,6 +296,14 @@ namespace das
 
   namespace _details
   {
+    template <typename O, typename M, std::size_t ... I>
+    O
+    construct_values(typename Plan<O, M>::Values& values,
+                     std::index_sequence<I...>)
+    {
+      return O(std::move(*std::get<I>(values))...);
+    }
+
     /// Deserialize by constructor.
     template <typename O, typename M>
     std::enable_if_t<
@@ -97,12 +311,12 @@ namespace das
       O>
     deserialize_switch(elle::serialization::SerializerIn& s)
     {
-      return std::forward_tuple(
-        [] (auto&& ... args) -> O
-        {
-          return O(std::move(args)...);
-        },
-        M::Fields::template map<Serializer<O, M>::template Deserialize>::value(s));
+      using Plan = _details::Plan<O, M>;
+      typename Plan::Values values;
+      Plan::template deserialize<typename Plan::Construct>(s, values);
+      return construct_values<O, M>(
+        values,
+        std::make_index_sequence<std::tuple_size<decltype(values)>::value>());
     }
 
     template <typename M>
@@ -137,9 +351,9 @@ namespace das
       O>
     deserialize_switch(elle::serialization::SerializerIn& s)
     {
+      using Plan = _details::Plan<O, M>;
       O res;
-      M::Fields::template map<Serializer<O, M>::
-        template DeserializeAssign>::value(s, res);
+      Plan::template deserialize<typename Plan::Assign>(s, res);
       return res;
     }
   }
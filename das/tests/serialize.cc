@@ -1,8 +1,11 @@
+#include <sstream>
 #include <string>
 
 #include <elle/json/json.hh>
 #include <elle/serialization/Serializer.hh>
+#include <elle/serialization/binary.hh>
 #include <elle/serialization/json.hh>
+#include <elle/serialization/json/MissingKey.hh>
 #include <elle/test.hh>
 
 #include <das/printer.hh>
@@ -157,9 +160,142 @@ composite()
   }
 }
 
+static
+void
+binary()
+{
+  User u("Doug", {Device(42, "arthur"), Device(51, "ford")});
+  ELLE_LOG("fields are written without names")
+  {
+    std::stringstream ss;
+    elle::serialization::binary::serialize(u, ss, false);
+    // Magic, then each field's value in model order: no key anywhere.
+    BOOST_CHECK_EQUAL(
+      ss.str(),
+      std::string("\x00" "\x04" "Doug" "\x02"
+                  "\x2a" "\x06" "arthur"
+                  "\x33" "\x04" "ford", 21));
+    BOOST_CHECK_EQUAL(
+      elle::serialization::binary::deserialize<User>(ss, false), u);
+  }
+  ELLE_LOG("default construction and assignment")
+  {
+    DevicePOD d;
+    d.id = 42;
+    d.name = "towel";
+    std::stringstream ss;
+    elle::serialization::binary::serialize(d, ss, false);
+    BOOST_CHECK_EQUAL(ss.str(), std::string("\x00" "\x2a" "\x05" "towel", 8));
+    BOOST_CHECK_EQUAL(
+      elle::serialization::binary::deserialize<DevicePOD>(ss, false), d);
+  }
+}
+
+static
+void
+keys()
+{
+  ELLE_LOG("field order and unknown keys")
+  {
+    std::stringstream ss(
+      "{\"unknown\": [1, {}], \"name\": \"towel\", \"nam\": 0, \"id\": 42}");
+    BOOST_CHECK_EQUAL(elle::serialization::json::deserialize<Device>(ss),
+                      Device(42, "towel"));
+  }
+  ELLE_LOG("missing field")
+  {
+    std::stringstream ss("{\"id\": 42, \"nom\": \"towel\"}");
+    BOOST_CHECK_THROW(elle::serialization::json::deserialize<DevicePOD>(ss),
+                      elle::serialization::MissingKey);
+  }
+  ELLE_LOG("perfect hash")
+  {
+    using Table = das::_details::FieldTable<Symbol_id, Symbol_name, Symbol_device>;
+    BOOST_CHECK_EQUAL(Table::index("id"), 0);
+    BOOST_CHECK_EQUAL(Table::index("name"), 1);
+    BOOST_CHECK_EQUAL(Table::index("device"), 2);
+    for (auto key: {"", "i", "ide", "Name", "devices"})
+      BOOST_CHECK_EQUAL(Table::index(key), -1);
+  }
+}
+
+struct Manual
+{
+  Manual(elle::serialization::SerializerIn& s)
+  {
+    this->serialize(s);
+  }
+
+  void
+  serialize(elle::serialization::Serializer& s)
+  {
+    s.serialize("id", this->id);
+    s.serialize("name", this->name);
+  }
+
+  int id;
+  std::string name;
+};
+
+static
+void
+benchmark()
+{
+  auto const count = RUNNING_ON_VALGRIND ? 100 : 100000;
+  std::vector<DevicePOD> devices(count);
+  for (int i = 0; i < count; ++i)
+  {
+    devices[i].id = i;
+    devices[i].name = "towel";
+  }
+  std::stringstream json;
+  elle::serialization::json::serialize(devices, json, false);
+  std::stringstream binary;
+  elle::serialization::binary::serialize(devices, binary, false);
+  auto measure = [&] (auto format, auto type, std::string const& data)
+    {
+      using Format = typename decltype(format)::type;
+      using Type = typename decltype(type)::type;
+      std::vector<Type> res;
+      auto const seconds = elapsed(
+        [&]
+        {
+          std::stringstream input(data);
+          res = elle::serialization::deserialize<Format, std::vector<Type>>(
+            input, false);
+        });
+      BOOST_CHECK_EQUAL(res.size(), count);
+      BOOST_CHECK_EQUAL(res.back().id, count - 1);
+      return count / seconds;
+    };
+  using elle::meta::Identity;
+  using elle::serialization::Binary;
+  using elle::serialization::Json;
+  // Measure outside of BOOST_TEST_MESSAGE, whose entry the checks would
+  // interrupt.
+  auto const json_manual =
+    measure(Identity<Json>(), Identity<Manual>(), json.str());
+  auto const json_plan =
+    measure(Identity<Json>(), Identity<DevicePOD>(), json.str());
+  auto const binary_manual =
+    measure(Identity<Binary>(), Identity<Manual>(), binary.str());
+  auto const binary_plan =
+    measure(Identity<Binary>(), Identity<DevicePOD>(), binary.str());
+  BOOST_TEST_MESSAGE(
+    "JSON deserialization: " << json_manual << " objects/s by name, "
+    << json_plan << " objects/s through the model plan");
+  BOOST_TEST_MESSAGE(
+    "binary deserialization: " << binary_manual << " objects/s by name, "
+    << binary_plan << " objects/s through the model plan");
+}
+
 ELLE_TEST_SUITE()
 {
   auto& suite = boost::unit_test::framework::master_test_suite();
   suite.add(BOOST_TEST_CASE(simple), 0, valgrind(1));
   suite.add(BOOST_TEST_CASE(composite), 0, valgrind(1));
+  suite.add(BOOST_TEST_CASE(binary), 0, valgrind(1));
+  suite.add(BOOST_TEST_CASE(keys), 0, valgrind(1));
+  benchmark_suite()->add(
+    BOOST_TEST_CASE_NAME(benchmark, "deserialization"), 0, valgrind(10));
 }
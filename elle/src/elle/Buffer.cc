@@ -107,6 +107,7 @@ namespace elle
     : _size(0)
     , _capacity(ELLE_BUFFER_INITIAL_SIZE)
     , _contents(static_cast<Byte*>(malloc(ELLE_BUFFER_INITIAL_SIZE)))
+    , _offset(0)
   {
     if (this->_contents == nullptr)
       throw std::bad_alloc();
@@ -116,6 +117,7 @@ namespace elle
     : _size(0)
     , _capacity(0)
     , _contents(nullptr)
+    , _offset(0)
   {
     if (size == 0)
     {
@@ -140,6 +142,7 @@ namespace elle
     : _size(0)
     , _capacity(0)
     , _contents(nullptr)
+    , _offset(0)
   {
     (*this) = std::move(other);
   }
@@ -148,6 +151,7 @@ namespace elle
     : _size(source._size)
     , _capacity(source._size)
     , _contents(static_cast<Byte*>(::malloc(this->_capacity)))
+    , _offset(0)
   {
     if (!this->_contents)
       throw std::bad_alloc();
@@ -161,20 +165,22 @@ namespace elle
   Buffer&
   Buffer::operator = (Buffer&& other)
   {
-    ::free(this->_contents);
+    ::free(this->_contents - this->_offset);
     this->_size = other._size;
     this->_capacity = other._capacity;
     this->_contents = other._contents;
+    this->_offset = other._offset;
     // XXX: this cost a lot !
     other._contents = static_cast<Byte*>(malloc(ELLE_BUFFER_INITIAL_SIZE));
     other._size = 0;
     other._capacity = ELLE_BUFFER_INITIAL_SIZE;
+    other._offset = 0;
     return *this;
   }
 
   Buffer::~Buffer()
   {
-    ::free(this->_contents);
+    ::free(this->_contents - this->_offset);
   }
 
   void
@@ -183,6 +189,7 @@ namespace elle
     Buffer::Size capacity = capacity_;
     if (capacity < ELLE_BUFFER_INITIAL_SIZE)
       capacity = ELLE_BUFFER_INITIAL_SIZE;
+    this->_compact();
     void* tmp = ::realloc(this->_contents, capacity);
     if (tmp == nullptr)
       throw std::bad_alloc();
@@ -208,14 +215,34 @@ namespace elle
   void Buffer::pop_front(Size size)
   {
     ELLE_ASSERT(size <= _size);
-    memmove(_contents, _contents + size, _size - size);
-    _size -= size;
+    this->_contents += size;
+    this->_offset += size;
+    this->_capacity -= size;
+    this->_size -= size;
+    // Rewind for free when there is nothing left to move.
+    if (this->_size == 0)
+      this->_compact();
+  }
+
+  void
+  Buffer::_compact()
+  {
+    if (this->_offset == 0)
+      return;
+    auto base = this->_contents - this->_offset;
+    memmove(base, this->_contents, this->_size);
+    this->_contents = base;
+    this->_capacity += this->_offset;
+    this->_offset = 0;
   }
 
   void
   Buffer::size(boost::call_traits<Buffer::Size>::param_type size_)
   {
     Buffer::Size size = size_;
+    if (this->_capacity < size)
+      // Reclaim the popped front first, which may spare the reallocation.
+      this->_compact();
     if (this->_capacity < size)
     {
       Buffer::Size next_size = Buffer::_next_size(size);
@@ -240,6 +267,7 @@ namespace elle
     Byte* new_contents = static_cast<Byte*>(::malloc(ELLE_BUFFER_INITIAL_SIZE));
     if (new_contents == nullptr)
         throw std::bad_alloc{};
+    this->_compact();
 
     ContentPair res{ContentPtr{this->_contents}, this->_size};
 
@@ -400,6 +428,7 @@ namespace elle
     auto size =
       std::max(static_cast<Buffer::Size>(ELLE_BUFFER_INITIAL_SIZE),
                this->_size);
+    this->_compact();
     if (size < this->_capacity)
     {
       void* tmp = ::realloc(_contents, size);
@@ -33,6 +33,7 @@ namespace elle
   /// The Buffer owns the pointed memory at every moment.
   ///
   /// @see WeakBuffer for a buffer that doesn't own the memory.
+  /// @see SharedBuffer for slices of a shared buffer.
   class ELLE_API Buffer:
     private boost::totally_ordered<Buffer>
   {
@@ -102,6 +103,11 @@ namespace elle
     shrink_to_fit();
   private:
     static Size _next_size(Size);
+    /// Move the contents back to the start of the allocation.
+    void
+    _compact();
+    /// Bytes dropped by pop_front ahead of the contents.
+    ELLE_ATTRIBUTE(Size, offset);
 
   public:
     static constexpr Size max_size = std::numeric_limits<Size>::max();
@@ -114,7 +120,9 @@ namespace elle
     void
     append(void const* data, Size size);
     /// Drop a number of bytes.
-    /// Costly, as it memmoves the remaing bytes.
+    ///
+    /// Constant time: the contents start is moved forward, and the dropped
+    /// bytes are only reclaimed upon growth.
     void
     pop_front(Size size = 1);
 
@@ -0,0 +1,81 @@
+#include <elle/SharedBuffer.hh>
+
+#include <elle/assert.hh>
+
+namespace elle
+{
+  /*-------------.
+  | Construction |
+  `-------------*/
+
+  SharedBuffer::SharedBuffer()
+    : Super()
+    , _owner()
+  {}
+
+  SharedBuffer::SharedBuffer(Buffer&& buffer)
+    : SharedBuffer(std::make_shared<Buffer const>(std::move(buffer)))
+  {}
+
+  SharedBuffer::SharedBuffer(std::shared_ptr<Buffer const> buffer)
+    : Super(buffer ? Super(*buffer) : Super())
+    , _owner(std::move(buffer))
+  {}
+
+  SharedBuffer::SharedBuffer(std::shared_ptr<Buffer const> buffer, Super view)
+    : Super(std::move(view))
+    , _owner(std::move(buffer))
+  {}
+
+  SharedBuffer::SharedBuffer(SharedBuffer&& other)
+    : Super(std::move(other))
+    , _owner(std::move(other._owner))
+  {}
+
+  SharedBuffer&
+  SharedBuffer::operator = (SharedBuffer&& other)
+  {
+    Super::operator = (other);
+    this->_owner = std::move(other._owner);
+    static_cast<Super&>(other) = Super();
+    return *this;
+  }
+
+  /*--------.
+  | Content |
+  `--------*/
+
+  SharedBuffer
+  SharedBuffer::range(int start) const
+  {
+    return SharedBuffer(this->_owner, Super::range(start));
+  }
+
+  SharedBuffer
+  SharedBuffer::range(int start, int end) const
+  {
+    return SharedBuffer(this->_owner, Super::range(start, end));
+  }
+
+  void
+  SharedBuffer::pop_front(Size size)
+  {
+    ELLE_ASSERT_LTE(size, this->size());
+    Super::operator = (Super(this->contents() + size, this->size() - size));
+  }
+
+  SharedBuffer
+  SharedBuffer::split(Size size)
+  {
+    ELLE_ASSERT_LTE(size, this->size());
+    SharedBuffer res(this->_owner, Super(this->contents(), size));
+    this->pop_front(size);
+    return res;
+  }
+
+  Buffer
+  SharedBuffer::buffer() const
+  {
+    return Buffer(this->contents(), this->size());
+  }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <memory>
+
+#include <elle/Buffer.hh>
+#include <elle/attribute.hh>
+
+namespace elle
+{
+  /// @brief A view into a reference counted Buffer.
+  ///
+  /// Copies and slices share the underlying allocation, which is released
+  /// along with the last of them. This enables several consumers to hold
+  /// parts of one packet without copying it.
+  class ELLE_API SharedBuffer
+    : public ConstWeakBuffer
+  {
+  /*------.
+  | Types |
+  `------*/
+  public:
+    using Super = ConstWeakBuffer;
+    using Self = SharedBuffer;
+
+  /*-------------.
+  | Construction |
+  `-------------*/
+  public:
+    /// An empty SharedBuffer.
+    SharedBuffer();
+    /// A SharedBuffer taking ownership of \a buffer content.
+    SharedBuffer(Buffer&& buffer) /* implicit */;
+    /// A SharedBuffer viewing the whole \a buffer.
+    SharedBuffer(std::shared_ptr<Buffer const> buffer);
+    SharedBuffer(SharedBuffer const& other) = default;
+    SharedBuffer(SharedBuffer&& other);
+    SharedBuffer&
+    operator = (SharedBuffer const& other) = default;
+    SharedBuffer&
+    operator = (SharedBuffer&& other);
+  private:
+    SharedBuffer(std::shared_ptr<Buffer const> buffer, Super view);
+
+  /*--------.
+  | Content |
+  `--------*/
+  public:
+    /// A slice of this buffer, sharing its memory.
+    SharedBuffer
+    range(int start) const;
+    /// A slice of this buffer, sharing its memory.
+    SharedBuffer
+    range(int start, int end) const;
+    /// Drop \a size bytes from the front of this view.
+    void
+    pop_front(Size size = 1);
+    /// Split the first \a size bytes off this view.
+    SharedBuffer
+    split(Size size);
+    /// An owned copy of this view.
+    Buffer
+    buffer() const;
+    /// The viewed buffer.
+    ELLE_ATTRIBUTE_R(std::shared_ptr<Buffer const>, owner);
+  };
+}
@@ -143,6 +143,76 @@ namespace elle
                      Buffer::Size buffer_size):
         IOStream(new StreamBuffer(underlying, honor_flush, buffer_size))
       {}
+
+      /*---------------------.
+      | One-shot compression |
+      `---------------------*/
+
+      boost::optional<Buffer>
+      compress(std::vector<ConstWeakBuffer> const& input,
+               Buffer::Size limit,
+               int level)
+      {
+        z_stream stream{};
+        // Negative window size: raw DEFLATE, without header nor trailer.
+        auto err = deflateInit2(
+          &stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+        if (err == Z_MEM_ERROR)
+          throw std::bad_alloc();
+        else if (err != Z_OK)
+          throw elle::Exception(
+            elle::sprintf("ZLIB deflateInit error: %s", err));
+        elle::SafeFinally end([&] { deflateEnd(&stream); });
+        Buffer output(limit);
+        stream.next_out = output.mutable_contents();
+        stream.avail_out = output.size();
+        for (std::size_t i = 0; i < input.size(); ++i)
+        {
+          stream.next_in = const_cast<unsigned char*>(input[i].contents());
+          stream.avail_in = input[i].size();
+          auto flush = i + 1 == input.size() ? Z_FINISH : Z_NO_FLUSH;
+          auto ret = deflate(&stream, flush);
+          ELLE_ASSERT_NEQ(ret, Z_STREAM_ERROR);
+          if (ret == Z_STREAM_END)
+            break;
+          if (stream.avail_out == 0)
+          {
+            ELLE_DEBUG("give up compressing beyond %s bytes", limit);
+            return boost::none;
+          }
+        }
+        if (input.empty() &&
+            deflate(&stream, Z_FINISH) != Z_STREAM_END)
+          return boost::none;
+        output.size(stream.total_out);
+        return output;
+      }
+
+      Buffer
+      decompress(ConstWeakBuffer input, Buffer::Size size)
+      {
+        z_stream stream{};
+        auto err = inflateInit2(&stream, -15);
+        if (err == Z_MEM_ERROR)
+          throw std::bad_alloc();
+        else if (err != Z_OK)
+          throw elle::Exception(
+            elle::sprintf("ZLIB inflateInit error: %s", err));
+        elle::SafeFinally end([&] { inflateEnd(&stream); });
+        Buffer output(size);
+        // ZLIB rejects null output, even empty.
+        unsigned char none;
+        stream.next_in = const_cast<unsigned char*>(input.contents());
+        stream.avail_in = input.size();
+        stream.next_out = size ? output.mutable_contents() : &none;
+        stream.avail_out = output.size();
+        auto ret = inflate(&stream, Z_FINISH);
+        if (ret != Z_STREAM_END || stream.total_out != size)
+          throw elle::Exception(
+            elle::sprintf("invalid DEFLATE data: %s (%s bytes of %s)",
+                          ret, stream.total_out, size));
+        return output;
+      }
     }
   }
 }
@@ -1,6 +1,10 @@
 #ifndef ELLE_FORMAT_GZIP_HH
 # define ELLE_FORMAT_GZIP_HH
 
+# include <vector>
+
+# include <boost/optional.hpp>
+
 # include <elle/Buffer.hh>
 # include <elle/IOStream.hh>
 # include <elle/compiler.hh>
@@ -41,6 +45,25 @@ namespace elle
                bool honor_flush,
                Buffer::Size buffer_size = 1 << 16);
       };
+
+      /// Compress the concatenation of \a input to raw DEFLATE data.
+      ///
+      /// Give up and return none as soon as the output exceeds \a limit
+      /// bytes, so incompressible data costs little to detect.
+      ///
+      /// \param input The fragments to compress.
+      /// \param limit The maximum compressed size.
+      /// \param level The ZLIB compression level.
+      ELLE_API
+      boost::optional<Buffer>
+      compress(std::vector<ConstWeakBuffer> const& input,
+               Buffer::Size limit,
+               int level = 1);
+
+      /// Decompress raw DEFLATE \a input to exactly \a size bytes.
+      ELLE_API
+      Buffer
+      decompress(ConstWeakBuffer input, Buffer::Size size);
     }
   }
 }
@@ -0,0 +1,634 @@
+#include <elle/json/Parser.hh>
+
+#include <cstdlib>
+#include <cstring>
+#include <istream>
+#include <limits>
+
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
+
+#include <elle/json/exceptions.hh>
+#include <elle/log.hh>
+#include <elle/printf.hh>
+
+ELLE_LOG_COMPONENT("elle.json.Parser");
+
+namespace elle
+{
+  namespace json
+  {
+    Handler::~Handler()
+    {}
+
+    namespace _details
+    {
+      char const*
+      string_run(char const* begin, char const* end)
+      {
+#ifdef __SSE2__
+        auto const quote = _mm_set1_epi8('"');
+        auto const backslash = _mm_set1_epi8('\\');
+        auto const control = _mm_set1_epi8(0x1f);
+        for (; end - begin >= 16; begin += 16)
+        {
+          auto const chunk =
+            _mm_loadu_si128(reinterpret_cast<__m128i const*>(begin));
+          // Unsigned c <= 0x1f iff max(c, 0x1f) == 0x1f.
+          auto const special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                         _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));
+          if (auto const mask = _mm_movemask_epi8(special))
+            return begin + __builtin_ctz(mask);
+        }
+#endif
+        for (; begin != end; ++begin)
+        {
+          auto const c = static_cast<unsigned char>(*begin);
+          if (c == '"' || c == '\\' || c < 0x20)
+            break;
+        }
+        return begin;
+      }
+    }
+
+    namespace
+    {
+      bool
+      whitespace(char c)
+      {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+      }
+
+      /// First non whitespace character of [\a begin, \a end).
+      char const*
+      skip_whitespace(char const* begin, char const* end)
+      {
+#ifdef __SSE2__
+        auto const space = _mm_set1_epi8(' ');
+        auto const newline = _mm_set1_epi8('\n');
+        auto const ret = _mm_set1_epi8('\r');
+        auto const tab = _mm_set1_epi8('\t');
+        for (; end - begin >= 16; begin += 16)
+        {
+          auto const chunk =
+            _mm_loadu_si128(reinterpret_cast<__m128i const*>(begin));
+          auto const blank = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, space),
+                         _mm_cmpeq_epi8(chunk, newline)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, ret),
+                         _mm_cmpeq_epi8(chunk, tab)));
+          auto const mask = ~_mm_movemask_epi8(blank) & 0xffff;
+          if (mask)
+            return begin + __builtin_ctz(mask);
+        }
+#endif
+        while (begin != end && whitespace(*begin))
+          ++begin;
+        return begin;
+      }
+
+      /// Access to the get area of any stream buffer, to parse it in place.
+      class GetArea
+        : public std::streambuf
+      {
+      public:
+        static
+        char const*
+        begin(std::streambuf& buf)
+        {
+          return (buf.*&GetArea::gptr)();
+        }
+
+        static
+        char const*
+        end(std::streambuf& buf)
+        {
+          return (buf.*&GetArea::egptr)();
+        }
+
+        static
+        void
+        consume(std::streambuf& buf, std::ptrdiff_t n)
+        {
+          (buf.*&GetArea::gbump)(int(n));
+        }
+      };
+
+      /// Contiguous window over the input.  Streams are read in place from
+      /// their get area, which is only consumed as far as parsed: nothing
+      /// past the value is ever taken from the stream, so nothing needs to
+      /// be put back.
+      class Source
+      {
+      public:
+        Source(char const* begin, char const* end)
+          : pos(begin)
+          , end(end)
+          , _input(nullptr)
+          , _lookahead()
+          , _consumed(0)
+          , _begin(begin)
+        {}
+
+        Source(std::istream& input)
+          : pos(nullptr)
+          , end(nullptr)
+          , _input(&input)
+          , _lookahead()
+          , _consumed(0)
+          , _begin(nullptr)
+        {}
+
+        /// Fetch more input once the window is exhausted, blocking only if
+        /// the stream has nothing buffered.
+        bool
+        refill()
+        {
+          if (!this->_input)
+            return false;
+          this->_commit();
+          auto& buf = *this->_input->rdbuf();
+          auto const c = buf.sgetc();
+          if (c == std::char_traits<char>::eof())
+          {
+            this->_input->setstate(std::ios_base::eofbit);
+            return false;
+          }
+          this->_begin = this->pos = GetArea::begin(buf);
+          this->end = GetArea::end(buf);
+          // Unbuffered streams peek one character at a time.
+          if (this->pos == this->end)
+          {
+            this->_lookahead = std::char_traits<char>::to_char_type(c);
+            this->_begin = this->pos = &this->_lookahead;
+            this->end = this->pos + 1;
+          }
+          return true;
+        }
+
+        /// The next character, or EOF.
+        int
+        peek()
+        {
+          if (this->pos == this->end && !this->refill())
+            return std::char_traits<char>::eof();
+          return static_cast<unsigned char>(*this->pos);
+        }
+
+        /// Consume and return the next character, or EOF.
+        int
+        get()
+        {
+          auto const res = this->peek();
+          if (res != std::char_traits<char>::eof())
+            ++this->pos;
+          return res;
+        }
+
+        /// The next non whitespace character, or EOF.
+        int
+        next()
+        {
+          while (true)
+          {
+            this->pos = skip_whitespace(this->pos, this->end);
+            if (this->pos != this->end)
+              return static_cast<unsigned char>(*this->pos);
+            if (!this->refill())
+              return std::char_traits<char>::eof();
+          }
+        }
+
+        std::size_t
+        offset() const
+        {
+          return this->_consumed + (this->pos - this->_begin);
+        }
+
+        /// Consume the parsed input from the stream, leaving the rest.
+        void
+        finish()
+        {
+          if (!this->_input)
+            return;
+          this->_commit();
+          this->end = this->pos;
+        }
+
+        char const* pos;
+        char const* end;
+
+      private:
+        void
+        _commit()
+        {
+          auto const n = this->pos - this->_begin;
+          if (n == 0)
+            return;
+          auto& buf = *this->_input->rdbuf();
+          if (this->_begin == &this->_lookahead)
+            buf.sbumpc();
+          else
+            GetArea::consume(buf, n);
+          this->_consumed += n;
+          this->_begin = this->pos;
+        }
+
+        std::istream* _input;
+        char _lookahead;
+        std::size_t _consumed;
+        char const* _begin;
+      };
+
+      class Parser
+      {
+      public:
+        Parser(Source& source, Handler& handler)
+          : _source(source)
+          , _handler(handler)
+          , _scratch()
+        {}
+
+        void
+        value(int depth = 0)
+        {
+          if (depth > max_depth)
+            this->_error("nesting deeper than %s levels", int(max_depth));
+          auto const c = this->_source.next();
+          switch (c)
+          {
+            case '{':
+              ++this->_source.pos;
+              this->_object(depth);
+              break;
+            case '[':
+              ++this->_source.pos;
+              this->_array(depth);
+              break;
+            case '"':
+              ++this->_source.pos;
+              this->_string(false);
+              break;
+            case 't':
+              this->_literal("true");
+              this->_handler.boolean(true);
+              break;
+            case 'f':
+              this->_literal("false");
+              this->_handler.boolean(false);
+              break;
+            case 'n':
+              this->_literal("null");
+              this->_handler.null();
+              break;
+            default:
+              if (c == '-' || (c >= '0' && c <= '9'))
+                this->_number();
+              else if (c == std::char_traits<char>::eof())
+                this->_error("unexpected end of input");
+              else
+                this->_error("unexpected character '%c'", char(c));
+          }
+        }
+
+      private:
+        static int const max_depth = 1024;
+
+        template <typename ... Args>
+        [[noreturn]]
+        void
+        _error(char const* fmt, Args&& ... args)
+        {
+          throw ParseError(elle::sprintf(
+                             "JSON error at offset %s: %s",
+                             this->_source.offset(),
+                             elle::sprintf(fmt, std::forward<Args>(args)...)));
+        }
+
+        void
+        _expect(char expected)
+        {
+          auto const c = this->_source.next();
+          if (c != expected)
+          {
+            if (c == std::char_traits<char>::eof())
+              this->_error("expected '%c', got end of input", expected);
+            this->_error("expected '%c', got '%c'", expected, char(c));
+          }
+          ++this->_source.pos;
+        }
+
+        /// Consume a comma, or \a close in which case return true.  Like
+        /// json-spirit, accept trailing commas.
+        bool
+        _separator(char close)
+        {
+          auto const c = this->_source.next();
+          if (c == close || c == ',')
+          {
+            ++this->_source.pos;
+            if (c == ',' && this->_source.next() == close)
+            {
+              ++this->_source.pos;
+              return true;
+            }
+            return c == close;
+          }
+          if (c == std::char_traits<char>::eof())
+            this->_error("expected ',' or '%c', got end of input", close);
+          this->_error("expected ',' or '%c', got '%c'", close, char(c));
+        }
+
+        void
+        _object(int depth)
+        {
+          this->_handler.object_begin();
+          if (this->_source.next() == '}')
+          {
+            ++this->_source.pos;
+            this->_handler.object_end();
+            return;
+          }
+          while (true)
+          {
+            this->_expect('"');
+            this->_string(true);
+            this->_expect(':');
+            this->value(depth + 1);
+            if (this->_separator('}'))
+              break;
+          }
+          this->_handler.object_end();
+        }
+
+        void
+        _array(int depth)
+        {
+          this->_handler.array_begin();
+          if (this->_source.next() == ']')
+          {
+            ++this->_source.pos;
+            this->_handler.array_end();
+            return;
+          }
+          while (true)
+          {
+            this->value(depth + 1);
+            if (this->_separator(']'))
+              break;
+          }
+          this->_handler.array_end();
+        }
+
+        void
+        _emit(bool key, elle::ConstWeakBuffer s)
+        {
+          if (key)
+            this->_handler.key(s);
+          else
+            this->_handler.string(s);
+        }
+
+        // The opening quote is consumed.  Strings without escapes lying in
+        // the current window are handed out in place.
+        void
+        _string(bool key)
+        {
+          auto& source = this->_source;
+          this->_scratch.clear();
+          while (true)
+          {
+            if (source.pos == source.end && !source.refill())
+              this->_error("unterminated string");
+            auto const run = _details::string_run(source.pos, source.end);
+            if (run != source.end && *run == '"' && this->_scratch.empty())
+            {
+              auto const begin = source.pos;
+              source.pos = run + 1;
+              this->_emit(key, elle::ConstWeakBuffer(begin, run - begin));
+              return;
+            }
+            this->_scratch.append(source.pos, run);
+            source.pos = run;
+            if (run == source.end)
+              continue;
+            auto const c = *source.pos++;
+            if (c == '"')
+            {
+              this->_emit(key, elle::ConstWeakBuffer(this->_scratch.data(),
+                                                     this->_scratch.size()));
+              return;
+            }
+            else if (c == '\\')
+              this->_escape();
+            else
+              this->_error("unescaped control character in string");
+          }
+        }
+
+        void
+        _escape()
+        {
+          auto const c = this->_source.get();
+          switch (c)
+          {
+            case '"':
+            case '\\':
+            case '/':
+              this->_scratch.push_back(c);
+              break;
+            case 'b':
+              this->_scratch.push_back('\b');
+              break;
+            case 'f':
+              this->_scratch.push_back('\f');
+              break;
+            case 'n':
+              this->_scratch.push_back('\n');
+              break;
+            case 'r':
+              this->_scratch.push_back('\r');
+              break;
+            case 't':
+              this->_scratch.push_back('\t');
+              break;
+            case 'u':
+            {
+              auto code = this->_hex();
+              if (code >= 0xd800 && code < 0xdc00)
+              {
+                // Surrogate pair.
+                if (this->_source.get() != '\\' || this->_source.get() != 'u')
+                  this->_error("unpaired UTF-16 surrogate");
+                auto const low = this->_hex();
+                if (low < 0xdc00 || low >= 0xe000)
+                  this->_error("invalid UTF-16 low surrogate");
+                code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+              }
+              this->_utf8(code);
+              break;
+            }
+            default:
+              this->_error("invalid escape sequence");
+          }
+        }
+
+        unsigned
+        _hex()
+        {
+          unsigned res = 0;
+          for (int i = 0; i < 4; ++i)
+          {
+            auto const c = this->_source.get();
+            res <<= 4;
+            if (c >= '0' && c <= '9')
+              res += c - '0';
+            else if (c >= 'a' && c <= 'f')
+              res += c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+              res += c - 'A' + 10;
+            else
+              this->_error("invalid unicode escape");
+          }
+          return res;
+        }
+
+        void
+        _utf8(unsigned code)
+        {
+          auto& s = this->_scratch;
+          if (code < 0x80)
+            s.push_back(code);
+          else if (code < 0x800)
+          {
+            s.push_back(0xc0 | (code >> 6));
+            s.push_back(0x80 | (code & 0x3f));
+          }
+          else if (code < 0x10000)
+          {
+            s.push_back(0xe0 | (code >> 12));
+            s.push_back(0x80 | ((code >> 6) & 0x3f));
+            s.push_back(0x80 | (code & 0x3f));
+          }
+          else
+          {
+            s.push_back(0xf0 | (code >> 18));
+            s.push_back(0x80 | ((code >> 12) & 0x3f));
+            s.push_back(0x80 | ((code >> 6) & 0x3f));
+            s.push_back(0x80 | (code & 0x3f));
+          }
+        }
+
+        void
+        _literal(char const* word)
+        {
+          for (auto p = word; *p; ++p)
+            if (this->_source.get() != *p)
+              this->_error("invalid literal, expected %s", word);
+        }
+
+        bool
+        _digits()
+        {
+          bool res = false;
+          for (int c = this->_source.peek(); c >= '0' && c <= '9';
+               c = this->_source.peek())
+          {
+            this->_scratch.push_back(c);
+            ++this->_source.pos;
+            res = true;
+          }
+          return res;
+        }
+
+        void
+        _number()
+        {
+          this->_scratch.clear();
+          auto const negative = this->_source.peek() == '-';
+          if (negative)
+            this->_scratch.push_back(this->_source.get());
+          if (!this->_digits())
+            this->_error("invalid number");
+          bool integral = true;
+          if (this->_source.peek() == '.')
+          {
+            integral = false;
+            this->_scratch.push_back(this->_source.get());
+            if (!this->_digits())
+              this->_error("invalid number fraction");
+          }
+          auto const e = this->_source.peek();
+          if (e == 'e' || e == 'E')
+          {
+            integral = false;
+            this->_scratch.push_back(this->_source.get());
+            auto const sign = this->_source.peek();
+            if (sign == '+' || sign == '-')
+              this->_scratch.push_back(this->_source.get());
+            if (!this->_digits())
+              this->_error("invalid number exponent");
+          }
+          if (integral)
+          {
+            // Accumulate the magnitude, falling back to a real on overflow.
+            uint64_t magnitude = 0;
+            bool overflow = false;
+            for (auto c: this->_scratch)
+            {
+              if (c == '-')
+                continue;
+              auto const digit = uint64_t(c - '0');
+              if (magnitude >
+                  (std::numeric_limits<uint64_t>::max() - digit) / 10)
+              {
+                overflow = true;
+                break;
+              }
+              magnitude = magnitude * 10 + digit;
+            }
+            auto const limit = negative ?
+              uint64_t(std::numeric_limits<int64_t>::max()) + 1 :
+              uint64_t(std::numeric_limits<int64_t>::max());
+            if (!overflow && magnitude <= limit)
+            {
+              this->_handler.integer(
+                negative ? int64_t(0 - magnitude) : int64_t(magnitude));
+              return;
+            }
+          }
+          this->_handler.real(std::strtod(this->_scratch.c_str(), nullptr));
+        }
+
+        Source& _source;
+        Handler& _handler;
+        std::string _scratch;
+      };
+    }
+
+    void
+    parse(std::istream& input, Handler& handler)
+    {
+      ELLE_TRACE_SCOPE("parse JSON from stream");
+      Source source(input);
+      Parser(source, handler).value();
+      source.finish();
+    }
+
+    void
+    parse(elle::ConstWeakBuffer input, Handler& handler)
+    {
+      ELLE_TRACE_SCOPE("parse JSON from %s bytes", input.size());
+      auto const begin = reinterpret_cast<char const*>(input.contents());
+      Source source(begin, begin + input.size());
+      Parser(source, handler).value();
+      if (source.next() != std::char_traits<char>::eof())
+        throw ParseError(elle::sprintf(
+                           "JSON error at offset %s: garbage after value",
+                           source.offset()));
+    }
+  }
+}
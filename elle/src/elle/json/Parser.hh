@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+
+#include <elle/Buffer.hh>
+#include <elle/compiler.hh>
+
+namespace elle
+{
+  namespace json ELLE_API
+  {
+    /// Receiver of the events of a JSON parse.
+    ///
+    /// Strings and keys are unescaped views only valid during the call.
+    class Handler
+    {
+    public:
+      virtual
+      ~Handler();
+      virtual
+      void
+      null() = 0;
+      virtual
+      void
+      boolean(bool v) = 0;
+      virtual
+      void
+      integer(int64_t v) = 0;
+      virtual
+      void
+      real(double v) = 0;
+      virtual
+      void
+      string(elle::ConstWeakBuffer v) = 0;
+      virtual
+      void
+      object_begin() = 0;
+      virtual
+      void
+      key(elle::ConstWeakBuffer k) = 0;
+      virtual
+      void
+      object_end() = 0;
+      virtual
+      void
+      array_begin() = 0;
+      virtual
+      void
+      array_end() = 0;
+    };
+
+    /// Parse one JSON value from \a input without building it, consuming
+    /// nothing past its end.
+    ///
+    /// @throw ParseError if the input is not valid JSON.
+    void
+    parse(std::istream& input, Handler& handler);
+
+    /// Parse \a input, which must hold exactly one JSON value.
+    ///
+    /// @throw ParseError if the input is not valid JSON.
+    void
+    parse(elle::ConstWeakBuffer input, Handler& handler);
+
+    namespace _details
+    {
+      /// First character of [\a begin, \a end) ending a raw run of string
+      /// characters: a quote, a backslash or a control character.  Scans
+      /// 16 bytes at a time where SSE2 is available.
+      char const*
+      string_run(char const* begin, char const* end);
+    }
+  }
+}
@@ -0,0 +1,208 @@
+#include <elle/json/Writer.hh>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+
+#include <elle/assert.hh>
+
+namespace elle
+{
+  namespace json
+  {
+    Writer::Writer(std::ostream& output, bool pretty)
+      : _output(output)
+      , _pretty(pretty)
+      , _empty()
+      , _keyed(false)
+    {}
+
+    void
+    Writer::_indent()
+    {
+      if (!this->_pretty)
+        return;
+      this->_output.put('\n');
+      for (auto i = this->_empty.size(); i > 0; --i)
+        this->_output.write("    ", 4);
+    }
+
+    void
+    Writer::_value()
+    {
+      if (this->_keyed)
+      {
+        this->_keyed = false;
+        return;
+      }
+      if (this->_empty.empty())
+        return;
+      if (!this->_empty.back())
+        this->_output.put(',');
+      this->_empty.back() = false;
+      this->_indent();
+    }
+
+    void
+    Writer::null()
+    {
+      this->_value();
+      this->_output.write("null", 4);
+    }
+
+    void
+    Writer::boolean(bool v)
+    {
+      this->_value();
+      if (v)
+        this->_output.write("true", 4);
+      else
+        this->_output.write("false", 5);
+    }
+
+    void
+    Writer::integer(int64_t v)
+    {
+      this->_value();
+      char repr[24];
+      auto const size = std::snprintf(repr, sizeof repr, "%lld", (long long)v);
+      this->_output.write(repr, size);
+    }
+
+    void
+    Writer::unsigned_integer(uint64_t v)
+    {
+      this->_value();
+      char repr[24];
+      auto const size =
+        std::snprintf(repr, sizeof repr, "%llu", (unsigned long long)v);
+      this->_output.write(repr, size);
+    }
+
+    void
+    Writer::real(double v)
+    {
+      this->_value();
+      char repr[32];
+      auto size = std::snprintf(repr, sizeof repr, "%.15g", v);
+      if (std::strtod(repr, nullptr) != v)
+        size = std::snprintf(repr, sizeof repr, "%.17g", v);
+      // Keep reals distinguishable from integers.
+      if (!std::strpbrk(repr, ".eEn"))
+      {
+        repr[size++] = '.';
+        repr[size++] = '0';
+      }
+      this->_output.write(repr, size);
+    }
+
+    void
+    Writer::string(elle::ConstWeakBuffer v)
+    {
+      this->_value();
+      this->_escaped(v);
+    }
+
+    void
+    Writer::_escaped(elle::ConstWeakBuffer s)
+    {
+      auto& output = this->_output;
+      auto it = reinterpret_cast<char const*>(s.contents());
+      auto const end = it + s.size();
+      output.put('"');
+      while (true)
+      {
+        auto const run = _details::string_run(it, end);
+        output.write(it, run - it);
+        if (run == end)
+          break;
+        auto const c = static_cast<unsigned char>(*run);
+        it = run + 1;
+        switch (c)
+        {
+          case '"':
+            output.write("\\\"", 2);
+            break;
+          case '\\':
+            output.write("\\\\", 2);
+            break;
+          case '\b':
+            output.write("\\b", 2);
+            break;
+          case '\f':
+            output.write("\\f", 2);
+            break;
+          case '\n':
+            output.write("\\n", 2);
+            break;
+          case '\r':
+            output.write("\\r", 2);
+            break;
+          case '\t':
+            output.write("\\t", 2);
+            break;
+          default:
+          {
+            char escape[7];
+            std::snprintf(escape, sizeof escape, "\\u%04x", c);
+            output.write(escape, 6);
+          }
+        }
+      }
+      output.put('"');
+    }
+
+    void
+    Writer::object_begin()
+    {
+      this->_value();
+      this->_output.put('{');
+      this->_empty.push_back(true);
+    }
+
+    void
+    Writer::key(elle::ConstWeakBuffer k)
+    {
+      ELLE_ASSERT(!this->_keyed);
+      this->_value();
+      this->_escaped(k);
+      if (this->_pretty)
+        this->_output.write(" : ", 3);
+      else
+        this->_output.put(':');
+      this->_keyed = true;
+    }
+
+    void
+    Writer::_end(char close)
+    {
+      ELLE_ASSERT(!this->_empty.empty());
+      auto const empty = this->_empty.back();
+      this->_empty.pop_back();
+      if (!empty)
+        this->_indent();
+      this->_output.put(close);
+    }
+
+    void
+    Writer::object_end()
+    {
+      this->_end('}');
+    }
+
+    void
+    Writer::array_begin()
+    {
+      this->_value();
+      this->_output.put('[');
+      this->_empty.push_back(true);
+    }
+
+    void
+    Writer::array_end()
+    {
+      this->_end(']');
+    }
+  }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+#include <elle/attribute.hh>
+#include <elle/json/Parser.hh>
+
+namespace elle
+{
+  namespace json ELLE_API
+  {
+    /// Write JSON to a stream as values are produced, without building it.
+    ///
+    /// Being a Handler, a Writer can be fed by parse to reformat JSON.
+    class Writer
+      : public Handler
+    {
+    public:
+      /// Unless \a pretty, write compact JSON.
+      Writer(std::ostream& output, bool pretty = false);
+
+    public:
+      void
+      null() override;
+      void
+      boolean(bool v) override;
+      void
+      integer(int64_t v) override;
+      void
+      unsigned_integer(uint64_t v);
+      /// The shortest representation reading back to \a v.
+      void
+      real(double v) override;
+      void
+      string(elle::ConstWeakBuffer v) override;
+      void
+      object_begin() override;
+      void
+      key(elle::ConstWeakBuffer k) override;
+      void
+      object_end() override;
+      void
+      array_begin() override;
+      void
+      array_end() override;
+
+    private:
+      /// Write the separator and indentation preceding a value.
+      void
+      _value();
+      void
+      _indent();
+      void
+      _escaped(elle::ConstWeakBuffer s);
+      void
+      _end(char close);
+      ELLE_ATTRIBUTE(std::ostream&, output);
+      ELLE_ATTRIBUTE(bool, pretty);
+      /// Whether each open container is still empty.
+      ELLE_ATTRIBUTE(std::vector<bool>, empty);
+      /// Whether a key awaits its value.
+      ELLE_ATTRIBUTE(bool, keyed);
+    };
+  }
+}
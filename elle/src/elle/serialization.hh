@@ -7,7 +7,10 @@ namespace elle
 {
   struct ELLE_API serialization_tag
   {
+    /// The version of elle being built.
     static elle::Version version;
+    /// First version reading vectors of numbers as one binary block.
+    static elle::Version const bulk_version;
   };
 }
 
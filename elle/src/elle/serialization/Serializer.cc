@@ -111,6 +111,32 @@ namespace elle
       }
     }
 
+    void
+    Serializer::_serialize(elle::SharedBuffer& v)
+    {
+      if (this->in())
+      {
+        auto buf = elle::Buffer{};
+        this->_serialize(buf);
+        v = elle::SharedBuffer(std::move(buf));
+      }
+      else
+        this->_serialize(static_cast<elle::ConstWeakBuffer&>(v));
+    }
+
+    void
+    Serializer::_serialize(elle::ConstWeakBuffer& v)
+    {
+      if (this->in())
+        err<Error>("%s: unable to deserialize view \"%s\" outside of memory",
+                   *this, this->current_name());
+      else
+      {
+        auto buf = elle::Buffer(v);
+        this->_serialize(buf);
+      }
+    }
+
     void
     Serializer::set_context(Context const& context)
     {
@@ -146,6 +172,19 @@ namespace elle
       }
     }
 
+    bool
+    Serializer::_serialize_bulk(void const*, std::size_t, std::size_t)
+    {
+      return false;
+    }
+
+    bool
+    Serializer::_deserialize_bulk(
+      std::size_t, std::function<void* (std::size_t)> const&)
+    {
+      return false;
+    }
+
     void
     Serializer::_serialize_dict_key(std::string const&,
         std::function<void ()> const&)
@@ -16,6 +16,7 @@
 # include <boost/multi_index_container.hpp>
 
 # include <elle/Buffer.hh>
+# include <elle/SharedBuffer.hh>
 # include <elle/TypeInfo.hh>
 # include <elle/Version.hh>
 # include <elle/attribute.hh>
@@ -236,6 +237,19 @@ namespace elle
       void
       _serialize_array(int size, // -1 for in(), array size for out()
                        std::function<void ()> const& f) = 0;
+      /// Serialize \a count contiguous numbers of \a size bytes at \a data
+      /// as one block.  Return false, writing nothing, if the format or the
+      /// peer versions require serializing them one by one.
+      virtual
+      bool
+      _serialize_bulk(void const* data, std::size_t size, std::size_t count);
+      /// Deserialize a block of numbers of \a size bytes, \a append
+      /// returning the storage for the given count of additional elements.
+      /// Return false, consuming nothing, if they are serialized one by one.
+      virtual
+      bool
+      _deserialize_bulk(std::size_t size,
+                        std::function<void* (std::size_t)> const& append);
       virtual
       void
       _serialize_dict_key(std::string const& name,
@@ -282,6 +296,16 @@ namespace elle
       _serialize(elle::Buffer& v) = 0;
       void
       _serialize(elle::WeakBuffer& v);
+      /// Deserialized through an elle::Buffer and serialized as a view,
+      /// unless overridden.
+      virtual
+      void
+      _serialize(elle::SharedBuffer& v);
+      /// Deserializing views is only supported in place.  Serialized
+      /// through an elle::Buffer unless overridden.
+      virtual
+      void
+      _serialize(elle::ConstWeakBuffer& v);
       virtual
       void
       _serialize(boost::posix_time::ptime& v) = 0;
@@ -313,6 +337,12 @@ namespace elle
       template <typename S = void, typename T, typename A>
       void
       _serialize(std::vector<T, A>& collection);
+      template <typename S, typename T, typename A>
+      bool
+      _serialize_contiguous(std::vector<T, A>& collection, std::false_type);
+      template <typename S, typename T, typename A>
+      bool
+      _serialize_contiguous(std::vector<T, A>& collection, std::true_type);
       template <typename T, typename C, typename A>
       void
       _serialize(std::set<T, C, A>& collection);
@@ -83,6 +83,17 @@ namespace elle
            decltype(serialization_api<T, S>::deserialize(
                       std::declval<elle::serialization::SerializerIn&>()))>));
 
+      /// Numbers stored contiguously in a vector serialize as one block,
+      /// unless a custom serializer is involved.
+      template <typename T, typename S>
+      struct bulk
+        : std::integral_constant<
+            bool,
+            std::is_same<S, void>::value &&
+            (std::is_same<T, double>::value ||
+             (std::is_integral<T>::value && !std::is_same<T, bool>::value))>
+      {};
+
       template <typename T>
       struct recurse
         : std::false_type
@@ -1030,7 +1041,35 @@ namespace elle
     void
     Serializer::_serialize(std::vector<T, A>& collection)
     {
-      this->_serialize<S, std::vector, T, A>(collection);
+      if (!this->_serialize_contiguous<S>(collection,
+                                          _details::bulk<T, S>()))
+        this->_serialize<S, std::vector, T, A>(collection);
+    }
+
+    template <typename S, typename T, typename A>
+    bool
+    Serializer::_serialize_contiguous(std::vector<T, A>&, std::false_type)
+    {
+      return false;
+    }
+
+    template <typename S, typename T, typename A>
+    bool
+    Serializer::_serialize_contiguous(std::vector<T, A>& collection,
+                                      std::true_type)
+    {
+      if (this->out())
+        return this->_serialize_bulk(
+          collection.data(), sizeof(T), collection.size());
+      else
+        return this->_deserialize_bulk(
+          sizeof(T),
+          [&] (std::size_t count) -> void*
+          {
+            auto const size = collection.size();
+            collection.resize(size + count);
+            return collection.data() + size;
+          });
     }
 
     // Specific overload to catch std::vector subclasses (for das, namely).
@@ -1,5 +1,7 @@
 #include <elle/serialization/SerializerIn.hh>
 
+#include <elle/assert.hh>
+
 namespace elle
 {
   namespace serialization
@@ -7,20 +9,46 @@ namespace elle
     SerializerIn::SerializerIn(std::istream& input,
                                bool versioned)
       : Super(versioned)
-      , _input(input)
+      , _input(&input)
     {}
 
     SerializerIn::SerializerIn(std::istream& input,
                                Versions versions,
                                bool versioned)
       : Super(std::move(versions), versioned)
-      , _input(input)
+      , _input(&input)
+    {}
+
+    SerializerIn::SerializerIn(bool versioned)
+      : Super(versioned)
+      , _input(nullptr)
     {}
 
+    std::istream&
+    SerializerIn::input() const
+    {
+      ELLE_ASSERT(this->_input);
+      return *this->_input;
+    }
+
     bool
     SerializerIn::out() const
     {
       return false;
     }
+
+    bool
+    SerializerIn::deserialize_members(
+      std::function<void (elle::ConstWeakBuffer const&)> const& member)
+    {
+      return this->_deserialize_members(member);
+    }
+
+    bool
+    SerializerIn::_deserialize_members(
+      std::function<void (elle::ConstWeakBuffer const&)> const&)
+    {
+      return false;
+    }
   }
 }
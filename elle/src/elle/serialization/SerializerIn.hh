@@ -1,6 +1,7 @@
 #ifndef ELLE_SERIALIZATION_SERIALIZER_IN_HH
 # define ELLE_SERIALIZATION_SERIALIZER_IN_HH
 
+# include <functional>
 # include <iosfwd>
 
 # include <elle/attribute.hh>
@@ -29,6 +30,9 @@ namespace elle
       SerializerIn(std::istream& input, bool versioned);
       SerializerIn(std::istream& input,
                    Versions versions, bool versioned = true);
+    protected:
+      /// Construct a serializer that does not read from a stream.
+      SerializerIn(bool versioned);
 
     /*-----------.
     | Properties |
@@ -59,12 +63,34 @@ namespace elle
       T
       deserialize();
 
+      /// Deserialize the members of the current object in one pass, in
+      /// document order: \a member is called with each key while the
+      /// corresponding member is entered, and may deserialize it
+      /// anonymously or ignore it.
+      ///
+      /// @return false, having consumed nothing, if the format is not keyed
+      ///         and fields must be deserialized in order by name.
+      bool
+      deserialize_members(
+        std::function<void (elle::ConstWeakBuffer const&)> const& member);
+    protected:
+      virtual
+      bool
+      _deserialize_members(
+        std::function<void (elle::ConstWeakBuffer const&)> const& member);
+
     /*--------.
     | Details |
     `--------*/
+    public:
+      /// The stream read from.
+      ///
+      /// @pre The serializer was constructed from a stream.
+      std::istream&
+      input() const;
     protected:
       friend class Serializer;
-      ELLE_ATTRIBUTE_R(std::istream&, input);
+      ELLE_ATTRIBUTE(std::istream*, input);
     };
   }
 }
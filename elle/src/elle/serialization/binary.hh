@@ -3,6 +3,7 @@
 
 # include <elle/serialization/binary/SerializerIn.hh>
 # include <elle/serialization/binary/SerializerOut.hh>
+# include <elle/serialization/binary/Writer.hh>
 
 namespace elle
 {
@@ -47,7 +48,84 @@ namespace elle
         return elle::serialization::deserialize<Serializer, Binary, T>
           (std::forward<Args>(args)...);
       }
-}
+
+      /// Deserialize in place from \a input, which must outlive the
+      /// deserialized ConstWeakBuffer fields.
+      template <typename T, typename Serializer = void>
+      T
+      deserialize(elle::ConstWeakBuffer const& input,
+                  bool versioned = true,
+                  boost::optional<Context const&> context = {})
+      {
+        SerializerIn s(input, versioned);
+        if (context)
+          s.set_context(context.get());
+        return s.template deserialize<T, Serializer>();
+      }
+
+      /// Deserialize in place from \a input, SharedBuffer fields being
+      /// slices of it.
+      template <typename T, typename Serializer = void>
+      T
+      deserialize(elle::SharedBuffer const& input,
+                  bool versioned = true,
+                  boost::optional<Context const&> context = {})
+      {
+        SerializerIn s(input, versioned);
+        if (context)
+          s.set_context(context.get());
+        return s.template deserialize<T, Serializer>();
+      }
+
+      /// Drop-in replacements for binary::serialize to a Buffer, going
+      /// through a Writer.
+      namespace compiled
+      {
+        template <typename T>
+        elle::Buffer
+        serialize(T const& o, bool versioned = true)
+        {
+          elle::Buffer res;
+          BufferSink sink(res);
+          Writer<BufferSink> s(sink, versioned);
+          s.serialize_forward(o);
+          return res;
+        }
+
+        template <typename T>
+        elle::Buffer
+        serialize(T const& o,
+                  elle::Version const& version,
+                  bool versioned = true)
+        {
+          using Tag = typename _details::serialization_tag<T>::type;
+          auto versions = _details::dependencies<Tag>(version, 42);
+          versions.emplace(elle::type_info<Tag>(), version);
+          elle::Buffer res;
+          BufferSink sink(res);
+          Writer<BufferSink> s(sink, std::move(versions), versioned);
+          s.serialize_forward(o);
+          return res;
+        }
+
+        // Names are not written in binary.
+        template <typename T>
+        elle::Buffer
+        serialize(T const& o, std::string const&, bool versioned = true)
+        {
+          return compiled::serialize(o, versioned);
+        }
+
+        // Prevent literal string from being converted to boolean and
+        // triggerring the versioned overload.
+        template <typename T>
+        elle::Buffer
+        serialize(T const& o, char const*, bool versioned = true)
+        {
+          return compiled::serialize(o, versioned);
+        }
+      }
+    }
   }
 }
 
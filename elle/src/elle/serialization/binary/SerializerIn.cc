@@ -1,5 +1,9 @@
 #include <elle/serialization/binary/SerializerIn.hh>
 
+#include <algorithm>
+#include <cstring>
+
+#include <elle/serialization/binary/SerializerOut.hh>
 #include <elle/serialization/json/Overflow.hh>
 #include <elle/serialization/json/FieldError.hh>
 
@@ -11,9 +15,63 @@ namespace elle
   {
     namespace binary
     {
+      /*-------.
+      | Memory |
+      `-------*/
+
+      /// Stream over contiguous memory, handing out views of it.
+      class SerializerIn::Memory
+        : public std::streambuf
+      {
+      public:
+        Memory(elle::ConstWeakBuffer source,
+               boost::optional<elle::SharedBuffer> shared = {})
+          : _source(std::move(source))
+          , _shared(std::move(shared))
+          , _stream(this)
+        {
+          auto begin =
+            reinterpret_cast<char*>(const_cast<Byte*>(this->_source.contents()));
+          this->setg(begin, begin, begin + this->_source.size());
+        }
+
+        /// The next \a size bytes, which are consumed.
+        elle::ConstWeakBuffer
+        view(int size)
+        {
+          if (size < 0 || this->egptr() - this->gptr() < size)
+            err<Error>("short read: expected %s bytes, got %s",
+                       size, this->egptr() - this->gptr());
+          elle::ConstWeakBuffer res(this->gptr(), size);
+          this->setg(this->eback(), this->gptr() + size, this->egptr());
+          return res;
+        }
+
+        /// The next \a size bytes, which are consumed, sharing the source
+        /// ownership if any.
+        elle::SharedBuffer
+        slice(int size)
+        {
+          if (!this->_shared)
+            return elle::SharedBuffer(elle::Buffer(this->view(size)));
+          auto const start = this->gptr() - this->eback();
+          this->view(size);
+          return this->_shared->range(start, start + size);
+        }
+
+        ELLE_ATTRIBUTE(elle::ConstWeakBuffer, source);
+        ELLE_ATTRIBUTE(boost::optional<elle::SharedBuffer>, shared);
+        ELLE_ATTRIBUTE_X(std::istream, stream);
+      };
+
+      /*-------------.
+      | Construction |
+      `-------------*/
+
       SerializerIn::SerializerIn(std::istream& input,
                                  bool versioned)
         : Super(input, versioned)
+        , _memory()
       {
         this->_check_magic(input);
       }
@@ -22,10 +80,52 @@ namespace elle
                                  Versions versions,
                                  bool versioned)
         : Super(input, std::move(versions), versioned)
+        , _memory()
       {
         this->_check_magic(input);
       }
 
+      SerializerIn::SerializerIn(elle::ConstWeakBuffer input, bool versioned)
+        : SerializerIn(std::make_unique<Memory>(std::move(input)), versioned)
+      {}
+
+      SerializerIn::SerializerIn(elle::ConstWeakBuffer input,
+                                 Versions versions,
+                                 bool versioned)
+        : SerializerIn(std::make_unique<Memory>(std::move(input)),
+                       std::move(versions), versioned)
+      {}
+
+      SerializerIn::SerializerIn(elle::SharedBuffer input, bool versioned)
+        : SerializerIn(std::make_unique<Memory>(input, input), versioned)
+      {}
+
+      SerializerIn::SerializerIn(elle::SharedBuffer input,
+                                 Versions versions,
+                                 bool versioned)
+        : SerializerIn(std::make_unique<Memory>(input, input),
+                       std::move(versions), versioned)
+      {}
+
+      // The memory stream is heap allocated, hence alive when passed to the
+      // base class, before it is stored.
+      SerializerIn::SerializerIn(std::unique_ptr<Memory> memory,
+                                 bool versioned)
+        : Super(memory->stream(), versioned)
+        , _memory(std::move(memory))
+      {
+        this->_check_magic(this->input());
+      }
+
+      SerializerIn::SerializerIn(std::unique_ptr<Memory> memory,
+                                 Versions versions,
+                                 bool versioned)
+        : Super(memory->stream(), std::move(versions), versioned)
+        , _memory(std::move(memory))
+      {
+        this->_check_magic(this->input());
+      }
+
       void
       SerializerIn::_check_magic(std::istream& input)
       {
@@ -157,6 +257,13 @@ namespace elle
       {
         int sz = _serialize_number();
         ELLE_DEBUG("%s: deserialize size: %s", *this, sz);
+        if (this->_memory)
+        {
+          auto view = this->_memory->view(sz);
+          buffer.size(0);
+          buffer.append(view.contents(), view.size());
+          return;
+        }
         buffer.size(sz);
         input().read((char*)buffer.mutable_contents(), sz);
         if (input().gcount() != sz)
@@ -165,6 +272,26 @@ namespace elle
                      *this, this->current_name(), sz, input().gcount());
       }
 
+      void
+      SerializerIn::_serialize(elle::SharedBuffer& buffer)
+      {
+        if (!this->_memory)
+          return Super::_serialize(buffer);
+        int sz = _serialize_number();
+        ELLE_DEBUG("%s: deserialize shared size: %s", *this, sz);
+        buffer = this->_memory->slice(sz);
+      }
+
+      void
+      SerializerIn::_serialize(elle::ConstWeakBuffer& buffer)
+      {
+        if (!this->_memory)
+          return Super::_serialize(buffer);
+        int sz = _serialize_number();
+        ELLE_DEBUG("%s: deserialize view size: %s", *this, sz);
+        buffer = this->_memory->view(sz);
+      }
+
       void
       SerializerIn::_serialize(boost::posix_time::ptime& time)
       {
@@ -249,6 +376,56 @@ namespace elle
           serialize_element();
       }
 
+      bool
+      SerializerIn::_deserialize_bulk(
+        std::size_t size,
+        std::function<void* (std::size_t)> const& append)
+      {
+        auto& input = this->input();
+        if (input.peek() != SerializerOut::bulk_marker)
+          return false;
+        input.get();
+        auto const width = this->_serialize_number();
+        if (width != static_cast<int64_t>(size))
+          err<Error>("%s: unable to deserialize \"%s\": expected %s-bytes"
+                     " numbers, got %s-bytes ones",
+                     *this, this->current_name(), size, width);
+        auto const count = this->_serialize_number();
+        if (count < 0)
+          err<Error>("%s: invalid count when deserializing \"%s\": %s",
+                     *this, this->current_name(), count);
+        ELLE_DEBUG("%s: deserialize %s %s-bytes numbers as a block",
+                   *this, count, size);
+        if (this->_memory)
+        {
+          if (count > std::numeric_limits<int>::max() / int64_t(size))
+            err<Error>("%s: short read when deserializing \"%s\"",
+                       *this, this->current_name());
+          auto view = this->_memory->view(count * size);
+          auto data = append(count);
+          std::memcpy(data, view.contents(), view.size());
+          SerializerOut::little_endian(data, size, count);
+          return true;
+        }
+        // Grow by bounded chunks, not trusting the count before the bytes
+        // are actually read.
+        auto const chunk = std::max<int64_t>(1, (1 << 20) / size);
+        for (int64_t read = 0; read < count;)
+        {
+          auto const n = std::min(chunk, count - read);
+          auto data = append(n);
+          input.read(static_cast<char*>(data), n * size);
+          if (input.gcount() != static_cast<std::streamsize>(n * size))
+            err<Error>("%s: short read when deserializing \"%s\":"
+                       " expected %s, got %s",
+                       *this, this->current_name(),
+                       n * size, input.gcount());
+          SerializerOut::little_endian(data, size, n);
+          read += n;
+        }
+        return true;
+      }
+
       void
       SerializerIn::_deserialize_dict_key(
         std::function<void (std::string const&)> const& f)
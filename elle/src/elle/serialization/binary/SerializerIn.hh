@@ -1,6 +1,7 @@
 #ifndef ELLE_SERIALIZATION_BINARY_SERIALIZERIN_HH
 # define ELLE_SERIALIZATION_BINARY_SERIALIZERIN_HH
 
+# include <memory>
 # include <vector>
 
 # include <elle/attribute.hh>
@@ -29,9 +30,25 @@ namespace elle
         SerializerIn(std::istream& input, bool versioned = true);
         SerializerIn(std::istream& input,
                      Versions versions, bool versioned = true);
+        /// Deserialize in place from \a input, which must outlive the
+        /// deserialized ConstWeakBuffer fields.
+        SerializerIn(elle::ConstWeakBuffer input, bool versioned = true);
+        SerializerIn(elle::ConstWeakBuffer input,
+                     Versions versions, bool versioned = true);
+        /// Deserialize in place from \a input, SharedBuffer fields being
+        /// slices of it.
+        SerializerIn(elle::SharedBuffer input, bool versioned = true);
+        SerializerIn(elle::SharedBuffer input,
+                     Versions versions, bool versioned = true);
       private:
+        class Memory;
+        SerializerIn(std::unique_ptr<Memory> memory, bool versioned);
+        SerializerIn(std::unique_ptr<Memory> memory,
+                     Versions versions, bool versioned);
         void
         _check_magic(std::istream& input);
+        /// The source when deserializing from memory.
+        ELLE_ATTRIBUTE(std::shared_ptr<Memory>, memory);
 
       /*--------------.
       | Serialization |
@@ -78,6 +95,12 @@ namespace elle
         _serialize(elle::Buffer& v) override;
         virtual
         void
+        _serialize(elle::SharedBuffer& v) override;
+        virtual
+        void
+        _serialize(elle::ConstWeakBuffer& v) override;
+        virtual
+        void
         _serialize(boost::posix_time::ptime& v) override;
         virtual
         void
@@ -101,6 +124,11 @@ namespace elle
         void
         _deserialize_dict_key(
           std::function<void (std::string const&)> const& f) override;
+        virtual
+        bool
+        _deserialize_bulk(
+          std::size_t size,
+          std::function<void* (std::size_t)> const& append) override;
 
         virtual
         bool
@@ -1,9 +1,14 @@
 #include <elle/serialization/binary/SerializerOut.hh>
 
+#include <algorithm>
+
+#include <boost/predef/other/endian.h>
+
 #include <elle/assert.hh>
 #include <elle/finally.hh>
 #include <elle/format/base64.hh>
 #include <elle/json/json.hh>
+#include <elle/serialization.hh>
 
 ELLE_LOG_COMPONENT("elle.serialization.binary.SerializerOut")
 
@@ -17,18 +22,25 @@ namespace elle
       | Construction |
       `-------------*/
 
-      SerializerOut::SerializerOut(std::ostream& output, bool versioned)
+      SerializerOut::SerializerOut(std::ostream& output,
+                                   bool versioned,
+                                   bool magic)
         : Super(output, versioned)
+        , _bulk(SerializerOut::bulk(this->versions()))
       {
-        this->_write_magic(output);
+        if (magic)
+          this->_write_magic(output);
       }
 
       SerializerOut::SerializerOut(std::ostream& output,
                                    Versions versions,
-                                   bool versioned)
+                                   bool versioned,
+                                   bool magic)
         : Super(output, std::move(versions), versioned)
+        , _bulk(SerializerOut::bulk(this->versions()))
       {
-        this->_write_magic(output);
+        if (magic)
+          this->_write_magic(output);
       }
 
       void
@@ -122,6 +134,64 @@ namespace elle
         f();
       }
 
+      unsigned char const SerializerOut::bulk_marker;
+
+      bool
+      SerializerOut::bulk(boost::optional<Versions> const& versions)
+      {
+        if (!versions)
+          return true;
+        auto it = versions->find(type_info<elle::serialization_tag>());
+        return it != versions->end() &&
+          it->second >= elle::serialization_tag::bulk_version;
+      }
+
+      void
+      SerializerOut::little_endian(void* data,
+                                   std::size_t size,
+                                   std::size_t count)
+      {
+#if BOOST_ENDIAN_BIG_BYTE
+        if (size > 1)
+          for (auto it = static_cast<unsigned char*>(data),
+                 end = it + size * count; it != end; it += size)
+            std::reverse(it, it + size);
+#else
+        (void) data;
+        (void) size;
+        (void) count;
+#endif
+      }
+
+      // Written as the marker, the size of numbers, their count and their
+      // little endian bytes, which is a plain copy on most hosts.
+      bool
+      SerializerOut::_serialize_bulk(void const* data,
+                                     std::size_t size,
+                                     std::size_t count)
+      {
+        if (!this->_bulk)
+          return false;
+        ELLE_DEBUG("serialize %s %s-bytes numbers as a block", count, size);
+        auto& output = this->output();
+        output.put(bulk_marker);
+        SerializerOut::serialize_number(output, size);
+        SerializerOut::serialize_number(output, count);
+#if BOOST_ENDIAN_BIG_BYTE
+        if (size > 1)
+        {
+          elle::Buffer swapped(data, size * count);
+          SerializerOut::little_endian(
+            swapped.mutable_contents(), size, count);
+          output.write(reinterpret_cast<char const*>(swapped.contents()),
+                       swapped.size());
+          return true;
+        }
+#endif
+        output.write(static_cast<char const*>(data), size * count);
+        return true;
+      }
+
       void
       SerializerOut::_serialize_dict_key(std::string const& name,
                                          std::function<void ()> const& f)
@@ -206,6 +276,21 @@ namespace elle
           output().write((const char*)buffer.contents(), buffer.size());
       }
 
+      void
+      SerializerOut::_serialize(elle::SharedBuffer& buffer)
+      {
+        this->_serialize(static_cast<elle::ConstWeakBuffer&>(buffer));
+      }
+
+      void
+      SerializerOut::_serialize(elle::ConstWeakBuffer& buffer)
+      {
+        ELLE_DEBUG("serialize size: %s", buffer.size())
+          this->_serialize_number(buffer.size());
+        ELLE_DEBUG("serialize content: %f", buffer)
+          output().write((const char*)buffer.contents(), buffer.size());
+      }
+
       void
       SerializerOut::_serialize(boost::posix_time::ptime& time)
       {
@@ -26,14 +26,21 @@ namespace elle
       | Construction |
       `-------------*/
       public:
-        SerializerOut(std::ostream& output, bool versioned = true);
+        /// Unless \a magic is false, start with the binary magic.
         SerializerOut(std::ostream& output,
-                      Versions versions, bool versioned = true);
+                      bool versioned = true,
+                      bool magic = true);
+        SerializerOut(std::ostream& output,
+                      Versions versions,
+                      bool versioned = true,
+                      bool magic = true);
         virtual
         ~SerializerOut();
       private:
         void
         _write_magic(std::ostream& output);
+        /// Whether vectors of numbers are written as one block.
+        ELLE_ATTRIBUTE(bool, bulk);
 
       /*--------------.
       | Serialization |
@@ -50,6 +57,11 @@ namespace elle
         _serialize_array(int size,
                          std::function<void ()> const& f) override;
         virtual
+        bool
+        _serialize_bulk(void const* data,
+                        std::size_t size,
+                        std::size_t count) override;
+        virtual
         void
         _serialize_dict_key(std::string const& name,
                             std::function<void ()> const& f) override;
@@ -91,6 +103,12 @@ namespace elle
         _serialize(elle::Buffer& v) override;
         virtual
         void
+        _serialize(elle::SharedBuffer& v) override;
+        virtual
+        void
+        _serialize(elle::ConstWeakBuffer& v) override;
+        virtual
+        void
         _serialize(boost::posix_time::ptime& v) override;
         virtual
         void
@@ -111,6 +129,19 @@ namespace elle
         size_t
         serialize_number(std::ostream& output,
                          int64_t number);
+        /// First byte of a block of numbers, never starting a number.
+        static unsigned char const bulk_marker = 0x80;
+        /// Whether peers at \a versions read blocks of numbers, that is
+        /// elle::serialization_tag::bulk_version onwards.  Unless
+        /// elle's own version is pinned, pinned versions denote older peers.
+        static
+        bool
+        bulk(boost::optional<Versions> const& versions);
+        /// Convert \a count numbers of \a size bytes at \a data between
+        /// host and little endian byte order.
+        static
+        void
+        little_endian(void* data, std::size_t size, std::size_t count);
 
       private:
         void
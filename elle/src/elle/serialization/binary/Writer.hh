@@ -0,0 +1,267 @@
+#ifndef ELLE_SERIALIZATION_BINARY_WRITER_HH
+# define ELLE_SERIALIZATION_BINARY_WRITER_HH
+
+# include <chrono>
+# include <cstdint>
+# include <deque>
+# include <list>
+# include <map>
+# include <memory>
+# include <set>
+# include <string>
+# include <unordered_map>
+# include <unordered_set>
+# include <utility>
+# include <vector>
+
+# include <boost/optional.hpp>
+
+# include <elle/Buffer.hh>
+# include <elle/Version.hh>
+# include <elle/attribute.hh>
+# include <elle/serialization/Serializer.hh>
+
+namespace elle
+{
+  namespace serialization
+  {
+    namespace binary
+    {
+      /// Sink appending bytes to a growable Buffer.
+      class BufferSink
+      {
+      public:
+        BufferSink(elle::Buffer& buffer);
+        void
+        write(void const* data, std::size_t size);
+        ELLE_ATTRIBUTE_R(elle::Buffer&, buffer);
+      };
+
+      /// Binary serializer resolved at compile time.
+      ///
+      /// Write the exact same bytes as binary::SerializerOut into a \a Sink
+      /// providing `write(void const*, std::size_t)`, without virtual calls,
+      /// std::function nor std::ostream.  Numbers, strings, buffers, dates,
+      /// durations, standard containers, options and pointers are encoded
+      /// inline, as are objects whose serialize method is a template over the
+      /// serializer:
+      ///
+      ///   template <typename S>
+      ///   void
+      ///   serialize(S& s)
+      ///   {
+      ///     s.serialize("x", this->_x);
+      ///   }
+      ///
+      /// Such methods keep working with the dynamic Serializer for
+      /// deserialization.  Objects that only take a Serializer&, as well as
+      /// Serialize<T> wrappers and functions, are written by a
+      /// binary::SerializerOut for their own subtree.
+      template <typename Sink>
+      class Writer
+      {
+      /*------.
+      | Types |
+      `------*/
+      public:
+        typedef Writer<Sink> Self;
+        typedef Serializer::Versions Versions;
+
+      /*-------------.
+      | Construction |
+      `-------------*/
+      public:
+        /// Write the binary magic to \a sink.
+        Writer(Sink& sink, bool versioned = true);
+        /// Write the binary magic to \a sink.
+        Writer(Sink& sink, Versions versions, bool versioned = true);
+
+      /*-----------.
+      | Properties |
+      `-----------*/
+      public:
+        bool
+        in() const;
+        bool
+        out() const;
+        bool
+        text() const;
+        ELLE_ATTRIBUTE(Sink&, sink);
+        ELLE_ATTRIBUTE_R(bool, versioned);
+        ELLE_ATTRIBUTE_R(boost::optional<Versions>, versions);
+        /// Whether vectors of numbers are written as one block.
+        ELLE_ATTRIBUTE(bool, bulk);
+
+      /*--------------.
+      | Serialization |
+      `--------------*/
+      public:
+        /// Serialize \a v.  Binary serialization is anonymous: \a name is
+        /// neither copied nor written.
+        template <typename Name, typename T>
+        void
+        serialize(Name const& name, T const& v);
+        template <typename Name, typename T, typename As>
+        void
+        serialize(Name const& name, T const& v, as<As>);
+        template <typename T>
+        void
+        serialize_forward(T const& v);
+        /// Contexts only matter when deserializing.
+        template <typename T>
+        void
+        serialize_context(T& value);
+      private:
+        void
+        _number(int64_t n);
+        void
+        _write(int8_t v);
+        void
+        _write(uint8_t v);
+        void
+        _write(int16_t v);
+        void
+        _write(uint16_t v);
+        void
+        _write(int32_t v);
+        void
+        _write(uint32_t v);
+        void
+        _write(int64_t v);
+        void
+        _write(uint64_t v);
+        void
+        _write(bool v);
+        void
+        _write(double v);
+        void
+        _write(char const* v);
+        void
+        _write(std::string const& v);
+        void
+        _write(elle::Buffer const& v);
+        void
+        _write(elle::ConstWeakBuffer const& v);
+        void
+        _write(elle::WeakBuffer const& v);
+        void
+        _write(elle::SharedBuffer const& v);
+        void
+        _write(boost::posix_time::ptime const& v);
+        void
+        _write(elle::Version const& v);
+        template <typename Repr, typename Ratio>
+        void
+        _write(std::chrono::duration<Repr, Ratio> const& v);
+        template <typename T>
+        void
+        _write(boost::optional<T> const& v);
+        template <typename T, typename D>
+        void
+        _write(std::unique_ptr<T, D> const& v);
+        template <typename T>
+        void
+        _write(std::shared_ptr<T> const& v);
+        template <typename T>
+        void
+        _write(T* v);
+        template <typename T1, typename T2>
+        void
+        _write(std::pair<T1, T2> const& v);
+        template <typename T, typename A>
+        void
+        _write(std::vector<T, A> const& v);
+        template <typename T, typename A>
+        void
+        _write(std::list<T, A> const& v);
+        template <typename T, typename A>
+        void
+        _write(std::deque<T, A> const& v);
+        template <typename T, typename C, typename A>
+        void
+        _write(std::set<T, C, A> const& v);
+        template <typename V, typename ... Rest>
+        void
+        _write(std::unordered_set<V, Rest...> const& v);
+        template <typename K, typename V, typename ... Rest>
+        void
+        _write(std::map<K, V, Rest...> const& v);
+        template <typename K, typename V, typename ... Rest>
+        void
+        _write(std::unordered_map<K, V, Rest...> const& v);
+        template <typename V, typename ... Rest>
+        void
+        _write(std::unordered_map<std::string, V, Rest...> const& v);
+        template <typename K, typename V, typename ... Rest>
+        void
+        _write(std::unordered_multimap<K, V, Rest...> const& v);
+        /// Objects, dispatched as the dynamic Serializer would.
+        template <typename T>
+        void
+        _write(T const& v);
+        template <typename T, typename A>
+        void
+        _write_vector(std::vector<T, A> const& v, std::false_type);
+        /// Write numbers as one block, as binary::SerializerOut does.
+        template <typename T, typename A>
+        void
+        _write_vector(std::vector<T, A> const& v, std::true_type);
+        template <typename C>
+        void
+        _write_collection(C const& collection);
+        template <typename C>
+        void
+        _write_assoc(C const& map);
+        /// Write the presence flag and the pointee.
+        template <typename P>
+        void
+        _write_pointer(P const& ptr, std::false_type);
+        /// Let binary::SerializerOut resolve the dynamic type.
+        template <typename P>
+        void
+        _write_pointer(P const& ptr, std::true_type);
+
+      /*---------.
+      | Dispatch |
+      `---------*/
+      private:
+        enum API
+        {
+          /// serialize(S&) accepting a Writer.
+          compiled,
+          /// serialize(S&, elle::Version const&) accepting a Writer.
+          compiled_versionned,
+          /// Serialize<T>::convert.
+          convert,
+          /// Anything binary::SerializerOut must handle.
+          dynamic,
+        };
+        template <typename T>
+        static
+        API constexpr
+        _api();
+        template <typename T>
+        void
+        _write_object(T const& v, std::integral_constant<API, compiled>);
+        template <typename T>
+        void
+        _write_object(T const& v,
+                      std::integral_constant<API, compiled_versionned>);
+        template <typename T>
+        void
+        _write_object(T const& v, std::integral_constant<API, convert>);
+        template <typename T>
+        void
+        _write_object(T const& v, std::integral_constant<API, dynamic>);
+        /// Write \a v through a binary::SerializerOut, without magic.
+        template <typename T>
+        void
+        _write_dynamic(T const& v);
+      };
+    }
+  }
+}
+
+# include <elle/serialization/binary/Writer.hxx>
+
+#endif
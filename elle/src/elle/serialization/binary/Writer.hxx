@@ -0,0 +1,638 @@
+#ifndef ELLE_SERIALIZATION_BINARY_WRITER_HXX
+# define ELLE_SERIALIZATION_BINARY_WRITER_HXX
+
+# include <cstring>
+# include <sstream>
+
+# include <boost/predef/other/endian.h>
+
+# include <elle/IOStream.hh>
+# include <elle/serialization/binary/SerializerOut.hh>
+
+namespace elle
+{
+  namespace serialization
+  {
+    namespace _details
+    {
+      ELLE_SERIALIZATION_STATIC_PREDICATE(
+        has_serialize_template_api,
+        (decltype(std::declval<T&>().serialize(std::declval<S&>()))));
+      ELLE_SERIALIZATION_STATIC_PREDICATE(
+        has_serialize_template_versionned_api,
+        (decltype(std::declval<T&>().serialize(
+                    std::declval<S&>(),
+                    std::declval<elle::Version const&>()))));
+    }
+
+    namespace binary
+    {
+      /*-----------.
+      | BufferSink |
+      `-----------*/
+
+      inline
+      BufferSink::BufferSink(elle::Buffer& buffer)
+        : _buffer(buffer)
+      {}
+
+      inline
+      void
+      BufferSink::write(void const* data, std::size_t size)
+      {
+        auto const offset = this->_buffer.size();
+        this->_buffer.size(offset + size);
+        std::memcpy(this->_buffer.mutable_contents() + offset, data, size);
+      }
+
+      /*-------------.
+      | Construction |
+      `-------------*/
+
+      template <typename Sink>
+      Writer<Sink>::Writer(Sink& sink, bool versioned)
+        : _sink(sink)
+        , _versioned(versioned)
+        , _versions()
+        , _bulk(SerializerOut::bulk(this->_versions))
+      {
+        static char const magic = 0;
+        this->_sink.write(&magic, 1);
+      }
+
+      template <typename Sink>
+      Writer<Sink>::Writer(Sink& sink, Versions versions, bool versioned)
+        : _sink(sink)
+        , _versioned(versioned)
+        , _versions(std::move(versions))
+        , _bulk(SerializerOut::bulk(this->_versions))
+      {
+        static char const magic = 0;
+        this->_sink.write(&magic, 1);
+      }
+
+      /*-----------.
+      | Properties |
+      `-----------*/
+
+      template <typename Sink>
+      bool
+      Writer<Sink>::in() const
+      {
+        return false;
+      }
+
+      template <typename Sink>
+      bool
+      Writer<Sink>::out() const
+      {
+        return true;
+      }
+
+      template <typename Sink>
+      bool
+      Writer<Sink>::text() const
+      {
+        return false;
+      }
+
+      /*--------------.
+      | Serialization |
+      `--------------*/
+
+      template <typename Sink>
+      template <typename Name, typename T>
+      void
+      Writer<Sink>::serialize(Name const&, T const& v)
+      {
+        static_assert(
+          !std::is_base_of<VirtuallySerializableBase, T>::value,
+          "serialize VirtuallySerializable objects through a pointer type");
+        this->_write(v);
+      }
+
+      template <typename Sink>
+      template <typename Name, typename T, typename As>
+      void
+      Writer<Sink>::serialize(Name const&, T const& v, as<As>)
+      {
+        this->_write(As(v));
+      }
+
+      template <typename Sink>
+      template <typename T>
+      void
+      Writer<Sink>::serialize_forward(T const& v)
+      {
+        this->_write(v);
+      }
+
+      template <typename Sink>
+      template <typename T>
+      void
+      Writer<Sink>::serialize_context(T&)
+      {}
+
+      /*--------.
+      | Numbers |
+      `--------*/
+
+      // Same encoding as binary::SerializerOut::serialize_number.
+      template <typename Sink>
+      void
+      Writer<Sink>::_number(int64_t n)
+      {
+        bool neg = n < 0;
+        if (neg)
+          n = -n;
+        unsigned char ser[9];
+        if (n <= 0x3f)
+        {
+          ser[0] = (neg ? 0x80 : 0) + n;
+          this->_sink.write(ser, 1);
+        }
+        else if (n <= 0x1fff)
+        {
+          ser[0] = (neg ? 0xC0 : 0x40) + (n >> 8);
+          ser[1] = n;
+          this->_sink.write(ser, 2);
+        }
+        else if (n <= 0x0fffff)
+        {
+          ser[0] = (neg ? 0xe0 : 0x60) + (n >> 16);
+          ser[1] = n >> 8;
+          ser[2] = n;
+          this->_sink.write(ser, 3);
+        }
+        else
+        {
+          ser[0] = neg ? 0xFF : 0x7F;
+          std::memcpy(ser + 1, &n, 8);
+          this->_sink.write(ser, 9);
+        }
+      }
+
+      template <typename Sink>
+      void
+      Writer<Sink>::_write(int8_t v)
+      {
+        this->_number(v);
+      }
+
+      template <typename Sink>
+      void
+      Writer<Sink>::_write(uint8_t v)
+      {
+        this->_number(v);
+      }
+
+      template <typename Sink>
+      void
+      Writer<Sink>::_write(int16_t v)
+      {
+        this->_number(v);
+      }
+
+      template <typename Sink>
+      void
+      Writer<Sink>::_write(uint16_t v)
+      {
+        this->_number(v);
+      }
+
+      template <typename Sink>
+      void
+      Writer<Sink>::_write(int32_t v)
+      {
+        this->_number(v);
+      }
+
+      template <typename Sink>
+      void
+      Writer<Sink>::_write(uint32_t v)
+      {
+        this->_number(v);
+      }
+
+      template <typename Sink>
+      void
+      Writer<Sink>::_write(int64_t v)
+      {
+        this->_number(v);
+      }
+
+      template <typename Sink>
+      void
+      Writer<Sink>::_write(uint64_t v)
+      {
+        this->_number(v);
+      }
+
+      template <typename Sink>
+      void
+      Writer<Sink>::_write(bool v)
+      {
+        this->_number(v ? 1 : 0);
+      }
+
+      template <typename Sink>
+      void
+      Writer<Sink>::_write(double v)
+      {
+        this->_sink.write(&v, sizeof(double));
+      }
+
+      /*--------.
+      | Strings |
+      `--------*/
+
+      template <typename Sink>
+      void
+      Writer<Sink>::_write(char const* v)
+      {
+        auto const size = std::strlen(v);
+        this->_number(size);
+        this->_sink.write(v, size);
+      }
+
+      template <typename Sink>
+      void
+      Writer<Sink>::_write(std::string const& v)
+      {
+        this->_number(v.size());
+        this->_sink.write(v.data(), v.size());
+      }
+
+      template <typename Sink>
+      void
+      Writer<Sink>::_write(elle::Buffer const& v)
+      {
+        this->_number(v.size());
+        this->_sink.write(v.contents(), v.size());
+      }
+
+      template <typename Sink>
+      void
+      Writer<Sink>::_write(elle::ConstWeakBuffer const& v)
+      {
+        this->_number(v.size());
+        this->_sink.write(v.contents(), v.size());
+      }
+
+      template <typename Sink>
+      void
+      Writer<Sink>::_write(elle::WeakBuffer const& v)
+      {
+        this->_write(static_cast<elle::ConstWeakBuffer const&>(v));
+      }
+
+      template <typename Sink>
+      void
+      Writer<Sink>::_write(elle::SharedBuffer const& v)
+      {
+        this->_write(static_cast<elle::ConstWeakBuffer const&>(v));
+      }
+
+      template <typename Sink>
+      void
+      Writer<Sink>::_write(boost::posix_time::ptime const& v)
+      {
+        std::stringstream ss;
+        auto output_facet = std::make_unique<boost::posix_time::time_facet>();
+        // ISO 8601
+        output_facet->format("%Y-%m-%dT%H:%M:%S%F%q");
+        ss.imbue(std::locale(ss.getloc(), output_facet.release()));
+        ss << v;
+        this->_write(ss.str());
+      }
+
+      // Versions are never versioned themselves.
+      template <typename Sink>
+      void
+      Writer<Sink>::_write(elle::Version const& v)
+      {
+        this->_write(v.major());
+        this->_write(v.minor());
+        this->_write(v.subminor());
+      }
+
+      template <typename Sink>
+      template <typename Repr, typename Ratio>
+      void
+      Writer<Sink>::_write(std::chrono::duration<Repr, Ratio> const& v)
+      {
+        this->_number(v.count());
+        this->_number(Ratio::num);
+        this->_number(Ratio::den);
+      }
+
+      /*------------------.
+      | Options, pointers |
+      `------------------*/
+
+      template <typename Sink>
+      template <typename T>
+      void
+      Writer<Sink>::_write(boost::optional<T> const& v)
+      {
+        this->_write(bool(v));
+        if (v)
+          this->_write(v.get());
+      }
+
+      template <typename Sink>
+      template <typename T, typename D>
+      void
+      Writer<Sink>::_write(std::unique_ptr<T, D> const& v)
+      {
+        this->_write_pointer(
+          v, std::is_base_of<VirtuallySerializableBase, T>());
+      }
+
+      template <typename Sink>
+      template <typename T>
+      void
+      Writer<Sink>::_write(std::shared_ptr<T> const& v)
+      {
+        this->_write_pointer(
+          v, std::is_base_of<VirtuallySerializableBase, T>());
+      }
+
+      template <typename Sink>
+      template <typename T>
+      void
+      Writer<Sink>::_write(T* v)
+      {
+        this->_write_pointer(
+          v,
+          std::integral_constant<
+            bool,
+            std::is_base_of<VirtuallySerializableBase, T>::value ||
+            _details::has_serialize_convert_api<T*, void>()>());
+      }
+
+      template <typename Sink>
+      template <typename P>
+      void
+      Writer<Sink>::_write_pointer(P const& ptr, std::false_type)
+      {
+        this->_write(bool(ptr));
+        if (ptr)
+          this->_write(*ptr);
+      }
+
+      template <typename Sink>
+      template <typename P>
+      void
+      Writer<Sink>::_write_pointer(P const& ptr, std::true_type)
+      {
+        this->_write_dynamic(ptr);
+      }
+
+      /*------------.
+      | Collections |
+      `------------*/
+
+      template <typename Sink>
+      template <typename T1, typename T2>
+      void
+      Writer<Sink>::_write(std::pair<T1, T2> const& v)
+      {
+        this->_number(2);
+        this->_write(v.first);
+        this->_write(v.second);
+      }
+
+      template <typename Sink>
+      template <typename T, typename A>
+      void
+      Writer<Sink>::_write(std::vector<T, A> const& v)
+      {
+        this->_write_vector(v, _details::bulk<T, void>());
+      }
+
+      template <typename Sink>
+      template <typename T, typename A>
+      void
+      Writer<Sink>::_write_vector(std::vector<T, A> const& v, std::false_type)
+      {
+        this->_write_collection(v);
+      }
+
+      template <typename Sink>
+      template <typename T, typename A>
+      void
+      Writer<Sink>::_write_vector(std::vector<T, A> const& v, std::true_type)
+      {
+        if (!this->_bulk)
+          return this->_write_collection(v);
+        static unsigned char const marker = SerializerOut::bulk_marker;
+        this->_sink.write(&marker, 1);
+        this->_number(sizeof(T));
+        this->_number(v.size());
+# if BOOST_ENDIAN_BIG_BYTE
+        if (sizeof(T) > 1)
+        {
+          std::vector<T> swapped(v.begin(), v.end());
+          SerializerOut::little_endian(swapped.data(), sizeof(T), v.size());
+          this->_sink.write(swapped.data(), sizeof(T) * v.size());
+          return;
+        }
+# endif
+        this->_sink.write(v.data(), sizeof(T) * v.size());
+      }
+
+      template <typename Sink>
+      template <typename T, typename A>
+      void
+      Writer<Sink>::_write(std::list<T, A> const& v)
+      {
+        this->_write_collection(v);
+      }
+
+      template <typename Sink>
+      template <typename T, typename A>
+      void
+      Writer<Sink>::_write(std::deque<T, A> const& v)
+      {
+        this->_write_collection(v);
+      }
+
+      template <typename Sink>
+      template <typename T, typename C, typename A>
+      void
+      Writer<Sink>::_write(std::set<T, C, A> const& v)
+      {
+        this->_write_collection(v);
+      }
+
+      template <typename Sink>
+      template <typename V, typename ... Rest>
+      void
+      Writer<Sink>::_write(std::unordered_set<V, Rest...> const& v)
+      {
+        this->_write_collection(v);
+      }
+
+      template <typename Sink>
+      template <typename K, typename V, typename ... Rest>
+      void
+      Writer<Sink>::_write(std::map<K, V, Rest...> const& v)
+      {
+        this->_write_assoc(v);
+      }
+
+      template <typename Sink>
+      template <typename K, typename V, typename ... Rest>
+      void
+      Writer<Sink>::_write(std::unordered_map<K, V, Rest...> const& v)
+      {
+        this->_write_assoc(v);
+      }
+
+      // String-keyed dictionaries are written as key/value sequences, not
+      // as pairs.
+      template <typename Sink>
+      template <typename V, typename ... Rest>
+      void
+      Writer<Sink>::_write(
+        std::unordered_map<std::string, V, Rest...> const& v)
+      {
+        this->_number(v.size());
+        for (auto const& pair: v)
+        {
+          this->_write(pair.first);
+          this->_write(pair.second);
+        }
+      }
+
+      template <typename Sink>
+      template <typename K, typename V, typename ... Rest>
+      void
+      Writer<Sink>::_write(std::unordered_multimap<K, V, Rest...> const& v)
+      {
+        this->_write_assoc(v);
+      }
+
+      template <typename Sink>
+      template <typename C>
+      void
+      Writer<Sink>::_write_collection(C const& collection)
+      {
+        this->_number(collection.size());
+        for (auto const& elt: collection)
+          this->_write(elt);
+      }
+
+      template <typename Sink>
+      template <typename C>
+      void
+      Writer<Sink>::_write_assoc(C const& map)
+      {
+        this->_number(map.size());
+        for (auto const& pair: map)
+          this->_write(pair);
+      }
+
+      /*---------.
+      | Dispatch |
+      `---------*/
+
+      // Mirror Serializer::Details::api, dynamic Serializer method APIs being
+      // compiled whenever they accept a Writer.
+      template <typename Sink>
+      template <typename T>
+      constexpr
+      typename Writer<Sink>::API
+      Writer<Sink>::_api()
+      {
+        return
+          _details::has_serialize_convert_api<T, void>() ? convert :
+          _details::has_serialize_wrapper_api<T>() ? dynamic :
+          _details::has_serialize_functions_api<T, void>() ? dynamic :
+          _details::has_serialize_method_api<T, void>() ?
+            (_details::has_serialize_template_api<T, Self>() ?
+             compiled : dynamic) :
+          _details::has_serialize_method_versionned_api<T, void>() ?
+            (_details::has_serialize_template_versionned_api<T, Self>() ?
+             compiled_versionned : dynamic) :
+          dynamic;
+      }
+
+      template <typename Sink>
+      template <typename T>
+      void
+      Writer<Sink>::_write(T const& v)
+      {
+        this->_write_object(v, std::integral_constant<API, _api<T>()>());
+      }
+
+      template <typename Sink>
+      template <typename T>
+      void
+      Writer<Sink>::_write_object(T const& v,
+                                  std::integral_constant<API, compiled>)
+      {
+        if (this->_versioned)
+          this->_write(_details::version_tag<T>(this->_versions));
+        elle::unconst(v).serialize(*this);
+      }
+
+      template <typename Sink>
+      template <typename T>
+      void
+      Writer<Sink>::_write_object(
+        T const& v,
+        std::integral_constant<API, compiled_versionned>)
+      {
+        auto const version = _details::version_tag<T>(this->_versions);
+        if (this->_versioned)
+          this->_write(version);
+        elle::unconst(v).serialize(*this, version);
+      }
+
+      template <typename Sink>
+      template <typename T>
+      void
+      Writer<Sink>::_write_object(T const& v,
+                                  std::integral_constant<API, convert>)
+      {
+        using Type = typename Serialize<T>::Type;
+        this->_write(Type(Serialize<T>::convert(elle::unconst(v))));
+      }
+
+      template <typename Sink>
+      template <typename T>
+      void
+      Writer<Sink>::_write_object(T const& v,
+                                  std::integral_constant<API, dynamic>)
+      {
+        this->_write_dynamic(v);
+      }
+
+      template <typename Sink>
+      template <typename T>
+      void
+      Writer<Sink>::_write_dynamic(T const& v)
+      {
+        elle::Buffer buffer;
+        {
+          elle::IOStream output(buffer.ostreambuf());
+          if (this->_versions)
+          {
+            SerializerOut s(output, *this->_versions, this->_versioned, false);
+            s.serialize_forward(v);
+          }
+          else
+          {
+            SerializerOut s(output, this->_versioned, false);
+            s.serialize_forward(v);
+          }
+        }
+        this->_sink.write(buffer.contents(), buffer.size());
+      }
+    }
+  }
+}
+
+#endif
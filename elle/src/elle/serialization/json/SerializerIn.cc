@@ -1,11 +1,15 @@
 #include <elle/serialization/json/SerializerIn.hh>
 
+#include <algorithm>
+#include <cstring>
 #include <limits>
+#include <sstream>
 
 #include <elle/Backtrace.hh>
 #include <elle/chrono.hh>
 #include <elle/format/base64.hh>
 #include <elle/finally.hh>
+#include <elle/json/Parser.hh>
 #include <elle/json/exceptions.hh>
 #include <elle/memory.hh>
 #include <elle/printf.hh>
@@ -14,6 +18,7 @@
 #include <elle/serialization/json/Overflow.hh>
 #include <elle/serialization/json/TypeError.hh>
 #include <elle/serialization/json/FieldError.hh>
+#include <elle/unreachable.hh>
 
 ELLE_LOG_COMPONENT("elle.serialization.json.SerializerIn");
 
@@ -23,6 +28,260 @@ namespace elle
   {
     namespace json
     {
+      /*--------.
+      | Builder |
+      `--------*/
+
+      /// Store parsing events as flat nodes.
+      class SerializerIn::Builder
+        : public elle::json::Handler
+      {
+      public:
+        Builder(std::vector<Node>& nodes, std::string& strings)
+          : _nodes(nodes)
+          , _strings(strings)
+          , _open()
+          , _key{0, 0}
+        {}
+
+        void
+        null() override
+        {
+          this->_push(Node::Type::null);
+        }
+
+        void
+        boolean(bool v) override
+        {
+          this->_push(Node::Type::boolean).boolean = v;
+        }
+
+        void
+        integer(int64_t v) override
+        {
+          this->_push(Node::Type::integer).integer = v;
+        }
+
+        void
+        real(double v) override
+        {
+          this->_push(Node::Type::real).real = v;
+        }
+
+        void
+        string(elle::ConstWeakBuffer v) override
+        {
+          auto const span = this->_intern(v);
+          this->_push(Node::Type::string).string = span;
+        }
+
+        void
+        object_begin() override
+        {
+          this->_push(Node::Type::object);
+          this->_open.push_back(this->_nodes.size() - 1);
+        }
+
+        void
+        key(elle::ConstWeakBuffer k) override
+        {
+          this->_key = this->_intern(k);
+        }
+
+        void
+        object_end() override
+        {
+          this->_shadow(this->_open.back());
+          this->_close();
+        }
+
+        void
+        array_begin() override
+        {
+          this->_push(Node::Type::array);
+          this->_open.push_back(this->_nodes.size() - 1);
+        }
+
+        void
+        array_end() override
+        {
+          this->_close();
+        }
+
+      private:
+        static
+        void
+        _check_size(std::size_t size)
+        {
+          if (size >= std::numeric_limits<uint32_t>::max())
+            throw elle::json::ParseError("JSON document too large");
+        }
+
+        Node&
+        _push(Node::Type type)
+        {
+          auto const index = this->_nodes.size();
+          _check_size(index + 1);
+          this->_nodes.emplace_back();
+          auto& node = this->_nodes.back();
+          node.type = type;
+          node.shadowed = false;
+          node.next = index + 1;
+          node.key = this->_key;
+          this->_key = Span{0, 0};
+          return node;
+        }
+
+        void
+        _close()
+        {
+          this->_nodes[this->_open.back()].next = this->_nodes.size();
+          this->_open.pop_back();
+        }
+
+        /// Mark the members of \a object that a later duplicate overrides.
+        void
+        _shadow(uint32_t object)
+        {
+          auto const end = this->_nodes.size();
+          auto& members = this->_members;
+          members.clear();
+          for (auto i = object + 1; i != end; i = this->_nodes[i].next)
+            members.push_back(i);
+          if (members.size() < 2)
+            return;
+          auto const less = [&] (uint32_t lhs, uint32_t rhs)
+            {
+              auto const& l = this->_nodes[lhs].key;
+              auto const& r = this->_nodes[rhs].key;
+              auto const cmp = std::memcmp(this->_strings.data() + l.offset,
+                                           this->_strings.data() + r.offset,
+                                           std::min(l.size, r.size));
+              if (cmp != 0)
+                return cmp < 0;
+              if (l.size != r.size)
+                return l.size < r.size;
+              return lhs < rhs;
+            };
+          std::sort(members.begin(), members.end(), less);
+          for (auto it = members.begin() + 1; it != members.end(); ++it)
+          {
+            auto const& previous = this->_nodes[*(it - 1)].key;
+            auto const& key = this->_nodes[*it].key;
+            if (previous.size == key.size &&
+                std::memcmp(this->_strings.data() + previous.offset,
+                            this->_strings.data() + key.offset,
+                            key.size) == 0)
+              this->_nodes[*(it - 1)].shadowed = true;
+          }
+        }
+
+        Span
+        _intern(elle::ConstWeakBuffer s)
+        {
+          auto const offset = this->_strings.size();
+          _check_size(offset + s.size());
+          this->_strings.append(reinterpret_cast<char const*>(s.contents()),
+                                s.size());
+          return Span{uint32_t(offset), uint32_t(s.size())};
+        }
+
+        std::vector<Node>& _nodes;
+        std::string& _strings;
+        std::vector<uint32_t> _open;
+        std::vector<uint32_t> _members;
+        Span _key;
+      };
+
+#ifdef __clang__
+# define CL(a) std::string((a).name())
+#else
+# define CL(a) (a)
+#endif
+
+      namespace
+      {
+        /// Replay \a json as parse events.
+        void
+        walk(elle::json::Json const& json, elle::json::Handler& handler)
+        {
+          auto const& type = json.type();
+#define INTEGER(Type)                                                   \
+          else if (CL(type) == CL(typeid(Type)))                        \
+            handler.integer(boost::any_cast<Type>(json))
+#define UNSIGNED(Type)                                                  \
+          else if (CL(type) == CL(typeid(Type)))                        \
+          {                                                             \
+            auto const v = boost::any_cast<Type>(json);                 \
+            if (v > uint64_t(std::numeric_limits<int64_t>::max()))      \
+              handler.real(v);                                          \
+            else                                                        \
+              handler.integer(v);                                       \
+          }
+          if (CL(type) == CL(typeid(elle::json::Object)))
+          {
+            handler.object_begin();
+            for (auto const& member:
+                   boost::any_cast<elle::json::Object const&>(json))
+            {
+              handler.key(elle::ConstWeakBuffer(member.first));
+              walk(member.second, handler);
+            }
+            handler.object_end();
+          }
+          else if (CL(type) == CL(typeid(elle::json::OrderedObject)))
+          {
+            handler.object_begin();
+            for (auto const& member:
+                   boost::any_cast<elle::json::OrderedObject const&>(json))
+            {
+              handler.key(elle::ConstWeakBuffer(member.first));
+              walk(member.second, handler);
+            }
+            handler.object_end();
+          }
+          else if (CL(type) == CL(typeid(elle::json::Array)))
+          {
+            handler.array_begin();
+            for (auto const& element:
+                   boost::any_cast<elle::json::Array const&>(json))
+              walk(element, handler);
+            handler.array_end();
+          }
+          else if (CL(type) == CL(typeid(std::string)))
+            handler.string(
+              elle::ConstWeakBuffer(boost::any_cast<std::string const&>(json)));
+          else if (CL(type) == CL(typeid(char const*)))
+            handler.string(boost::any_cast<char const*>(json));
+          else if (CL(type) == CL(typeid(bool)))
+            handler.boolean(boost::any_cast<bool>(json));
+          INTEGER(int16_t);
+          INTEGER(int32_t);
+          INTEGER(int64_t);
+          INTEGER(long);
+          INTEGER(long long);
+          INTEGER(uint16_t);
+          INTEGER(uint32_t);
+          UNSIGNED(uint64_t)
+          UNSIGNED(unsigned long)
+          UNSIGNED(unsigned long long)
+          else if (CL(type) == CL(typeid(float)))
+            handler.real(boost::any_cast<float>(json));
+          else if (CL(type) == CL(typeid(double)))
+            handler.real(boost::any_cast<double>(json));
+          else if (CL(type) == CL(typeid(elle::json::NullType)) ||
+                   CL(type) == CL(typeid(void)))
+            handler.null();
+          else
+            throw Error(elle::sprintf("unable to read JSON from type %s",
+                                      elle::demangle(type.name())));
+#undef UNSIGNED
+#undef INTEGER
+        }
+      }
+
+#undef CL
+
       /*-------------.
       | Construction |
       `-------------*/
@@ -31,7 +290,8 @@ namespace elle
                                  bool versioned)
         : Super(input, versioned)
         , _partial(false)
-        , _json()
+        , _nodes()
+        , _strings()
         , _current()
       {
         this->_load_json(input);
@@ -42,7 +302,8 @@ namespace elle
                                  bool versioned)
         : Super(input, std::move(versions), versioned)
         , _partial(false)
-        , _json()
+        , _nodes()
+        , _strings()
         , _current()
       {
         this->_load_json(input);
@@ -53,8 +314,9 @@ namespace elle
       {
         try
         {
-          this->_json = elle::json::read(input);
-          this->_current.push_back(&this->_json);
+          Builder builder(this->_nodes, this->_strings);
+          elle::json::parse(input, builder);
+          this->_current.push_back(Frame{0, 0});
         }
         catch (elle::json::ParseError const& e)
         {
@@ -64,19 +326,29 @@ namespace elle
         }
       }
 
-      SerializerIn::SerializerIn(elle::json::Json input, bool versioned)
-        : Super(ELLE_SFINAE_INSTANCE(std::istream), versioned) // FIXME
+      SerializerIn::SerializerIn(elle::json::Json const& input,
+                                 bool versioned)
+        : Super(versioned)
         , _partial(false)
-        , _json(std::move(input))
+        , _nodes()
+        , _strings()
         , _current()
       {
-        this->_current.push_back(&this->_json);
+        this->_load_json(input);
+      }
+
+      void
+      SerializerIn::_load_json(elle::json::Json const& input)
+      {
+        Builder builder(this->_nodes, this->_strings);
+        walk(input, builder);
+        this->_current.push_back(Frame{0, 0});
       }
 
       void
       SerializerIn::_serialize(int64_t& v)
       {
-        v = this->_check_type<int64_t>();
+        v = this->_check_type(Node::Type::integer).integer;
       }
 
       void
@@ -143,13 +415,17 @@ namespace elle
       void
       SerializerIn::_serialize(double& v)
       {
-        v = this->_check_type<double, int64_t>();
+        auto const& node = this->_nodes[this->_current.back().node];
+        if (node.type == Node::Type::integer)
+          v = node.integer;
+        else
+          v = this->_check_type(Node::Type::real).real;
       }
 
       void
       SerializerIn::_serialize(bool& v)
       {
-        v = this->_check_type<bool>();
+        v = this->_check_type(Node::Type::boolean).boolean;
       }
 
       void
@@ -157,9 +433,7 @@ namespace elle
                                             bool,
                                             std::function<void ()> const& f)
       {
-        auto& object = this->_check_type<elle::json::Object>();
-        auto it = object.find(name);
-        if (it != object.end())
+        if (this->_find(name))
           f();
         else
           ELLE_DEBUG("skip option as JSON key is missing");
@@ -169,7 +443,7 @@ namespace elle
       SerializerIn::_serialize_option(bool,
                                       std::function<void ()> const& f)
       {
-        if (this->_current.back()->type() != typeid(elle::json::NullType))
+        if (this->_nodes[this->_current.back().node].type != Node::Type::null)
           f();
         else
           ELLE_DEBUG("skip option as JSON value is null");
@@ -178,14 +452,16 @@ namespace elle
       void
       SerializerIn::_serialize(std::string& v)
       {
-        v = this->_check_type<std::string>();
+        v = this->_string(this->_check_type(Node::Type::string).string);
       }
 
       void
       SerializerIn::_serialize(elle::Buffer& buffer)
       {
-        auto& str = this->_check_type<std::string>();
-        std::stringstream encoded(str);
+        auto const& str = this->_check_type(Node::Type::string).string;
+        auto const text =
+          elle::ConstWeakBuffer(this->_strings.data() + str.offset, str.size);
+        elle::IOStream encoded(text.istreambuf());
         elle::format::base64::Stream base64(encoded);
         {
           elle::IOStream output(buffer.ostreambuf());
@@ -198,7 +474,8 @@ namespace elle
       void
       SerializerIn::_serialize(boost::posix_time::ptime& time)
       {
-        auto& str = this->_check_type<std::string>();
+        auto const str =
+          this->_string(this->_check_type(Node::Type::string).string);
         // Use the ISO extended input facet to interpret the string.
         std::stringstream ss(str);
         auto input_facet =
@@ -249,25 +526,23 @@ namespace elle
                                              std::int64_t& num,
                                              std::int64_t& denom)
       {
-        auto const repr = this->_check_type<std::string>();
+        auto const repr =
+          this->_string(this->_check_type(Node::Type::string).string);
         elle::chrono::duration_parse(repr, ticks, num, denom);
       }
 
       bool
       SerializerIn::_enter(std::string const& name)
       {
-        auto& object = this->_check_type<elle::json::Object>();
-        auto it = object.find(name);
-        if (it == object.end())
-          if (this->_partial)
-            return false;
-          else
-            throw MissingKey(name);
-        else
+        if (auto const member = this->_find(name))
         {
-          this->_current.push_back(&it->second);
+          this->_current.push_back(Frame{member, 0});
           return true;
         }
+        else if (this->_partial)
+          return false;
+        else
+          throw MissingKey(name);
       }
 
       void
@@ -281,12 +556,14 @@ namespace elle
         int size,
         std::function<void ()> const& serialize_element)
       {
-        auto& array = this->_check_type<elle::json::Array>();
-        for (auto& elt: array)
+        auto const& array = this->_check_type(Node::Type::array);
+        auto const end = array.next;
+        for (auto i = this->_current.back().node + 1; i != end;
+             i = this->_nodes[i].next)
         {
-          this->_current.push_back(&elt);
+          this->_current.push_back(Frame{i, 0});
+          elle::SafeFinally pop([&] { this->_current.pop_back(); });
           serialize_element();
-          this->_current.pop_back();
         }
       }
 
@@ -294,77 +571,129 @@ namespace elle
       SerializerIn::_deserialize_dict_key(
         std::function<void (std::string const&)> const& f)
       {
-        auto& current = *this->_current.back();
-        if (current.type() == typeid(elle::json::Object))
-        {
-          const auto& object = boost::any_cast<elle::json::Object>(current);
-          for (auto& elt: object)
-            if (this->_enter(elt.first))
-            {
-              elle::SafeFinally leave([&] { this->_leave(elt.first); });
-              f(elt.first);
-            }
-        }
-        else if (current.type() == typeid(elle::json::Array))
-        {
-          auto& array = boost::any_cast<elle::json::Array&>(current);
-          for (auto& elt: array)
+        auto const index = this->_current.back().node;
+        auto const& current = this->_nodes[index];
+        auto const end = current.next;
+        if (current.type == Node::Type::object)
+          for (auto i = index + 1; i != end; i = this->_nodes[i].next)
           {
-            if (elt.type() == typeid(elle::json::Array))
-            {
-              auto& subarray = boost::any_cast<elle::json::Array&>(elt);
-              if (subarray.size() == 2
-                  && subarray.front().type() == typeid(std::string))
-              {
-                auto key = boost::any_cast<std::string>(subarray.front());
-                elle::SafeFinally leave([&] { this->_leave(key); });
-                this->_current.push_back(&subarray.back());
-                f(key);
-              }
-            }
+            if (this->_nodes[i].shadowed)
+              continue;
+            auto const key = this->_string(this->_nodes[i].key);
+            this->_current.push_back(Frame{i, 0});
+            elle::SafeFinally leave([&] { this->_leave(key); });
+            f(key);
+          }
+        else if (current.type == Node::Type::array)
+          for (auto i = index + 1; i != end; i = this->_nodes[i].next)
+          {
+            auto const& pair = this->_nodes[i];
+            // A two elements array whose first element is a string.
+            if (pair.type != Node::Type::array || pair.next == i + 1)
+              continue;
+            auto const& first = this->_nodes[i + 1];
+            if (first.type != Node::Type::string || first.next == pair.next)
+              continue;
+            auto const second = first.next;
+            if (this->_nodes[second].next != pair.next)
+              continue;
+            auto const key = this->_string(first.string);
+            this->_current.push_back(Frame{second, 0});
+            elle::SafeFinally leave([&] { this->_leave(key); });
+            f(key);
           }
-        }
       }
 
-      template <typename T, typename ... Types>
-      struct
-      any_casts
+      bool
+      SerializerIn::_deserialize_members(
+        std::function<void (elle::ConstWeakBuffer const&)> const& member)
       {
-        static
-        T&
-        cast(std::string const& name, boost::any& value)
+        auto const index = this->_current.back().node;
+        auto const end = this->_check_type(Node::Type::object).next;
+        // Reuse one name slot so member names only allocate when growing.
+        this->_names.emplace_back();
+        elle::SafeFinally pop_name([&] { this->_names.pop_back(); });
+        for (auto i = index + 1; i != end; i = this->_nodes[i].next)
         {
-          throw TypeError(name, typeid(T), value.type());
+          if (this->_nodes[i].shadowed)
+            continue;
+          auto const& key = this->_nodes[i].key;
+          auto const name = this->_strings.data() + key.offset;
+          this->_names.back().assign(name, key.size);
+          this->_current.push_back(Frame{i, 0});
+          elle::SafeFinally pop([&] { this->_current.pop_back(); });
+          member(elle::ConstWeakBuffer(name, key.size));
         }
-      };
+        return true;
+      }
 
-      template <typename T, typename First, typename ... Tail>
-      struct
-      any_casts<T, First, Tail ...>
+      std::string
+      SerializerIn::_string(Span span) const
       {
-        static
-        T&
-        cast(std::string const& name, boost::any& value)
-        {
-          if (value.type() == typeid(First))
+        return std::string(this->_strings.data() + span.offset, span.size);
+      }
+
+      uint32_t
+      SerializerIn::_find(std::string const& name)
+      {
+        auto& frame = this->_current.back();
+        auto const& object = this->_check_type(Node::Type::object);
+        auto const begin = frame.node + 1;
+        auto const end = object.next;
+        auto const start = frame.hint ? frame.hint : begin;
+        auto const match = [&] (uint32_t i)
           {
-            value = T(boost::any_cast<First&>(value));
-            return boost::any_cast<T&>(value);
-          }
-          else
-            return any_casts<T, Tail ...>::cast(name, value);
-        }
-      };
+            auto const& key = this->_nodes[i].key;
+            return !this->_nodes[i].shadowed && key.size == name.size() &&
+              std::memcmp(this->_strings.data() + key.offset,
+                          name.data(), name.size()) == 0;
+          };
+        auto const found = [&] (uint32_t i)
+          {
+            frame.hint = i;
+            return i;
+          };
+        for (auto i = start; i != end; i = this->_nodes[i].next)
+          if (match(i))
+            return found(i);
+        for (auto i = begin; i != start; i = this->_nodes[i].next)
+          if (match(i))
+            return found(i);
+        return 0;
+      }
 
-      template <typename T, typename ... Alternatives>
-      T&
-      SerializerIn::_check_type()
+      // Report types as the elle::json representation would.
+      SerializerIn::Node const&
+      SerializerIn::_check_type(Node::Type type)
       {
-        auto& current = *this->_current.back();
-        auto name = this->_names.empty() ? "" : this->_names.back();
-        if (current.type() == typeid(T))
-          return boost::any_cast<T&>(current);
-        return any_casts<T, Alternatives ...>::cast(name, current);
+        auto const& current = this->_nodes[this->_current.back().node];
+        if (current.type != type)
+        {
+          auto const type_info = [] (Node::Type type) -> std::type_info const&
+            {
+              switch (type)
+              {
+                case Node::Type::null:
+                  return typeid(elle::json::NullType);
+                case Node::Type::boolean:
+                  return typeid(bool);
+                case Node::Type::integer:
+                  return typeid(int64_t);
+                case Node::Type::real:
+                  return typeid(double);
+                case Node::Type::string:
+                  return typeid(std::string);
+                case Node::Type::object:
+                  return typeid(elle::json::Object);
+                case Node::Type::array:
+                  return typeid(elle::json::Array);
+              }
+              elle::unreachable();
+            };
+          throw TypeError(this->current_name(),
+                          type_info(type), type_info(current.type));
+        }
+        return current;
       }
     }
   }
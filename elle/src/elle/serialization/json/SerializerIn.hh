@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 #include <elle/json/json.hh>
 #include <elle/serialization/SerializerIn.hh>
 
@@ -26,10 +29,14 @@ namespace elle
         SerializerIn(std::istream& input, bool versioned = true);
         SerializerIn(std::istream& input,
                      Versions versions, bool versioned = true);
-        SerializerIn(elle::json::Json input, bool versioned = true);
+        /// Deserialize from an already parsed JSON value.
+        SerializerIn(elle::json::Json const& input, bool versioned = true);
       private:
+        class Builder;
         void
         _load_json(std::istream& input);
+        void
+        _load_json(elle::json::Json const& input);
 
       /*--------------.
       | Configuration |
@@ -85,17 +92,75 @@ namespace elle
         _deserialize_dict_key(
           std::function<void (std::string const&)> const& f) override;
         bool
+        _deserialize_members(
+          std::function<void (elle::ConstWeakBuffer const&)> const& member)
+          override;
+        bool
         _enter(std::string const& name) override;
         void
         _leave(std::string const& name) override;
 
-        ELLE_ATTRIBUTE(boost::any, json);
-        ELLE_ATTRIBUTE(std::vector<boost::any*>, current);
+      /*-----.
+      | JSON |
+      `-----*/
+      private:
+        /// A span of the string pool.
+        struct Span
+        {
+          uint32_t offset;
+          uint32_t size;
+        };
+        /// A JSON value.  The document is stored flat, in order, each
+        /// container followed by its elements.
+        struct Node
+        {
+          enum class Type : uint8_t
+          {
+            null,
+            boolean,
+            integer,
+            real,
+            string,
+            object,
+            array,
+          };
+          Type type;
+          /// Whether a later member of the same object has the same key.
+          /// Like elle::json::read, the last one wins.
+          bool shadowed;
+          /// Index of the next sibling, past the elements if any.
+          uint32_t next;
+          /// The key of object members.
+          Span key;
+          union
+          {
+            bool boolean;
+            int64_t integer;
+            double real;
+            Span string;
+          };
+        };
+        /// A node being deserialized.
+        struct Frame
+        {
+          uint32_t node;
+          /// The last member looked up in objects, where to resume since
+          /// members are mostly read in order.
+          uint32_t hint;
+        };
+        ELLE_ATTRIBUTE(std::vector<Node>, nodes);
+        /// Unescaped strings and keys, back to back.
+        ELLE_ATTRIBUTE(std::string, strings);
+        ELLE_ATTRIBUTE(std::vector<Frame>, current);
 
       private:
-        template <typename T, typename ... Alternatives>
-        T&
-        _check_type();
+        Node const&
+        _check_type(Node::Type type);
+        /// The index of member \a name of the current object, or 0.
+        uint32_t
+        _find(std::string const& name);
+        std::string
+        _string(Span span) const;
         template <typename T>
         void
         _serialize_int(T& v);
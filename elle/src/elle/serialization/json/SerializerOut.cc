@@ -1,9 +1,7 @@
 #include <elle/serialization/json/SerializerOut.hh>
 
-#include <elle/Lazy.hh>
 #include <elle/assert.hh>
 #include <elle/format/base64.hh>
-#include <elle/json/json.hh>
 #include <elle/log.hh>
 
 ELLE_LOG_COMPONENT("elle.serialization.json.SerializerOut")
@@ -22,35 +20,32 @@ namespace elle
                                    bool versioned,
                                    bool pretty)
         : Super(output, versioned)
-        , _json()
-        , _current()
+        , _writer(output, pretty)
+        , _slots{Slot{Slot::State::empty, false, {}, false, false}}
         , _pretty(pretty)
-      {
-        this->_current.push_back(&this->_json);
-      }
+      {}
 
       SerializerOut::SerializerOut(std::ostream& output,
                                    Versions versions,
                                    bool versioned,
                                    bool pretty)
         : Super(output, std::move(versions), versioned)
-        , _json()
-        , _current()
+        , _writer(output, pretty)
+        , _slots{Slot{Slot::State::empty, false, {}, false, false}}
         , _pretty(pretty)
-      {
-        this->_current.push_back(&this->_json);
-      }
+      {}
 
       SerializerOut::~SerializerOut() noexcept(false)
       {
-        ELLE_TRACE_SCOPE("%s: write JSON %s", this, this->output());
-        ELLE_DUMP(
-          "%s",
-          elle::lazy([&] { return elle::json::pretty_print(this->_json); }));
-        if (this->_pretty)
-          this->output() << elle::json::pretty_print(this->_json);
-        else
-          elle::json::write(this->output(), this->_json);
+        ELLE_TRACE_SCOPE("%s: finish writing JSON to %s", this, this->output());
+        while (!this->_slots.empty())
+        {
+          this->_close(this->_slots.back());
+          this->_slots.pop_back();
+        }
+        if (!this->_pretty)
+          this->output() << '\n';
+        this->output().flush();
       }
 
       /*--------------.
@@ -60,30 +55,34 @@ namespace elle
       bool
       SerializerOut::_enter(std::string const& name)
       {
-        ELLE_ASSERT(!this->_current.empty());
-        auto& current = *this->_current.back();
-        if (current.empty())
+        ELLE_ASSERT(!this->_slots.empty());
+        auto& current = this->_slots.back();
+        if (current.state == Slot::State::empty)
         {
           ELLE_DEBUG("create current object");
-          current = elle::json::Object();
+          this->_key(current);
+          this->_writer.object_begin();
+          current.state = Slot::State::object;
         }
-        if (current.type() == typeid(elle::json::Object))
+        if (current.state == Slot::State::object)
         {
           ELLE_DEBUG_SCOPE("insert key \"%s\"", name);
-          auto& object = boost::any_cast<elle::json::Object&>(current);
           // FIXME: hackish way to not serialize version twice when
           // serialize_forward is used.
-          if (name == ".version" && object.find(name) != object.end())
-            return false;
-          auto it = object.insert(std::make_pair(name, boost::any()));
-          this->_current.push_back(&it.first->second);
+          if (name == ".version")
+          {
+            if (current.version)
+              return false;
+            current.version = true;
+          }
+          this->_slots.push_back(
+            Slot{Slot::State::empty, true, name, false, false});
         }
-        else if (current.type() == typeid(elle::json::Array))
+        else if (current.state == Slot::State::array)
         {
           ELLE_DEBUG_SCOPE("insert array element");
-          auto& array = boost::any_cast<elle::json::Array&>(current);
-          array.emplace_back();
-          this->_current.push_back(&array.back());
+          this->_slots.push_back(
+            Slot{Slot::State::empty, false, {}, false, false});
         }
         else
         {
@@ -96,18 +95,65 @@ namespace elle
       void
       SerializerOut::_leave(std::string const& name)
       {
-        ELLE_ASSERT(!this->_current.empty());
-        this->_current.pop_back();
+        ELLE_ASSERT_GT(this->_slots.size(), 1u);
+        this->_close(this->_slots.back());
+        this->_slots.pop_back();
+      }
+
+      void
+      SerializerOut::_key(Slot& slot)
+      {
+        if (slot.member)
+          this->_writer.key(slot.key);
+      }
+
+      // Values never written are null, unless they are dropped options.
+      void
+      SerializerOut::_close(Slot& slot)
+      {
+        switch (slot.state)
+        {
+          case Slot::State::empty:
+            if (!slot.dropped)
+            {
+              this->_key(slot);
+              this->_writer.null();
+            }
+            break;
+          case Slot::State::object:
+            this->_writer.object_end();
+            break;
+          case Slot::State::array:
+            this->_writer.array_end();
+            break;
+          case Slot::State::filled:
+            break;
+        }
+      }
+
+      elle::json::Writer&
+      SerializerOut::_value()
+      {
+        ELLE_ASSERT(!this->_slots.empty());
+        auto& current = this->_slots.back();
+        if (current.state != Slot::State::empty)
+          ELLE_ABORT("%s: serializing in-place to an already filled object",
+                     *this);
+        this->_key(current);
+        current.state = Slot::State::filled;
+        return this->_writer;
       }
 
       void
       SerializerOut::_serialize_array(int size,
                                       std::function<void ()> const& f)
       {
-        ELLE_ASSERT(!this->_current.empty());
-        auto& current = *this->_current.back();
-        ELLE_ASSERT(current.empty());
-        current = elle::json::Array();
+        ELLE_ASSERT(!this->_slots.empty());
+        auto& current = this->_slots.back();
+        ELLE_ASSERT(current.state == Slot::State::empty);
+        this->_key(current);
+        this->_writer.array_begin();
+        current.state = Slot::State::array;
         f();
       }
 
@@ -124,91 +170,86 @@ namespace elle
       void
       SerializerOut::_serialize(int64_t& v)
       {
-        auto& current = this->_get_current();
-        current = v;
+        this->_value().integer(v);
       }
 
       void
       SerializerOut::_serialize(uint64_t& v)
       {
-        auto& current = this->_get_current();
-        current = v;
+        this->_value().unsigned_integer(v);
       }
 
       void
       SerializerOut::_serialize(int32_t& v)
       {
-        auto& current = this->_get_current();
-        current = v;
+        this->_value().integer(v);
       }
 
       void
       SerializerOut::_serialize(uint32_t& v)
       {
-        auto& current = this->_get_current();
-        current = v;
+        this->_value().unsigned_integer(v);
       }
 
       void
       SerializerOut::_serialize(int16_t& v)
       {
-        auto& current = this->_get_current();
-        current = v;
+        this->_value().integer(v);
       }
 
       void
       SerializerOut::_serialize(uint16_t& v)
       {
-        auto& current = this->_get_current();
-        current = v;
+        this->_value().unsigned_integer(v);
       }
 
       void
       SerializerOut::_serialize(int8_t& v)
       {
-        auto& current = this->_get_current();
-        current = int(v);
+        this->_value().integer(v);
       }
 
       void
       SerializerOut::_serialize(uint8_t& v)
       {
-        auto& current = this->_get_current();
-        current = int(v);
+        this->_value().integer(v);
       }
 
       void
       SerializerOut::_serialize(double& v)
       {
-        auto& current = this->_get_current();
-        current = v;
+        this->_value().real(v);
       }
 
       void
       SerializerOut::_serialize(bool& v)
       {
-        auto& current = this->_get_current();
-        current = v;
+        this->_value().boolean(v);
       }
 
       void
       SerializerOut::_serialize(std::string& v)
       {
-        auto& current = this->_get_current();
-        current = v;
+        this->_value().string(v);
       }
 
       void
       SerializerOut::_serialize(elle::Buffer& buffer)
+      {
+        auto view = elle::ConstWeakBuffer(buffer);
+        this->_serialize(view);
+      }
+
+      void
+      SerializerOut::_serialize(elle::ConstWeakBuffer& buffer)
       {
         std::stringstream encoded;
         {
           elle::format::base64::Stream base64(encoded);
-          base64.write(reinterpret_cast<char*>(buffer.contents()),
+          base64.write(reinterpret_cast<char const*>(buffer.contents()),
                        buffer.size());
         }
-        auto& current = this->_get_current();
-        current = encoded.str();
+        this->_value().string(encoded.str());
       }
 
       void
@@ -221,7 +262,7 @@ namespace elle
         output_facet->format("%Y-%m-%dT%H:%M:%S%F%q");
         ss.imbue(std::locale(ss.getloc(), output_facet.release()));
         ss << time;
-        this->_get_current() = ss.str();
+        this->_value().string(ss.str());
       }
 
       void
@@ -275,8 +316,7 @@ namespace elle
             }
           }
         }
-        auto& current = this->_get_current();
-        current = elle::sprintf("%s%s", ticks, orders[order]);
+        this->_value().string(elle::sprintf("%s%s", ticks, orders[order]));
       }
 
       void
@@ -296,29 +336,12 @@ namespace elle
           f();
         else
         {
-          *this->_current.back() = elle::json::NullType();
-          if (!this->_names.empty())
-          {
-            ELLE_ASSERT_GT(signed(this->_current.size()), 1);
-            auto& last = *this->_current[this->_current.size() - 2];
-            if (last.type() == typeid(elle::json::Object))
-              ELLE_ENFORCE(boost::any_cast<elle::json::Object&>(last).erase(
-                             this->_names.back()));
-          }
-        }
-      }
-
-      boost::any&
-      SerializerOut::_get_current()
-      {
-        ELLE_ASSERT(!this->_current.empty());
-        auto& current = *this->_current.back();
-        if (!current.empty())
-        {
-          ELLE_ABORT("%s: serializing in-place to an already filled object: %s",
-                     *this, elle::json::pretty_print(current));
+          auto& current = this->_slots.back();
+          if (!this->_names.empty() && current.member)
+            current.dropped = true;
+          else
+            this->_value().null();
         }
-        return current;
       }
     }
   }
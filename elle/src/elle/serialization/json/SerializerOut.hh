@@ -1,11 +1,11 @@
 #ifndef ELLE_SERIALIZATION_JSON_SERIALIZEROUT_HH
 # define ELLE_SERIALIZATION_JSON_SERIALIZEROUT_HH
 
+# include <string>
 # include <vector>
 
-# include <boost/any.hpp>
-
 # include <elle/attribute.hh>
+# include <elle/json/Writer.hh>
 # include <elle/serialization/SerializerOut.hh>
 
 namespace elle
@@ -93,6 +93,9 @@ namespace elle
         _serialize(elle::Buffer& v) override;
         virtual
         void
+        _serialize(elle::ConstWeakBuffer& v) override;
+        virtual
+        void
         _serialize(boost::posix_time::ptime& v) override;
         virtual
         void
@@ -108,16 +111,44 @@ namespace elle
         void
         _serialize_option(bool filled,
                           std::function<void ()> const& f) override;
-      private:
-        boost::any&
-        _get_current();
 
       /*-----.
       | JSON |
       `-----*/
       private:
-        ELLE_ATTRIBUTE(boost::any, json);
-        ELLE_ATTRIBUTE(std::vector<boost::any*>, current);
+        /// A JSON value being written.  Values are streamed as soon as they
+        /// are known, keys only once their value is.
+        struct Slot
+        {
+          enum class State
+          {
+            /// Nothing written yet.
+            empty,
+            object,
+            array,
+            /// A fundamental value was written.
+            filled,
+          };
+          State state;
+          /// Whether the slot is an object member, with its key.
+          bool member;
+          std::string key;
+          /// Whether the member was dropped, being an empty option.
+          bool dropped;
+          /// Whether the object has a .version member.
+          bool version;
+        };
+        /// Write the key of the current slot, expecting a fundamental value.
+        elle::json::Writer&
+        _value();
+        /// Write the key of \a slot if it is a member.
+        void
+        _key(Slot& slot);
+        /// Finish writing \a slot.
+        void
+        _close(Slot& slot);
+        ELLE_ATTRIBUTE(elle::json::Writer, writer);
+        ELLE_ATTRIBUTE(std::vector<Slot>, slots);
         ELLE_ATTRIBUTE(bool, pretty);
       };
     }
@@ -7,6 +7,9 @@
 #  define RUNNING_ON_VALGRIND 0
 # endif
 
+#include <algorithm>
+#include <chrono>
+
 #include <boost/preprocessor/cat.hpp>
 #include <boost/preprocessor/punctuation/comma_if.hpp>
 #include <boost/preprocessor/seq/for_each_i.hpp>
@@ -276,4 +279,34 @@ valgrind(T base, int factor = 50) -> decltype(base * 42)
   return base * (RUNNING_ON_VALGRIND ? factor : 1) * (ARM_FACTOR ? factor : 1);
 }
 
+/*-----------.
+| Benchmarks |
+`-----------*/
+
+/// Seconds spent running \a action, never zero so rates can be derived.
+template <typename F>
+static
+double
+elapsed(F const& action)
+{
+  auto const start = std::chrono::steady_clock::now();
+  action();
+  auto const us = std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - start).count();
+  return std::max<long>(us, 1) / 1e6;
+}
+
+/// A "benchmark" suite added to \a parent, disabled by default so regular
+/// runs stay fast. Run it explicitly with --run_test=benchmark.
+inline
+boost::unit_test::test_suite*
+benchmark_suite(boost::unit_test::test_suite& parent =
+                  boost::unit_test::framework::master_test_suite())
+{
+  auto res = BOOST_TEST_SUITE("benchmark");
+  res->p_default_status.value = boost::unit_test::test_unit::RS_DISABLED;
+  parent.add(res);
+  return res;
+}
+
 #endif
@@ -4,6 +4,7 @@
 #include <elle/test.hh>
 
 #include <elle/Buffer.hh>
+#include <elle/SharedBuffer.hh>
 
 static
 void
@@ -226,6 +227,75 @@ test_assign()
   BOOST_CHECK_EQUAL(b2.size(), 0);
 }
 
+static
+void
+test_pop_front()
+{
+  elle::Buffer b("0123456789");
+  auto contents = b.contents();
+  auto capacity = b.capacity();
+  b.pop_front(4);
+  // No copy: the remaining bytes stay in place.
+  BOOST_CHECK(b.contents() == contents + 4);
+  BOOST_CHECK_EQUAL(b.capacity(), capacity - 4);
+  BOOST_CHECK_EQUAL(b, "456789");
+  // Growth reclaims the popped bytes.
+  b.append("ab", 2);
+  BOOST_CHECK_EQUAL(b, "456789ab");
+  b.pop_front(2);
+  b.size(capacity);
+  BOOST_CHECK(b.contents() == contents);
+  BOOST_CHECK_EQUAL(b.capacity(), capacity);
+  BOOST_CHECK_EQUAL(elle::ConstWeakBuffer(b).range(0, 6), "6789ab");
+  b.size(6);
+  b.pop_front(6);
+  BOOST_CHECK(b.empty());
+  BOOST_CHECK(b.contents() == contents);
+  b.append("xyz", 3);
+  b.pop_front(1);
+  elle::Buffer moved(std::move(b));
+  BOOST_CHECK_EQUAL(moved, "yz");
+  b = std::move(moved);
+  b.shrink_to_fit();
+  BOOST_CHECK_EQUAL(b, "yz");
+  b.pop_front();
+  auto released = b.release();
+  BOOST_CHECK_EQUAL(released.second, 1);
+  BOOST_CHECK_EQUAL(released.first.get()[0], 'z');
+}
+
+static
+void
+test_shared()
+{
+  elle::SharedBuffer empty;
+  BOOST_CHECK(empty.empty());
+  BOOST_CHECK(!empty.owner());
+  elle::Buffer b("channel:payload");
+  auto contents = b.contents();
+  elle::SharedBuffer shared(std::move(b));
+  BOOST_CHECK(shared.contents() == contents);
+  auto header = shared.split(8);
+  BOOST_CHECK_EQUAL(header, "channel:");
+  BOOST_CHECK_EQUAL(shared, "payload");
+  BOOST_CHECK(shared.contents() == contents + 8);
+  BOOST_CHECK_EQUAL(header.owner(), shared.owner());
+  BOOST_CHECK_EQUAL(shared.owner().use_count(), 2);
+  auto slice = shared.range(3, -1);
+  BOOST_CHECK_EQUAL(slice, "loa");
+  BOOST_CHECK_EQUAL(shared.owner().use_count(), 3);
+  slice.pop_front(2);
+  BOOST_CHECK_EQUAL(slice, "a");
+  auto copy = slice.buffer();
+  BOOST_CHECK_EQUAL(copy, "a");
+  BOOST_CHECK(copy.contents() != slice.contents());
+  // Slices keep the memory alive.
+  header = elle::SharedBuffer();
+  shared = std::move(slice);
+  BOOST_CHECK_EQUAL(shared, "a");
+  BOOST_CHECK_EQUAL(shared.owner().use_count(), 1);
+}
+
 static
 void
 delete_noop(elle::Byte*)
@@ -365,6 +435,8 @@ ELLE_TEST_SUITE()
   memory->add(BOOST_TEST_CASE(test_capacity));
   memory->add(BOOST_TEST_CASE(test_release));
   memory->add(BOOST_TEST_CASE(test_assign));
+  memory->add(BOOST_TEST_CASE(test_pop_front));
+  memory->add(BOOST_TEST_CASE(test_shared));
 
   boost::unit_test::test_suite* streams = BOOST_TEST_SUITE("streams");
   buffer->add(streams);
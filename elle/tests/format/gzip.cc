@@ -126,6 +126,34 @@ flush()
   }
 }
 
+static
+void
+one_shot()
+{
+  auto const data = content();
+  elle::ConstWeakBuffer input(data.data(), data.size());
+  // Compress fragments as a whole.
+  std::vector<elle::ConstWeakBuffer> fragments = {
+    {input.contents(), 1000},
+    {input.contents() + 1000, 0},
+    {input.contents() + 1000, input.size() - 1000},
+  };
+  auto compressed = elle::format::gzip::compress(fragments, input.size());
+  BOOST_REQUIRE(compressed);
+  BOOST_CHECK_LE(compressed->size(), input.size() / 5);
+  BOOST_CHECK_EQUAL(
+    elle::format::gzip::decompress(*compressed, input.size()), input);
+  BOOST_CHECK_THROW(
+    elle::format::gzip::decompress(*compressed, input.size() - 1),
+    elle::Exception);
+  // Give up when output exceeds the limit.
+  BOOST_CHECK(!elle::format::gzip::compress({input}, 64));
+  // Empty input.
+  auto empty = elle::format::gzip::compress({}, 16);
+  BOOST_REQUIRE(empty);
+  BOOST_CHECK_EQUAL(elle::format::gzip::decompress(*empty, 0).size(), 0);
+}
+
 ELLE_TEST_SUITE()
 {
   auto& suite = boost::unit_test::framework::master_test_suite();
@@ -139,4 +167,5 @@ ELLE_TEST_SUITE()
   suite.add(BOOST_TEST_CASE(empty_content));
   suite.add(BOOST_TEST_CASE(empty_content_noflush));
   suite.add(BOOST_TEST_CASE(flush));
+  suite.add(BOOST_TEST_CASE(one_shot));
 }
@@ -1,13 +1,21 @@
 #include <deque>
+#include <fstream>
 #include <list>
+#include <map>
+#include <set>
 #include <sstream>
 #include <string>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include <elle/IOStream.hh>
 #include <elle/attribute.hh>
+#include <elle/filesystem/TemporaryDirectory.hh>
 #include <elle/filesystem/path.hh>
+#include <elle/json/Writer.hh>
+#include <elle/json/exceptions.hh>
+#include <elle/json/json.hh>
 #include <elle/serialization/binary.hh>
 #include <elle/serialization/json.hh>
 #include <elle/serialization/json/MissingKey.hh>
@@ -1490,6 +1498,62 @@ json_optionals()
   }
 }
 
+static
+void
+json_duplicate_keys()
+{
+  // As with elle::json::read, the last occurrence of a key wins.
+  std::stringstream stream(
+    "{"
+    "  \"a\": 1,"
+    "  \"b\": 2,"
+    "  \"a\": 3,"
+    "  \"map\": {\"x\": 1, \"y\": 2, \"x\": 3}"
+    "}");
+  elle::serialization::json::SerializerIn input(stream, false);
+  int a = 0;
+  int b = 0;
+  std::unordered_map<std::string, int> map;
+  input.serialize("a", a);
+  input.serialize("b", b);
+  input.serialize("map", map);
+  BOOST_CHECK_EQUAL(a, 3);
+  BOOST_CHECK_EQUAL(b, 2);
+  BOOST_CHECK_EQUAL(map.size(), 2);
+  BOOST_CHECK_EQUAL(map["x"], 3);
+  BOOST_CHECK_EQUAL(map["y"], 2);
+}
+
+static
+void
+json_value()
+{
+  auto ordered = elle::json::OrderedObject{};
+  ordered["real"] = 2.5;
+  ordered["int"] = int64_t(3);
+  auto object = elle::json::Object{};
+  object["int"] = int64_t(-42);
+  object["small"] = uint16_t(7);
+  object["string"] = std::string("castor");
+  object["bool"] = true;
+  object["null"] = elle::json::NullType();
+  object["array"] = elle::json::Array{int32_t(1), int64_t(2)};
+  object["ordered"] = ordered;
+  elle::serialization::json::SerializerIn input(object, false);
+  BOOST_CHECK_EQUAL(input.deserialize<int>("int"), -42);
+  BOOST_CHECK_EQUAL(input.deserialize<int>("small"), 7);
+  BOOST_CHECK_EQUAL(input.deserialize<std::string>("string"), "castor");
+  BOOST_CHECK(input.deserialize<bool>("bool"));
+  BOOST_CHECK(!input.deserialize<boost::optional<int>>("null"));
+  BOOST_CHECK_EQUAL(input.deserialize<std::vector<int>>("array"),
+                    (std::vector<int>{1, 2}));
+  auto const map =
+    input.deserialize<std::unordered_map<std::string, double>>("ordered");
+  BOOST_CHECK_EQUAL(map.size(), 2);
+  BOOST_CHECK_EQUAL(map.at("real"), 2.5);
+  BOOST_CHECK_EQUAL(map.at("int"), 3);
+}
+
 template <typename Format>
 static
 void
@@ -1718,6 +1782,871 @@ convert()
   }
 }
 
+/*---------.
+| Compiled |
+`---------*/
+
+namespace compiled
+{
+  class Block
+  {
+  public:
+    Block()
+      : _address()
+      , _owner()
+      , _version(0)
+      , _size(0)
+      , _children()
+      , _label()
+      , _meta()
+    {}
+
+    Block(int i)
+      : _address(std::string(32, 'a' + i % 26))
+      , _owner(elle::sprintf("owner-%s", i))
+      , _version(i)
+      , _size(int64_t(i) << 20)
+      , _children{i, -i, 1 << i % 24, int64_t(i) << 40}
+      , _label(i % 2 ? boost::optional<std::string>("label")
+                     : boost::optional<std::string>())
+      , _meta{{"mode", "rw"}, {"ttl", std::to_string(i)}}
+    {}
+
+    Block(elle::serialization::SerializerIn& s)
+      : Block()
+    {
+      this->serialize(s);
+    }
+
+    bool
+    operator ==(Block const& other) const
+    {
+      return this->_address == other._address &&
+        this->_owner == other._owner &&
+        this->_version == other._version &&
+        this->_size == other._size &&
+        this->_children == other._children &&
+        this->_label == other._label &&
+        this->_meta == other._meta;
+    }
+
+    template <typename S>
+    void
+    serialize(S& s)
+    {
+      s.serialize("address", this->_address);
+      s.serialize("owner", this->_owner);
+      s.serialize("version", this->_version);
+      s.serialize("size", this->_size);
+      s.serialize("children", this->_children);
+      s.serialize("label", this->_label);
+      s.serialize("meta", this->_meta);
+    }
+
+    typedef elle::serialization_tag serialization_tag;
+
+    ELLE_ATTRIBUTE(elle::Buffer, address);
+    ELLE_ATTRIBUTE_R(std::string, owner);
+    ELLE_ATTRIBUTE(int, version);
+    ELLE_ATTRIBUTE(uint64_t, size);
+    ELLE_ATTRIBUTE(std::vector<int64_t>, children);
+    ELLE_ATTRIBUTE(boost::optional<std::string>, label);
+    ELLE_ATTRIBUTE((std::unordered_map<std::string, std::string>), meta);
+  };
+
+  static
+  std::ostream&
+  operator << (std::ostream& out, Block const& b)
+  {
+    out << "Block(" << b.owner() << ")";
+    return out;
+  }
+
+  class Index
+  {
+  public:
+    Index()
+      : _blocks()
+      , _root()
+      , _location()
+      , _super()
+      , _convertable(0)
+      , _ttl()
+      , _by_version()
+    {}
+
+    Index(int count)
+      : Index()
+    {
+      for (int i = 0; i < count; ++i)
+      {
+        this->_blocks.emplace_back(i);
+        this->_by_version.emplace(i, std::to_string(i));
+      }
+      this->_root.reset(new Block(count));
+      this->_location = Point(count, -count);
+      this->_super.reset(new Sub1<false>(count));
+      this->_convertable = Convertable(count);
+      this->_ttl = std::chrono::seconds(count);
+    }
+
+    template <typename S>
+    void
+    serialize(S& s, elle::Version const& v)
+    {
+      s.serialize("blocks", this->_blocks);
+      s.serialize("root", this->_root);
+      s.serialize("location", this->_location);
+      if (v >= elle::Version(0, 2, 0))
+        s.serialize("super", this->_super);
+      s.serialize("convertable", this->_convertable);
+      s.serialize("ttl", this->_ttl);
+      s.serialize("by_version", this->_by_version);
+    }
+
+    typedef versioning::lib::serialization serialization_tag;
+
+    ELLE_ATTRIBUTE(std::vector<Block>, blocks);
+    ELLE_ATTRIBUTE(std::unique_ptr<Block>, root);
+    /// Only serializable through the dynamic Serializer.
+    ELLE_ATTRIBUTE(Point, location);
+    ELLE_ATTRIBUTE(std::unique_ptr<Super<false>>, super);
+    ELLE_ATTRIBUTE(Convertable, convertable);
+    ELLE_ATTRIBUTE(std::chrono::milliseconds, ttl);
+    ELLE_ATTRIBUTE((std::map<int, std::string>), by_version);
+  };
+
+  template <typename T>
+  static
+  void
+  check(T const& v)
+  {
+    for (bool versioned: {true, false})
+      BOOST_CHECK_EQUAL(
+        elle::serialization::binary::compiled::serialize(v, versioned),
+        elle::serialization::binary::serialize(v, versioned));
+  }
+
+  static
+  void
+  wire_format()
+  {
+    check(int8_t(-42));
+    check(uint16_t(4242));
+    for (auto i: std::vector<int64_t>{
+        0, 1, -1, 63, 64, -63, -64, 8191, 8192, 65535, 65536, -65535,
+        -65536, 1048575, 1048576, 5000000000, -5000000000,
+        4611686018427387905})
+      check(i);
+    check(51.51);
+    check(true);
+    check(std::string("compiled"));
+    check(elle::Buffer("compiled"));
+    check(std::list<std::string>{"a", "b"});
+    check(std::deque<int>{1, 2, 3});
+    check(std::set<int>{1, 2, 3});
+    check(std::pair<int, std::string>(1, "one"));
+    check(std::unordered_map<int, int>{{1, 2}, {3, 4}});
+    check(boost::optional<int>());
+    check(boost::optional<int>(42));
+    check(std::chrono::microseconds(42));
+    check(elle::Version(0, 1, 2));
+    check(boost::posix_time::ptime(
+            boost::gregorian::date(2016, 1, 1),
+            boost::posix_time::hours(1)));
+    check(Point(42, 51));
+    check(Line(Point(42, 51), Point(69, 86)));
+    check(Convertable(42));
+    for (int i = 0; i < 3; ++i)
+      check(Block(i));
+    check(Index(3));
+    for (auto v: {elle::Version(0, 1, 0), elle::Version(0, 3, 0)})
+      BOOST_CHECK_EQUAL(
+        elle::serialization::binary::compiled::serialize(Index(3), v),
+        elle::serialization::binary::serialize(Index(3), v));
+  }
+
+  static
+  void
+  round_trip()
+  {
+    Block b(7);
+    auto data = elle::serialization::binary::compiled::serialize(b);
+    BOOST_CHECK_EQUAL(
+      elle::serialization::binary::deserialize<Block>(data), b);
+  }
+
+  /*----------.
+  | Benchmark |
+  `----------*/
+
+  /// Serialize \a objects \a rounds times with \a f, return objects/s and
+  /// MB/s.
+  template <typename T, typename F>
+  static
+  std::pair<double, double>
+  _throughput(std::vector<T> const& objects, int rounds, F const& f)
+  {
+    std::size_t bytes = 0;
+    auto const seconds = elapsed(
+      [&]
+      {
+        for (int r = 0; r < rounds; ++r)
+          for (auto const& o: objects)
+            bytes += f(o).size();
+      });
+    return {objects.size() * rounds / seconds, bytes / seconds / 1e6};
+  }
+
+  template <typename T>
+  static
+  void
+  _benchmark(std::string const& name, std::vector<T> const& objects)
+  {
+    auto const rounds = RUNNING_ON_VALGRIND ? 1 : 100;
+    auto dynamic = _throughput(
+      objects, rounds,
+      [] (T const& o) { return elle::serialization::binary::serialize(o); });
+    auto compiled = _throughput(
+      objects, rounds,
+      [] (T const& o)
+      {
+        return elle::serialization::binary::compiled::serialize(o);
+      });
+    BOOST_TEST_MESSAGE(
+      name << ": "
+      << dynamic.first << " objects/s, " << dynamic.second << " MB/s "
+      << "through binary::SerializerOut, "
+      << compiled.first << " objects/s, " << compiled.second << " MB/s "
+      << "through binary::Writer");
+  }
+
+  static
+  void
+  benchmark()
+  {
+    {
+      std::vector<Block> blocks;
+      for (int i = 0; i < 1000; ++i)
+        blocks.emplace_back(i);
+      _benchmark("blocks", blocks);
+    }
+    {
+      std::vector<std::vector<int64_t>> vectors(
+        100, std::vector<int64_t>(1000, 1 << 30));
+      _benchmark("integer vectors", vectors);
+    }
+    {
+      std::vector<elle::Buffer> buffers(100, elle::Buffer(std::string(
+                                          1 << 16, 'b')));
+      _benchmark("64 KiB buffers", buffers);
+    }
+  }
+}
+
+/*----------.
+| Zero copy |
+`----------*/
+
+namespace zero_copy
+{
+  class Packet
+  {
+  public:
+    Packet(int id, std::string const& data, std::string const& name)
+      : _id(id)
+      , _data(elle::Buffer(data))
+      , _name(this->_data)
+      , _copy(name)
+    {}
+
+    Packet(elle::serialization::SerializerIn& s)
+      : _id(0)
+      , _data()
+      , _name()
+      , _copy()
+    {
+      this->serialize(s);
+    }
+
+    void
+    serialize(elle::serialization::Serializer& s)
+    {
+      s.serialize("id", this->_id);
+      s.serialize("data", this->_data);
+      s.serialize("name", this->_name);
+      s.serialize("copy", this->_copy);
+    }
+
+    typedef elle::serialization_tag serialization_tag;
+
+    ELLE_ATTRIBUTE_R(int, id);
+    ELLE_ATTRIBUTE_R(elle::SharedBuffer, data);
+    ELLE_ATTRIBUTE_R(elle::ConstWeakBuffer, name);
+    ELLE_ATTRIBUTE_R(elle::Buffer, copy);
+  };
+
+  static
+  bool
+  inside(elle::ConstWeakBuffer const& view, elle::ConstWeakBuffer const& source)
+  {
+    return view.contents() >= source.contents() &&
+      view.contents() + view.size() <= source.contents() + source.size();
+  }
+
+  static
+  void
+  shared()
+  {
+    elle::SharedBuffer source(
+      elle::serialization::binary::serialize(Packet(42, "data", "copy")));
+    auto p = elle::serialization::binary::deserialize<Packet>(source);
+    BOOST_CHECK_EQUAL(p.id(), 42);
+    BOOST_CHECK_EQUAL(p.data(), "data");
+    BOOST_CHECK_EQUAL(p.name(), "data");
+    BOOST_CHECK_EQUAL(p.copy(), "copy");
+    BOOST_CHECK(inside(p.data(), source));
+    BOOST_CHECK(inside(p.name(), source));
+    BOOST_CHECK(!inside(p.copy(), source));
+    BOOST_CHECK_EQUAL(p.data().owner(), source.owner());
+    // The slice keeps the packet alive.
+    auto owner = std::weak_ptr<elle::Buffer const>(source.owner());
+    source = elle::SharedBuffer();
+    BOOST_CHECK(!owner.expired());
+    BOOST_CHECK_EQUAL(p.data(), "data");
+  }
+
+  static
+  void
+  weak()
+  {
+    auto source =
+      elle::serialization::binary::serialize(Packet(42, "data", "copy"));
+    auto p = elle::serialization::binary::deserialize<Packet>(
+      elle::ConstWeakBuffer(source));
+    BOOST_CHECK_EQUAL(p.id(), 42);
+    BOOST_CHECK_EQUAL(p.data(), "data");
+    BOOST_CHECK_EQUAL(p.name(), "data");
+    BOOST_CHECK(inside(p.name(), source));
+    // Without a shared owner, SharedBuffer fields are copies.
+    BOOST_CHECK(!inside(p.data(), source));
+  }
+
+  static
+  void
+  stream()
+  {
+    auto source =
+      elle::serialization::binary::serialize(Packet(42, "data", "copy"));
+    BOOST_CHECK_THROW(
+      elle::serialization::binary::deserialize<Packet>(source),
+      elle::serialization::Error);
+    auto data = elle::serialization::binary::deserialize<elle::SharedBuffer>(
+      elle::serialization::binary::serialize(elle::SharedBuffer(
+                                               elle::Buffer("data"))));
+    BOOST_CHECK_EQUAL(data, "data");
+    // Slices are serialized as views of their own bytes.
+    auto const slice =
+      elle::SharedBuffer(elle::Buffer("castor polux")).range(7);
+    std::stringstream json;
+    elle::serialization::json::serialize(slice, json, false);
+    BOOST_CHECK_EQUAL(
+      elle::serialization::json::deserialize<elle::Buffer>(json, false),
+      "polux");
+  }
+
+  static
+  void
+  truncated()
+  {
+    auto source =
+      elle::serialization::binary::serialize(Packet(42, "data", "copy"));
+    for (auto size: {3, 8})
+      BOOST_CHECK_THROW(
+        elle::serialization::binary::deserialize<Packet>(
+          elle::ConstWeakBuffer(source.contents(), size)),
+        elle::serialization::Error);
+  }
+}
+
+/*-----.
+| Bulk |
+`-----*/
+
+namespace bulk
+{
+  typedef elle::serialization::binary::SerializerOut SerializerOut;
+
+  template <typename T>
+  static
+  elle::Buffer
+  _serialize(T const& o,
+             boost::optional<SerializerOut::Versions> versions = {})
+  {
+    elle::Buffer res;
+    {
+      elle::IOStream output(res.ostreambuf());
+      if (versions)
+      {
+        SerializerOut s(output, std::move(versions.get()), false);
+        s.serialize_forward(o);
+      }
+      else
+      {
+        SerializerOut s(output, false);
+        s.serialize_forward(o);
+      }
+    }
+    return res;
+  }
+
+  static
+  SerializerOut::Versions
+  _elle(elle::Version const& version)
+  {
+    return {{elle::type_info<elle::serialization_tag>(), version}};
+  }
+
+  template <typename T>
+  static
+  void
+  _round_trip(std::vector<T> const& v)
+  {
+    auto data = _serialize(v);
+    BOOST_CHECK_EQUAL(data[1], SerializerOut::bulk_marker);
+    BOOST_CHECK_EQUAL(
+      elle::serialization::binary::deserialize<std::vector<T>>(data, false),
+      v);
+    BOOST_CHECK_EQUAL(
+      elle::serialization::binary::deserialize<std::vector<T>>(
+        elle::ConstWeakBuffer(data), false),
+      v);
+    BOOST_CHECK_EQUAL(
+      elle::serialization::binary::compiled::serialize(v, false), data);
+    auto json = elle::serialization::json::serialize(v, false);
+    BOOST_CHECK_EQUAL(
+      elle::serialization::json::deserialize<std::vector<T>>(json, false), v);
+  }
+
+  static
+  void
+  round_trip()
+  {
+    _round_trip(std::vector<int8_t>{0, -1, 127, -128});
+    _round_trip(std::vector<uint8_t>{0, 1, 255});
+    _round_trip(std::vector<int16_t>{0, -1, 0x1234, -32768});
+    _round_trip(std::vector<uint16_t>{0, 0xffff});
+    _round_trip(std::vector<int32_t>{0, -1, 0x12345678});
+    _round_trip(std::vector<uint32_t>{0, 0xffffffff});
+    _round_trip(std::vector<int64_t>{0, -1, 1ll << 62});
+    _round_trip(std::vector<uint64_t>{0, 1ull << 62});
+    _round_trip(std::vector<double>{0, -1.5, 3.14});
+    _round_trip(std::vector<int64_t>{});
+  }
+
+  static
+  void
+  wire_format()
+  {
+    auto data = _serialize(std::vector<uint16_t>{1, 0x0102});
+    BOOST_CHECK_EQUAL(
+      data, elle::Buffer(std::string("\x00\x80\x02\x02\x01\x00\x02\x01", 8)));
+  }
+
+  // Peers pinning versions without elle's, or an older one, read numbers one
+  // by one, while both encodings are understood on input.
+  static
+  void
+  versions()
+  {
+    std::vector<int32_t> const v{1, 2, 3};
+    auto const element_wise =
+      elle::Buffer(std::string("\x00\x03\x01\x02\x03", 5));
+    BOOST_CHECK_EQUAL(_serialize(v, SerializerOut::Versions()), element_wise);
+    BOOST_CHECK_EQUAL(_serialize(v, _elle(elle::Version(0, 1, 0))),
+                      element_wise);
+    BOOST_CHECK_EQUAL(
+      _serialize(v, _elle(elle::serialization_tag::bulk_version)),
+      _serialize(v));
+    BOOST_CHECK_EQUAL(
+      elle::serialization::binary::deserialize<std::vector<int32_t>>(
+        element_wise, false),
+      v);
+    {
+      elle::Buffer compiled;
+      elle::serialization::binary::BufferSink sink(compiled);
+      elle::serialization::binary::Writer<
+        elle::serialization::binary::BufferSink> w(
+          sink, _elle(elle::Version(0, 1, 0)), false);
+      w.serialize_forward(v);
+      BOOST_CHECK_EQUAL(compiled, element_wise);
+    }
+  }
+
+  // A writer pinned to the release preceding blocks of numbers writes what
+  // that release did.
+  static
+  void
+  previous_version()
+  {
+    auto const& bulk = elle::serialization_tag::bulk_version;
+    auto const previous =
+      _elle(elle::Version(bulk.major(), bulk.minor() - 1, 0));
+    BOOST_CHECK_EQUAL(
+      _serialize(std::vector<int32_t>{-1, 0x40, 0x12345}, previous),
+      elle::Buffer(std::string("\x00\x03\x81\x40\x40\x61\x23\x45", 8)));
+    BOOST_CHECK_EQUAL(
+      _serialize(std::vector<uint16_t>{1, 0x0102}, previous),
+      elle::Buffer(std::string("\x00\x02\x01\x41\x02", 5)));
+  }
+
+  static
+  void
+  mismatch()
+  {
+    auto data = _serialize(std::vector<int32_t>{1, 2, 3});
+    BOOST_CHECK_THROW(
+      elle::serialization::binary::deserialize<std::vector<int64_t>>(
+        data, false),
+      elle::serialization::Error);
+    BOOST_CHECK_THROW(
+      elle::serialization::binary::deserialize<std::vector<int32_t>>(
+        elle::ConstWeakBuffer(data.contents(), data.size() - 1), false),
+      elle::serialization::Error);
+    BOOST_CHECK_THROW(
+      elle::serialization::binary::deserialize<std::vector<int32_t>>(
+        elle::Buffer(data.contents(), data.size() - 1), false),
+      elle::serialization::Error);
+  }
+
+  static
+  void
+  benchmark()
+  {
+    auto const rounds = RUNNING_ON_VALGRIND ? 1 : 100;
+    std::vector<int64_t> const v(1 << 16, 1 << 30);
+    auto measure = [&] (boost::optional<SerializerOut::Versions> versions)
+      {
+        return v.size() * rounds / elapsed(
+          [&]
+          {
+            for (int r = 0; r < rounds; ++r)
+            {
+              auto data = _serialize(v, versions);
+              auto res = elle::serialization::binary::deserialize<
+                std::vector<int64_t>>(data, false);
+              BOOST_CHECK_EQUAL(res.size(), v.size());
+            }
+          });
+      };
+    auto const element_wise = measure(SerializerOut::Versions());
+    auto const block = measure(boost::none);
+    BOOST_TEST_MESSAGE(
+      "integers round trip: " << element_wise << " numbers/s one by one, "
+      << block << " numbers/s as a block");
+  }
+}
+
+namespace streaming
+{
+  /// Record parse events as a readable trace.
+  class Recorder
+    : public elle::json::Handler
+  {
+  public:
+    void
+    null() override
+    {
+      this->trace << "null ";
+    }
+
+    void
+    boolean(bool v) override
+    {
+      this->trace << (v ? "true " : "false ");
+    }
+
+    void
+    integer(int64_t v) override
+    {
+      this->trace << "i" << v << " ";
+    }
+
+    void
+    real(double v) override
+    {
+      this->trace << "r" << v << " ";
+    }
+
+    void
+    string(elle::ConstWeakBuffer v) override
+    {
+      this->trace << "'" << v.string() << "' ";
+    }
+
+    void
+    object_begin() override
+    {
+      this->trace << "{ ";
+    }
+
+    void
+    key(elle::ConstWeakBuffer k) override
+    {
+      this->trace << k.string() << ": ";
+    }
+
+    void
+    object_end() override
+    {
+      this->trace << "} ";
+    }
+
+    void
+    array_begin() override
+    {
+      this->trace << "[ ";
+    }
+
+    void
+    array_end() override
+    {
+      this->trace << "] ";
+    }
+
+    std::stringstream trace;
+  };
+
+  static
+  std::string
+  _trace(std::string const& json)
+  {
+    Recorder r;
+    elle::json::parse(elle::ConstWeakBuffer(json), r);
+    return r.trace.str();
+  }
+
+  static
+  void
+  events()
+  {
+    BOOST_CHECK_EQUAL(
+      _trace(" {\"a\" : [1, -2, 2.5, 1e3, true, false, null], \"b\": {}} "),
+      "{ a: [ i1 i-2 r2.5 r1000 true false null ] b: { } } ");
+    BOOST_CHECK_EQUAL(_trace("[]"), "[ ] ");
+    BOOST_CHECK_EQUAL(_trace("[1,]"), "[ i1 ] ");
+    BOOST_CHECK_EQUAL(_trace("9223372036854775807"), "i9223372036854775807 ");
+    BOOST_CHECK_EQUAL(_trace("9223372036854775808"), "r9.22337e+18 ");
+    BOOST_CHECK_EQUAL(
+      _trace("\"a\\\"\\\\\\/\\b\\f\\n\\r\\t\\u00e9\\ud83d\\ude00z\""),
+      "'a\"\\/\b\f\n\r\t\xc3\xa9\xf0\x9f\x98\x80z' ");
+    // Long enough for the vectorized scan to find the quote mid-block.
+    auto const raw = std::string(37, 'x');
+    BOOST_CHECK_EQUAL(_trace("\"" + raw + "\""), "'" + raw + "' ");
+    for (auto invalid: {"", "[", "{\"a\"}", "[1 2]", "tru", "\"\\x\"",
+                        "-", "1.", "\"\x01\"", "[1] 2", "\"\\ud83d\""})
+      BOOST_CHECK_THROW(_trace(invalid), elle::json::ParseError);
+  }
+
+  static
+  void
+  stream()
+  {
+    std::stringstream input("{\"a\": [1]} trailing");
+    Recorder r;
+    elle::json::parse(input, r);
+    BOOST_CHECK_EQUAL(r.trace.str(), "{ a: [ i1 ] } ");
+    std::string rest;
+    std::getline(input, rest);
+    BOOST_CHECK_EQUAL(rest, " trailing");
+    // Unbuffered files have no get area to parse in place nor any room to
+    // put characters back: the number lookahead must stay in the file.
+    elle::filesystem::TemporaryDirectory d("stream");
+    auto const path = d.path() / "values.json";
+    {
+      std::ofstream output(path.string());
+      output << "[12] 34 56";
+    }
+    std::filebuf file;
+    file.pubsetbuf(nullptr, 0);
+    file.open(path.string(), std::ios_base::in);
+    std::istream unbuffered(&file);
+    Recorder values;
+    for (int i = 0; i < 3; ++i)
+      elle::json::parse(unbuffered, values);
+    BOOST_CHECK_EQUAL(values.trace.str(), "[ i12 ] i34 i56 ");
+  }
+
+  static
+  void
+  writer()
+  {
+    auto const json =
+      std::string("{\"a\":[1,-2,2.5,1.0,true,null,\"\\\"\\n\\u0001\"],\"b\":{}}");
+    {
+      std::stringstream output;
+      elle::json::Writer w(output);
+      elle::json::parse(elle::ConstWeakBuffer(json), w);
+      BOOST_CHECK_EQUAL(output.str(), json);
+    }
+    {
+      std::stringstream output;
+      elle::json::Writer w(output, true);
+      elle::json::parse(elle::ConstWeakBuffer("{\"a\": [1, {}], \"b\": []}"),
+                        w);
+      BOOST_CHECK_EQUAL(output.str(),
+                        "{\n"
+                        "    \"a\" : [\n"
+                        "        1,\n"
+                        "        {}\n"
+                        "    ],\n"
+                        "    \"b\" : []\n"
+                        "}");
+    }
+    {
+      std::stringstream output;
+      elle::json::Writer w(output);
+      w.array_begin();
+      w.real(0.1);
+      w.real(1e300);
+      w.unsigned_integer(18446744073709551615ull);
+      w.array_end();
+      BOOST_CHECK_EQUAL(output.str(), "[0.1,1e+300,18446744073709551615]");
+    }
+  }
+
+  struct Entry
+  {
+    Entry(elle::serialization::SerializerIn& s)
+    {
+      this->serialize(s);
+    }
+
+    void
+    serialize(elle::serialization::Serializer& s)
+    {
+      s.serialize("path", this->path);
+      s.serialize("bytes", this->bytes);
+      s.serialize("is_dir", this->is_dir);
+      s.serialize("rev", this->rev);
+      s.serialize("modified", this->modified);
+    }
+
+    std::string path;
+    int64_t bytes;
+    bool is_dir;
+    std::string rev;
+    std::string modified;
+  };
+
+  struct Delta
+  {
+    Delta(elle::serialization::SerializerIn& s)
+    {
+      this->serialize(s);
+    }
+
+    void
+    serialize(elle::serialization::Serializer& s)
+    {
+      s.serialize("cursor", this->cursor);
+      s.serialize("has_more", this->has_more);
+      s.serialize("entries", this->entries);
+    }
+
+    std::string cursor;
+    bool has_more;
+    std::vector<Entry> entries;
+  };
+
+  /// A Dropbox delta-like payload.
+  static
+  std::string
+  _payload(int entries)
+  {
+    std::stringstream res;
+    res << "{\"cursor\": \"AAHz2ff3Nm0IejMGc6Cl3k-5ByJG\", \"has_more\": false, "
+        << "\"reset\": false, \"entries\": [";
+    for (int i = 0; i < entries; ++i)
+      res << (i ? ", " : "")
+          << "{\"path\": \"/photos/2016/holidays \\u00e9t\\u00e9/IMG_" << i
+          << ".jpg\", \"bytes\": " << i * 4096 << ", \"is_dir\": false, "
+          << "\"rev\": \"" << std::hex << i * 7919 << std::dec << "\", "
+          << "\"modified\": \"Tue, 19 Jul 2016 21:55:38 +0000\", "
+          << "\"thumb_exists\": true, \"icon\": \"page_white_picture\", "
+          << "\"mime_type\": \"image/jpeg\", \"size\": \"4 KB\"}";
+    res << "]}";
+    return res.str();
+  }
+
+  /// Ignore all events.
+  class Null
+    : public elle::json::Handler
+  {
+  public:
+    void null() override {}
+    void boolean(bool) override {}
+    void integer(int64_t) override {}
+    void real(double) override {}
+    void string(elle::ConstWeakBuffer) override {}
+    void object_begin() override {}
+    void key(elle::ConstWeakBuffer) override {}
+    void object_end() override {}
+    void array_begin() override {}
+    void array_end() override {}
+  };
+
+  static
+  void
+  benchmark()
+  {
+    auto const entries = RUNNING_ON_VALGRIND ? 100 : 10000;
+    auto const rounds = RUNNING_ON_VALGRIND ? 1 : 10;
+    auto const payload = _payload(entries);
+    {
+      std::stringstream input(payload);
+      auto const delta = elle::serialization::json::deserialize<Delta>(
+        input, false);
+      BOOST_CHECK_EQUAL(delta.entries.size(), entries);
+      BOOST_CHECK_EQUAL(delta.entries[1].path,
+                        "/photos/2016/holidays \xc3\xa9t\xc3\xa9/IMG_1.jpg");
+      BOOST_CHECK_EQUAL(delta.entries[1].bytes, 4096);
+      BOOST_CHECK_EQUAL(delta.entries[1].rev, "1eef");
+    }
+    auto measure = [&] (std::function<void ()> const& f)
+      {
+        return payload.size() * rounds / elapsed(
+          [&]
+          {
+            for (int r = 0; r < rounds; ++r)
+              f();
+          }) / 1e6;
+      };
+    auto const dom = measure(
+      [&]
+      {
+        std::stringstream input(payload);
+        elle::json::read(input);
+      });
+    auto const events = measure(
+      [&]
+      {
+        Null handler;
+        elle::json::parse(elle::ConstWeakBuffer(payload), handler);
+      });
+    auto const objects = measure(
+      [&]
+      {
+        std::stringstream input(payload);
+        elle::serialization::json::deserialize<Delta>(input, false);
+      });
+    BOOST_TEST_MESSAGE(
+      "JSON parsing: " << dom << " MB/s into a json-spirit tree, "
+      << events << " MB/s as events, "
+      << objects << " MB/s deserialized");
+  }
+}
+
 #define FOR_ALL_SERIALIZATION_TYPES(Name)                               \
   {                                                                     \
     boost::unit_test::test_suite* subsuite = BOOST_TEST_SUITE(#Name);   \
@@ -1791,4 +2720,42 @@ ELLE_TEST_SUITE()
   suite.add(BOOST_TEST_CASE(json_iso8601));
   suite.add(BOOST_TEST_CASE(json_unicode_surrogate));
   suite.add(BOOST_TEST_CASE(json_optionals));
+  suite.add(BOOST_TEST_CASE(json_duplicate_keys));
+  suite.add(BOOST_TEST_CASE(json_value));
+  {
+    auto subsuite = BOOST_TEST_SUITE("compiled");
+    master.add(subsuite);
+    subsuite->add(BOOST_TEST_CASE(compiled::wire_format));
+    subsuite->add(BOOST_TEST_CASE(compiled::round_trip));
+  }
+  {
+    auto subsuite = BOOST_TEST_SUITE("zero_copy");
+    master.add(subsuite);
+    subsuite->add(BOOST_TEST_CASE(zero_copy::shared));
+    subsuite->add(BOOST_TEST_CASE(zero_copy::weak));
+    subsuite->add(BOOST_TEST_CASE(zero_copy::stream));
+    subsuite->add(BOOST_TEST_CASE(zero_copy::truncated));
+  }
+  {
+    auto subsuite = BOOST_TEST_SUITE("bulk");
+    master.add(subsuite);
+    subsuite->add(BOOST_TEST_CASE(bulk::round_trip));
+    subsuite->add(BOOST_TEST_CASE(bulk::wire_format));
+    subsuite->add(BOOST_TEST_CASE(bulk::versions));
+    subsuite->add(BOOST_TEST_CASE(bulk::previous_version));
+    subsuite->add(BOOST_TEST_CASE(bulk::mismatch));
+  }
+  {
+    auto subsuite = BOOST_TEST_SUITE("streaming");
+    master.add(subsuite);
+    subsuite->add(BOOST_TEST_CASE(streaming::events));
+    subsuite->add(BOOST_TEST_CASE(streaming::stream));
+    subsuite->add(BOOST_TEST_CASE(streaming::writer));
+  }
+  {
+    auto subsuite = benchmark_suite(master);
+    subsuite->add(BOOST_TEST_CASE_NAME(compiled::benchmark, "compiled"));
+    subsuite->add(BOOST_TEST_CASE_NAME(bulk::benchmark, "bulk"));
+    subsuite->add(BOOST_TEST_CASE_NAME(streaming::benchmark, "streaming"));
+  }
 }
@@ -17,6 +17,9 @@ namespace infinit
       : Super(backend.scheduler())
       , _backend(backend)
       , _id(id)
+      , _handler()
+      , _handled(0)
+      , _woken(false)
     {
       ELLE_DEBUG_SCOPE("%s: open %s", this->_backend, *this);
       this->_backend._channels[this->_id] = this;
@@ -34,6 +37,9 @@ namespace infinit
       , _id(source._id)
       , _packets(std::move(source._packets))
       , _available(std::move(source._available))
+      , _handler(std::move(source._handler))
+      , _handled(source._handled)
+      , _woken(source._woken)
     {
       source._id = 0;
       ELLE_ASSERT_NEQ(this->_backend._channels.find(this->_id),
@@ -55,6 +61,8 @@ namespace infinit
         ELLE_ASSERT_NEQ(this->_backend._channels.find(this->_id),
                         this->_backend._channels.end());
         this->_backend._channels.erase(this->_id);
+        if (this != &this->_backend._default)
+          this->_backend._closed();
       }
     }
 
@@ -88,6 +96,46 @@ namespace infinit
       return this->_backend._read(this);
     }
 
+    elle::Buffer
+    Channel::read(reactor::Duration timeout)
+    {
+      return this->_backend._read(this, timeout);
+    }
+
+    void
+    Channel::handle(Handler handler)
+    {
+      this->_handler = std::move(handler);
+      while (!this->_packets.empty())
+      {
+        auto packet = std::move(this->_packets.front());
+        this->_packets.pop_front();
+        this->_handler(std::move(packet));
+        ++this->_handled;
+      }
+    }
+
+    void
+    Channel::wait()
+    {
+      ELLE_ASSERT(this->_handler);
+      this->_backend._wait(this);
+    }
+
+    bool
+    Channel::wait(reactor::DurationOpt timeout)
+    {
+      ELLE_ASSERT(this->_handler);
+      return this->_backend._wait(this, timeout);
+    }
+
+    void
+    Channel::wake()
+    {
+      this->_woken = true;
+      this->_available.signal();
+    }
+
     /*--------.
     | Sending |
     `--------*/
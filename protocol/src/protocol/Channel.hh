@@ -1,8 +1,11 @@
 #ifndef INFINIT_PROTOCOL_CHANNEL_HH
 # define INFINIT_PROTOCOL_CHANNEL_HH
 
+# include <functional>
+
 # include <elle/Printable.hh>
 
+# include <reactor/duration.hh>
 # include <reactor/signal.hh>
 
 # include <protocol/Stream.hh>
@@ -22,6 +25,8 @@ namespace infinit
       using Self = Channel;
       using Super = Stream;
       using Id = int;
+      /// Incoming packets handler.
+      using Handler = std::function<void (elle::Buffer)>;
 
     /*-------------.
     | Construction |
@@ -52,6 +57,33 @@ namespace infinit
     public:
       elle::Buffer
       read() override;
+      /// Read a packet, waiting for at most \a timeout.
+      ///
+      /// Like timed waits, the stream is read by a background thread
+      /// meanwhile. Raise reactor::Timeout if no packet came in time.
+      elle::Buffer
+      read(reactor::Duration timeout);
+      /// Pass incoming packets to \a handler instead of queuing them for read,
+      /// starting with those already queued.
+      ///
+      /// The handler is called by whichever thread reads the underlying
+      /// stream, and must not block nor throw: an error would fail that read,
+      /// and with it every reader of the stream.
+      void
+      handle(Handler handler);
+      /// Read until a packet is passed to our handler.
+      void
+      wait();
+      /// Wait until a packet is passed to our handler, for at most \a timeout.
+      ///
+      /// Unlike wait(), the stream is read by a background thread meanwhile,
+      /// so that giving up never interrupts a read. Return false on timeout or
+      /// wake().
+      bool
+      wait(reactor::DurationOpt timeout);
+      /// Make the ongoing or next timed wait return.
+      void
+      wake();
 
     /*--------.
     | Sending |
@@ -65,10 +97,15 @@ namespace infinit
     `--------*/
     private:
       friend class ChanneledStream;
-      ELLE_ATTRIBUTE(ChanneledStream&, backend);
+      ELLE_ATTRIBUTE_R(ChanneledStream&, backend);
       ELLE_ATTRIBUTE_R(Id, id);
       ELLE_ATTRIBUTE(std::list<elle::Buffer>, packets);
       ELLE_ATTRIBUTE(reactor::Signal, available);
+      ELLE_ATTRIBUTE(Handler, handler);
+      /// Number of packets passed to the handler.
+      ELLE_ATTRIBUTE(std::size_t, handled);
+      /// Whether a timed wait must return.
+      ELLE_ATTRIBUTE(bool, woken);
     };
   }
 }
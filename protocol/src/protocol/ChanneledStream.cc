@@ -1,7 +1,10 @@
 #include <boost/foreach.hpp>
 
+#include <elle/finally.hh>
 #include <elle/log.hh>
+#include <elle/printf.hh>
 
+#include <reactor/exception.hh>
 #include <reactor/scheduler.hh>
 #include <reactor/thread.hh>
 
@@ -26,11 +29,14 @@ namespace infinit
       , _master(this->_handshake(backend))
       , _id_current(0)
       , _reading(false)
+      , _failure()
       , _backend(backend)
       , _channels()
+      , _closed()
       , _channels_new()
       , _channel_available()
       , _default(*this)
+      , _reader()
     {}
 
     ChanneledStream::ChanneledStream(Stream& backend)
@@ -126,46 +132,160 @@ namespace infinit
         }
     }
 
+    elle::Buffer
+    ChanneledStream::_read(Channel* channel, reactor::Duration timeout)
+    {
+      ELLE_TRACE_SCOPE("%s: read packet on channel %s for %s",
+                       *this, channel->_id, timeout);
+      auto const start = boost::posix_time::microsec_clock::universal_time();
+      while (channel->_packets.empty())
+      {
+        if (this->_failure)
+          std::rethrow_exception(this->_failure);
+        this->_read_background();
+        auto const remaining = timeout -
+          (boost::posix_time::microsec_clock::universal_time() - start);
+        if (remaining <= reactor::Duration() ||
+            !reactor::wait(channel->_available, remaining))
+          throw reactor::Timeout(timeout);
+      }
+      auto packet = std::move(channel->_packets.front());
+      channel->_packets.pop_front();
+      ELLE_TRACE("%s: %f available.", *this, packet);
+      return packet;
+    }
+
+    void
+    ChanneledStream::_wait(Channel* channel)
+    {
+      ELLE_TRACE_SCOPE("%s: wait for packet on channel %s", *this, channel->_id);
+      auto const handled = channel->_handled;
+      while (channel->_handled == handled)
+      {
+        if (!this->_reading)
+          this->_read(false, channel->_id);
+        else
+          ELLE_DEBUG("%s: reader already present, waiting.", *this)
+            scheduler().current()->wait(channel->_available);
+      }
+    }
+
+    bool
+    ChanneledStream::_wait(Channel* channel, reactor::DurationOpt timeout)
+    {
+      ELLE_TRACE_SCOPE("%s: wait for packet on channel %s%s",
+                       *this, channel->_id,
+                       timeout ? elle::sprintf(" for %s", *timeout) : "");
+      auto const handled = channel->_handled;
+      auto const start = boost::posix_time::microsec_clock::universal_time();
+      elle::SafeFinally consume([channel] { channel->_woken = false; });
+      while (channel->_handled == handled)
+      {
+        if (channel->_woken)
+          return false;
+        if (this->_failure)
+          std::rethrow_exception(this->_failure);
+        this->_read_background();
+        auto remaining = timeout;
+        if (timeout)
+        {
+          remaining = *timeout -
+            (boost::posix_time::microsec_clock::universal_time() - start);
+          if (*remaining <= reactor::Duration())
+            return false;
+        }
+        if (!reactor::wait(channel->_available, remaining))
+          return false;
+      }
+      return true;
+    }
+
+    void
+    ChanneledStream::_read_background()
+    {
+      if (this->_reading || this->_reader)
+        return;
+      ELLE_TRACE("%s: read in background", *this);
+      // Claim reading right away, the reader only starts on the next round.
+      this->_reading = true;
+      this->_reader.reset(
+        new reactor::Thread(
+          this->scheduler(),
+          elle::sprintf("%s reader", *this),
+          [this]
+          {
+            try
+            {
+              this->_read(false, 0);
+            }
+            catch (reactor::Terminate const&)
+            {
+              throw;
+            }
+            catch (std::exception const& e)
+            {
+              ELLE_TRACE("%s: background read failed: %s", *this, e.what());
+              this->_failure = std::current_exception();
+            }
+          }));
+    }
+
     void
     ChanneledStream::_read(bool new_channel, int requested_channel)
     {
       ELLE_TRACE_SCOPE("%s: reading packets.", *this);
-      ELLE_ASSERT(!_reading);
+      // Once the background reader failed, the stream is left in an unknown
+      // state.
+      if (this->_failure)
+        std::rethrow_exception(this->_failure);
+      // The background reader never returns, it dispatches every packet.
+      bool const background =
+        this->_reader && this->scheduler().current() == this->_reader.get();
+      ELLE_ASSERT(background || !this->_reading);
+      this->_reading = true;
       try
       {
         bool goon = true;
         while (goon)
         {
-          elle::With<reactor::Thread::NonInterruptible>() << [&]
+          auto read = [&]
           {
-            this->_reading = true;
             elle::Buffer p(this->_backend.read());
+            // Stripping the channel id only moves the packet start forward:
+            // the payload is handed over to its channel without copy.
             int channel_id = this->uint32_get(p, this->version());
-            // FIXME: The size of the packet isn't
-            // adjusted. This is cosmetic though.
             auto it = this->_channels.find(channel_id);
             if (it != this->_channels.end())
             {
+              auto& channel = *it->second;
               ELLE_DEBUG("%s: received %f on existing %s (requested %s).",
-                         *this, p, *it->second, requested_channel);
-              it->second->_packets.push_back(std::move(p));
-              if (channel_id == requested_channel)
+                         *this, p, channel, requested_channel);
+              bool const handled = bool(channel._handler);
+              if (handled)
+              {
+                channel._handler(std::move(p));
+                ++channel._handled;
+                channel._available.signal();
+              }
+              else
+                channel._packets.push_back(std::move(p));
+              if (!background && channel_id == requested_channel)
                 {
                   goon = false;
                   return;
                 }
-              else
-                it->second->_available.signal_one();
+              else if (!handled)
+                channel._available.signal_one();
             }
             else
             {
-              ELLE_ASSERT(channel_id != requested_channel);
+              ELLE_ASSERT(background || channel_id != requested_channel);
               Channel res(*this, channel_id);
               ELLE_DEBUG("%s: received %f on brand new %s (requested %s).",
                          *this, p, res, requested_channel);
               res._packets.push_back(std::move(p));
               this->_channels_new.push_back(std::move(res));
-              if (new_channel)
+              if (!background && new_channel)
                 {
                   goon = false;
                   return;
@@ -174,6 +294,15 @@ namespace infinit
                 this->_channel_available.signal_one();
             }
           };
+          // The background reader is only terminated along with the stream,
+          // others must not leave it midway through a packet.
+          if (background)
+            read();
+          else
+            elle::With<reactor::Thread::NonInterruptible>() << [&]
+            {
+              read();
+            };
         }
         // Exited loop, Wake another thread so it can read future packets.
         this->_reading = false;
@@ -249,10 +378,11 @@ namespace infinit
     {
       ELLE_TRACE_SCOPE("%s: send %f on channel %s", *this, packet, id);
 
-      auto backend_packet = elle::Buffer{};
-      this->uint32_put(backend_packet, id, this->version());
-      backend_packet.append(packet.contents(), packet.size());
-      this->_backend.write(backend_packet);
+      auto header = elle::Buffer{};
+      this->uint32_put(header, id, this->version());
+      // Send the channel id and payload as fragments: the payload is not
+      // copied unless the backend needs a contiguous packet.
+      this->_backend.writev({header, packet});
     }
 
     /*--------.
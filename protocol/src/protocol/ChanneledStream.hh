@@ -3,6 +3,11 @@
 
 # include <unordered_map>
 
+# include <boost/signals2/signal.hpp>
+
+# include <reactor/duration.hh>
+# include <reactor/thread.hh>
+
 # include <protocol/Channel.hh>
 # include <protocol/Stream.hh>
 # include <protocol/fwd.hh>
@@ -70,7 +75,28 @@ namespace infinit
       elle::Buffer
       _read(Channel* channel);
 
+      /// Read a packet on \a channel for at most \a timeout, leaving reads to
+      /// the background reader.
+      elle::Buffer
+      _read(Channel* channel, reactor::Duration timeout);
+
+      /// Read until a packet is passed to \a channel handler.
+      void
+      _wait(Channel* channel);
+
+      /// Wait until a packet is passed to \a channel handler, for at most
+      /// \a timeout, leaving reads to the background reader. Return whether
+      /// one was, rather than \a channel being woken or the timeout expiring.
+      bool
+      _wait(Channel* channel, reactor::DurationOpt timeout);
+
+      /// Start the background reader if no thread reads.
+      void
+      _read_background();
+
       ELLE_ATTRIBUTE(bool, reading);
+      /// Why the background reader failed, if it did.
+      ELLE_ATTRIBUTE(std::exception_ptr, failure);
 
     /*--------.
     | Sending |
@@ -96,10 +122,17 @@ namespace infinit
       friend class Channel;
 
       ELLE_ATTRIBUTE(Stream&, backend);
-      ELLE_ATTRIBUTE(Channels, channels);
+      /// Open channels, including the default one.
+      ELLE_ATTRIBUTE_R(Channels, channels);
+      /// Emitted when a channel other than the default one is closed.
+      ELLE_ATTRIBUTE_RX(boost::signals2::signal<void ()>, closed);
       ELLE_ATTRIBUTE(std::list<Channel>, channels_new);
       ELLE_ATTRIBUTE(reactor::Signal, channel_available);
       ELLE_ATTRIBUTE(Channel, default);
+      /// Reads on behalf of threads that may give up waiting, since giving up
+      /// must not interrupt a read midway through a packet. Once started, it
+      /// reads until the stream fails or is destroyed.
+      ELLE_ATTRIBUTE(reactor::Thread::unique_ptr, reader);
     };
   }
 }
@@ -0,0 +1,110 @@
+#ifndef INFINIT_PROTOCOL_FUTURE_HH
+# define INFINIT_PROTOCOL_FUTURE_HH
+
+# include <exception>
+# include <functional>
+# include <memory>
+
+# include <boost/optional.hpp>
+
+# include <elle/attribute.hh>
+
+# include <reactor/Barrier.hh>
+# include <reactor/duration.hh>
+
+namespace infinit
+{
+  namespace protocol
+  {
+    /// The result of an asynchronous call, waitable from reactor threads.
+    ///
+    /// Copies share the same result. Once they are all destroyed, the future
+    /// is abandoned unless resolved.
+    template <typename T>
+    class Future
+    {
+    /*------.
+    | Types |
+    `------*/
+    public:
+      using Self = Future<T>;
+      using Result = T;
+
+    /*-------------.
+    | Construction |
+    `-------------*/
+    public:
+      /// An unresolved future.
+      Future();
+
+    /*--------.
+    | Waiting |
+    `--------*/
+    public:
+      /// Whether the result is available.
+      bool
+      ready() const;
+      /// Wait for the result, at most \a timeout. Return whether it is ready.
+      bool
+      wait(reactor::DurationOpt timeout = reactor::DurationOpt()) const;
+      /// The result, waiting for it if needed. Rethrow the call error, if any.
+      T
+      get() const;
+      /// Opened once the result is available, to wait along other waitables.
+      reactor::Barrier&
+      barrier() const;
+
+    /*-----------.
+    | Resolution |
+    `-----------*/
+    public:
+      /// Resolve with the result of \a compute, or the error it throws.
+      void
+      resolve(std::function<T ()> const& compute);
+      /// Resolve with error \a e.
+      void
+      fail(std::exception_ptr e);
+      /// A copy to resolve this future with, which does not keep it from
+      /// being abandoned.
+      Self
+      resolver() const;
+      /// Run \a action if the future is abandoned, replacing any previous one.
+      void
+      abandoned(std::function<void ()> action);
+
+    private:
+      struct State
+      {
+        reactor::Barrier barrier;
+        std::function<T ()> result;
+      };
+      /// Shared by the copies that wait for the result.
+      struct Interest
+      {
+        ~Interest();
+        std::weak_ptr<State> state;
+        std::function<void ()> abandoned;
+      };
+      ELLE_ATTRIBUTE(std::shared_ptr<State>, state);
+      ELLE_ATTRIBUTE(std::shared_ptr<Interest>, interest);
+    };
+
+    /// Wait for all \a futures, at most \a timeout. Return whether they are all
+    /// ready.
+    template <typename Futures>
+    bool
+    when_all(Futures const& futures,
+             reactor::DurationOpt timeout = reactor::DurationOpt());
+
+    /// Wait for one of \a futures, at most \a timeout. Return the index of a
+    /// ready one, or none on timeout.
+    template <typename Futures>
+    boost::optional<std::size_t>
+    when_any(Futures const& futures,
+             reactor::DurationOpt timeout = reactor::DurationOpt());
+  }
+}
+
+# include <protocol/Future.hxx>
+
+#endif
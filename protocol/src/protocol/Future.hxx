@@ -0,0 +1,193 @@
+#ifndef INFINIT_PROTOCOL_FUTURE_HXX
+# define INFINIT_PROTOCOL_FUTURE_HXX
+
+# include <vector>
+
+# include <boost/signals2/connection.hpp>
+
+# include <elle/assert.hh>
+
+# include <reactor/scheduler.hh>
+
+namespace infinit
+{
+  namespace protocol
+  {
+    namespace details
+    {
+      template <typename T>
+      struct FutureResult
+      {
+        static
+        std::function<T ()>
+        compute(std::function<T ()> const& f)
+        {
+          auto value = f();
+          return [value] { return value; };
+        }
+      };
+
+      template <>
+      struct FutureResult<void>
+      {
+        static
+        std::function<void ()>
+        compute(std::function<void ()> const& f)
+        {
+          f();
+          return [] {};
+        }
+      };
+    }
+
+    /*-------------.
+    | Construction |
+    `-------------*/
+
+    template <typename T>
+    Future<T>::Future()
+      : _state(std::make_shared<State>())
+      , _interest(std::make_shared<Interest>())
+    {
+      this->_interest->state = this->_state;
+    }
+
+    template <typename T>
+    Future<T>::Interest::~Interest()
+    {
+      if (this->abandoned)
+        if (auto state = this->state.lock())
+          if (!state->barrier.opened())
+            this->abandoned();
+    }
+
+    /*--------.
+    | Waiting |
+    `--------*/
+
+    template <typename T>
+    bool
+    Future<T>::ready() const
+    {
+      return this->_state->barrier.opened();
+    }
+
+    template <typename T>
+    bool
+    Future<T>::wait(reactor::DurationOpt timeout) const
+    {
+      return reactor::wait(this->_state->barrier, timeout);
+    }
+
+    template <typename T>
+    T
+    Future<T>::get() const
+    {
+      this->wait();
+      return this->_state->result();
+    }
+
+    template <typename T>
+    reactor::Barrier&
+    Future<T>::barrier() const
+    {
+      return this->_state->barrier;
+    }
+
+    /*-----------.
+    | Resolution |
+    `-----------*/
+
+    template <typename T>
+    void
+    Future<T>::resolve(std::function<T ()> const& compute)
+    {
+      ELLE_ASSERT(!this->ready());
+      try
+      {
+        this->_state->result = details::FutureResult<T>::compute(compute);
+      }
+      catch (...)
+      {
+        auto e = std::current_exception();
+        this->_state->result = [e] () -> T { std::rethrow_exception(e); };
+      }
+      this->_state->barrier.open();
+    }
+
+    template <typename T>
+    void
+    Future<T>::fail(std::exception_ptr e)
+    {
+      this->resolve([e] () -> T { std::rethrow_exception(e); });
+    }
+
+    template <typename T>
+    Future<T>
+    Future<T>::resolver() const
+    {
+      auto res = *this;
+      res._interest.reset();
+      return res;
+    }
+
+    template <typename T>
+    void
+    Future<T>::abandoned(std::function<void ()> action)
+    {
+      ELLE_ASSERT(this->_interest);
+      this->_interest->abandoned = std::move(action);
+    }
+
+    /*------------.
+    | Combinators |
+    `------------*/
+
+    template <typename Futures>
+    bool
+    when_all(Futures const& futures, reactor::DurationOpt timeout)
+    {
+      reactor::Waitables waitables;
+      for (auto const& future: futures)
+        if (!future.ready())
+          waitables << future.barrier();
+      if (waitables.empty())
+        return true;
+      return reactor::wait(waitables, timeout);
+    }
+
+    template <typename Futures>
+    boost::optional<std::size_t>
+    when_any(Futures const& futures, reactor::DurationOpt timeout)
+    {
+      auto find = [&] () -> boost::optional<std::size_t>
+        {
+          std::size_t i = 0;
+          for (auto const& future: futures)
+          {
+            if (future.ready())
+              return i;
+            ++i;
+          }
+          return boost::none;
+        };
+      if (auto res = find())
+        return res;
+      reactor::Barrier any("when_any");
+      std::vector<boost::signals2::scoped_connection> connections;
+      for (auto const& future: futures)
+        connections.emplace_back(
+          future.barrier().changed().connect(
+            [&any] (bool opened)
+            {
+              if (opened)
+                any.open();
+            }));
+      if (!reactor::wait(any, timeout))
+        return boost::none;
+      return find();
+    }
+  }
+}
+
+#endif
@@ -1,14 +1,526 @@
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include <elle/Error.hh>
+#include <elle/With.hh>
+#include <elle/finally.hh>
+#include <elle/json/json.hh>
+#include <elle/log.hh>
+#include <elle/printf.hh>
+
+#include <reactor/TimeoutGuard.hh>
 #include <reactor/exception.hh>
+#include <reactor/network/http-server.hh>
+#include <reactor/scheduler.hh>
+#include <reactor/thread.hh>
 
+#include <protocol/Channel.hh>
+#include <protocol/ChanneledStream.hh>
 #include <protocol/RPC.hh>
+#include <protocol/StreamPool.hh>
+#include <protocol/exceptions.hh>
+
+ELLE_LOG_COMPONENT("infinit.protocol.RPC");
 
 namespace infinit
 {
   namespace protocol
   {
     BaseRPC::BaseRPC(ChanneledStream& channels)
+      : BaseRPC(&channels, nullptr)
+    {}
+
+    BaseRPC::BaseRPC(StreamPool& pool)
+      : BaseRPC(nullptr, &pool)
+    {}
+
+    BaseRPC::BaseRPC(ChanneledStream* channels, StreamPool* pool)
       : _channels(channels)
+      , _pool(pool)
       , _id(0)
+      , _concurrency(128)
+      , _queue_size(1024)
+      , _statistics{0, 0, 0, 0}
+      , _admissions()
+      , _pending()
+      , _backtraces(false)
+      , _stream_window(64)
+      , _procedure_metrics()
+      , _metrics_self(std::make_shared<BaseRPC*>(this))
+      , _calls()
+    {}
+
+    BaseRPC::~BaseRPC()
+    {
+      for (auto& pending: this->_calls)
+        pending.second.pump.reset();
+      auto e = std::make_exception_ptr(RPCError("RPC destroyed before reply"));
+      for (auto& pending: this->_calls)
+        this->_fail(pending.second, e);
+    }
+
+    Channel
+    BaseRPC::_open()
+    {
+      if (this->_pool)
+        return this->_pool->channel();
+      return Channel(*this->_channels);
+    }
+
+    Channel
+    BaseRPC::_accept()
+    {
+      if (!this->_channels)
+        throw RPCError("pooled RPCs cannot serve calls");
+      return this->_channels->accept();
+    }
+
+    /*------------------.
+    | Admission control |
+    `------------------*/
+
+    BaseRPC::Admission::Admission()
+      : concurrency(0)
+      , priority(Priority::normal)
+      , running(0)
     {}
+
+    void
+    BaseRPC::limit(uint32_t id, std::size_t concurrency)
+    {
+      this->_admissions[id].concurrency = concurrency;
+    }
+
+    void
+    BaseRPC::priority(uint32_t id, Priority priority)
+    {
+      this->_admissions[id].priority = priority;
+    }
+
+    bool
+    BaseRPC::_available(Admission const& admission) const
+    {
+      return this->_statistics.running < this->_concurrency &&
+        (admission.concurrency == 0 ||
+         admission.running < admission.concurrency);
+    }
+
+    bool
+    BaseRPC::_admit(reactor::Scope& scope,
+                    uint32_t id,
+                    std::function<void ()> call)
+    {
+      auto& admission = this->_admissions[id];
+      Request request{id, std::move(call)};
+      if (this->_available(admission))
+      {
+        this->_start(scope, std::move(request));
+        return true;
+      }
+      if (this->_statistics.queued >= this->_queue_size)
+      {
+        ELLE_TRACE("reject call to %s: %s requests queued",
+                   id, this->_statistics.queued);
+        ++this->_statistics.rejected;
+        return false;
+      }
+      ELLE_DEBUG("queue call to %s: %s running",
+                 id, this->_statistics.running);
+      this->_pending[static_cast<int>(admission.priority)].push_back(
+        std::move(request));
+      ++this->_statistics.queued;
+      this->_statistics.queued_max =
+        std::max(this->_statistics.queued_max, this->_statistics.queued);
+      return true;
+    }
+
+    void
+    BaseRPC::_start(reactor::Scope& scope, Request request)
+    {
+      ++this->_admissions[request.id].running;
+      ++this->_statistics.running;
+      // The scope joins its threads before it dies, the admission is looked
+      // up on release rather than held on to.
+      scope.run_background(
+        elle::sprintf("RPC %s", request.id),
+        [this, &scope, request]
+        {
+          {
+            elle::SafeFinally release(
+              [&]
+              {
+                --this->_admissions[request.id].running;
+                --this->_statistics.running;
+              });
+            request.call();
+          }
+          // A call may end normally while the scope is torn down, when
+          // canceled: queued calls must not be started in a dying scope.
+          if (!reactor::scheduler().current()->terminating())
+            this->_dispatch(scope);
+        });
+    }
+
+    void
+    BaseRPC::_dispatch(reactor::Scope& scope)
+    {
+      // Serve higher priorities first, skipping requests whose procedure is
+      // at its limit.
+      for (auto pending = this->_pending.rbegin();
+           pending != this->_pending.rend();
+           ++pending)
+        for (auto it = pending->begin(); it != pending->end();)
+        {
+          if (this->_statistics.running >= this->_concurrency)
+            return;
+          if (this->_available(this->_admissions[it->id]))
+          {
+            auto request = std::move(*it);
+            it = pending->erase(it);
+            --this->_statistics.queued;
+            this->_start(scope, std::move(request));
+          }
+          else
+            ++it;
+        }
+    }
+
+    void
+    BaseRPC::_abandon()
+    {
+      for (auto& pending: this->_pending)
+        pending.clear();
+      this->_statistics.queued = 0;
+    }
+
+    /*-------------.
+    | Call control |
+    `-------------*/
+
+    bool
+    BaseRPC::_call_control() const
+    {
+      auto const& version =
+        this->_pool ? this->_pool->version() : this->_channels->version();
+      return version >= elle::Version(0, 4, 0);
+    }
+
+    void
+    BaseRPC::_within(Deadline const& deadline,
+                     std::function<void ()> const& action)
+    {
+      auto const remaining = BaseRPC::_remaining(deadline);
+      if (!remaining)
+        return action();
+      reactor::TimeoutGuard guard(*remaining);
+      action();
+    }
+
+    reactor::DurationOpt
+    BaseRPC::_remaining(Deadline const& deadline)
+    {
+      if (!deadline)
+        return {};
+      auto const remaining =
+        *deadline - boost::posix_time::microsec_clock::universal_time();
+      if (remaining <= reactor::Duration())
+      {
+        ELLE_TRACE("deadline passed %s ago", -remaining);
+        throw reactor::Timeout(remaining);
+      }
+      return remaining;
+    }
+
+    uint32_t
+    BaseRPC::_stream_refill(uint32_t window)
+    {
+      return std::max(window / 2, uint32_t(1));
+    }
+
+    BaseRPC::Call::Call()
+      : canceled(false)
+      , credit(0)
+      , thread(nullptr)
+    {}
+
+    void
+    BaseRPC::_cancel(Channel& channel) const
+    {
+      if (!this->_call_control())
+        return;
+      ELLE_TRACE("cancel call on %s", channel);
+      try
+      {
+        // An empty packet on the call channel cancels it.
+        elle::With<reactor::Thread::NonInterruptible>() << [&]
+        {
+          channel.write(elle::Buffer());
+        };
+      }
+      catch (std::exception const& e)
+      {
+        ELLE_TRACE("unable to cancel call on %s: %s", channel, e.what());
+      }
+    }
+
+    /*--------.
+    | Metrics |
+    `--------*/
+
+    BaseRPC::Metrics
+    BaseRPC::metrics() const
+    {
+      Metrics res;
+      for (auto const& procedure: this->_procedure_metrics)
+        res.emplace(procedure.second.first, procedure.second.second);
+      return res;
+    }
+
+    ProcedureMetrics&
+    BaseRPC::_measure(uint32_t id, std::string const& name)
+    {
+      auto it = this->_procedure_metrics.find(id);
+      if (it == this->_procedure_metrics.end())
+        it = this->_procedure_metrics.emplace(
+          id, std::make_pair(name, ProcedureMetrics())).first;
+      return it->second.second;
+    }
+
+    static
+    elle::json::Json
+    to_json(CallMetrics const& metrics)
+    {
+      auto const& latency = metrics.latency;
+      return elle::json::OrderedObject{
+        {"calls", metrics.calls},
+        {"errors", metrics.errors},
+        {"bytes_in", metrics.bytes_in},
+        {"bytes_out", metrics.bytes_out},
+        {"latency", elle::json::OrderedObject{
+            {"min", latency.count() ? latency.min() : 0},
+            {"mean", latency.mean()},
+            {"p50", latency.percentile(0.5)},
+            {"p90", latency.percentile(0.9)},
+            {"p99", latency.percentile(0.99)},
+            {"p999", latency.percentile(0.999)},
+            {"max", latency.max()},
+          }},
+      };
+    }
+
+    void
+    BaseRPC::serve_metrics(reactor::network::HttpServer& server,
+                           std::string const& route)
+    {
+      std::weak_ptr<BaseRPC*> self(this->_metrics_self);
+      server.register_route(
+        route,
+        reactor::http::Method::GET,
+        [self, route] (reactor::network::HttpServer::Headers const&,
+                       reactor::network::HttpServer::Cookies const&,
+                       reactor::network::HttpServer::Parameters const&,
+                       elle::Buffer const&)
+        {
+          auto rpc = self.lock();
+          if (!rpc)
+            throw reactor::network::HttpServer::Exception(
+              route, reactor::http::StatusCode::Gone);
+          elle::json::OrderedObject res;
+          for (auto const& procedure: (*rpc)->metrics())
+            res[procedure.first] = elle::json::OrderedObject{
+              {"caller", to_json(procedure.second.caller)},
+              {"server", to_json(procedure.second.server)},
+            };
+          std::stringstream output;
+          elle::json::write(output, res, false);
+          return output.str();
+        });
+    }
+
+    /*-------------------.
+    | Asynchronous calls |
+    `-------------------*/
+
+    struct BaseRPC::AsyncCall
+    {
+      AsyncCall(Channel channel_,
+                Reply reply_,
+                Failure fail_,
+                reactor::DurationOpt timeout_)
+        : channel(std::move(channel_))
+        , done(false)
+        , cancel(false)
+        , reply(std::move(reply_))
+        , fail(std::move(fail_))
+        , timeout(timeout_)
+        , deadline()
+      {
+        if (this->timeout)
+          this->deadline =
+            boost::posix_time::microsec_clock::universal_time() +
+            *this->timeout;
+      }
+
+      /// Give up on the call with \a e, telling the peer to cancel it.
+      void
+      abandon(std::exception_ptr e)
+      {
+        this->done = true;
+        this->cancel = true;
+        this->fail(e);
+      }
+
+      Channel channel;
+      bool done;
+      /// Whether the peer must be told to cancel the call.
+      bool cancel;
+      Reply reply;
+      Failure fail;
+      reactor::DurationOpt timeout;
+      Deadline deadline;
+    };
+
+    BaseRPC::Pending::Pending()
+      : calls()
+      , pump()
+    {}
+
+    std::function<void ()>
+    BaseRPC::_async(std::function<void (Channel&)> const& send,
+                    Reply reply,
+                    Failure fail,
+                    reactor::DurationOpt timeout)
+    {
+      auto call = std::make_shared<AsyncCall>(
+        this->_open(), std::move(reply), std::move(fail), timeout);
+      auto raw = call.get();
+      call->channel.handle(
+        [raw] (elle::Buffer response)
+        {
+          if (raw->done)
+            return;
+          raw->done = true;
+          raw->reply(std::move(response));
+        });
+      send(call->channel);
+      auto& connection = call->channel.backend();
+      // Forget connections that have no pending calls left.
+      for (auto it = this->_calls.begin(); it != this->_calls.end();)
+        if (it->first != &connection && it->second.calls.empty() &&
+            (!it->second.pump || it->second.pump->done()))
+          it = this->_calls.erase(it);
+        else
+          ++it;
+      auto& pending = this->_calls[&connection];
+      std::weak_ptr<AsyncCall> weak = call;
+      pending.calls.push_back(std::move(call));
+      if (!pending.pump || pending.pump->done())
+        pending.pump.reset(
+          new reactor::Thread(
+            elle::sprintf("RPC replies on %s", connection),
+            [this, &connection] { this->_pump_replies(connection); }));
+      // Calls are only owned by pending entries, which we outlive.
+      return [this, weak, &connection]
+        {
+          auto call = weak.lock();
+          if (!call || call->done)
+            return;
+          ELLE_TRACE("abandon call on %s", call->channel);
+          call->abandon(
+            std::make_exception_ptr(RPCError("asynchronous call abandoned")));
+          // Wake the pump, waiting on the first call, to cancel this one.
+          auto& pending = this->_calls.at(&connection);
+          if (!pending.calls.empty())
+            pending.calls.front()->channel.wake();
+        };
+    }
+
+    void
+    BaseRPC::_pump_replies(ChanneledStream& connection)
+    {
+      // Entries are only erased once their pump is done, this one is stable.
+      auto& pending = this->_calls.at(&connection);
+      try
+      {
+        while (!pending.calls.empty())
+        {
+          this->_expire(pending);
+          auto call = pending.calls.front();
+          if (call->done)
+          {
+            pending.calls.pop_front();
+            continue;
+          }
+          // Calls may have been abandoned while others were canceled.
+          if (std::any_of(pending.calls.begin(), pending.calls.end(),
+                          [] (std::shared_ptr<AsyncCall> const& c)
+                          {
+                            return c->cancel;
+                          }))
+            continue;
+          // Wait until the first pending deadline at most. Answers are read
+          // in the background meanwhile: timing out or being woken never
+          // interrupts a read.
+          Deadline deadline;
+          for (auto const& c: pending.calls)
+            if (!c->done && c->deadline &&
+                (!deadline || *c->deadline < *deadline))
+              deadline = c->deadline;
+          reactor::DurationOpt timeout;
+          if (deadline)
+            timeout =
+              *deadline - boost::posix_time::microsec_clock::universal_time();
+          call->channel.wait(timeout);
+        }
+      }
+      catch (reactor::Terminate const&)
+      {
+        throw;
+      }
+      catch (std::exception const& e)
+      {
+        ELLE_TRACE("fail %s pending calls on %s: %s",
+                   pending.calls.size(), connection, e.what());
+        this->_fail(pending, std::current_exception());
+      }
+    }
+
+    void
+    BaseRPC::_expire(Pending& pending)
+    {
+      auto const now = boost::posix_time::microsec_clock::universal_time();
+      // Cancelling writes, and calls may be queued meanwhile.
+      std::vector<std::shared_ptr<AsyncCall>> cancel;
+      for (auto const& call: pending.calls)
+      {
+        if (!call->done && call->deadline && *call->deadline <= now)
+        {
+          ELLE_TRACE("call on %s timed out", call->channel);
+          call->abandon(
+            std::make_exception_ptr(reactor::Timeout(*call->timeout)));
+        }
+        if (call->cancel)
+        {
+          call->cancel = false;
+          cancel.push_back(call);
+        }
+      }
+      for (auto const& call: cancel)
+        this->_cancel(call->channel);
+    }
+
+    void
+    BaseRPC::_fail(Pending& pending, std::exception_ptr e)
+    {
+      auto calls = std::move(pending.calls);
+      pending.calls.clear();
+      for (auto const& call: calls)
+        if (!call->done)
+        {
+          call->done = true;
+          call->fail(e);
+        }
+    }
   }
 }
@@ -1,18 +1,32 @@
 #ifndef INFINIT_PROTOCOL_RPC_HH
 # define INFINIT_PROTOCOL_RPC_HH
 
+# include <array>
+# include <deque>
+# include <functional>
+# include <map>
 # include <ostream>
+# include <type_traits>
 # include <memory>
 # include <unordered_map>
 
+# include <boost/date_time/posix_time/posix_time_types.hpp>
 # include <boost/function.hpp>
 # include <boost/noncopyable.hpp>
+# include <boost/optional.hpp>
 
+# include <elle/Buffer.hh>
 # include <elle/Printable.hh>
 
+# include <reactor/Scope.hh>
+# include <reactor/duration.hh>
+# include <reactor/network/fwd.hh>
 # include <reactor/thread.hh>
 
+# include <protocol/Channel.hh>
+# include <protocol/Future.hh>
 # include <protocol/fwd.hh>
+# include <protocol/metrics.hh>
 
 namespace infinit
 {
@@ -41,9 +55,21 @@ namespace infinit
       template <typename I, typename O>
       friend class RPC;
 
+      /// Pass the serialization of a streamed item to a sender.
+      using Sender =
+        std::function<void (std::function<void (OSerializer&)> const&)>;
+
       virtual
       void
       _call(ISerializer& in, OSerializer& out) = 0;
+      /// Whether calls answer with a stream of items.
+      virtual
+      bool
+      _streaming() const;
+      /// Serve a streaming call, passing items to \a send.
+      virtual
+      void
+      _stream(ISerializer& in, Sender const& send);
 
     private:
       ELLE_ATTRIBUTE(std::string, name);
@@ -65,8 +91,13 @@ namespace infinit
       ~Procedure();
 
     protected:
+      using Sender = typename BaseProcedure<ISerializer, OSerializer>::Sender;
       void
       _call(ISerializer& in, OSerializer& out) override;
+      bool
+      _streaming() const override;
+      void
+      _stream(ISerializer& in, Sender const& send) override;
 
     private:
       template <typename I, typename O>
@@ -85,8 +116,42 @@ namespace infinit
 
     class BaseRPC
     {
+    /*------.
+    | Types |
+    `------*/
+    public:
+      /// Order in which queued requests are served.
+      enum class Priority
+      {
+        low,
+        normal,
+        high,
+      };
+
+      /// Server side load counters.
+      struct Statistics
+      {
+        /// Procedures currently running.
+        std::size_t running;
+        /// Requests waiting for a worker.
+        std::size_t queued;
+        /// Highest number of requests ever waiting.
+        std::size_t queued_max;
+        /// Requests answered with a busy error.
+        std::size_t rejected;
+      };
+
     public:
       BaseRPC(ChanneledStream& channels);
+      /// Call procedures over channels striped across \a pool connections.
+      /// Such an RPC cannot serve calls.
+      BaseRPC(StreamPool& pool);
+    private:
+      BaseRPC(ChanneledStream* channels, StreamPool* pool);
+    public:
+      /// Fail pending asynchronous calls.
+      virtual
+      ~BaseRPC();
       /** Run forever until one of the following:
       *   - Connection gets closed
       *   - Thread gets terminated
@@ -108,8 +173,179 @@ namespace infinit
                 typename ... Args>
       friend class Procedure;
 
-      ELLE_ATTRIBUTE(ChanneledStream&, channels, protected);
+      ELLE_ATTRIBUTE(ChanneledStream*, channels, protected);
+      ELLE_ATTRIBUTE(StreamPool*, pool, protected);
       ELLE_ATTRIBUTE(uint32_t, id, protected);
+      /// Open a channel for a call.
+      Channel
+      _open();
+      /// Accept a channel for a call from the peer.
+      Channel
+      _accept();
+
+    /*------------------.
+    | Admission control |
+    `------------------*/
+    public:
+      /// Limit the number of concurrent calls to procedure \a id, zero
+      /// meaning only the global limit applies.
+      void
+      limit(uint32_t id, std::size_t concurrency);
+      /// Set the priority of procedure \a id queued calls.
+      void
+      priority(uint32_t id, Priority priority);
+      /// Maximum number of procedures parallel_run runs at once.
+      ELLE_ATTRIBUTE_RW(std::size_t, concurrency);
+      /// Maximum number of requests parallel_run queues before answering
+      /// with a busy error.
+      ELLE_ATTRIBUTE_RW(std::size_t, queue_size);
+      ELLE_ATTRIBUTE_R(Statistics, statistics);
+    protected:
+      /// Run \a call for procedure \a id in \a scope if limits allow,
+      /// queue it otherwise. Return false if the queue is full.
+      ///
+      /// \a id must be a registered procedure: its admission state is kept
+      /// for the lifetime of the RPC.
+      bool
+      _admit(reactor::Scope& scope,
+             uint32_t id,
+             std::function<void ()> call);
+      /// Drop queued requests.
+      void
+      _abandon();
+    private:
+      struct Admission
+      {
+        Admission();
+        std::size_t concurrency;
+        Priority priority;
+        std::size_t running;
+      };
+      struct Request
+      {
+        uint32_t id;
+        std::function<void ()> call;
+      };
+      bool
+      _available(Admission const& admission) const;
+      void
+      _start(reactor::Scope& scope, Request request);
+      void
+      _dispatch(reactor::Scope& scope);
+      ELLE_ATTRIBUTE((std::unordered_map<uint32_t, Admission>), admissions);
+      /// Queued requests, by priority.
+      ELLE_ATTRIBUTE((std::array<std::deque<Request>, 3>), pending);
+
+    /*-------------.
+    | Call control |
+    `-------------*/
+    public:
+      /// Whether to ask peers for the backtraces of failed calls. Otherwise,
+      /// when the protocol version allows it, errors only carry a code and a
+      /// message.
+      ELLE_ATTRIBUTE_RW(bool, backtraces);
+      /// Number of streamed items received ahead of their consumption.
+      ELLE_ATTRIBUTE_RW(uint32_t, stream_window);
+    protected:
+      using Deadline = boost::optional<boost::posix_time::ptime>;
+      /// Whether the negotiated protocol version carries call deadlines and
+      /// cancellations.
+      bool
+      _call_control() const;
+      /// Run \a action, raising reactor::Timeout once \a deadline is passed.
+      /// The action must not use the connection: it could be interrupted
+      /// midway through a packet.
+      static
+      void
+      _within(Deadline const& deadline, std::function<void ()> const& action);
+      /// The time left until \a deadline, if any, raising reactor::Timeout if
+      /// it is passed.
+      static
+      reactor::DurationOpt
+      _remaining(Deadline const& deadline);
+      /// Tell the peer the call on \a channel was abandoned.
+      void
+      _cancel(Channel& channel) const;
+      /// Number of streamed items a caller consumes before renewing their
+      /// credit, out of a \a window.
+      static
+      uint32_t
+      _stream_refill(uint32_t window);
+      /// A call served by parallel_run, which the peer may cancel.
+      struct Call
+      {
+        Call();
+        bool canceled;
+        /// Number of streamed items the peer is ready to receive.
+        std::size_t credit;
+        /// The thread running the procedure, once started.
+        reactor::Thread* thread;
+      };
+
+    /*--------.
+    | Metrics |
+    `--------*/
+    public:
+      using Metrics = std::map<std::string, ProcedureMetrics>;
+      /// A snapshot of the calls made and served so far, by procedure.
+      Metrics
+      metrics() const;
+      /// Serve metrics as JSON on \a route of \a server. Once this RPC is
+      /// destroyed the route answers 410 Gone, until registered again.
+      void
+      serve_metrics(reactor::network::HttpServer& server,
+                    std::string const& route = "/metrics");
+    protected:
+      /// The metrics of procedure \a id, named \a name.
+      ProcedureMetrics&
+      _measure(uint32_t id, std::string const& name);
+    private:
+      ELLE_ATTRIBUTE(
+        (std::unordered_map<uint32_t, std::pair<std::string, ProcedureMetrics>>),
+        procedure_metrics);
+      /// Reset on destruction, so metrics routes outliving this RPC know.
+      ELLE_ATTRIBUTE(std::shared_ptr<BaseRPC*>, metrics_self);
+
+    /*-------------------.
+    | Asynchronous calls |
+    `-------------------*/
+    protected:
+      using Reply = std::function<void (elle::Buffer)>;
+      using Failure = std::function<void (std::exception_ptr)>;
+      /// Send a question with \a send on a new channel and pass the answer to
+      /// \a reply, or the error that prevented receiving it to \a fail,
+      /// reactor::Timeout if none came within \a timeout.
+      ///
+      /// Answers are read by the connection background reader, which runs
+      /// \a reply, while one thread per connection expires and cancels calls.
+      /// Neither callback may block. A connection failure only fails the
+      /// calls pending on that connection.
+      ///
+      /// Return an action abandoning the call: it fails and the peer is told
+      /// to cancel it, like timed out calls.
+      std::function<void ()>
+      _async(std::function<void (Channel&)> const& send,
+             Reply reply,
+             Failure fail,
+             reactor::DurationOpt timeout);
+    private:
+      struct AsyncCall;
+      /// Calls pending on a connection and the thread expiring them.
+      struct Pending
+      {
+        Pending();
+        /// Pending calls, in emission order.
+        std::deque<std::shared_ptr<AsyncCall>> calls;
+        reactor::Thread::unique_ptr pump;
+      };
+      void
+      _pump_replies(ChanneledStream& connection);
+      /// Fail expired calls and tell the peer to cancel abandoned ones.
+      void
+      _expire(Pending& pending);
+      void
+      _fail(Pending& pending, std::exception_ptr e);
+      ELLE_ATTRIBUTE((std::unordered_map<ChanneledStream*, Pending>), calls);
     };
 
     template <typename ISerializer, typename OSerializer>
@@ -129,7 +365,24 @@ namespace infinit
       public:
         RemoteProcedure(std::string const& name,
                         RPC<ISerializer, OSerializer>& owner);
+        /// Call the remote procedure. If it returns a reactor::Generator, its
+        /// items are received as they are consumed.
         R operator() (Args ...);
+        /// Call the remote procedure without waiting for its result. The call
+        /// fails with reactor::Timeout after timeout, and is canceled on the
+        /// peer as well if every copy of the future is destroyed first.
+        Future<R>
+        async_call(Args ...);
+        /// Limit the number of concurrent calls served by parallel_run.
+        void
+        limit(std::size_t concurrency);
+        /// Set the priority of calls queued by parallel_run.
+        void
+        priority(BaseRPC::Priority priority);
+        /// Time calls wait for their result, also sent to the peer so it gives
+        /// up on them as well.
+        ELLE_ATTRIBUTE_RW(reactor::DurationOpt, timeout);
+      public:
         void operator = (boost::function<R (Args...)> const& implem);
         template <typename I, typename O>
         friend class RPC;
@@ -137,6 +390,22 @@ namespace infinit
                         RPC<ISerializer, OSerializer>& owner,
                         uint32_t id);
       private:
+        R
+        _invoke(std::false_type, Args ... args);
+        R
+        _invoke(std::true_type, Args ... args);
+        /// Send the question, returning its size.
+        elle::Buffer::Size
+        _question(Channel& channel, Args ... args) const;
+        CallMetrics&
+        _metrics() const;
+        void
+        _grant(Channel& channel, uint32_t credit) const;
+        [[noreturn]]
+        void
+        _error(ISerializer& input) const;
+        R
+        _answer(elle::Buffer const& response) const;
         ELLE_ATTRIBUTE(uint32_t, id);
         ELLE_ATTRIBUTE(std::string, name);
         ELLE_ATTRIBUTE(Owner&, owner);
@@ -144,6 +413,7 @@ namespace infinit
 
     public:
       RPC(ChanneledStream& channels);
+      RPC(StreamPool& pool);
 
       template <typename R, typename ... Args>
       RemoteProcedure<R, Args...>
@@ -159,12 +429,28 @@ namespace infinit
       void
       run(ExceptionHandler = {}) override;
 
+      /// Like run, but serve calls concurrently, within the limits set by
+      /// concurrency, queue_size and per procedure limits.
       virtual
       void
       parallel_run();
 
     protected:
       typedef BaseProcedure<ISerializer, OSerializer> LocalProcedure;
+      /// Handle packets following a question on its channel: credits for
+      /// streamed items, or cancellation.
+      Channel::Handler
+      _control(std::shared_ptr<Call> call) const;
+      /// Stream the items of \a procedure on \a channel, as \a call credits
+      /// allow, until \a deadline. The deadline is checked between items and
+      /// while waiting for credit, never while writing one.
+      void
+      _stream(Channel& channel,
+              Call& call,
+              LocalProcedure& procedure,
+              ISerializer& input,
+              CallMetrics& metrics,
+              Deadline const& deadline);
       typedef std::pair<std::string,
                         std::unique_ptr<LocalProcedure>> NamedProcedure;
       typedef std::unordered_map<uint32_t, NamedProcedure> Procedures;
@@ -4,12 +4,15 @@
 # include <type_traits>
 
 # include <elle/Backtrace.hh>
+# include <elle/finally.hh>
 # include <elle/log.hh>
 # include <elle/printf.hh>
 # include <elle/memory.hh>
 
+# include <reactor/Generator.hh>
 # include <reactor/network/exception.hh>
 # include <reactor/Scope.hh>
+# include <reactor/exception.hh>
 # include <reactor/scheduler.hh>
 # include <reactor/thread.hh>
 
@@ -26,6 +29,19 @@ namespace infinit
       : elle::Exception(what)
     {}
 
+    /// Whether procedures returning R stream their result.
+    template <typename R>
+    struct IsGenerator
+      : public std::false_type
+    {};
+
+    template <typename T>
+    struct IsGenerator<reactor::Generator<T>>
+      : public std::true_type
+    {
+      typedef T Item;
+    };
+
     /*--------------.
     | BaseProcedure |
     `--------------*/
@@ -40,6 +56,20 @@ namespace infinit
     BaseProcedure<IS, OS>::~BaseProcedure()
     {}
 
+    template <typename IS, typename OS>
+    bool
+    BaseProcedure<IS, OS>::_streaming() const
+    {
+      return false;
+    }
+
+    template <typename IS, typename OS>
+    void
+    BaseProcedure<IS, OS>::_stream(IS&, Sender const&)
+    {
+      ELLE_ABORT("%s is not a streaming procedure", this->_name);
+    }
+
     /*----------.
     | Procedure |
     `----------*/
@@ -87,6 +117,105 @@ namespace infinit
       put_args<OS, Args...>(output, args...);
     }
 
+    /// Read the header of a question: the procedure id and, if the protocol
+    /// carries them, the deadline and whether backtraces are wanted.
+    template <typename IS>
+    static
+    uint32_t
+    get_header(IS& input,
+               bool control,
+               boost::optional<boost::posix_time::ptime>& deadline,
+               bool& backtrace)
+    {
+      uint32_t id;
+      input >> id;
+      backtrace = !control;
+      if (control)
+      {
+        int64_t timeout;
+        input >> timeout;
+        if (timeout >= 0)
+          deadline = boost::posix_time::microsec_clock::universal_time() +
+            boost::posix_time::milliseconds(timeout);
+        input >> backtrace;
+      }
+      return id;
+    }
+
+    /// Write an error reply. Before call control, the error code is not sent
+    /// and backtraces always are.
+    template <typename OS>
+    static
+    void
+    put_error(OS& output,
+              bool control,
+              bool backtrace,
+              RPCErrorCode code,
+              std::string const& message,
+              elle::Backtrace const* bt)
+    {
+      output << false;
+      if (control)
+        output << static_cast<uint8_t>(code);
+      output << message;
+      if (!bt || !backtrace)
+      {
+        output << uint16_t(0);
+        return;
+      }
+      // Frames are only resolved here, when the peer wants them.
+      auto const& frames = bt->frames();
+      output << uint16_t(frames.size());
+      for (auto const& frame: frames)
+      {
+        output << frame.symbol;
+        output << frame.symbol_mangled;
+        output << frame.symbol_demangled;
+        output << frame.address;
+        output << frame.offset;
+      }
+    }
+
+    /// Write the error reply matching failure \a e.
+    template <typename OS>
+    static
+    void
+    put_failure(OS& output,
+                bool control,
+                bool backtrace,
+                std::exception_ptr e)
+    {
+      try
+      {
+        std::rethrow_exception(e);
+      }
+      catch (RPCError const& e)
+      {
+        put_error(output, control, backtrace, e.code(), e.what(),
+                  &e.backtrace());
+      }
+      catch (reactor::Timeout const& e)
+      {
+        put_error(output, control, backtrace, RPCErrorCode::timeout, e.what(),
+                  &e.backtrace());
+      }
+      catch (elle::Exception const& e)
+      {
+        put_error(output, control, backtrace, RPCErrorCode::remote, e.what(),
+                  &e.backtrace());
+      }
+      catch (std::exception const& e)
+      {
+        put_error(output, control, backtrace, RPCErrorCode::remote, e.what(),
+                  nullptr);
+      }
+      catch (...)
+      {
+        put_error(output, control, backtrace, RPCErrorCode::remote,
+                  "unknown error", nullptr);
+      }
+    }
+
     template <typename IS,
               typename R>
     struct GetRes
@@ -133,7 +262,8 @@ namespace infinit
       std::string const& name,
       RPC<IS, OS>& owner,
       uint32_t id)
-      : _id(id)
+      : _timeout()
+      , _id(id)
       , _name(name)
       , _owner(owner)
     {}
@@ -162,60 +292,315 @@ namespace infinit
     R
     RPC<IS, OS>::RemoteProcedure<R, Args...>::
     operator () (Args ... args)
+    {
+      return this->_invoke(IsGenerator<R>(), args...);
+    }
+
+    template <typename IS,
+              typename OS>
+    template <typename R,
+              typename ... Args>
+    R
+    RPC<IS, OS>::RemoteProcedure<R, Args...>::
+    _invoke(std::false_type, Args ... args)
     {
       ELLE_LOG_COMPONENT("infinit.protocol.RPC");
 
       ELLE_TRACE_SCOPE("%s: call remote procedure: %s",
                        this->_owner, this->_name);
 
-      Channel channel(this->_owner._channels);
+      CallMeasure measure(this->_metrics());
+      Channel channel(this->_owner._open());
+      measure.metrics().bytes_out += this->_question(channel, args...);
+      auto response = [&]
       {
-        elle::Buffer question;
+        try
         {
-          elle::IOStream outs(question.ostreambuf());
-          OS output(outs);
-          output << this->_id;
-          put_args<OS, Args...>(output, args...);
+          if (!this->_timeout)
+            return channel.read();
+          return channel.read(this->_timeout.get());
         }
-        channel.write(question);
-      }
-      {
-        elle::Buffer response(channel.read());
-        elle::IOStream ins(response.istreambuf());
-        IS input(ins);
-        bool res;
-        input >> res;
-        if (res)
-          return GetRes<IS, R>::get_res(input);
-        else
+        catch (reactor::Terminate const&)
         {
-          std::string error;
-          input >> error;
-          ELLE_TRACE_SCOPE("%s: remote procedure call failed: %s",
-                           this->_owner, error);
-          uint16_t bt_size;
-          input >> bt_size;
-          std::vector<elle::StackFrame> frames;
-          for (int i = 0; i < bt_size; ++i)
+          this->_owner._cancel(channel);
+          throw;
+        }
+        catch (reactor::Timeout const&)
+        {
+          this->_owner._cancel(channel);
+          throw;
+        }
+      }();
+      measure.metrics().bytes_in += response.size();
+      return measure.succeed([&] { return this->_answer(response); });
+    }
+
+    template <typename IS,
+              typename OS>
+    template <typename R,
+              typename ... Args>
+    R
+    RPC<IS, OS>::RemoteProcedure<R, Args...>::
+    _invoke(std::true_type, Args ... args)
+    {
+      ELLE_LOG_COMPONENT("infinit.protocol.RPC");
+
+      ELLE_TRACE_SCOPE("%s: call streaming remote procedure: %s",
+                       this->_owner, this->_name);
+
+      typedef typename IsGenerator<R>::Item Item;
+      auto const start = CallMeasure::Clock::now();
+      // Open the channel first, for pooled connections to negotiate their
+      // version.
+      auto channel = std::make_shared<Channel>(this->_owner._open());
+      if (!this->_owner._call_control())
+        throw RPCError(
+          elle::sprintf("streaming procedure '%s' needs protocol 0.4.0",
+                        this->_name));
+      this->_metrics().bytes_out += this->_question(*channel, args...);
+      auto const window = this->_owner.stream_window();
+      auto const refill = BaseRPC::_stream_refill(window);
+      auto self = *this;
+      return R(
+        [self, channel, window, refill, start]
+        (typename reactor::yielder<Item>::type const& yield)
+        {
+          // The call lasts until the last item is received.
+          CallMeasure measure(self._metrics(), start);
+          try
           {
-            elle::StackFrame frame;
-            input >> frame.symbol;
-            input >> frame.symbol_mangled;
-            input >> frame.symbol_demangled;
-            input >> frame.address;
-            input >> frame.offset;
-            frames.push_back(frame);
+            // The peer sends items as long as we grant it credit: the
+            // window sent along the question, renewed as items are consumed.
+            uint32_t consumed = 0;
+            while (true)
+            {
+              auto packet = channel->read();
+              measure.metrics().bytes_in += packet.size();
+              elle::IOStream ins(packet.istreambuf());
+              IS input(ins);
+              bool ok;
+              input >> ok;
+              if (!ok)
+                self._error(input);
+              bool more;
+              input >> more;
+              if (!more)
+              {
+                measure.succeeded(true);
+                return;
+              }
+              Item item;
+              input >> item;
+              yield(std::move(item));
+              if (++consumed == refill)
+              {
+                self._grant(*channel, consumed);
+                consumed = 0;
+              }
+            }
+          }
+          catch (reactor::Terminate const&)
+          {
+            self._owner._cancel(*channel);
+            throw;
           }
-          elle::Backtrace bt(frames);
-          // FIXME: only protocol error should throw this, not remote
-          // exceptions.
-          RPCError e
-            (elle::sprintf("remote procedure '%s' failed with '%s'", this->_name, error));
-          elle::Exception inner_exception(bt, error);
-          e.inner_exception(std::make_exception_ptr(inner_exception));
-          throw e;
+        },
+        window);
+    }
+
+    template <typename IS,
+              typename OS>
+    template <typename R,
+              typename ... Args>
+    Future<R>
+    RPC<IS, OS>::RemoteProcedure<R, Args...>::
+    async_call(Args ... args)
+    {
+      ELLE_LOG_COMPONENT("infinit.protocol.RPC");
+
+      ELLE_TRACE_SCOPE("%s: call remote procedure asynchronously: %s",
+                       this->_owner, this->_name);
+
+      Future<R> future;
+      // Callbacks must not keep the future from being abandoned.
+      auto res = future.resolver();
+      auto self = *this;
+      auto& metrics = this->_metrics();
+      auto const start = CallMeasure::Clock::now();
+      auto abandon = this->_owner._async(
+        [&] (Channel& channel)
+        {
+          metrics.bytes_out += this->_question(channel, args...);
+        },
+        [self, res, &metrics, start] (elle::Buffer response) mutable
+        {
+          metrics.bytes_in += response.size();
+          bool succeeded = true;
+          res.resolve(
+            [&]
+            {
+              try
+              {
+                return self._answer(response);
+              }
+              catch (...)
+              {
+                succeeded = false;
+                throw;
+              }
+            });
+          metrics.record(CallMeasure::Clock::now() - start, succeeded);
+        },
+        [res, &metrics, start] (std::exception_ptr e) mutable
+        {
+          metrics.record(CallMeasure::Clock::now() - start, false);
+          res.fail(e);
+        },
+        this->_timeout);
+      future.abandoned(std::move(abandon));
+      return future;
+    }
+
+    template <typename IS,
+              typename OS>
+    template <typename R,
+              typename ... Args>
+    void
+    RPC<IS, OS>::RemoteProcedure<R, Args...>::
+    limit(std::size_t concurrency)
+    {
+      this->_owner.BaseRPC::limit(this->_id, concurrency);
+    }
+
+    template <typename IS,
+              typename OS>
+    template <typename R,
+              typename ... Args>
+    void
+    RPC<IS, OS>::RemoteProcedure<R, Args...>::
+    priority(BaseRPC::Priority priority)
+    {
+      this->_owner.BaseRPC::priority(this->_id, priority);
+    }
+
+    template <typename IS,
+              typename OS>
+    template <typename R,
+              typename ... Args>
+    elle::Buffer::Size
+    RPC<IS, OS>::RemoteProcedure<R, Args...>::
+    _question(Channel& channel, Args ... args) const
+    {
+      elle::Buffer question;
+      {
+        elle::IOStream outs(question.ostreambuf());
+        OS output(outs);
+        output << this->_id;
+        if (this->_owner._call_control())
+        {
+          output << int64_t(
+            this->_timeout ? this->_timeout->total_milliseconds() : -1);
+          output << this->_owner.backtraces();
         }
+        if (IsGenerator<R>::value)
+          output << this->_owner.stream_window();
+        put_args<OS, Args...>(output, args...);
+      }
+      channel.write(question);
+      return question.size();
+    }
+
+    template <typename IS,
+              typename OS>
+    template <typename R,
+              typename ... Args>
+    CallMetrics&
+    RPC<IS, OS>::RemoteProcedure<R, Args...>::_metrics() const
+    {
+      return this->_owner._measure(this->_id, this->_name).caller;
+    }
+
+    template <typename IS,
+              typename OS>
+    template <typename R,
+              typename ... Args>
+    void
+    RPC<IS, OS>::RemoteProcedure<R, Args...>::
+    _grant(Channel& channel, uint32_t credit) const
+    {
+      elle::Buffer packet;
+      {
+        elle::IOStream outs(packet.ostreambuf());
+        OS output(outs);
+        output << credit;
       }
+      channel.write(packet);
+    }
+
+    template <typename IS,
+              typename OS>
+    template <typename R,
+              typename ... Args>
+    R
+    RPC<IS, OS>::RemoteProcedure<R, Args...>::
+    _answer(elle::Buffer const& response) const
+    {
+      ELLE_LOG_COMPONENT("infinit.protocol.RPC");
+
+      elle::IOStream ins(response.istreambuf());
+      IS input(ins);
+      bool res;
+      input >> res;
+      if (res)
+        return GetRes<IS, R>::get_res(input);
+      else
+        this->_error(input);
+    }
+
+    template <typename IS,
+              typename OS>
+    template <typename R,
+              typename ... Args>
+    void
+    RPC<IS, OS>::RemoteProcedure<R, Args...>::
+    _error(IS& input) const
+    {
+      ELLE_LOG_COMPONENT("infinit.protocol.RPC");
+
+      auto code = RPCErrorCode::remote;
+      if (this->_owner._call_control())
+      {
+        uint8_t c;
+        input >> c;
+        code = static_cast<RPCErrorCode>(c);
+      }
+      std::string error;
+      input >> error;
+      ELLE_TRACE_SCOPE("%s: remote procedure call failed: %s",
+                       this->_owner, error);
+      uint16_t bt_size;
+      input >> bt_size;
+      std::vector<elle::StackFrame> frames;
+      frames.reserve(bt_size);
+      for (int i = 0; i < bt_size; ++i)
+      {
+        elle::StackFrame frame;
+        input >> frame.symbol;
+        input >> frame.symbol_mangled;
+        input >> frame.symbol_demangled;
+        input >> frame.address;
+        input >> frame.offset;
+        frames.push_back(frame);
+      }
+      elle::Backtrace bt(frames);
+      // FIXME: only protocol error should throw this, not remote
+      // exceptions.
+      RPCError e
+        (elle::sprintf("remote procedure '%s' failed with '%s'", this->_name, error),
+         code);
+      elle::Exception inner_exception(bt, error);
+      e.inner_exception(std::make_exception_ptr(inner_exception));
+      throw e;
     }
 
     /*------------------.
@@ -301,6 +686,59 @@ namespace infinit
           out << c;
         }
       };
+
+      template <typename IS,
+                typename OS,
+                typename T,
+                typename ... Args>
+      struct VoidSwitch<IS, OS, reactor::Generator<T>, Args ...>
+      {
+        static
+        void
+        call(IS&,
+             OS&,
+             boost::function<reactor::Generator<T> (Args...)> const&)
+        {
+          ELLE_ABORT("streaming procedure called for a single result");
+        }
+      };
+
+      template <typename IS,
+                typename OS,
+                typename R,
+                typename ... Args>
+      struct StreamSwitch
+      {
+        template <typename Sender>
+        static
+        void
+        call(IS&,
+             Sender const&,
+             boost::function<R (Args...)> const&)
+        {
+          ELLE_ABORT("single result procedure called for a stream");
+        }
+      };
+
+      template <typename IS,
+                typename OS,
+                typename T,
+                typename ... Args>
+      struct StreamSwitch<IS, OS, reactor::Generator<T>, Args ...>
+      {
+        template <typename Sender>
+        static
+        void
+        call(IS& in,
+             Sender const& send,
+             boost::function<reactor::Generator<T> (Args...)> const& f)
+        {
+          auto items =
+            Call<IS, reactor::Generator<T>, Args...>::template call<>(in, f);
+          for (auto item: items)
+            send([&] (OS& out) { out << item; });
+        }
+      };
     }
 
     /*----------.
@@ -319,6 +757,26 @@ namespace infinit
         in, out, this->_function);
     }
 
+    template <typename IS,
+              typename OS,
+              typename R,
+              typename ... Args>
+    bool
+    Procedure<IS, OS, R, Args...>::_streaming() const
+    {
+      return IsGenerator<R>::value;
+    }
+
+    template <typename IS,
+              typename OS,
+              typename R,
+              typename ... Args>
+    void
+    Procedure<IS, OS, R, Args...>::_stream(IS& in, Sender const& send)
+    {
+      StreamSwitch<IS, OS, R, Args ...>::call(in, send, this->_function);
+    }
+
     /*----.
     | RPC |
     `----*/
@@ -354,11 +812,19 @@ namespace infinit
       : BaseRPC(channels)
     {}
 
+    template <typename IS,
+              typename OS>
+    RPC<IS, OS>::RPC(StreamPool& pool)
+      : BaseRPC(pool)
+    {}
+
     template<typename T>
     bool
     handle_exception(ExceptionHandler & handler,
                      T& output,
-                     std::exception_ptr ex)
+                     std::exception_ptr ex,
+                     bool control,
+                     bool backtrace)
     {
       ELLE_LOG_COMPONENT("infinit.protocol.RPC");
       bool res = false;
@@ -369,39 +835,135 @@ namespace infinit
           handler(std::current_exception());
         std::rethrow_exception(ex);
       }
-      catch (elle::Exception& e)
+      catch (...)
       {
-        if (dynamic_cast<LastMessageException*>(&e))
+        auto e = std::current_exception();
+        try
+        {
+          std::rethrow_exception(e);
+        }
+        catch (LastMessageException const&)
+        {
           res = true;
+        }
+        catch (...)
+        {}
         ELLE_TRACE_SCOPE("RPC procedure failed: %s (stop_request = %s)",
-          e.what(), res);
-        output << false;
-        output << std::string(e.what());
-        output << uint16_t(e.backtrace().frames().size());
-        for (auto const& frame: e.backtrace().frames())
+                         elle::exception_string(e), res);
+        put_failure(output, control, backtrace, e);
+      }
+      return res;
+    }
+
+    template <typename IS,
+              typename OS>
+    Channel::Handler
+    RPC<IS, OS>::_control(std::shared_ptr<Call> call) const
+    {
+      return [call] (elle::Buffer packet)
+      {
+        ELLE_LOG_COMPONENT("infinit.protocol.RPC");
+        // An empty packet cancels the call: skip it if still queued,
+        // terminate it if running.
+        if (packet.size() == 0)
         {
-          output << frame.symbol;
-          output << frame.symbol_mangled;
-          output << frame.symbol_demangled;
-          output << frame.address;
-          output << frame.offset;
+          ELLE_TRACE("call canceled by peer");
+          call->canceled = true;
+          if (call->thread)
+            call->thread->terminate();
+          return;
+        }
+        // Errors must not escape: this runs in whichever thread reads the
+        // stream, and would fail every reader.
+        try
+        {
+          elle::IOStream ins(packet.istreambuf());
+          IS input(ins);
+          uint32_t credit;
+          input >> credit;
+          ELLE_DEBUG("peer grants %s more items", credit);
+          call->credit += credit;
         }
+        catch (std::exception const&)
+        {
+          ELLE_WARN("ignore malformed control packet: %s",
+                    elle::exception_string());
+        }
+      };
+    }
+
+    template <typename IS,
+              typename OS>
+    void
+    RPC<IS, OS>::_stream(Channel& channel,
+                         Call& call,
+                         LocalProcedure& procedure,
+                         IS& input,
+                         CallMetrics& metrics,
+                         Deadline const& deadline)
+    {
+      ELLE_LOG_COMPONENT("infinit.protocol.RPC");
+      uint32_t window;
+      input >> window;
+      call.credit += window;
+      auto const refill = BaseRPC::_stream_refill(window);
+      uint32_t sent = 0;
+      // Wait for the credit to reach \a credit, or the call to be canceled.
+      // Control packets are read in the background meanwhile, so that the
+      // deadline or a cancellation never interrupts a read.
+      auto wait_credit = [&] (std::size_t credit)
+      {
+        while (call.credit < credit)
+        {
+          if (call.canceled)
+            throw elle::Error("call canceled by peer");
+          ELLE_DEBUG("%s: wait for credit", *this)
+            channel.wait(BaseRPC::_remaining(deadline));
+        }
+      };
+      // The caller renews credit for every refill items it receives, receive
+      // those renewals before ending the call: arriving on a closed channel,
+      // they would be taken for a new call.
+      auto settle = [&]
+      {
+        ELLE_DEBUG("%s: wait for the last renewals", *this)
+          wait_credit(window - sent % refill);
+      };
+      try
+      {
+        procedure._stream(
+          input,
+          [&] (std::function<void (OS&)> const& put)
+          {
+            BaseRPC::_remaining(deadline);
+            wait_credit(1);
+            --call.credit;
+            ++sent;
+            elle::Buffer packet;
+            {
+              elle::IOStream outs(packet.ostreambuf());
+              OS output(outs);
+              output << true;
+              output << true;
+              put(output);
+            }
+            channel.write(packet);
+            metrics.bytes_out += packet.size();
+          });
       }
-      catch (std::exception& e)
+      catch (reactor::Terminate const&)
       {
-        ELLE_TRACE_SCOPE("RPC procedure failed: %s", e.what());
-        output << false;
-        output << std::string(e.what());
-        output << uint16_t(0);
+        throw;
       }
       catch (...)
       {
-        ELLE_TRACE_SCOPE("RPC procedure failed: unknown error");
-        output << false;
-        output << std::string("unknown error");
-        output << uint16_t(0);
+        // The caller still renews credit for the items it got before the
+        // error.
+        auto error = std::current_exception();
+        settle();
+        std::rethrow_exception(error);
       }
-      return res;
+      settle();
     }
 
     template <typename IS,
@@ -419,47 +981,110 @@ namespace infinit
         while (!stop_request)
         {
           ELLE_TRACE_SCOPE("%s: Accepting new request...", *this);
-          Channel c(this->_channels.accept());
+          Channel c(this->_accept());
           elle::Buffer question(c.read());
+          auto const received = CallMeasure::Clock::now();
+          if (question.size() == 0)
+          {
+            ELLE_DEBUG("%s: ignore cancellation of a finished call", *this);
+            continue;
+          }
           elle::IOStream ins(question.istreambuf());
           IS input(ins);
-          uint32_t id;
-          input >> id;
+          Deadline deadline;
+          bool backtrace;
+          uint32_t id =
+            get_header(input, this->_call_control(), deadline, backtrace);
           ELLE_TRACE_SCOPE("%s: Processing request for %s...", *this, id);
           auto procedure = this->_procedures.find(id);
+          auto call = std::make_shared<Call>();
+          c.handle(this->_control(call));
 
           elle::Buffer answer;
           elle::IOStream outs(answer.ostreambuf());
           OS output(outs);
-          try
+          CallMetrics* metrics = nullptr;
+          bool succeeded = false;
+          auto serve = [&]
           {
-            if (procedure == this->_procedures.end())
-              throw Exception(sprintf("call to unknown procedure: %s", id));
-            else if (procedure->second.second == nullptr)
+            try
             {
-              throw Exception(sprintf("remote call to non-local procedure: %s",
-                                      procedure->second.first));
+              if (procedure == this->_procedures.end())
+                throw RPCError(sprintf("call to unknown procedure: %s", id),
+                               RPCErrorCode::unknown_procedure);
+              else if (procedure->second.second == nullptr)
+              {
+                throw RPCError(sprintf("remote call to non-local procedure: %s",
+                                       procedure->second.first),
+                               RPCErrorCode::unknown_procedure);
+              }
+              else
+              {
+                auto const &name = procedure->second.first;
+                metrics = &this->_measure(id, name).server;
+
+                auto& local = *procedure->second.second;
+                ELLE_TRACE("%s: remote procedure called: %s", *this, name)
+                  if (local._streaming())
+                  {
+                    this->_stream(c, *call, local, input, *metrics, deadline);
+                    output << true;
+                    output << false;
+                  }
+                  else
+                    BaseRPC::_within(
+                      deadline, [&] { local._call(input, output); });
+                ELLE_TRACE("%s: procedure %s succeeded", *this, name);
+                succeeded = true;
+              }
             }
-            else
+            catch (reactor::Terminate const&)
             {
-              auto const &name = procedure->second.first;
-
-              ELLE_TRACE("%s: remote procedure called: %s", *this, name)
-                procedure->second.second->_call(input, output);
-              ELLE_TRACE("%s: procedure %s succeeded", *this, name);
+              ELLE_TRACE("%s: terminating as requested", *this);
+              throw;
             }
-          }
-          catch (reactor::Terminate const&)
+            catch (...)
+            { // Pass exception through handler if present, reply with an error
+              stop_request = handle_exception(
+                handler, output, std::current_exception(),
+                this->_call_control(), backtrace);
+            }
+          };
+          if (this->_call_control())
           {
-            ELLE_TRACE("%s: terminating as requested", *this);
-            throw;
+            // Run the procedure in its own thread, so that a cancellation
+            // from the peer can terminate it. Control packets are passed to
+            // the call by the background reader meanwhile.
+            elle::SafeFinally detach([&] { call->thread = nullptr; });
+            reactor::Thread::unique_ptr thread(
+              new reactor::Thread(
+                sprintf("%s: call %s", *this, id),
+                [&]
+                {
+                  elle::SafeFinally done([&] { c.wake(); });
+                  serve();
+                }));
+            call->thread = thread.get();
+            while (!thread->done())
+              c.wait(reactor::DurationOpt());
           }
-          catch (...)
-          { // Pass exception through handler if present, reply with an error
-            stop_request = handle_exception(handler, output, std::current_exception());
+          else
+            serve();
+          if (call->canceled)
+          {
+            ELLE_TRACE("%s: call canceled", *this);
+            if (metrics)
+              metrics->record(CallMeasure::Clock::now() - received, false);
+            continue;
           }
           outs.flush();
           c.write(answer);
+          if (metrics)
+          {
+            metrics->bytes_in += question.size();
+            metrics->bytes_out += answer.size();
+            metrics->record(CallMeasure::Clock::now() - received, succeeded);
+          }
         }
       }
       catch (reactor::network::ConnectionClosed const& e)
@@ -486,81 +1111,133 @@ namespace infinit
       {
         elle::With<reactor::Scope>("RPC // run") << [&] (reactor::Scope& scope)
         {
-          int i = 0;
+          elle::SafeFinally abandon([this] { this->_abandon(); });
           while (true)
           {
-            auto chan = std::make_shared<Channel>(this->_channels.accept());
-            ++i;
+            auto chan = std::make_shared<Channel>(this->_accept());
+            auto question = std::make_shared<elle::Buffer>(chan->read());
+            auto const received = CallMeasure::Clock::now();
+            if (question->size() == 0)
+            {
+              ELLE_DEBUG("%s: ignore cancellation of a finished call", *this);
+              continue;
+            }
+            // The deadline counts from reception, so that time spent waiting
+            // for admission is charged to the call.
+            uint32_t id;
+            Deadline deadline;
+            bool backtrace;
+            {
+              elle::IOStream ins(question->istreambuf());
+              IS input(ins);
+              id = get_header(
+                input, this->_call_control(), deadline, backtrace);
+            }
+            auto refuse = [&] (RPCErrorCode code, std::string const& message)
+            {
+              elle::Buffer answer;
+              elle::IOStream outs(answer.ostreambuf());
+              OS output(outs);
+              put_error(output, this->_call_control(), false,
+                        code, message, nullptr);
+              outs.flush();
+              chan->write(answer);
+            };
+            // Answer calls to unknown procedures right away: admission
+            // control keeps state per procedure, which peers must not grow.
+            auto procedure = this->_procedures.find(id);
+            if (procedure == this->_procedures.end())
+            {
+              ELLE_TRACE("%s: call to unknown procedure: %s", *this, id);
+              refuse(RPCErrorCode::unknown_procedure,
+                     sprintf("call to unknown procedure: %s", id));
+              continue;
+            }
+            if (procedure->second.second == nullptr)
+            {
+              ELLE_TRACE("%s: remote call to non-local procedure: %s",
+                         *this, procedure->second.first);
+              refuse(RPCErrorCode::unknown_procedure,
+                     sprintf("remote call to non-local procedure: %s",
+                             procedure->second.first));
+              continue;
+            }
+            auto const named = &procedure->second;
+            auto call = std::make_shared<Call>();
+            chan->handle(this->_control(call));
 
-            auto call_procedure = [&, chan] {
+            auto call_procedure =
+              [this, chan, question, call, received, deadline, backtrace,
+               id, named]
+            {
               ELLE_LOG_COMPONENT("infinit.protocol.RPC");
 
-              elle::Buffer question(chan->read());
-              elle::IOStream ins(question.istreambuf());
+              if (call->canceled)
+                return;
+              call->thread = reactor::scheduler().current();
+              elle::SafeFinally detach([&] { call->thread = nullptr; });
+              elle::IOStream ins(question->istreambuf());
               IS input(ins);
-              uint32_t id;
-              input >> id;
-              auto procedure = this->_procedures.find(id);
+              {
+                // Skip the header, already parsed on reception.
+                Deadline ignored;
+                bool ignored_backtrace;
+                get_header(
+                  input, this->_call_control(), ignored, ignored_backtrace);
+              }
+              auto const& name = named->first;
+              auto& local = *named->second;
+              auto& metrics = this->_measure(id, name).server;
 
               elle::Buffer answer;
               elle::IOStream outs(answer.ostreambuf());
               OS output(outs);
+              bool succeeded = false;
               try
               {
-                if (procedure == _procedures.end())
-                  throw Exception(sprintf("call to unknown procedure: %s", id));
-                else if (procedure->second.second == nullptr)
-                {
-                  throw Exception(sprintf("remote call to non-local procedure: %s",
-                                          procedure->second.first));
-                }
-                else
-                {
-                  auto const &name = procedure->second.first;
-
-                  ELLE_TRACE("%s: remote procedure called: %s", *this, name)
-                    procedure->second.second->_call(input, output);
-                  ELLE_TRACE("%s: procedure %s succeeded", *this, name);
-                }
+                ELLE_TRACE("%s: remote procedure called: %s", *this, name)
+                  if (local._streaming())
+                  {
+                    this->_stream(
+                      *chan, *call, local, input, metrics, deadline);
+                    output << true;
+                    output << false;
+                  }
+                  else
+                    BaseRPC::_within(
+                      deadline, [&] { local._call(input, output); });
+                ELLE_TRACE("%s: procedure %s succeeded", *this, name);
+                succeeded = true;
               }
-              catch (elle::Error const& e)
+              catch (reactor::Terminate const&)
               {
-                ELLE_TRACE("%s: procedure failed: %s", *this, e.what());
-                output << false;
-                output << std::string(e.what());
-                output << uint16_t(e.backtrace().frames().size());
-                for (auto const& frame: e.backtrace().frames())
+                if (call->canceled)
                 {
-                  output << frame.symbol;
-                  output << frame.symbol_mangled;
-                  output << frame.symbol_demangled;
-                  output << frame.address;
-                  output << frame.offset;
+                  ELLE_TRACE("%s: call canceled", *this);
+                  metrics.record(CallMeasure::Clock::now() - received, false);
+                  return;
                 }
-              }
-              catch (reactor::Terminate const&)
-              {
                 ELLE_TRACE("%s: terminating as requested", *this);
                 throw;
               }
-              catch (std::exception& e)
-              {
-                ELLE_TRACE("%s: procedure failed: %s", *this, e.what());
-                output << false;
-                output << std::string(e.what());
-                output << uint16_t(0);
-              }
               catch (...)
               {
-                ELLE_TRACE("%s: procedure failed: unknown error", *this);
-                output << false;
-                output << std::string("unknown error");
-                output << uint16_t(0);
+                ELLE_TRACE("%s: procedure failed: %s",
+                           *this, elle::exception_string());
+                put_failure(output, this->_call_control(), backtrace,
+                            std::current_exception());
               }
               outs.flush();
               chan->write(answer);
+              metrics.bytes_in += question->size();
+              metrics.bytes_out += answer.size();
+              metrics.record(CallMeasure::Clock::now() - received, succeeded);
             };
-            scope.run_background(elle::sprintf("RPC %s", i), call_procedure);
+            if (!this->_admit(scope, id, call_procedure))
+            {
+              ELLE_TRACE("%s: server busy, reject call to %s", *this, id);
+              refuse(RPCErrorCode::busy, "server busy");
+            }
           }
         };
       }
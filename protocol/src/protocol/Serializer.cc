@@ -5,6 +5,7 @@
 #endif
 
 #include <elle/Buffer.hh>
+#include <elle/format/gzip.hh>
 #include <elle/log.hh>
 
 #include <cryptography/hash.hh>
@@ -37,10 +38,13 @@ namespace infinit
       pImpl(std::iostream& stream,
             elle::Buffer::Size chunk_size,
             bool checksum,
+            Checksum algorithm,
             elle::Version const& version)
         : _stream(stream)
+        , _socket(dynamic_cast<reactor::network::Socket*>(&stream))
         , _chunk_size(chunk_size)
         , _checksum(checksum)
+        , _algorithm(algorithm)
         , _version(version)
         , _lock_write()
         , _lock_read()
@@ -75,7 +79,7 @@ namespace infinit
       _read() = 0;
 
       void
-      write(elle::Buffer const& packet)
+      write(Stream::Buffers const& packet)
       {
         reactor::Lock lock(this->_lock_write);
         elle::IOStreamClear clearer(this->_stream);
@@ -84,12 +88,15 @@ namespace infinit
 
       virtual
       void
-      _write(elle::Buffer const&) = 0;
+      _write(Stream::Buffers const&) = 0;
 
     private:
       ELLE_ATTRIBUTE_RX(std::iostream&, stream, protected);
+      /// The stream as a socket, to write fragments without copying them.
+      ELLE_ATTRIBUTE(reactor::network::Socket*, socket, protected);
       ELLE_ATTRIBUTE(elle::Buffer::Size, chunk_size, protected);
       ELLE_ATTRIBUTE(bool, checksum, protected);
+      ELLE_ATTRIBUTE(Checksum, algorithm, protected);
       ELLE_ATTRIBUTE_R(elle::Version, version);
       ELLE_ATTRIBUTE(reactor::Mutex, lock_write, protected);
       ELLE_ATTRIBUTE(reactor::Mutex, lock_read, protected);
@@ -102,7 +109,7 @@ namespace infinit
       Version010Impl(std::iostream& stream,
                      elle::Buffer::Size chunk_size,
                      bool checksum)
-        :  Serializer::pImpl(stream, chunk_size, checksum,
+        :  Serializer::pImpl(stream, chunk_size, checksum, Checksum::sha1,
                              elle::Version(0, 1, 0))
       {}
 
@@ -111,18 +118,21 @@ namespace infinit
       _read() final;
 
       void
-      _write(elle::Buffer const&) final;
+      _write(Stream::Buffers const&) final;
     };
 
     struct Impl
       : public Serializer::pImpl
     {
     public:
-      Impl(std::iostream& stream,
+      Impl(Serializer& owner,
+                     std::iostream& stream,
                      elle::Buffer::Size chunk_size,
                      bool checksum,
+                     Checksum algorithm,
                      elle::Version const& version)
-        :  Serializer::pImpl(stream, chunk_size, checksum, version)
+        :  Serializer::pImpl(stream, chunk_size, checksum, algorithm, version)
+        , _owner(owner)
       {}
 
     public:
@@ -130,7 +140,12 @@ namespace infinit
       _read() final;
 
       void
-      _write(elle::Buffer const&) final;
+      _write(Stream::Buffers const&) final;
+
+    private:
+      boost::optional<elle::Buffer>
+      _compress(Stream::Buffers const& packet, elle::Buffer::Size size);
+      ELLE_ATTRIBUTE(Serializer&, owner);
     };
 
     /*------.
@@ -141,25 +156,48 @@ namespace infinit
       : elle::Error("end of serializer stream")
     {}
 
+    std::ostream&
+    operator <<(std::ostream& output, Compression compression)
+    {
+      switch (compression)
+      {
+        case Compression::none:
+          return output << "none";
+        case Compression::deflate:
+          return output << "DEFLATE";
+      }
+      return output << "unknown compression "
+                    << static_cast<int>(compression);
+    }
+
     /*-------------.
     | Construction |
     `-------------*/
 
     Serializer::Serializer(std::iostream& stream,
                            elle::Version const& version,
-                           bool checksum)
-      : Serializer(*reactor::Scheduler::scheduler(), stream, version, checksum)
+                           bool checksum,
+                           Checksum checksum_algorithm,
+                           Compression compression)
+      : Serializer(*reactor::Scheduler::scheduler(),
+                   stream, version, checksum, checksum_algorithm, compression)
     {}
 
     Serializer::Serializer(reactor::Scheduler& scheduler,
                            std::iostream& stream,
                            elle::Version const& version,
-                           bool checksum)
+                           bool checksum,
+                           Checksum checksum_algorithm,
+                           Compression compression)
       : Super(scheduler)
       , _stream(stream)
       , _version(version)
       , _chunk_size(2 << 16)
       , _checksum(checksum)
+      , _checksum_algorithm(Checksum::sha1)
+      , _compression(Compression::none)
+      , _compression_threshold(1024)
+      , _compression_statistics{0, 0, 0, 0}
     {
       if (this->version() >= elle::Version(0, 2, 0))
       {
@@ -176,12 +214,44 @@ namespace infinit
         }
       }
       ELLE_TRACE("using version: '%s'", this->version());
+      if (this->version() >= elle::Version(0, 4, 0))
+      {
+        ELLE_TRACE("%s: send checksum algorithm %s and compression %s",
+                   *this, checksum_algorithm, compression)
+        {
+          stream.put(static_cast<char>(checksum_algorithm));
+          stream.put(static_cast<char>(compression));
+          stream.flush();
+        }
+        ELLE_TRACE("%s: read peer checksum algorithm and compression", *this)
+        {
+          auto peer_checksum = stream.get();
+          auto peer_compression = stream.get();
+          if (peer_compression == std::iostream::traits_type::eof())
+            throw EOF();
+          if (peer_checksum > static_cast<int>(Checksum::xxhash64))
+            throw protocol::Error(
+              elle::sprintf("unknown checksum algorithm: %s", peer_checksum));
+          if (peer_compression > static_cast<int>(Compression::deflate))
+            throw protocol::Error(
+              elle::sprintf("unknown compression: %s", peer_compression));
+          ELLE_DEBUG("peer checksum algorithm: %s, compression: %s",
+                     Checksum(peer_checksum), Compression(peer_compression));
+          this->_checksum_algorithm =
+            std::min(Checksum(peer_checksum), checksum_algorithm);
+          this->_compression =
+            std::min(Compression(peer_compression), compression);
+        }
+      }
+      ELLE_TRACE("using checksum: %s, compression: %s",
+                 this->checksum_algorithm(), this->compression());
       if (this->version() < elle::Version(0, 2, 0))
         this->_impl.reset(
           new Version010Impl(stream, this->_chunk_size, checksum));
       else
         this->_impl.reset(
-          new Impl(stream, this->_chunk_size, checksum, version));
+          new Impl(*this, stream, this->_chunk_size, checksum,
+                   this->_checksum_algorithm, this->version()));
     }
 
     Serializer::~Serializer()
@@ -206,6 +276,14 @@ namespace infinit
     Serializer::_write(elle::Buffer const& packet)
     {
       ELLE_TRACE_SCOPE("%s: write packet (%s bytes)", *this, packet.size());
+      this->_impl->write({packet});
+    }
+
+    void
+    Serializer::_writev(Buffers const& packet)
+    {
+      ELLE_TRACE_SCOPE("%s: write packet (%s fragments)",
+                       *this, packet.size());
       this->_impl->write(packet);
     }
 
@@ -274,6 +352,51 @@ namespace infinit
       }
     }
 
+    // Below this size, chunks are read through the stream buffer, which
+    // fetches them along with what follows in a single system call.
+    static elle::Buffer::Size const direct_threshold = 4096;
+
+    // Read a chunk like above, but straight from \a socket into \a content
+    // once what the stream already buffered is consumed, sparing large
+    // payloads the round trip through the stream buffer.
+    static
+    void
+    read(Serializer::Inner& stream,
+         reactor::network::Socket* socket,
+         elle::Buffer& content,
+         uint32_t size,
+         uint32_t offset = 0)
+    {
+      if (!socket || size < direct_threshold)
+        return read(stream, content, size, offset);
+      auto* where = content.mutable_contents() + offset;
+      auto buffered = std::min<std::streamsize>(
+        std::max<std::streamsize>(stream.rdbuf()->in_avail(), 0), size);
+      if (buffered > 0)
+        stream.rdbuf()->sgetn(reinterpret_cast<char*>(where), buffered);
+      ELLE_DEBUG_SCOPE("read %s bytes from %s at offset %s (%s buffered)",
+                       size, *socket, offset, buffered);
+      elle::WeakBuffer rest(where + buffered, size - buffered);
+      // Read the full chunk even if terminated to keep the stream in a
+      // consistent state.
+      int nread = 0;
+      try
+      {
+        socket->read(rest, {}, &nread);
+      }
+      catch (...)
+      {
+        ELLE_TRACE("reading %s interrupted", *socket);
+        while (nread < signed(rest.size()))
+        {
+          int r = 0;
+          socket->read(rest.range(nread), {}, &r);
+          nread += r;
+        }
+        throw;
+      }
+    }
+
     static
     elle::Buffer
     read(Serializer::Inner& stream,
@@ -292,14 +415,14 @@ namespace infinit
     // Return the sha1 of a given buffer.
     static
     elle::Buffer
-    compute_checksum(elle::Buffer const& content)
+    compute_checksum(elle::ConstWeakBuffer const& content)
     {
       ELLE_DUMP("compute checksum of '%x'", content);
 #if defined(INFINIT_CRYPTOGRAPHY_LEGACY)
       auto _hash =
         infinit::cryptography::hash(
           infinit::cryptography::Plain(
-            elle::WeakBuffer(content.mutable_contents(),
+            elle::WeakBuffer(const_cast<elle::Byte*>(content.contents()),
                              content.size())),
           infinit::cryptography::Oneway::sha1);
       auto hash(_hash.buffer());
@@ -314,6 +437,60 @@ namespace infinit
       return hash;
     }
 
+    // Read fragments in turn, to hash them without concatenating them.
+    class FragmentsStreamBuffer
+      : public std::streambuf
+    {
+    public:
+      FragmentsStreamBuffer(Stream::Buffers const& fragments)
+        : _fragments(fragments)
+        , _next(0)
+      {}
+
+    protected:
+      int
+      underflow() override
+      {
+        while (this->_next < this->_fragments.size())
+        {
+          auto const& fragment = this->_fragments[this->_next++];
+          if (fragment.empty())
+            continue;
+          auto data =
+            reinterpret_cast<char*>(const_cast<elle::Byte*>(fragment.contents()));
+          this->setg(data, data, data + fragment.size());
+          return traits_type::to_int_type(*data);
+        }
+        return traits_type::eof();
+      }
+
+    private:
+      Stream::Buffers const& _fragments;
+      std::size_t _next;
+    };
+
+    // Return the sha1 of the concatenated fragments.
+    static
+    elle::Buffer
+    compute_checksum(Stream::Buffers const& fragments)
+    {
+      if (fragments.size() == 1)
+        return compute_checksum(fragments.front());
+#if defined(INFINIT_CRYPTOGRAPHY_LEGACY)
+      elle::Buffer content;
+      for (auto const& fragment: fragments)
+        content.append(fragment.contents(), fragment.size());
+      return compute_checksum(content);
+#else
+      FragmentsStreamBuffer buffer(fragments);
+      std::istream input(&buffer);
+      auto hash =
+        infinit::cryptography::hash(input, infinit::cryptography::Oneway::sha1);
+      ELLE_DUMP("checksum: '%x'", hash);
+      return hash;
+#endif
+    }
+
     // Make sure the given buffer checksum match the given checksum.
     static
     void
@@ -331,6 +508,57 @@ namespace infinit
       }
     }
 
+    static
+    elle::Buffer::Size
+    size(Stream::Buffers const& fragments)
+    {
+      elle::Buffer::Size res = 0;
+      for (auto const& fragment: fragments)
+        res += fragment.size();
+      return res;
+    }
+
+    // Below this size, fragments are copied in the stream buffer to be
+    // coalesced with what surrounds them instead of being written apart.
+    static elle::Buffer::Size const gather_threshold = 4096;
+
+    // Write \a size bytes from \a offset in the concatenated fragments,
+    // prefixed by the pending stream content, with a single gather write
+    // when the stream is a socket. Feed them to \a hasher on the way.
+    static
+    void
+    write(Serializer::Inner& stream,
+          reactor::network::Socket* socket,
+          Stream::Buffers const& fragments,
+          elle::Buffer::Size offset,
+          elle::Buffer::Size size,
+          Hasher* hasher = nullptr)
+    {
+      Stream::Buffers range;
+      for (auto const& fragment: fragments)
+      {
+        if (size == 0)
+          break;
+        if (offset >= fragment.size())
+        {
+          offset -= fragment.size();
+          continue;
+        }
+        auto piece = std::min(fragment.size() - offset, size);
+        range.emplace_back(fragment.contents() + offset, piece);
+        if (hasher)
+          hasher->update(range.back());
+        size -= piece;
+        offset = 0;
+      }
+      if (socket && infinit::protocol::size(range) >= gather_threshold)
+        socket->writev(range);
+      else
+        for (auto const& piece: range)
+          stream.write(reinterpret_cast<char const*>(piece.contents()),
+                       piece.size());
+    }
+
     static
     void
     write(Serializer::Inner& stream,
@@ -384,7 +612,7 @@ namespace infinit
     }
 
     void
-    Version010Impl::_write(elle::Buffer const& packet)
+    Version010Impl::_write(Stream::Buffers const& packet)
     {
       // The write must not be interrupted, otherwise it will break
       // the serialization protocol.
@@ -397,7 +625,12 @@ namespace infinit
             infinit::protocol::write(this->_stream, this->version(), hash);
         }
         ELLE_DEBUG("send actual data")
-          infinit::protocol::write(this->_stream, this->version(), packet);
+        {
+          auto size = infinit::protocol::size(packet);
+          Serializer::Super::uint32_put(this->_stream, size, this->version());
+          infinit::protocol::write(
+            this->_stream, this->_socket, packet, 0, size);
+        }
         this->_stream.flush();
       };
     }
@@ -460,12 +693,33 @@ namespace infinit
            return this->_stream.peek();
          } == std::iostream::traits_type::eof())
         throw Serializer::EOF();
+      // Compressed packets are announced with their original size.
+      auto compression = Compression::none;
+      uint32_t raw_size = 0;
+      if (this->_owner.compression() != Compression::none)
+      {
+        char encoding = 0;
+        this->_stream.read(&encoding, 1);
+        compression = Compression(encoding);
+        if (compression > this->_owner.compression())
+          throw protocol::Error(
+            elle::sprintf("unexpected compression: %s", compression));
+        if (compression != Compression::none)
+          raw_size = Serializer::Super::uint32_get(
+            this->_stream, this->version());
+      }
+      // Legacy SHA-1 checksums are sent first and verified in a second pass,
+      // others are computed as chunks come and sent last.
+      bool const legacy = this->_algorithm == Checksum::sha1;
       elle::Buffer hash;
-      if (this->_checksum)
+      if (this->_checksum && legacy)
       {
         ELLE_DEBUG("read checksum")
           hash = infinit::protocol::read(this->_stream, this->version(), {});
       }
+      boost::optional<Hasher> hasher;
+      if (this->_checksum && !legacy)
+        hasher.emplace(this->_algorithm);
       // Get the total size.
       uint32_t total_size(Serializer::Super::uint32_get(this->_stream,
                                                         this->version()));
@@ -476,7 +730,11 @@ namespace infinit
       {
         uint32_t size = std::min(total_size - offset, this->_chunk_size);
         ELLE_DEBUG("read chunk of size %s", size);
-        infinit::protocol::read(this->_stream, packet, size, offset);
+        infinit::protocol::read(
+          this->_stream, this->_socket, packet, size, offset);
+        if (hasher)
+          hasher->update(
+            elle::ConstWeakBuffer(packet.contents() + offset, size));
         offset += size;
         ELLE_ASSERT_LTE(offset, total_size);
         if (offset >= total_size)
@@ -486,34 +744,126 @@ namespace infinit
       }
       ELLE_DUMP("packet content: '%f'", packet);
       // Check hash.
-      if (this->_checksum)
+      if (hasher)
+      {
+        elle::Buffer expected(Hasher::size(this->_algorithm));
+        ELLE_DEBUG("read checksum")
+          infinit::protocol::read(this->_stream, expected, expected.size());
+        auto checksum = hasher->digest();
+        ELLE_DUMP("checksum: '%x', expected '%x'", checksum, expected);
+        if (checksum != expected)
+        {
+          ELLE_ERR("wrong packet checksum")
+            throw ChecksumError();
+        }
+      }
+      else if (this->_checksum)
         enforce_checksums_equal(packet, hash);
-      ELLE_TRACE("%s: got packet of size %s", this, total_size);
+      if (compression != Compression::none)
+      {
+        ELLE_DEBUG("decompress %s bytes to %s", total_size, raw_size);
+        // The raw size comes from the peer: DEFLATE cannot expand data more
+        // than 1032 times, refuse to allocate anything larger.
+        if (raw_size > uint64_t(total_size) * 1032)
+        {
+          ELLE_ERR("compressed packet of %s bytes announces %s bytes",
+                   total_size, raw_size);
+          throw protocol::Error("invalid compressed packet size");
+        }
+        try
+        {
+          packet = elle::format::gzip::decompress(packet, raw_size);
+        }
+        catch (elle::Exception const& e)
+        {
+          ELLE_ERR("unable to decompress packet: %s", e.what());
+          throw protocol::Error("invalid compressed packet");
+        }
+      }
+      ELLE_TRACE("%s: got packet of size %s", this, packet.size());
       return packet;
     }
 
+    boost::optional<elle::Buffer>
+    Impl::_compress(Stream::Buffers const& packet, elle::Buffer::Size size)
+    {
+      auto& statistics = this->_owner.compression_statistics();
+      boost::optional<elle::Buffer> res;
+      // Give up on packets that do not shrink by at least an eighth.
+      if (size >= this->_owner.compression_threshold())
+        res = elle::format::gzip::compress(packet, size - size / 8);
+      statistics.raw += size;
+      if (res)
+      {
+        ELLE_DEBUG("compressed %s bytes to %s", size, res->size());
+        statistics.compressed += res->size();
+        ++statistics.packets;
+      }
+      else
+      {
+        statistics.compressed += size;
+        ++statistics.skipped;
+      }
+      return res;
+    }
+
     void
-    Impl::_write(elle::Buffer const& packet)
+    Impl::_write(Stream::Buffers const& input)
     {
-      ELLE_DEBUG_SCOPE("chunk writer, sz=%s, chunk=%s", packet.size(),
+      auto compression = this->_owner.compression();
+      auto const input_size = infinit::protocol::size(input);
+      boost::optional<elle::Buffer> compressed;
+      if (compression != Compression::none)
+        compressed = this->_compress(input, input_size);
+      Stream::Buffers deflated;
+      if (compressed)
+        deflated.emplace_back(*compressed);
+      else
+        compression = Compression::none;
+      auto const& packet = compressed ? deflated : input;
+      auto const packet_size = infinit::protocol::size(packet);
+      ELLE_DEBUG_SCOPE("chunk writer, sz=%s, chunk=%s", packet_size,
                        this->_chunk_size);
       elle::Buffer::Size offset = 0;
+      bool const legacy = this->_algorithm == Checksum::sha1;
+      boost::optional<Hasher> hasher;
+      if (this->_checksum && !legacy)
+        hasher.emplace(this->_algorithm);
       try
       {
         auto send = [&]
           {
-            auto to_send = std::min(this->_chunk_size, packet.size() - offset);
+            auto to_send = std::min(this->_chunk_size, packet_size - offset);
             ELLE_DEBUG("send actual data: %s", to_send)
             infinit::protocol::write(
-              this->_stream,
-              this->version(), packet, false, offset, to_send);
+              this->_stream, this->_socket, packet, offset, to_send,
+              hasher.get_ptr());
             offset += to_send;
+            // Send the checksum, computed on the fly, after the last chunk.
+            if (hasher && offset >= packet_size)
+            {
+              auto hash = hasher->digest();
+              ELLE_DEBUG("send checksum %x", hash)
+                infinit::protocol::write(
+                  this->_stream, this->version(), hash, false);
+            }
             this->_stream.flush();
           };
         {
           elle::With<reactor::Thread::NonInterruptible>() << [&]
           {
-            if (this->_checksum)
+            if (this->_owner.compression() != Compression::none)
+            {
+              ELLE_DEBUG("send compression %s", compression)
+              {
+                char encoding = static_cast<char>(compression);
+                this->_stream.write(&encoding, 1);
+              }
+              if (compression != Compression::none)
+                Serializer::Super::uint32_put(
+                  this->_stream, input_size, this->version());
+            }
+            if (this->_checksum && legacy)
             // Compute the hash and send it first.
             {
               auto hash = compute_checksum(packet);
@@ -522,7 +872,7 @@ namespace infinit
             }
             // Send the size.
             {
-              auto size = packet.size();
+              auto size = packet_size;
               ELLE_DEBUG("send packet size %s", size)
                 Serializer::Super::uint32_put(this->_stream, size, this->version());
             }
@@ -530,9 +880,9 @@ namespace infinit
             send();
           };
         }
-        while (offset < packet.size())
+        while (offset < packet_size)
         {
-          ELLE_DEBUG("writing control: o=%s, size=%s", offset, packet.size());
+          ELLE_DEBUG("writing control: o=%s, size=%s", offset, packet_size);
           elle::With<reactor::Thread::NonInterruptible>() << [&]
           {
             write_control(this->_stream, Control::keep_going);
@@ -542,10 +892,10 @@ namespace infinit
       }
       catch (reactor::Terminate const&)
       {
-        if (offset < packet.size())
+        if (offset < packet_size)
         {
           ELLE_DEBUG("interrupted after sending %s bytes over %s",
-                     offset, packet.size());
+                     offset, packet_size);
           write_control(this->_stream, Control::interrupt);
           this->_stream.flush();
         }
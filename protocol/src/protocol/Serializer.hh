@@ -9,6 +9,7 @@
 # include <elle/compiler.hh>
 
 # include <protocol/Stream.hh>
+# include <protocol/checksum.hh>
 
 # ifdef EOF
 #  undef EOF
@@ -18,6 +19,18 @@ namespace infinit
 {
   namespace protocol
   {
+    /// Packet compression algorithms.
+    enum class Compression: uint8_t
+    {
+      none = 0,
+      /// Raw DEFLATE, through ZLIB.
+      deflate = 1,
+    };
+
+    ELLE_API
+    std::ostream&
+    operator <<(std::ostream& output, Compression compression);
+
     class ELLE_API Serializer
       : public Stream
     {
@@ -33,19 +46,40 @@ namespace infinit
       public:
         EOF();
       };
+      /// Compression counters, on the sending side.
+      struct CompressionStatistics
+      {
+        /// Bytes of packets before compression.
+        uint64_t raw;
+        /// Bytes of packets as sent.
+        uint64_t compressed;
+        /// Packets sent compressed.
+        uint64_t packets;
+        /// Packets sent raw, for being too small or incompressible.
+        uint64_t skipped;
+      };
 
     /*-------------.
     | Construction |
     `-------------*/
     public:
+      /// Exchange packets over \a stream.
+      ///
+      /// From version 0.4.0, peers agree on the most conservative of their
+      /// \a checksum_algorithm and \a compression during the handshake;
+      /// older peers use SHA-1 and no compression.
       Serializer(std::iostream& stream,
                  elle::Version const& version = elle::Version(0, 1, 0),
-                 bool checksum = true);
+                 bool checksum = true,
+                 Checksum checksum_algorithm = Checksum::crc32c,
+                 Compression compression = Compression::none);
 
       Serializer(reactor::Scheduler& scheduler,
                  std::iostream& stream,
                  elle::Version const& version  = elle::Version(0, 1, 0),
-                 bool checksum = true);
+                 bool checksum = true,
+                 Checksum checksum_algorithm = Checksum::crc32c,
+                 Compression compression = Compression::none);
 
     public:
       ~Serializer();
@@ -63,6 +97,8 @@ namespace infinit
     protected:
       void
       _write(elle::Buffer const& packet) override;
+      void
+      _writev(Buffers const& packet) override;
 
     /*----------.
     | Printable |
@@ -78,6 +114,13 @@ namespace infinit
       ELLE_ATTRIBUTE_R(elle::Version, version, override);
       ELLE_ATTRIBUTE_R(elle::Buffer::Size, chunk_size);
       ELLE_ATTRIBUTE_R(bool, checksum);
+      /// The negotiated checksum algorithm.
+      ELLE_ATTRIBUTE_R(Checksum, checksum_algorithm);
+      /// The negotiated compression.
+      ELLE_ATTRIBUTE_R(Compression, compression);
+      /// Packets smaller than this are sent uncompressed.
+      ELLE_ATTRIBUTE_RW(elle::Buffer::Size, compression_threshold);
+      ELLE_ATTRIBUTE_RX(CompressionStatistics, compression_statistics);
     public:
       class pImpl;
     private:
@@ -45,6 +45,25 @@ namespace infinit
       this->_write(packet);
     }
 
+    void
+    Stream::writev(Buffers const& packet)
+    {
+      this->_writev(packet);
+    }
+
+    void
+    Stream::_writev(Buffers const& packet)
+    {
+      elle::Buffer::Size size = 0;
+      for (auto const& fragment: packet)
+        size += fragment.size();
+      elle::Buffer concatenated;
+      concatenated.capacity(size);
+      for (auto const& fragment: packet)
+        concatenated.append(fragment.contents(), fragment.size());
+      this->_write(concatenated);
+    }
+
     /*------------------.
     | Int serialization |
     `------------------*/
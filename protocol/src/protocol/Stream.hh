@@ -2,6 +2,7 @@
 # define INFINIT_PROTOCOL_STREAM_HH
 
 # include <iosfwd>
+# include <vector>
 
 # include <elle/Buffer.hh>
 # include <elle/Printable.hh>
@@ -15,6 +16,13 @@ namespace infinit
   {
     class Stream: public elle::Printable
     {
+    /*------.
+    | Types |
+    `------*/
+    public:
+      /// Packet fragments, sent as their concatenation.
+      using Buffers = std::vector<elle::ConstWeakBuffer>;
+
     /*-------------.
     | Construction |
     `-------------*/
@@ -47,10 +55,17 @@ namespace infinit
     public:
       void
       write(elle::Buffer const& packet);
+      /// Send the concatenation of \a packet fragments as one packet.
+      void
+      writev(Buffers const& packet);
     protected:
       virtual
       void
       _write(elle::Buffer const& packet) = 0;
+      /// Send fragments, concatenated in a single buffer by default.
+      virtual
+      void
+      _writev(Buffers const& packet);
 
     /*------------------.
     | Int serialization |
@@ -0,0 +1,249 @@
+#include <elle/finally.hh>
+#include <elle/log.hh>
+
+#include <reactor/exception.hh>
+#include <reactor/scheduler.hh>
+
+#include <protocol/ChanneledStream.hh>
+#include <protocol/Serializer.hh>
+#include <protocol/StreamPool.hh>
+
+ELLE_LOG_COMPONENT("infinit.protocol.StreamPool");
+
+namespace infinit
+{
+  namespace protocol
+  {
+    /*-----------.
+    | Connection |
+    `-----------*/
+
+    /// A pooled connection, which tracks its load and health as packets go
+    /// through.
+    class StreamPool::Connection
+      : public Stream
+    {
+    public:
+      typedef Stream Super;
+
+      Connection(StreamPool& pool, std::unique_ptr<std::iostream> socket)
+        : _pool(pool)
+        , _socket(std::move(socket))
+        , _serializer(*this->_socket, pool._version, pool._checksum)
+        , _healthy(true)
+        , _sending(0)
+        , _channels(*this)
+      {
+        this->_channels.closed().connect([&pool] { pool._released(); });
+      }
+
+      elle::Version const&
+      version() const override
+      {
+        return this->_serializer.version();
+      }
+
+      elle::Buffer
+      read() override
+      {
+        return this->_watch([&] { return this->_serializer.read(); });
+      }
+
+      /// Bytes being sent, then open channels.
+      std::pair<std::size_t, std::size_t>
+      load() const
+      {
+        return {this->_sending, this->_channels.channels().size()};
+      }
+
+      /// Whether no channel but the default one is open and nothing is
+      /// being sent.
+      bool
+      idle() const
+      {
+        return this->_sending == 0 && this->_channels.channels().size() <= 1;
+      }
+
+      void
+      print(std::ostream& stream) const override
+      {
+        stream << "StreamPool::Connection " << this;
+      }
+
+    protected:
+      void
+      _write(elle::Buffer const& packet) override
+      {
+        this->_writev({packet});
+      }
+
+      void
+      _writev(Buffers const& packet) override
+      {
+        std::size_t size = 0;
+        for (auto const& fragment: packet)
+          size += fragment.size();
+        this->_sending += size;
+        elle::SafeFinally sent([&] { this->_sending -= size; });
+        this->_watch([&] { this->_serializer.writev(packet); });
+      }
+
+    private:
+      // Mark the connection failed if \a action fails, unless the current
+      // thread is merely terminated.
+      template <typename Action>
+      auto
+      _watch(Action const& action) -> decltype(action())
+      {
+        try
+        {
+          return action();
+        }
+        catch (reactor::Terminate const&)
+        {
+          throw;
+        }
+        catch (std::exception const& e)
+        {
+          if (this->_healthy)
+          {
+            ELLE_WARN("%s: connection lost: %s", this->_pool, e.what());
+            this->_healthy = false;
+            ++this->_pool._failures;
+          }
+          throw;
+        }
+      }
+
+      ELLE_ATTRIBUTE(StreamPool&, pool);
+      ELLE_ATTRIBUTE(std::unique_ptr<std::iostream>, socket);
+      ELLE_ATTRIBUTE(Serializer, serializer);
+      ELLE_ATTRIBUTE_R(bool, healthy);
+      ELLE_ATTRIBUTE(std::size_t, sending);
+      ELLE_ATTRIBUTE_X(ChanneledStream, channels);
+    };
+
+    /*-------------.
+    | Construction |
+    `-------------*/
+
+    StreamPool::StreamPool(Connect connect,
+                           std::size_t size,
+                           elle::Version const& version,
+                           bool checksum)
+      : _size(size)
+      , _version(version)
+      , _failures(0)
+      , _released()
+      , _connect(std::move(connect))
+      , _checksum(checksum)
+      , _connections()
+      , _connecting(0)
+      , _connected()
+    {
+      ELLE_ASSERT_GT(size, 0u);
+    }
+
+    StreamPool::~StreamPool()
+    {}
+
+    /*---------.
+    | Channels |
+    `---------*/
+
+    Channel
+    StreamPool::channel()
+    {
+      while (true)
+      {
+        this->_reap();
+        auto best = this->_select();
+        if ((!best || !best->idle()) &&
+            this->_connections.size() + this->_connecting < this->_size)
+        {
+          try
+          {
+            best = &this->_open();
+          }
+          catch (reactor::Terminate const&)
+          {
+            throw;
+          }
+          catch (std::exception const& e)
+          {
+            if (!best)
+              throw;
+            ELLE_WARN("%s: unable to open connection: %s", *this, e.what());
+          }
+        }
+        if (best)
+        {
+          ELLE_DEBUG("%s: open channel on %s", *this, *best);
+          return Channel(best->channels());
+        }
+        ELLE_DEBUG("%s: wait for a connection", *this)
+          reactor::wait(this->_connected);
+      }
+    }
+
+    std::size_t
+    StreamPool::connections() const
+    {
+      return this->_connections.size();
+    }
+
+    StreamPool::Connection*
+    StreamPool::_select() const
+    {
+      Connection* res = nullptr;
+      for (auto const& connection: this->_connections)
+        if (connection->healthy() &&
+            (!res || connection->load() < res->load()))
+          res = connection.get();
+      return res;
+    }
+
+    StreamPool::Connection&
+    StreamPool::_open()
+    {
+      ELLE_TRACE_SCOPE("%s: open connection %s",
+                       *this, this->_connections.size() + 1);
+      ++this->_connecting;
+      elle::SafeFinally connected(
+        [&]
+        {
+          --this->_connecting;
+          this->_connected.signal();
+        });
+      std::unique_ptr<Connection> connection(
+        new Connection(*this, this->_connect()));
+      this->_version = connection->version();
+      this->_connections.push_back(std::move(connection));
+      return *this->_connections.back();
+    }
+
+    void
+    StreamPool::_reap()
+    {
+      for (auto it = this->_connections.begin();
+           it != this->_connections.end();)
+        if (!(*it)->healthy() && (*it)->idle())
+        {
+          ELLE_TRACE("%s: drop failed %s", *this, **it);
+          it = this->_connections.erase(it);
+        }
+        else
+          ++it;
+    }
+
+    /*----------.
+    | Printable |
+    `----------*/
+
+    void
+    StreamPool::print(std::ostream& stream) const
+    {
+      stream << "StreamPool " << this;
+    }
+  }
+}
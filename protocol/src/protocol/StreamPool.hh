@@ -0,0 +1,101 @@
+#ifndef INFINIT_PROTOCOL_STREAMPOOL_HH
+# define INFINIT_PROTOCOL_STREAMPOOL_HH
+
+# include <functional>
+# include <iosfwd>
+# include <list>
+# include <memory>
+
+# include <boost/signals2/signal.hpp>
+
+# include <elle/Printable.hh>
+# include <elle/Version.hh>
+# include <elle/attribute.hh>
+
+# include <reactor/signal.hh>
+
+# include <protocol/Channel.hh>
+# include <protocol/fwd.hh>
+
+namespace infinit
+{
+  namespace protocol
+  {
+    /// Channels striped over several connections to the same peer.
+    ///
+    /// A channel sticks to the connection it was opened on. New channels go to
+    /// the healthy connection with the fewest bytes being sent, then the fewest
+    /// open channels, so a large transfer does not delay short calls opened
+    /// meanwhile. Connections are opened on demand when all others are busy,
+    /// up to size, and dropped once they fail and their channels are closed,
+    /// to be replaced by new ones.
+    class StreamPool
+      : public elle::Printable
+    {
+    /*------.
+    | Types |
+    `------*/
+    public:
+      using Self = StreamPool;
+      /// Open a connection to the peer.
+      using Connect = std::function<std::unique_ptr<std::iostream> ()>;
+      class Connection;
+
+    /*-------------.
+    | Construction |
+    `-------------*/
+    public:
+      /// Pool up to \a size connections opened by \a connect, serialized with
+      /// \a version and \a checksum.
+      StreamPool(Connect connect,
+                 std::size_t size,
+                 elle::Version const& version = elle::Version(0, 1, 0),
+                 bool checksum = true);
+      ~StreamPool();
+
+    /*---------.
+    | Channels |
+    `---------*/
+    public:
+      /// Open a channel on the least loaded healthy connection.
+      Channel
+      channel();
+      /// Number of pooled connections, including failed ones whose channels
+      /// are still open.
+      std::size_t
+      connections() const;
+      /// Maximum number of connections.
+      ELLE_ATTRIBUTE_R(std::size_t, size);
+      /// The version negotiated with the peer, or the local one until
+      /// connected.
+      ELLE_ATTRIBUTE_R(elle::Version, version);
+      /// Number of connections lost so far.
+      ELLE_ATTRIBUTE_R(std::size_t, failures);
+      /// Emitted when a channel is closed, lightening its connection.
+      ELLE_ATTRIBUTE_RX(boost::signals2::signal<void ()>, released);
+    private:
+      Connection*
+      _select() const;
+      Connection&
+      _open();
+      /// Drop failed connections no channel uses anymore.
+      void
+      _reap();
+      ELLE_ATTRIBUTE(Connect, connect);
+      ELLE_ATTRIBUTE(bool, checksum);
+      ELLE_ATTRIBUTE(std::list<std::unique_ptr<Connection>>, connections);
+      /// Number of connections being opened.
+      ELLE_ATTRIBUTE(std::size_t, connecting);
+      ELLE_ATTRIBUTE(reactor::Signal, connected);
+
+    /*----------.
+    | Printable |
+    `----------*/
+    public:
+      void
+      print(std::ostream& stream) const override;
+    };
+  }
+}
+
+#endif
@@ -0,0 +1,42 @@
+#include <protocol/binary.hh>
+
+namespace infinit
+{
+  namespace protocol
+  {
+    namespace binary
+    {
+      /*------.
+      | Input |
+      `------*/
+
+      Input::Input(std::istream& input)
+        : _serializer(input, false)
+      {}
+
+      Input&
+      Input::operator >>(char& value)
+      {
+        int8_t byte;
+        this->_serializer.serialize_forward(byte);
+        value = byte;
+        return *this;
+      }
+
+      /*-------.
+      | Output |
+      `-------*/
+
+      Output::Output(std::ostream& output)
+        : _serializer(output, false)
+      {}
+
+      Output&
+      Output::operator <<(char value)
+      {
+        this->_serializer.serialize_forward(int8_t(value));
+        return *this;
+      }
+    }
+  }
+}
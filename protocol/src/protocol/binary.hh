@@ -0,0 +1,53 @@
+#pragma once
+
+#include <iosfwd>
+
+#include <elle/serialization/binary.hh>
+
+namespace infinit
+{
+  namespace protocol
+  {
+    /// RPC archives over elle's binary serialization, for use as
+    /// RPC<binary::Input, binary::Output>.
+    namespace binary
+    {
+      /// Read the values of one RPC packet.
+      class ELLE_API Input
+      {
+      public:
+        Input(std::istream& input);
+        template <typename T>
+        Input&
+        operator >>(T& value)
+        {
+          this->_serializer.serialize_forward(value);
+          return *this;
+        }
+        /// Serialization has no plain characters, they travel as bytes.
+        Input&
+        operator >>(char& value);
+      private:
+        elle::serialization::binary::SerializerIn _serializer;
+      };
+
+      /// Write the values of one RPC packet.
+      class ELLE_API Output
+      {
+      public:
+        Output(std::ostream& output);
+        template <typename T>
+        Output&
+        operator <<(T const& value)
+        {
+          this->_serializer.serialize_forward(value);
+          return *this;
+        }
+        Output&
+        operator <<(char value);
+      private:
+        elle::serialization::binary::SerializerOut _serializer;
+      };
+    }
+  }
+}
@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+
+#include <elle/assert.hh>
+
+#include <protocol/checksum.hh>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+# define INFINIT_PROTOCOL_CRC32C_SSE42
+# include <nmmintrin.h>
+#endif
+
+namespace infinit
+{
+  namespace protocol
+  {
+    std::ostream&
+    operator <<(std::ostream& output, Checksum checksum)
+    {
+      switch (checksum)
+      {
+        case Checksum::sha1:
+          return output << "SHA-1";
+        case Checksum::crc32c:
+          return output << "CRC32C";
+        case Checksum::xxhash64:
+          return output << "xxHash64";
+      }
+      return output << "unknown checksum " << static_cast<int>(checksum);
+    }
+
+    /*-------.
+    | CRC32C |
+    `-------*/
+
+    namespace
+    {
+      // Slicing-by-8 tables for the reflected Castagnoli polynomial.
+      struct CRC32CTables
+      {
+        CRC32CTables()
+        {
+          for (uint32_t i = 0; i < 256; ++i)
+          {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+              crc = (crc >> 1) ^ (0x82f63b78 & (0 - (crc & 1)));
+            this->table[0][i] = crc;
+          }
+          for (uint32_t i = 0; i < 256; ++i)
+            for (int slice = 1; slice < 8; ++slice)
+            {
+              auto previous = this->table[slice - 1][i];
+              this->table[slice][i] =
+                (previous >> 8) ^ this->table[0][previous & 0xff];
+            }
+        }
+
+        uint32_t table[8][256];
+      };
+
+      uint32_t
+      crc32c_software(uint32_t crc, unsigned char const* data, std::size_t size)
+      {
+        static CRC32CTables const tables;
+        auto const& t = tables.table;
+        for (; size >= 8; data += 8, size -= 8)
+        {
+          crc ^= data[0] | data[1] << 8 | data[2] << 16 |
+            static_cast<uint32_t>(data[3]) << 24;
+          crc =
+            t[7][crc & 0xff] ^ t[6][(crc >> 8) & 0xff] ^
+            t[5][(crc >> 16) & 0xff] ^ t[4][crc >> 24] ^
+            t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+        }
+        for (; size > 0; ++data, --size)
+          crc = (crc >> 8) ^ t[0][(crc ^ *data) & 0xff];
+        return crc;
+      }
+
+#ifdef INFINIT_PROTOCOL_CRC32C_SSE42
+      __attribute__((target("sse4.2")))
+      uint32_t
+      crc32c_sse42(uint32_t crc, unsigned char const* data, std::size_t size)
+      {
+        for (; size > 0 && reinterpret_cast<uintptr_t>(data) % 8;
+             ++data, --size)
+          crc = _mm_crc32_u8(crc, *data);
+        uint64_t crc64 = crc;
+        for (; size >= 8; data += 8, size -= 8)
+        {
+          uint64_t word;
+          std::memcpy(&word, data, 8);
+          crc64 = _mm_crc32_u64(crc64, word);
+        }
+        crc = static_cast<uint32_t>(crc64);
+        for (; size > 0; ++data, --size)
+          crc = _mm_crc32_u8(crc, *data);
+        return crc;
+      }
+#endif
+    }
+
+    uint32_t
+    crc32c(uint32_t crc, void const* data, std::size_t size)
+    {
+      auto bytes = static_cast<unsigned char const*>(data);
+#ifdef INFINIT_PROTOCOL_CRC32C_SSE42
+      static bool const hardware = __builtin_cpu_supports("sse4.2");
+      if (hardware)
+        return ~crc32c_sse42(~crc, bytes, size);
+#endif
+      return ~crc32c_software(~crc, bytes, size);
+    }
+
+    /*---------.
+    | xxHash64 |
+    `---------*/
+
+    namespace
+    {
+      uint64_t const prime1 = 0x9e3779b185ebca87ULL;
+      uint64_t const prime2 = 0xc2b2ae3d27d4eb4fULL;
+      uint64_t const prime3 = 0x165667b19e3779f9ULL;
+      uint64_t const prime4 = 0x85ebca77c2b2ae63ULL;
+      uint64_t const prime5 = 0x27d4eb2f165667c5ULL;
+
+      uint64_t
+      rotate(uint64_t value, int bits)
+      {
+        return (value << bits) | (value >> (64 - bits));
+      }
+
+      uint64_t
+      read64(unsigned char const* data)
+      {
+        uint64_t res = 0;
+        for (int i = 7; i >= 0; --i)
+          res = res << 8 | data[i];
+        return res;
+      }
+
+      uint64_t
+      read32(unsigned char const* data)
+      {
+        return data[0] | data[1] << 8 | data[2] << 16 |
+          static_cast<uint64_t>(data[3]) << 24;
+      }
+
+      uint64_t
+      accumulate(uint64_t lane, uint64_t input)
+      {
+        return rotate(lane + input * prime2, 31) * prime1;
+      }
+
+      uint64_t
+      merge(uint64_t hash, uint64_t lane)
+      {
+        return (hash ^ accumulate(0, lane)) * prime1 + prime4;
+      }
+    }
+
+    /*-------.
+    | Hasher |
+    `-------*/
+
+    Hasher::Hasher(Checksum algorithm)
+      : _algorithm(algorithm)
+      , _crc(0)
+      , _total(0)
+      , _lanes{{prime1 + prime2, prime2, 0, 0 - prime1}}
+      , _pending()
+      , _pending_size(0)
+    {
+      ELLE_ASSERT_NEQ(algorithm, Checksum::sha1);
+    }
+
+    std::size_t
+    Hasher::size(Checksum algorithm)
+    {
+      switch (algorithm)
+      {
+        case Checksum::crc32c:
+          return 4;
+        case Checksum::xxhash64:
+          return 8;
+        default:
+          return 20;
+      }
+    }
+
+    void
+    Hasher::_stripe(unsigned char const* data)
+    {
+      for (int i = 0; i < 4; ++i)
+        this->_lanes[i] = accumulate(this->_lanes[i], read64(data + 8 * i));
+    }
+
+    void
+    Hasher::update(elle::ConstWeakBuffer data)
+    {
+      auto bytes = data.contents();
+      auto size = data.size();
+      if (this->_algorithm == Checksum::crc32c)
+      {
+        this->_crc = crc32c(this->_crc, bytes, size);
+        return;
+      }
+      this->_total += size;
+      if (this->_pending_size > 0)
+      {
+        auto fill = std::min(size, 32 - this->_pending_size);
+        std::memcpy(this->_pending.data() + this->_pending_size, bytes, fill);
+        this->_pending_size += fill;
+        bytes += fill;
+        size -= fill;
+        if (this->_pending_size < 32)
+          return;
+        this->_stripe(this->_pending.data());
+        this->_pending_size = 0;
+      }
+      for (; size >= 32; bytes += 32, size -= 32)
+        this->_stripe(bytes);
+      std::memcpy(this->_pending.data(), bytes, size);
+      this->_pending_size = size;
+    }
+
+    elle::Buffer
+    Hasher::digest() const
+    {
+      uint64_t hash;
+      std::size_t size;
+      if (this->_algorithm == Checksum::crc32c)
+      {
+        hash = this->_crc;
+        size = 4;
+      }
+      else
+      {
+        auto const& lanes = this->_lanes;
+        if (this->_total >= 32)
+        {
+          hash = rotate(lanes[0], 1) + rotate(lanes[1], 7) +
+            rotate(lanes[2], 12) + rotate(lanes[3], 18);
+          for (auto lane: lanes)
+            hash = merge(hash, lane);
+        }
+        else
+          hash = prime5;
+        hash += this->_total;
+        auto data = this->_pending.data();
+        auto remaining = this->_pending_size;
+        for (; remaining >= 8; data += 8, remaining -= 8)
+          hash =
+            rotate(hash ^ accumulate(0, read64(data)), 27) * prime1 + prime4;
+        if (remaining >= 4)
+        {
+          hash = rotate(hash ^ read32(data) * prime1, 23) * prime2 + prime3;
+          data += 4;
+          remaining -= 4;
+        }
+        for (; remaining > 0; ++data, --remaining)
+          hash = rotate(hash ^ *data * prime5, 11) * prime1;
+        hash ^= hash >> 33;
+        hash *= prime2;
+        hash ^= hash >> 29;
+        hash *= prime3;
+        hash ^= hash >> 32;
+        size = 8;
+      }
+      elle::Buffer res(size);
+      for (std::size_t i = 0; i < size; ++i)
+        res[i] = (hash >> (8 * (size - 1 - i))) & 0xff;
+      return res;
+    }
+  }
+}
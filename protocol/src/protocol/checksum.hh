@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+
+#include <elle/Buffer.hh>
+#include <elle/attribute.hh>
+#include <elle/compiler.hh>
+
+namespace infinit
+{
+  namespace protocol
+  {
+    /// Packet checksum algorithms, from the most to the least conservative.
+    enum class Checksum: uint8_t
+    {
+      /// SHA-1 digest sent ahead of the packet, for legacy peers.
+      sha1 = 0,
+      /// CRC32C (Castagnoli), using SSE4.2 when the CPU has it.
+      crc32c = 1,
+      /// 64-bit xxHash.
+      xxhash64 = 2,
+    };
+
+    ELLE_API
+    std::ostream&
+    operator <<(std::ostream& output, Checksum checksum);
+
+    /// CRC32C of \a size bytes at \a data, continuing from \a crc.
+    ELLE_API
+    uint32_t
+    crc32c(uint32_t crc, void const* data, std::size_t size);
+
+    /// Running CRC32C or xxHash64 digest, fed piecewise as data is
+    /// transmitted.
+    class ELLE_API Hasher
+    {
+    public:
+      Hasher(Checksum algorithm);
+      /// Hash \a data after what was fed so far.
+      void
+      update(elle::ConstWeakBuffer data);
+      /// The digest of the data fed so far, in network byte order.
+      elle::Buffer
+      digest() const;
+      /// The size of digests of \a algorithm.
+      static
+      std::size_t
+      size(Checksum algorithm);
+      ELLE_ATTRIBUTE_R(Checksum, algorithm);
+    private:
+      void
+      _stripe(unsigned char const* data);
+      ELLE_ATTRIBUTE(uint32_t, crc);
+      ELLE_ATTRIBUTE(uint64_t, total);
+      ELLE_ATTRIBUTE((std::array<uint64_t, 4>), lanes);
+      ELLE_ATTRIBUTE((std::array<unsigned char, 32>), pending);
+      ELLE_ATTRIBUTE(std::size_t, pending_size);
+    };
+  }
+}
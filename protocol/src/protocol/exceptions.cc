@@ -16,8 +16,9 @@ namespace infinit
       Super("peer has interrupted sending")
     {}
 
-    RPCError::RPCError(std::string const& message):
-      Super(message)
+    RPCError::RPCError(std::string const& message, RPCErrorCode code):
+      Super(message),
+      _code(code)
     {}
   }
 }
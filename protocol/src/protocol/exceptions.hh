@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstdint>
+
 #include <elle/Exception.hh>
+#include <elle/attribute.hh>
 
 namespace infinit
 {
@@ -33,13 +36,28 @@ namespace infinit
       InterruptionError();
     };
 
+    /// Kinds of RPC failures, sent along error replies.
+    enum class RPCErrorCode: uint8_t
+    {
+      /// The remote procedure threw.
+      remote = 0,
+      /// The procedure is unknown or not implemented by the peer.
+      unknown_procedure = 1,
+      /// The peer is overloaded.
+      busy = 2,
+      /// The call deadline passed.
+      timeout = 3,
+    };
+
     /// A remote RPC could not be called.
     class RPCError:
       public Error
     {
     public:
       typedef Error Super;
-      RPCError(std::string const& message);
+      RPCError(std::string const& message,
+               RPCErrorCode code = RPCErrorCode::remote);
+      ELLE_ATTRIBUTE_R(RPCErrorCode, code);
     };
   }
 }
@@ -7,11 +7,14 @@ namespace infinit
   {
     class Channel;
     class ChanneledStream;
+    template <typename T>
+    class Future;
     class BaseRPC;
     template <typename ISerializer, typename OSerializer>
     class RPC;
     class Serializer;
     class Stream;
+    class StreamPool;
   }
 }
 
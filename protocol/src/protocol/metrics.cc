@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <protocol/metrics.hh>
+
+namespace infinit
+{
+  namespace protocol
+  {
+    /*----------.
+    | Histogram |
+    `----------*/
+
+    Histogram::Histogram()
+      : _count(0)
+      , _min(std::numeric_limits<uint64_t>::max())
+      , _max(0)
+      , _sum(0)
+      , _buckets()
+    {}
+
+    std::size_t
+    Histogram::_bucket(uint64_t value)
+    {
+      if (value < sub_buckets)
+        return value;
+      // Position of the leading bit, at least 4, and the 4 bits after it.
+      int const exponent = 63 - __builtin_clzll(value);
+      auto const mantissa = (value >> (exponent - 4)) & (sub_buckets - 1);
+      return sub_buckets * (exponent - 3) + mantissa;
+    }
+
+    uint64_t
+    Histogram::_highest(std::size_t bucket)
+    {
+      if (bucket < sub_buckets)
+        return bucket;
+      int const shift = bucket / sub_buckets - 1;
+      uint64_t const mantissa = bucket % sub_buckets;
+      return ((sub_buckets + mantissa) << shift) + ((uint64_t(1) << shift) - 1);
+    }
+
+    void
+    Histogram::record(uint64_t value)
+    {
+      ++this->_buckets[_bucket(value)];
+      ++this->_count;
+      this->_min = std::min(this->_min, value);
+      this->_max = std::max(this->_max, value);
+      this->_sum += value;
+    }
+
+    uint64_t
+    Histogram::percentile(double ratio) const
+    {
+      if (this->_count == 0)
+        return 0;
+      auto const rank = std::max<uint64_t>(
+        1, std::min<uint64_t>(std::ceil(ratio * this->_count), this->_count));
+      uint64_t seen = 0;
+      for (std::size_t bucket = 0; bucket < this->_buckets.size(); ++bucket)
+      {
+        seen += this->_buckets[bucket];
+        if (seen >= rank)
+          return std::max(this->_min, std::min(_highest(bucket), this->_max));
+      }
+      return this->_max;
+    }
+
+    double
+    Histogram::mean() const
+    {
+      return this->_count ? this->_sum / this->_count : 0;
+    }
+
+    /*------------.
+    | CallMetrics |
+    `------------*/
+
+    CallMetrics::CallMetrics()
+      : calls(0)
+      , errors(0)
+      , bytes_in(0)
+      , bytes_out(0)
+      , latency()
+    {}
+
+    void
+    CallMetrics::record(Clock::duration duration, bool succeeded)
+    {
+      ++this->calls;
+      if (!succeeded)
+        ++this->errors;
+      this->latency.record(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+          duration).count());
+    }
+
+    /*------------.
+    | CallMeasure |
+    `------------*/
+
+    CallMeasure::CallMeasure(CallMetrics& metrics, Clock::time_point start)
+      : _metrics(metrics)
+      , _start(start)
+      , _succeeded(false)
+    {}
+
+    CallMeasure::~CallMeasure()
+    {
+      this->_metrics.record(Clock::now() - this->_start, this->_succeeded);
+    }
+  }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <elle/attribute.hh>
+#include <elle/compiler.hh>
+
+namespace infinit
+{
+  namespace protocol
+  {
+    /// Distribution of values recorded in log-linear buckets: values under 16
+    /// are exact, larger ones fall in one of 16 buckets per power of two,
+    /// hence within 6.25% of their actual value.
+    class ELLE_API Histogram
+    {
+    public:
+      Histogram();
+      void
+      record(uint64_t value);
+      /// The smallest value greater than \a ratio of recorded ones, \a ratio
+      /// ranging from 0 to 1, or 0 if none were recorded.
+      uint64_t
+      percentile(double ratio) const;
+      /// The average recorded value, or 0 if none were recorded.
+      double
+      mean() const;
+      ELLE_ATTRIBUTE_R(uint64_t, count);
+      ELLE_ATTRIBUTE_R(uint64_t, min);
+      ELLE_ATTRIBUTE_R(uint64_t, max);
+    private:
+      static std::size_t constexpr sub_buckets = 16;
+      static
+      std::size_t
+      _bucket(uint64_t value);
+      /// The highest value falling in \a bucket.
+      static
+      uint64_t
+      _highest(std::size_t bucket);
+      ELLE_ATTRIBUTE(double, sum);
+      ELLE_ATTRIBUTE((std::array<uint64_t, sub_buckets * 61>), buckets);
+    };
+
+    /// Calls of a procedure on one side of an RPC.
+    struct ELLE_API CallMetrics
+    {
+      using Clock = std::chrono::steady_clock;
+      CallMetrics();
+      /// Account for a call that lasted \a duration.
+      void
+      record(Clock::duration duration, bool succeeded);
+      uint64_t calls;
+      /// Calls that failed, timed out or were abandoned.
+      uint64_t errors;
+      /// Bytes received, respectively sent, for these calls.
+      uint64_t bytes_in;
+      uint64_t bytes_out;
+      /// Call durations in microseconds, from the question to the answer.
+      Histogram latency;
+    };
+
+    /// Calls of a procedure made, respectively served, by an RPC.
+    struct ELLE_API ProcedureMetrics
+    {
+      CallMetrics caller;
+      CallMetrics server;
+    };
+
+    /// Account for a call in \a metrics when destroyed: its duration since
+    /// construction and, unless marked as succeeded, its failure.
+    class ELLE_API CallMeasure
+    {
+    public:
+      using Clock = CallMetrics::Clock;
+      CallMeasure(CallMetrics& metrics,
+                  Clock::time_point start = Clock::now());
+      CallMeasure(CallMeasure const&) = delete;
+      ~CallMeasure();
+      /// Run \a action, marking the call as succeeded unless it throws.
+      template <typename Action>
+      auto
+      succeed(Action const& action) -> decltype(action())
+      {
+        this->_succeeded = true;
+        try
+        {
+          return action();
+        }
+        catch (...)
+        {
+          this->_succeeded = false;
+          throw;
+        }
+      }
+      ELLE_ATTRIBUTE_X(CallMetrics&, metrics);
+      ELLE_ATTRIBUTE(Clock::time_point, start);
+      ELLE_ATTRIBUTE_RW(bool, succeeded);
+    };
+  }
+}
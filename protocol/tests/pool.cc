@@ -0,0 +1,276 @@
+#include <elle/With.hh>
+#include <elle/test.hh>
+
+#include <protocol/ChanneledStream.hh>
+#include <protocol/Channel.hh>
+#include <protocol/RPC.hh>
+#include <protocol/binary.hh>
+#include <protocol/Serializer.hh>
+#include <protocol/StreamPool.hh>
+
+#include <reactor/Barrier.hh>
+#include <reactor/Scope.hh>
+#include <reactor/network/exception.hh>
+#include <reactor/network/tcp-server.hh>
+#include <reactor/network/tcp-socket.hh>
+#include <reactor/scheduler.hh>
+
+ELLE_LOG_COMPONENT("infinit.protocol.test");
+
+static elle::Version const version(0, 4, 0);
+
+// Accept connections and serve the channels of each one.
+class Server
+{
+public:
+  using Serve = std::function<void (infinit::protocol::ChanneledStream&)>;
+
+  Server(std::string const& name, Serve serve)
+    : _server()
+    , _sockets()
+    , _serve(std::move(serve))
+    , _thread(name, [this] { this->_run(); })
+  {
+    this->_server.listen();
+  }
+
+  ~Server()
+  {
+    this->stop();
+  }
+
+  int
+  port() const
+  {
+    return this->_server.port();
+  }
+
+  /// Drop the \a i-th accepted connection.
+  void
+  drop(int i)
+  {
+    this->_sockets.at(i)->close();
+  }
+
+  /// Stop serving. Derived servers must do so upon destruction, before the
+  /// members their connections use are destroyed.
+  void
+  stop()
+  {
+    this->_thread.terminate_now();
+  }
+
+private:
+  void
+  _run()
+  {
+    elle::With<reactor::Scope>() << [&] (reactor::Scope& scope)
+    {
+      while (true)
+      {
+        std::shared_ptr<reactor::network::TCPSocket> socket(
+          this->_server.accept());
+        this->_sockets.push_back(socket);
+        scope.run_background(
+          "connection",
+          [this, socket]
+          {
+            try
+            {
+              infinit::protocol::Serializer s(*socket, version);
+              infinit::protocol::ChanneledStream channels(s);
+              this->_serve(channels);
+            }
+            catch (elle::Error const&)
+            {}
+          });
+      }
+    };
+  }
+
+  ELLE_ATTRIBUTE(reactor::network::TCPServer, server);
+  ELLE_ATTRIBUTE(
+    std::vector<std::shared_ptr<reactor::network::TCPSocket>>, sockets);
+  ELLE_ATTRIBUTE(Serve, serve);
+  ELLE_ATTRIBUTE(reactor::Thread, thread);
+};
+
+// Echo packets on every channel of every connection.
+class EchoServer
+  : public Server
+{
+public:
+  EchoServer()
+    : Server(
+      "echo server",
+      [] (infinit::protocol::ChanneledStream& channels)
+      {
+        elle::With<reactor::Scope>() << [&] (reactor::Scope& echoes)
+        {
+          while (true)
+          {
+            auto c = std::make_shared<infinit::protocol::Channel>(
+              channels.accept());
+            echoes.run_background("echo", [c] { c->write(c->read()); });
+          }
+        };
+      })
+  {}
+};
+
+struct PoolRPC:
+  public infinit::protocol::RPC<infinit::protocol::binary::Input,
+                                infinit::protocol::binary::Output>
+{
+  template <typename Backend>
+  PoolRPC(Backend& backend)
+    : infinit::protocol::RPC<infinit::protocol::binary::Input,
+                             infinit::protocol::binary::Output>(backend)
+    , answer("answer", *this)
+    , wait("wait", *this)
+  {}
+
+  RemoteProcedure<int> answer;
+  RemoteProcedure<int> wait;
+};
+
+// Serve RPCs on every connection.
+class RPCServer
+  : public Server
+{
+public:
+  RPCServer()
+    : Server(
+      "rpc server",
+      [this] (infinit::protocol::ChanneledStream& channels)
+      {
+        PoolRPC rpc(channels);
+        rpc.answer = [] { return 42; };
+        rpc.wait = [this] { reactor::wait(this->_barrier); return 51; };
+        rpc.parallel_run();
+      })
+    , _barrier()
+  {}
+
+  ~RPCServer()
+  {
+    this->stop();
+  }
+
+  ELLE_ATTRIBUTE_RX(reactor::Barrier, barrier);
+};
+
+ELLE_TEST_SCHEDULED(striping)
+{
+  EchoServer server;
+  infinit::protocol::StreamPool pool(
+    [&]
+    {
+      return std::unique_ptr<std::iostream>(
+        new reactor::network::TCPSocket("127.0.0.1", server.port()));
+    },
+    2, version);
+  BOOST_CHECK_EQUAL(pool.connections(), 0u);
+  {
+    auto c = pool.channel();
+    c.write(elle::Buffer("ping"));
+    BOOST_CHECK_EQUAL(c.read(), elle::Buffer("ping"));
+  }
+  BOOST_CHECK_EQUAL(pool.connections(), 1u);
+  BOOST_CHECK_EQUAL(pool.version(), version);
+  // A channel opened during a large transfer uses another connection.
+  elle::Buffer large(std::string(16 * (1 << 20), 'l'));
+  auto big = pool.channel();
+  elle::With<reactor::Scope>() << [&] (reactor::Scope& scope)
+  {
+    reactor::Barrier sending;
+    scope.run_background(
+      "large",
+      [&]
+      {
+        sending.open();
+        big.write(large);
+        BOOST_CHECK_EQUAL(big.read(), large);
+      });
+    reactor::wait(sending);
+    reactor::yield();
+    auto small = pool.channel();
+    BOOST_CHECK_EQUAL(pool.connections(), 2u);
+    small.write(elle::Buffer("small"));
+    BOOST_CHECK_EQUAL(small.read(), elle::Buffer("small"));
+    reactor::wait(scope);
+  };
+  // No more connections than the pool size.
+  {
+    auto a = pool.channel();
+    auto b = pool.channel();
+    auto c = pool.channel();
+    BOOST_CHECK_EQUAL(pool.connections(), 2u);
+  }
+}
+
+ELLE_TEST_SCHEDULED(reconnection)
+{
+  EchoServer server;
+  infinit::protocol::StreamPool pool(
+    [&]
+    {
+      return std::unique_ptr<std::iostream>(
+        new reactor::network::TCPSocket("127.0.0.1", server.port()));
+    },
+    1, version);
+  {
+    auto c = pool.channel();
+    c.write(elle::Buffer("ping"));
+    BOOST_CHECK_EQUAL(c.read(), elle::Buffer("ping"));
+    server.drop(0);
+    BOOST_CHECK_THROW(c.read(), elle::Error);
+    BOOST_CHECK_EQUAL(pool.failures(), 1u);
+  }
+  // The failed connection is replaced once its channels are closed.
+  auto c = pool.channel();
+  c.write(elle::Buffer("pong"));
+  BOOST_CHECK_EQUAL(c.read(), elle::Buffer("pong"));
+  BOOST_CHECK_EQUAL(pool.connections(), 1u);
+}
+
+ELLE_TEST_SCHEDULED(async)
+{
+  RPCServer server;
+  infinit::protocol::StreamPool pool(
+    [&]
+    {
+      return std::unique_ptr<std::iostream>(
+        new reactor::network::TCPSocket("127.0.0.1", server.port()));
+    },
+    2, version);
+  PoolRPC rpc(pool);
+  // The pending call keeps the first connection busy, the next one opens
+  // another connection.
+  auto blocked = rpc.wait.async_call();
+  reactor::Barrier released;
+  boost::signals2::scoped_connection release =
+    pool.released().connect([&] { released.open(); });
+  auto answer = rpc.answer.async_call();
+  BOOST_CHECK_EQUAL(pool.connections(), 2u);
+  // Replies on the second connection are not held behind the first one.
+  BOOST_CHECK_EQUAL(answer.get(), 42);
+  BOOST_CHECK(!blocked.ready());
+  // Wait for the answered call to release its channel.
+  reactor::wait(released);
+  // Losing the first connection only fails the calls pending on it.
+  auto waiting = rpc.wait.async_call();
+  server.drop(0);
+  BOOST_CHECK_THROW(blocked.get(), elle::Error);
+  BOOST_CHECK(!waiting.ready());
+  server.barrier().open();
+  BOOST_CHECK_EQUAL(waiting.get(), 51);
+}
+
+ELLE_TEST_SUITE()
+{
+  auto& suite = boost::unit_test::framework::master_test_suite();
+  suite.add(BOOST_TEST_CASE(striping), 0, valgrind(10, 10));
+  suite.add(BOOST_TEST_CASE(reconnection), 0, valgrind(3, 10));
+  suite.add(BOOST_TEST_CASE(async), 0, valgrind(3, 10));
+}
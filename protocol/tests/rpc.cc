@@ -1,8 +1,13 @@
 #include <protocol/ChanneledStream.hh>
 #include <protocol/RPC.hh>
 #include <protocol/Serializer.hh>
+#include <protocol/binary.hh>
 
+#include <reactor/Generator.hh>
+#include <reactor/Scope.hh>
 #include <reactor/asio.hh>
+#include <reactor/http/Request.hh>
+#include <reactor/network/http-server.hh>
 #include <reactor/network/exception.hh>
 #include <reactor/network/tcp-server.hh>
 #include <reactor/network/tcp-socket.hh>
@@ -11,6 +16,7 @@
 #include <reactor/semaphore.hh>
 #include <reactor/thread.hh>
 
+#include <elle/json/json.hh>
 #include <elle/test.hh>
 
 ELLE_LOG_COMPONENT("infinit.protocol.test");
@@ -26,12 +32,12 @@ static
 reactor::Thread* suicide_thread(nullptr);
 
 struct DummyRPC:
-  public infinit::protocol::RPC<elle::serialize::InputBinaryArchive,
-                                elle::serialize::OutputBinaryArchive>
+  public infinit::protocol::RPC<infinit::protocol::binary::Input,
+                                infinit::protocol::binary::Output>
 {
   DummyRPC(infinit::protocol::ChanneledStream& channels)
-    : infinit::protocol::RPC<elle::serialize::InputBinaryArchive,
-                             elle::serialize::OutputBinaryArchive>(channels)
+    : infinit::protocol::RPC<infinit::protocol::binary::Input,
+                             infinit::protocol::binary::Output>(channels)
     , answer("answer", *this)
     , square("square", *this)
     , concat("concat", *this)
@@ -39,8 +45,19 @@ struct DummyRPC:
     , suicide("suicide", *this)
     , count("count", *this)
     , wait("wait", *this)
+    , range("range", *this)
+    , blob("blob", *this)
   {}
 
+  uint32_t
+  procedure_id(std::string const& name) const
+  {
+    for (auto const& procedure: this->_procedures)
+      if (procedure.second.first == name)
+        return procedure.first;
+    throw elle::Error(elle::sprintf("no such procedure: %s", name));
+  }
+
   RemoteProcedure<int> answer;
   RemoteProcedure<int, int> square;
   RemoteProcedure<std::string, std::string const&, std::string const&> concat;
@@ -48,13 +65,17 @@ struct DummyRPC:
   RemoteProcedure<void> suicide;
   RemoteProcedure<int> count;
   RemoteProcedure<void> wait;
+  RemoteProcedure<reactor::Generator<int>, int> range;
+  RemoteProcedure<std::string, int> blob;
 };
 
 class RPCServer
 {
 public:
-  RPCServer(TestConfig config)
+  RPCServer(TestConfig config,
+            std::function<void (DummyRPC&)> setup = {})
     : _config(config)
+    , _setup(std::move(setup))
     , _counter(0)
     , _server()
     , _thread(elle::sprintf("%s runner", *this), [this] { this->_run(); })
@@ -85,7 +106,7 @@ public:
     auto& sched = *reactor::Scheduler::scheduler();
     auto socket = this->_server.accept();
     infinit::protocol::Serializer s(sched, *socket, _config.version, _config.checksum);
-    infinit::protocol::ChanneledStream channels(sched, s, _config.version);
+    infinit::protocol::ChanneledStream channels(sched, s);
 
     DummyRPC rpc(channels);
     rpc.answer = [] { return 42; };
@@ -113,6 +134,24 @@ public:
         return this->_counter;
       };
     rpc.wait = [this] { ++this->_counter; reactor::sleep(); };
+    rpc.range = [this] (int n)
+      {
+        if (n < 0)
+          throw std::runtime_error("negative range");
+        return reactor::Generator<int>(
+          [this, n] (reactor::yielder<int>::type const& yield)
+          {
+            for (int i = 0; i < n; ++i)
+            {
+              ++this->_counter;
+              yield(i);
+            }
+          },
+          1);
+      };
+    rpc.blob = [] (int size) { return std::string(size, 'x'); };
+    if (this->_setup)
+      this->_setup(rpc);
     try
     {
       if (this->_config.sync)
@@ -125,12 +164,99 @@ public:
   }
 
   ELLE_ATTRIBUTE_R(TestConfig, config);
+  ELLE_ATTRIBUTE(std::function<void (DummyRPC&)>, setup);
   ELLE_ATTRIBUTE_R(int, counter);
   ELLE_ATTRIBUTE_RX(reactor::Barrier, count_barrier)
   ELLE_ATTRIBUTE(reactor::network::TCPServer, server);
   ELLE_ATTRIBUTE(reactor::Thread, thread);
 };
 
+/// Forward a connection to a server, optionally holding an answer after
+/// its first bytes.
+class Proxy
+{
+public:
+  Proxy(int port)
+    : _port(port)
+    , _hold(false)
+    , _held()
+    , _release()
+    , _server()
+    , _thread("proxy", [this] { this->_run(); })
+  {
+    this->_server.listen();
+  }
+
+  ~Proxy()
+  {
+    this->_thread.terminate_now();
+  }
+
+  int
+  port() const
+  {
+    return this->_server.port();
+  }
+
+  /// Hold the next data from the server, until released, once its first
+  /// bytes are forwarded.
+  void
+  hold()
+  {
+    this->_hold = true;
+  }
+
+  void
+  _run()
+  {
+    auto client = this->_server.accept();
+    reactor::network::TCPSocket server("127.0.0.1", this->_port);
+    try
+    {
+      elle::With<reactor::Scope>() << [&] (reactor::Scope& scope)
+      {
+        scope.run_background(
+          "questions", [&] { this->_forward(*client, server, false); });
+        scope.run_background(
+          "answers", [&] { this->_forward(server, *client, true); });
+        reactor::wait(scope);
+      };
+    }
+    catch (reactor::network::ConnectionClosed const&)
+    {}
+  }
+
+  void
+  _forward(reactor::network::Socket& from,
+           reactor::network::Socket& to,
+           bool answers)
+  {
+    char buffer[4096];
+    while (true)
+    {
+      std::size_t size =
+        from.read_some(elle::WeakBuffer(buffer, sizeof buffer));
+      std::size_t offset = 0;
+      if (answers && this->_hold)
+      {
+        this->_hold = false;
+        offset = std::min(size, std::size_t(16));
+        to.write(elle::ConstWeakBuffer(buffer, offset));
+        this->_held.open();
+        reactor::wait(this->_release);
+      }
+      to.write(elle::ConstWeakBuffer(buffer + offset, size - offset));
+    }
+  }
+
+  ELLE_ATTRIBUTE(int, port);
+  ELLE_ATTRIBUTE(bool, hold);
+  ELLE_ATTRIBUTE_RX(reactor::Barrier, held);
+  ELLE_ATTRIBUTE_RX(reactor::Barrier, release);
+  ELLE_ATTRIBUTE(reactor::network::TCPServer, server);
+  ELLE_ATTRIBUTE(reactor::Thread, thread);
+};
+
 /*------.
 | Basic |
 `------*/
@@ -140,7 +266,7 @@ ELLE_TEST_SCHEDULED(rpc, (TestConfig, config))
   RPCServer server(config);
   reactor::network::TCPSocket socket("127.0.0.1", server.port());
   infinit::protocol::Serializer s(socket, config.version, config.checksum);
-  infinit::protocol::ChanneledStream channels(s, config.version);
+  infinit::protocol::ChanneledStream channels(s);
   DummyRPC rpc(channels);
   BOOST_CHECK_EQUAL(rpc.answer(), 42);
   BOOST_CHECK_EQUAL(rpc.square(8), 64);
@@ -161,7 +287,7 @@ ELLE_TEST_SCHEDULED(terminate, (TestConfig, config))
     {
       reactor::network::TCPSocket socket("127.0.0.1", server.port());
       infinit::protocol::Serializer s(socket, config.version, config.checksum);
-      infinit::protocol::ChanneledStream channels(s, config.version);
+      infinit::protocol::ChanneledStream channels(s);
       DummyRPC rpc(channels);
       suicide_thread = &thread;
       BOOST_CHECK_THROW(rpc.suicide(), std::runtime_error);
@@ -178,7 +304,7 @@ ELLE_TEST_SCHEDULED(parallel, (TestConfig, config))
   RPCServer server(config);
   reactor::network::TCPSocket socket("127.0.0.1", server.port());
   infinit::protocol::Serializer s(socket, config.version, config.checksum);
-  infinit::protocol::ChanneledStream channels(s, config.version);
+  infinit::protocol::ChanneledStream channels(s);
   DummyRPC rpc(channels);
   std::vector<reactor::Thread*> threads;
   std::list<int> inserted;
@@ -211,6 +337,488 @@ ELLE_TEST_SCHEDULED(parallel, (TestConfig, config))
   BOOST_CHECK(inserted.empty());
 }
 
+/*-------------.
+| Asynchronous |
+`-------------*/
+
+ELLE_TEST_SCHEDULED(async, (TestConfig, config))
+{
+  RPCServer server(config);
+  reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  infinit::protocol::Serializer s(socket, config.version, config.checksum);
+  infinit::protocol::ChanneledStream channels(s);
+  DummyRPC rpc(channels);
+  {
+    std::vector<infinit::protocol::Future<int>> squares;
+    for (int i = 0; i < 64; ++i)
+      squares.push_back(rpc.square.async_call(i));
+    BOOST_CHECK(infinit::protocol::when_all(squares));
+    for (int i = 0; i < 64; ++i)
+    {
+      BOOST_CHECK(squares[i].ready());
+      BOOST_CHECK_EQUAL(squares[i].get(), i * i);
+    }
+  }
+  {
+    auto concat = rpc.concat.async_call("foo", "bar");
+    auto raise = rpc.raise.async_call();
+    BOOST_CHECK_THROW(raise.get(), std::runtime_error);
+    BOOST_CHECK_EQUAL(concat.get(), "foobar");
+  }
+  {
+    auto count = rpc.count.async_call();
+    BOOST_CHECK(!count.wait(boost::posix_time::milliseconds(10)));
+    if (!config.sync)
+    {
+      std::vector<infinit::protocol::Future<int>> futures{
+        count, rpc.answer.async_call()};
+      auto any = infinit::protocol::when_any(futures);
+      BOOST_CHECK(any);
+      BOOST_CHECK_EQUAL(*any, 1u);
+    }
+    BOOST_CHECK(!infinit::protocol::when_any(
+                  std::vector<infinit::protocol::Future<int>>{count},
+                  boost::posix_time::milliseconds(10)));
+    server.count_barrier().open();
+    BOOST_CHECK_EQUAL(count.get(), 1);
+  }
+}
+
+/*-----------.
+| Streaming |
+`-----------*/
+
+ELLE_TEST_SCHEDULED(stream, (TestConfig, config))
+{
+  if (config.version < elle::Version(0, 4, 0))
+    return;
+  RPCServer server(config);
+  reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  infinit::protocol::Serializer s(socket, config.version, config.checksum);
+  infinit::protocol::ChanneledStream channels(s);
+  DummyRPC rpc(channels);
+  rpc.stream_window(4);
+  {
+    int expected = 0;
+    for (auto i: rpc.range(100))
+      BOOST_CHECK_EQUAL(i, expected++);
+    BOOST_CHECK_EQUAL(expected, 100);
+  }
+  {
+    auto items = rpc.range(1000);
+    auto it = items.begin();
+    BOOST_CHECK(it != items.end());
+    BOOST_CHECK_EQUAL(*it, 0);
+    for (int i = 0; i < 20; ++i)
+      reactor::yield();
+    // The server does not run ahead of the granted credit.
+    BOOST_CHECK_LT(server.counter(), 100 + 10);
+  }
+  BOOST_CHECK_THROW(
+    {
+      for (auto i: rpc.range(-1))
+        BOOST_FAIL(elle::sprintf("unexpected item: %s", i));
+    },
+    infinit::protocol::RPCError);
+  BOOST_CHECK_EQUAL(rpc.answer(), 42);
+}
+
+// Control packets the server cannot read are skipped, the stream carries on.
+ELLE_TEST_SCHEDULED(stream_malformed_control, (TestConfig, config))
+{
+  if (config.version < elle::Version(0, 4, 0))
+    return;
+  RPCServer server(config);
+  reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  infinit::protocol::Serializer s(socket, config.version, config.checksum);
+  infinit::protocol::ChanneledStream channels(s);
+  DummyRPC rpc(channels);
+  // Stream by hand, to interleave garbage with the credit.
+  infinit::protocol::Channel channel(channels);
+  auto send = [&] (std::function<void (infinit::protocol::binary::Output&)> f)
+  {
+    elle::Buffer packet;
+    {
+      elle::IOStream outs(packet.ostreambuf());
+      infinit::protocol::binary::Output output(outs);
+      f(output);
+    }
+    channel.write(packet);
+  };
+  send([&] (infinit::protocol::binary::Output& output)
+       {
+         output << rpc.procedure_id("range");
+         output << int64_t(-1);
+         output << false;
+         // Window.
+         output << uint32_t(1);
+         output << 3;
+       });
+  for (int i = 0; i <= 3; ++i)
+  {
+    auto packet = channel.read();
+    elle::IOStream ins(packet.istreambuf());
+    infinit::protocol::binary::Input input(ins);
+    bool ok;
+    input >> ok;
+    BOOST_CHECK(ok);
+    bool more;
+    input >> more;
+    BOOST_CHECK_EQUAL(more, i < 3);
+    if (!more)
+      break;
+    int item;
+    input >> item;
+    BOOST_CHECK_EQUAL(item, i);
+    if (i == 0)
+      channel.write(elle::Buffer("garbage", 7));
+    send([] (infinit::protocol::binary::Output& output)
+         {
+           output << uint32_t(1);
+         });
+  }
+  BOOST_CHECK_EQUAL(server.counter(), 3);
+  BOOST_CHECK_EQUAL(rpc.answer(), 42);
+}
+
+/*--------.
+| Errors |
+`--------*/
+
+ELLE_TEST_SCHEDULED(errors, (TestConfig, config))
+{
+  using infinit::protocol::RPCError;
+  using infinit::protocol::RPCErrorCode;
+  RPCServer server(config);
+  reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  infinit::protocol::Serializer s(socket, config.version, config.checksum);
+  infinit::protocol::ChanneledStream channels(s);
+  DummyRPC rpc(channels);
+  DummyRPC::RemoteProcedure<int> missing("missing", rpc);
+  bool control = config.version >= elle::Version(0, 4, 0);
+  try
+  {
+    rpc.raise();
+    BOOST_FAIL("remote procedure should have thrown");
+  }
+  catch (RPCError const& e)
+  {
+    BOOST_CHECK(e.code() == RPCErrorCode::remote);
+  }
+  try
+  {
+    missing();
+    BOOST_FAIL("unknown procedure should have thrown");
+  }
+  catch (RPCError const& e)
+  {
+    BOOST_CHECK(e.code() == (control ? RPCErrorCode::unknown_procedure
+                                     : RPCErrorCode::remote));
+  }
+  // The connection survives errors.
+  BOOST_CHECK_EQUAL(rpc.answer(), 42);
+}
+
+/*------------------.
+| Admission control |
+`------------------*/
+
+ELLE_TEST_SCHEDULED(admission, (TestConfig, config))
+{
+  if (config.sync)
+    return;
+  DummyRPC* served = nullptr;
+  RPCServer server(
+    config,
+    [&] (DummyRPC& rpc)
+    {
+      rpc.count.limit(1);
+      rpc.queue_size(1);
+      served = &rpc;
+    });
+  reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  infinit::protocol::Serializer s(socket, config.version, config.checksum);
+  infinit::protocol::ChanneledStream channels(s);
+  DummyRPC rpc(channels);
+  auto first = rpc.count.async_call();
+  auto second = rpc.count.async_call();
+  auto third = rpc.count.async_call();
+  try
+  {
+    third.get();
+    BOOST_FAIL("call should have been rejected");
+  }
+  catch (infinit::protocol::RPCError const& e)
+  {
+    if (config.version >= elle::Version(0, 4, 0))
+      BOOST_CHECK(e.code() == infinit::protocol::RPCErrorCode::busy);
+  }
+  // Other procedures are not limited.
+  BOOST_CHECK_EQUAL(rpc.answer(), 42);
+  BOOST_CHECK_EQUAL(server.counter(), 1);
+  BOOST_CHECK_EQUAL(served->statistics().running, 1u);
+  BOOST_CHECK_EQUAL(served->statistics().queued, 1u);
+  BOOST_CHECK_EQUAL(served->statistics().rejected, 1u);
+  server.count_barrier().open();
+  BOOST_CHECK_EQUAL(first.get(), 1);
+  BOOST_CHECK_EQUAL(second.get(), 2);
+  BOOST_CHECK_EQUAL(served->statistics().queued, 0u);
+  BOOST_CHECK_EQUAL(served->statistics().queued_max, 1u);
+}
+
+// Tearing the server down with calls queued ends them all.
+ELLE_TEST_SCHEDULED(admission_teardown, (TestConfig, config))
+{
+  if (config.sync)
+    return;
+  DummyRPC* served = nullptr;
+  RPCServer server(
+    config,
+    [&] (DummyRPC& rpc)
+    {
+      rpc.count.limit(1);
+      served = &rpc;
+    });
+  reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  infinit::protocol::Serializer s(socket, config.version, config.checksum);
+  infinit::protocol::ChanneledStream channels(s);
+  DummyRPC rpc(channels);
+  std::vector<infinit::protocol::Future<int>> calls;
+  for (int i = 0; i < 3; ++i)
+    calls.push_back(rpc.count.async_call());
+  while (!served || served->statistics().queued < 2)
+    reactor::yield();
+  BOOST_CHECK_EQUAL(server.counter(), 1);
+  server.terminate();
+  BOOST_CHECK(infinit::protocol::when_all(calls));
+  for (auto& call: calls)
+    BOOST_CHECK_THROW(call.get(), std::runtime_error);
+  BOOST_CHECK_EQUAL(server.counter(), 1);
+}
+
+ELLE_TEST_SCHEDULED(admission_unknown, (TestConfig, config))
+{
+  if (config.sync || config.version < elle::Version(0, 4, 0))
+    return;
+  DummyRPC* served = nullptr;
+  RPCServer server(
+    config,
+    [&] (DummyRPC& rpc)
+    {
+      rpc.concurrency(1);
+      rpc.queue_size(0);
+      served = &rpc;
+    });
+  reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  infinit::protocol::Serializer s(socket, config.version, config.checksum);
+  infinit::protocol::ChanneledStream channels(s);
+  DummyRPC rpc(channels);
+  DummyRPC::RemoteProcedure<int> missing("missing", rpc);
+  auto first = rpc.count.async_call();
+  while (server.counter() < 1)
+    reactor::yield();
+  // Unknown procedures are answered without going through admission.
+  try
+  {
+    missing();
+    BOOST_FAIL("unknown procedure should have thrown");
+  }
+  catch (infinit::protocol::RPCError const& e)
+  {
+    BOOST_CHECK(e.code() == infinit::protocol::RPCErrorCode::unknown_procedure);
+  }
+  BOOST_CHECK_EQUAL(served->statistics().rejected, 0u);
+  server.count_barrier().open();
+  BOOST_CHECK_EQUAL(first.get(), 1);
+}
+
+/*---------------------------.
+| Deadlines and cancellation |
+`---------------------------*/
+
+ELLE_TEST_SCHEDULED(deadline, (TestConfig, config))
+{
+  if (config.version < elle::Version(0, 4, 0))
+    return;
+  DummyRPC* served = nullptr;
+  RPCServer server(config, [&] (DummyRPC& rpc) { served = &rpc; });
+  reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  infinit::protocol::Serializer s(socket, config.version, config.checksum);
+  infinit::protocol::ChanneledStream channels(s);
+  DummyRPC rpc(channels);
+  auto wait = rpc.wait;
+  wait.timeout(valgrind(boost::posix_time::milliseconds(100), 10));
+  BOOST_CHECK_THROW(wait(), reactor::Timeout);
+  // The server gave up on the call too, or it would not answer in sync mode.
+  BOOST_CHECK_EQUAL(rpc.answer(), 42);
+  while (served->statistics().running)
+    reactor::yield();
+  BOOST_CHECK_EQUAL(server.counter(), 1);
+}
+
+ELLE_TEST_SCHEDULED(deadline_queued, (TestConfig, config))
+{
+  if (config.sync || config.version < elle::Version(0, 4, 0))
+    return;
+  DummyRPC* served = nullptr;
+  RPCServer server(
+    config,
+    [&] (DummyRPC& rpc)
+    {
+      rpc.count.limit(1);
+      served = &rpc;
+    });
+  reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  infinit::protocol::Serializer s(socket, config.version, config.checksum);
+  infinit::protocol::ChanneledStream channels(s);
+  DummyRPC rpc(channels);
+  auto first = rpc.count.async_call();
+  while (server.counter() < 1)
+    reactor::yield();
+  // Queue a call by hand, so the caller does not cancel it on timeout.
+  infinit::protocol::Channel channel(channels);
+  {
+    elle::Buffer question;
+    {
+      elle::IOStream outs(question.ostreambuf());
+      infinit::protocol::binary::Output output(outs);
+      output << rpc.procedure_id("count");
+      output << int64_t(10);
+      output << false;
+    }
+    channel.write(question);
+  }
+  while (served->statistics().queued < 1)
+    reactor::yield();
+  reactor::sleep(valgrind(boost::posix_time::milliseconds(100), 10));
+  server.count_barrier().open();
+  BOOST_CHECK_EQUAL(first.get(), 1);
+  // The queued call expired before being admitted and was skipped.
+  auto response = channel.read();
+  elle::IOStream ins(response.istreambuf());
+  infinit::protocol::binary::Input input(ins);
+  bool success;
+  input >> success;
+  BOOST_CHECK(!success);
+  uint8_t code;
+  input >> code;
+  BOOST_CHECK(static_cast<infinit::protocol::RPCErrorCode>(code) ==
+              infinit::protocol::RPCErrorCode::timeout);
+  BOOST_CHECK_EQUAL(server.counter(), 1);
+}
+
+ELLE_TEST_SCHEDULED(cancel, (TestConfig, config))
+{
+  if (config.sync || config.version < elle::Version(0, 4, 0))
+    return;
+  DummyRPC* served = nullptr;
+  RPCServer server(config, [&] (DummyRPC& rpc) { served = &rpc; });
+  reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  infinit::protocol::Serializer s(socket, config.version, config.checksum);
+  infinit::protocol::ChanneledStream channels(s);
+  DummyRPC rpc(channels);
+  reactor::Thread caller("caller", [&] { rpc.wait(); });
+  do
+  {
+    reactor::yield();
+  }
+  while (server.counter() < 1);
+  BOOST_CHECK_EQUAL(served->statistics().running, 1u);
+  caller.terminate_now();
+  // The server terminates the abandoned call.
+  while (served->statistics().running)
+    reactor::yield();
+  BOOST_CHECK_EQUAL(rpc.answer(), 42);
+}
+
+ELLE_TEST_SCHEDULED(async_deadline, (TestConfig, config))
+{
+  if (config.version < elle::Version(0, 4, 0))
+    return;
+  DummyRPC* served = nullptr;
+  RPCServer server(config, [&] (DummyRPC& rpc) { served = &rpc; });
+  reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  infinit::protocol::Serializer s(socket, config.version, config.checksum);
+  infinit::protocol::ChanneledStream channels(s);
+  DummyRPC rpc(channels);
+  auto wait = rpc.wait;
+  wait.timeout(valgrind(boost::posix_time::milliseconds(100), 10));
+  auto call = wait.async_call();
+  BOOST_CHECK_THROW(call.get(), reactor::Timeout);
+  // Later calls are still answered.
+  BOOST_CHECK_EQUAL(rpc.answer.async_call().get(), 42);
+  while (served->statistics().running)
+    reactor::yield();
+  BOOST_CHECK_EQUAL(server.counter(), 1);
+}
+
+ELLE_TEST_SCHEDULED(async_abandon, (TestConfig, config))
+{
+  if (config.sync || config.version < elle::Version(0, 4, 0))
+    return;
+  DummyRPC* served = nullptr;
+  RPCServer server(config, [&] (DummyRPC& rpc) { served = &rpc; });
+  reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  infinit::protocol::Serializer s(socket, config.version, config.checksum);
+  infinit::protocol::ChanneledStream channels(s);
+  DummyRPC rpc(channels);
+  {
+    auto call = rpc.wait.async_call();
+    while (server.counter() < 1)
+      reactor::yield();
+    BOOST_CHECK_EQUAL(served->statistics().running, 1u);
+  }
+  // Destroying the last copy of the future cancels the call on the server.
+  while (served->statistics().running)
+    reactor::yield();
+  BOOST_CHECK_EQUAL(rpc.answer.async_call().get(), 42);
+}
+
+ELLE_TEST_SCHEDULED(deadline_large_reply, (TestConfig, config))
+{
+  if (config.version < elle::Version(0, 4, 0))
+    return;
+  RPCServer server(config);
+  Proxy proxy(server.port());
+  reactor::network::TCPSocket socket("127.0.0.1", proxy.port());
+  infinit::protocol::Serializer s(socket, config.version, config.checksum);
+  infinit::protocol::ChanneledStream channels(s);
+  DummyRPC rpc(channels);
+  // Ask for a large blob by hand, so that no caller waits for it.
+  int const size = 1 << 20;
+  infinit::protocol::Channel channel(channels);
+  {
+    elle::Buffer question;
+    {
+      elle::IOStream outs(question.ostreambuf());
+      infinit::protocol::binary::Output output(outs);
+      output << rpc.procedure_id("blob");
+      output << int64_t(-1);
+      output << false;
+      output << size;
+    }
+    proxy.hold();
+    channel.write(question);
+  }
+  reactor::wait(proxy.held());
+  // Time out while the blob is read midway.
+  auto wait = rpc.wait;
+  wait.timeout(valgrind(boost::posix_time::milliseconds(100), 10));
+  BOOST_CHECK_THROW(wait(), reactor::Timeout);
+  proxy.release().open();
+  // The blob is received whole, and the stream is still usable.
+  auto response = channel.read();
+  elle::IOStream ins(response.istreambuf());
+  infinit::protocol::binary::Input input(ins);
+  bool success;
+  input >> success;
+  BOOST_CHECK(success);
+  std::string blob;
+  input >> blob;
+  BOOST_CHECK(blob == std::string(size, 'x'));
+  BOOST_CHECK_EQUAL(rpc.answer(), 42);
+}
+
 /*--------------.
 | Disconnection |
 `--------------*/
@@ -220,7 +828,7 @@ ELLE_TEST_SCHEDULED(disconnection, (TestConfig, config))
   RPCServer server(config);
   reactor::network::TCPSocket socket("127.0.0.1", server.port());
   infinit::protocol::Serializer s(socket, config.version, config.checksum);
-  infinit::protocol::ChanneledStream channels(s, config.version);
+  infinit::protocol::ChanneledStream channels(s);
   DummyRPC rpc(channels);
   reactor::Thread call_1("call 1",
                          [&]
@@ -241,13 +849,102 @@ ELLE_TEST_SCHEDULED(disconnection, (TestConfig, config))
   reactor::wait({call_1, call_2});
 }
 
+ELLE_TEST_SCHEDULED(async_disconnection, (TestConfig, config))
+{
+  RPCServer server(config);
+  reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  infinit::protocol::Serializer s(socket, config.version, config.checksum);
+  infinit::protocol::ChanneledStream channels(s);
+  DummyRPC rpc(channels);
+  auto call_1 = rpc.wait.async_call();
+  auto call_2 = rpc.wait.async_call();
+  do
+  {
+    reactor::yield();
+  }
+  while (server.counter() < (config.sync ? 1 : 2));
+  server.terminate();
+  BOOST_CHECK(infinit::protocol::when_all(
+                std::vector<infinit::protocol::Future<void>>{call_1, call_2}));
+  BOOST_CHECK_THROW(call_1.get(), std::runtime_error);
+  BOOST_CHECK_THROW(call_2.get(), std::runtime_error);
+}
+
+/*--------.
+| Metrics |
+`--------*/
+
+ELLE_TEST_SCHEDULED(histogram)
+{
+  infinit::protocol::Histogram h;
+  BOOST_CHECK_EQUAL(h.percentile(0.5), 0u);
+  for (uint64_t i = 1; i <= 1000; ++i)
+    h.record(i);
+  BOOST_CHECK_EQUAL(h.count(), 1000u);
+  BOOST_CHECK_EQUAL(h.min(), 1u);
+  BOOST_CHECK_EQUAL(h.max(), 1000u);
+  BOOST_CHECK_CLOSE(h.mean(), 500.5, 0.001);
+  // Small values are exact, others within a sixteenth.
+  BOOST_CHECK_EQUAL(h.percentile(0.01), 10u);
+  for (auto ratio: {0.5, 0.9, 0.99})
+  {
+    BOOST_CHECK_GE(h.percentile(ratio), ratio * 1000);
+    BOOST_CHECK_LE(h.percentile(ratio), ratio * 1000 * 17 / 16);
+  }
+  BOOST_CHECK_EQUAL(h.percentile(1), 1000u);
+}
+
+ELLE_TEST_SCHEDULED(metrics, (TestConfig, config))
+{
+  DummyRPC* served = nullptr;
+  RPCServer server(config, [&] (DummyRPC& rpc) { served = &rpc; });
+  reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  infinit::protocol::Serializer s(socket, config.version, config.checksum);
+  infinit::protocol::ChanneledStream channels(s);
+  DummyRPC rpc(channels);
+  BOOST_CHECK_EQUAL(rpc.answer(), 42);
+  BOOST_CHECK_EQUAL(rpc.square(3), 9);
+  BOOST_CHECK_EQUAL(rpc.square.async_call(4).get(), 16);
+  BOOST_CHECK_THROW(rpc.raise(), std::runtime_error);
+  auto metrics = rpc.metrics();
+  BOOST_CHECK_EQUAL(metrics.size(), 3u);
+  auto const& square = metrics.at("square").caller;
+  BOOST_CHECK_EQUAL(square.calls, 2u);
+  BOOST_CHECK_EQUAL(square.errors, 0u);
+  BOOST_CHECK_GT(square.bytes_in, 0u);
+  BOOST_CHECK_GT(square.bytes_out, 0u);
+  BOOST_CHECK_EQUAL(square.latency.count(), 2u);
+  BOOST_CHECK_EQUAL(metrics.at("square").server.calls, 0u);
+  BOOST_CHECK_EQUAL(metrics.at("raise").caller.calls, 1u);
+  BOOST_CHECK_EQUAL(metrics.at("raise").caller.errors, 1u);
+  // Calls answered before the last one are accounted for by the server.
+  auto server_metrics = served->metrics();
+  BOOST_CHECK_EQUAL(server_metrics.at("answer").server.calls, 1u);
+  BOOST_CHECK_EQUAL(server_metrics.at("square").server.calls, 2u);
+  BOOST_CHECK_EQUAL(server_metrics.at("square").server.bytes_in,
+                    square.bytes_out);
+  BOOST_CHECK_EQUAL(server_metrics.at("square").caller.calls, 0u);
+  // Metrics are served as JSON.
+  reactor::network::HttpServer http;
+  rpc.serve_metrics(http);
+  auto json = boost::any_cast<elle::json::Object>(
+    elle::json::read(reactor::http::get(http.url("metrics")).string()));
+  auto const& caller = boost::any_cast<elle::json::Object>(
+    boost::any_cast<elle::json::Object>(json.at("square")).at("caller"));
+  BOOST_CHECK_EQUAL(boost::any_cast<int64_t>(caller.at("calls")), 2);
+  // Routes outlive their RPC.
+  {
+    DummyRPC gone(channels);
+    gone.serve_metrics(http, "/gone");
+  }
+  reactor::http::Request r(http.url("gone"));
+  BOOST_CHECK_EQUAL(r.status(), reactor::http::StatusCode::Gone);
+}
+
 /*-----------.
 | Test suite |
 `-----------*/
 
-#define ELLE_TEST_NAMED_CASE(func, name)\
-  ::boost::unit_test::make_test_case(func, name)
-
 ELLE_TEST_SUITE()
 {
   auto& suite = boost::unit_test::framework::master_test_suite();
@@ -260,15 +957,38 @@ ELLE_TEST_SUITE()
     {false, true,  elle::Version(0, 2, 0)},
     {false, false, elle::Version(0, 1, 0)},
     {false, false, elle::Version(0, 2, 0)},
+    {true,  true,  elle::Version(0, 4, 0)},
+    {false, true,  elle::Version(0, 4, 0)},
   };
   auto test = [&](std::string const& name, std::function<void(TestConfig)> f)
   {
-    for (int i=0; i<8; ++i)
+    for (auto const& config: configs)
       suite.add(
-        BOOST_TEST_CASE(std::bind(f, configs[i])), 0, valgrind(1, 10));
+        BOOST_TEST_CASE_NAME(
+          std::bind(f, config),
+          elle::sprintf("%s_%s_%s_%s", name, config.sync ? "sync" : "async",
+                        config.checksum ? "checksum" : "plain",
+                        config.version)),
+        0, valgrind(1, 10));
   };
   test("rpc", &rpc);
   test("terminate", &terminate);
   test("parallel", &parallel);
   test("disconnection", &disconnection);
+  test("async", &async);
+  test("async_disconnection", &async_disconnection);
+  test("stream", &stream);
+  test("stream_malformed_control", &stream_malformed_control);
+  test("errors", &errors);
+  test("admission", &admission);
+  test("admission_teardown", &admission_teardown);
+  test("admission_unknown", &admission_unknown);
+  test("deadline", &deadline);
+  test("deadline_queued", &deadline_queued);
+  test("cancel", &cancel);
+  test("async_deadline", &async_deadline);
+  test("async_abandon", &async_abandon);
+  test("deadline_large_reply", &deadline_large_reply);
+  test("metrics", &metrics);
+  suite.add(BOOST_TEST_CASE(histogram), 0, valgrind(1, 10));
 }
@@ -16,6 +16,7 @@
 #include <elle/test.hh>
 #include <elle/cast.hh>
 #include <elle/IOStream.hh>
+#include <elle/serialization/binary.hh>
 #include <elle/With.hh>
 
 ELLE_LOG_COMPONENT("infinit.protocol.test");
@@ -184,7 +185,11 @@ public:
 
 public:
   SocketInstrumentation()
-    : _router(*reactor::Scheduler::scheduler(), "router",
+    // Relay small writes right away: Nagle would hold them until the peer's
+    // delayed acknowledgment, past the tests' short sleeps.
+    : _a_server(true)
+    , _b_server(true)
+    , _router(*reactor::Scheduler::scheduler(), "router",
               std::bind(&SocketInstrumentation::_route, this))
     , alice_conf(new Conf)
     , bob_conf(new Conf)
@@ -393,7 +398,8 @@ dialog(elle::Version const& version,
 
 #define CASES(function)                                                 \
   for (auto const& version: {elle::Version{0, 1, 0},                    \
-                             elle::Version{0, 2, 0}})                   \
+                             elle::Version{0, 2, 0},                    \
+                             elle::Version{0, 4, 0}})                   \
     for (auto checksum: {true, false})                                  \
       ELLE_LOG("case: version = %s, checksum = %s", version, checksum)  \
         function(version, checksum)                                     \
@@ -486,6 +492,45 @@ ELLE_TEST_SCHEDULED(exchange)
   CASES(_exchange);
 }
 
+static
+void
+_fragments(elle::Version const& version,
+           bool checksum)
+{
+  // Fragments are gathered in one write on sockets, whatever their size
+  // relative to the chunk size.
+  std::vector<std::pair<elle::Buffer, elle::Buffer>> packets = {
+    {elle::Buffer("header"), elle::Buffer()},
+    {elle::Buffer("header"), std::string(1000, 'a')},
+    {std::string(5000, 'h'), std::string(10, 'b')},
+    {elle::Buffer("header"), std::string((2 << 16) + 11, 'c')},
+    {std::string((2 << 16) - 3, 'h'), std::string((2 << 17) + 7, 'd')},
+  };
+  dialog<SocketInstrumentation>(
+    version,
+    checksum,
+    [] (SocketInstrumentation&) {},
+    [&] (infinit::protocol::Serializer& s)
+    {
+      for (auto const& packet: packets)
+        s.writev({packet.first, packet.second});
+    },
+    [&] (infinit::protocol::Serializer& s)
+    {
+      for (auto const& packet: packets)
+      {
+        auto expected = packet.first;
+        expected.append(packet.second.contents(), packet.second.size());
+        BOOST_CHECK_EQUAL(s.read(), expected);
+      }
+    });
+}
+
+ELLE_TEST_SCHEDULED(fragments)
+{
+  CASES(_fragments);
+}
+
 static
 void
 _connection_lost_reader(elle::Version const& version,
@@ -761,6 +806,173 @@ ELLE_TEST_SCHEDULED(termination)
   _termination(elle::Version{0, 1, 0}, false);
   _termination(elle::Version{0, 2, 0}, false);
   _termination(elle::Version{0, 3, 0}, false);
+  _termination(elle::Version{0, 4, 0}, false);
+}
+
+ELLE_TEST_SCHEDULED(checksums)
+{
+  using infinit::protocol::Checksum;
+  using infinit::protocol::Hasher;
+  BOOST_CHECK_EQUAL(infinit::protocol::crc32c(0, "123456789", 9), 0xe3069283);
+  {
+    Hasher hasher(Checksum::xxhash64);
+    BOOST_CHECK_EQUAL(hasher.digest(),
+                      elle::Buffer("\xef\x46\xdb\x37\x51\xd8\xe9\x99", 8));
+  }
+  // Digests do not depend on how data is split.
+  auto data = infinit::cryptography::random::generate<elle::Buffer>(1000);
+  for (auto algorithm: {Checksum::crc32c, Checksum::xxhash64})
+  {
+    Hasher whole(algorithm);
+    whole.update(data);
+    BOOST_CHECK_EQUAL(whole.digest().size(), Hasher::size(algorithm));
+    for (auto step: {1, 7, 32, 333})
+    {
+      Hasher pieces(algorithm);
+      for (int offset = 0; offset < signed(data.size()); offset += step)
+        pieces.update(
+          elle::ConstWeakBuffer(data.contents() + offset,
+                                std::min<int>(step, data.size() - offset)));
+      BOOST_CHECK_EQUAL(pieces.digest(), whole.digest());
+    }
+  }
+}
+
+ELLE_TEST_SCHEDULED(checksum_negotiation)
+{
+  using infinit::protocol::Checksum;
+  struct Case
+  {
+    elle::Version version;
+    Checksum alice;
+    Checksum bob;
+    Checksum expected;
+  };
+  auto const packet = std::string((2 << 16) * 2 + 5, 'p');
+  for (auto const& c: std::vector<Case>{
+      {{0, 4, 0}, Checksum::crc32c, Checksum::crc32c, Checksum::crc32c},
+      {{0, 4, 0}, Checksum::xxhash64, Checksum::xxhash64, Checksum::xxhash64},
+      {{0, 4, 0}, Checksum::xxhash64, Checksum::crc32c, Checksum::crc32c},
+      {{0, 4, 0}, Checksum::crc32c, Checksum::sha1, Checksum::sha1},
+      {{0, 3, 0}, Checksum::xxhash64, Checksum::xxhash64, Checksum::sha1},
+    })
+  {
+    Connector sockets;
+    std::unique_ptr<infinit::protocol::Serializer> alice;
+    std::unique_ptr<infinit::protocol::Serializer> bob;
+    elle::With<reactor::Scope>() << [&] (reactor::Scope& scope)
+    {
+      scope.run_background(
+        "alice",
+        [&]
+        {
+          alice.reset(new infinit::protocol::Serializer(
+                        sockets.alice(), c.version, true, c.alice));
+          alice->write(elle::Buffer(packet));
+          BOOST_CHECK_EQUAL(alice->read(), elle::Buffer("ok"));
+        });
+      scope.run_background(
+        "bob",
+        [&]
+        {
+          bob.reset(new infinit::protocol::Serializer(
+                      sockets.bob(), c.version, true, c.bob));
+          BOOST_CHECK_EQUAL(bob->read(), elle::Buffer(packet));
+          bob->write(elle::Buffer("ok"));
+        });
+      scope.wait();
+    };
+    BOOST_CHECK_EQUAL(alice->checksum_algorithm(), c.expected);
+    BOOST_CHECK_EQUAL(bob->checksum_algorithm(), c.expected);
+  }
+}
+
+ELLE_TEST_SCHEDULED(compression)
+{
+  using infinit::protocol::Compression;
+  std::string text;
+  for (int i = 0; i < 1000; ++i)
+    text += elle::sprintf("{\"block\": %s, \"owner\": \"alice\"}", i % 17);
+  std::vector<elle::Buffer> const packets = {
+    // Too small to be compressed.
+    elle::Buffer("small"),
+    // Spans several chunks when not compressed.
+    std::string((2 << 16) * 3, 'z'),
+    text,
+    // Incompressible.
+    infinit::cryptography::random::generate<elle::Buffer>(10000),
+  };
+  for (auto checksum: {true, false})
+    for (auto peer: {Compression::deflate, Compression::none})
+    {
+      Connector sockets;
+      std::unique_ptr<infinit::protocol::Serializer> alice;
+      std::unique_ptr<infinit::protocol::Serializer> bob;
+      elle::With<reactor::Scope>() << [&] (reactor::Scope& scope)
+      {
+        scope.run_background(
+          "alice",
+          [&]
+          {
+            alice.reset(new infinit::protocol::Serializer(
+                          sockets.alice(), elle::Version(0, 4, 0), checksum,
+                          infinit::protocol::Checksum::crc32c,
+                          Compression::deflate));
+            for (auto const& packet: packets)
+              alice->write(packet);
+            // Fragments are compressed as a whole.
+            alice->writev({elle::ConstWeakBuffer(text.data(), 100),
+                           elle::ConstWeakBuffer(text.data() + 100,
+                                                 text.size() - 100)});
+          });
+        scope.run_background(
+          "bob",
+          [&]
+          {
+            bob.reset(new infinit::protocol::Serializer(
+                        sockets.bob(), elle::Version(0, 4, 0), checksum,
+                        infinit::protocol::Checksum::crc32c, peer));
+            for (auto const& packet: packets)
+              BOOST_CHECK_EQUAL(bob->read(), packet);
+            BOOST_CHECK_EQUAL(bob->read(), elle::Buffer(text));
+          });
+        scope.wait();
+      };
+      BOOST_CHECK_EQUAL(alice->compression(), peer);
+      BOOST_CHECK_EQUAL(bob->compression(), peer);
+      auto const& statistics = alice->compression_statistics();
+      if (peer == Compression::none)
+      {
+        BOOST_CHECK_EQUAL(statistics.raw, 0);
+        continue;
+      }
+      BOOST_CHECK_EQUAL(statistics.packets, 3);
+      BOOST_CHECK_EQUAL(statistics.skipped, 2);
+      BOOST_CHECK_EQUAL(statistics.raw,
+                        5 + (2 << 16) * 3 + 2 * text.size() + 10000);
+      BOOST_CHECK_LT(statistics.compressed, 5 + 10000 + text.size());
+    }
+}
+
+ELLE_TEST_SCHEDULED(compression_bomb)
+{
+  using infinit::protocol::Compression;
+  using infinit::protocol::Stream;
+  elle::Version const version(0, 4, 0);
+  // Forge a peer announcing 4GiB of decompressed data for 4 bytes.
+  std::stringstream stream(std::ios::in | std::ios::out | std::ios::app);
+  elle::serialization::binary::serialize(version, stream);
+  stream.put(static_cast<char>(infinit::protocol::Checksum::crc32c));
+  stream.put(static_cast<char>(Compression::deflate));
+  stream.put(static_cast<char>(Compression::deflate));
+  Stream::uint32_put(stream, std::numeric_limits<uint32_t>::max(), version);
+  Stream::uint32_put(stream, 4, version);
+  stream.write("bomb", 4);
+  infinit::protocol::Serializer s(
+    stream, version, false, infinit::protocol::Checksum::crc32c,
+    Compression::deflate);
+  BOOST_CHECK_EQUAL(s.compression(), Compression::deflate);
+  BOOST_CHECK_THROW(s.read(), infinit::protocol::Error);
 }
 
 ELLE_TEST_SCHEDULED(eof)
@@ -977,17 +1189,88 @@ ELLE_TEST_SCHEDULED(interruption2)
   }
 }
 
+/*----------.
+| Benchmark |
+`----------*/
+
+namespace benchmark
+{
+  /// Receive throughput, in MB/s, of \a size bytes packets over loopback TCP,
+  /// read straight from the socket or through its stream buffer if
+  /// \a direct is false.
+  static
+  double
+  _receive(elle::Buffer::Size size, bool direct)
+  {
+    static elle::Version const version(0, 4, 0);
+    auto const volume = RUNNING_ON_VALGRIND ? 1 << 20 : 64 << 20;
+    auto const packets = std::max<int>(1, volume / size);
+    reactor::network::TCPServer server;
+    server.listen();
+    reactor::network::TCPSocket client("127.0.0.1", server.port());
+    std::unique_ptr<reactor::network::Socket> peer(server.accept());
+    // A plain stream over the socket buffer hides it from the Serializer.
+    std::iostream hidden(peer->rdbuf());
+    std::iostream& stream = direct ? *peer : hidden;
+    elle::Buffer const packet(std::string(size, 'p'));
+    double seconds = 0;
+    elle::With<reactor::Scope>() << [&] (reactor::Scope& scope)
+    {
+      scope.run_background(
+        "sender",
+        [&]
+        {
+          infinit::protocol::Serializer s(client, version, false);
+          for (int i = 0; i < packets; ++i)
+            s.write(packet);
+        });
+      infinit::protocol::Serializer s(stream, version, false);
+      seconds = elapsed(
+        [&]
+        {
+          for (int i = 0; i < packets; ++i)
+            BOOST_CHECK_EQUAL(s.read().size(), size);
+        });
+      reactor::wait(scope);
+    };
+    return double(size) * packets / seconds / 1e6;
+  }
+
+  ELLE_TEST_SCHEDULED(receive, (elle::Buffer::Size, size))
+  {
+    auto const direct = _receive(size, true);
+    auto const stream = _receive(size, false);
+    BOOST_TEST_MESSAGE(
+      size << " bytes packets: " << direct << " MB/s from the socket, "
+      << stream << " MB/s through the stream buffer");
+  }
+}
+
 ELLE_TEST_SUITE()
 {
   auto& suite = boost::unit_test::framework::master_test_suite();
   suite.add(BOOST_TEST_CASE(exchange_packets), 0, valgrind(10, 10));
   suite.add(BOOST_TEST_CASE(exchange), 0, valgrind(20, 10));
+  suite.add(BOOST_TEST_CASE(fragments), 0, valgrind(10, 10));
   suite.add(BOOST_TEST_CASE(connection_lost_reader), 0, valgrind(3, 10));
   suite.add(BOOST_TEST_CASE(connection_lost_sender), 0, valgrind(3, 10));
   suite.add(BOOST_TEST_CASE(corruption), 0, valgrind(3, 10));
   suite.add(BOOST_TEST_CASE(interruption), 0, valgrind(6, 15));
   suite.add(BOOST_TEST_CASE(interruption2), 0, valgrind(3, 10));
   suite.add(BOOST_TEST_CASE(termination), 0, valgrind(3, 10));
+  suite.add(BOOST_TEST_CASE(checksums), 0, valgrind(3, 10));
+  suite.add(BOOST_TEST_CASE(checksum_negotiation), 0, valgrind(10, 10));
+  suite.add(BOOST_TEST_CASE(compression), 0, valgrind(10, 10));
+  suite.add(BOOST_TEST_CASE(compression_bomb), 0, valgrind(1, 10));
   suite.add(BOOST_TEST_CASE(eof), 0, valgrind(3));
   suite.add(BOOST_TEST_CASE(message), 0, valgrind(3));
+  {
+    auto s = benchmark_suite(suite);
+    auto receive_1k = std::bind(&benchmark::receive, 1 << 10);
+    s->add(BOOST_TEST_CASE(receive_1k), 0, valgrind(20, 5));
+    auto receive_64k = std::bind(&benchmark::receive, 64 << 10);
+    s->add(BOOST_TEST_CASE(receive_64k), 0, valgrind(20, 5));
+    auto receive_16m = std::bind(&benchmark::receive, 16 << 20);
+    s->add(BOOST_TEST_CASE(receive_16m), 0, valgrind(20, 5));
+  }
 }
@@ -1,4 +1,5 @@
 #include <reactor/Barrier.hh>
+#include <reactor/scheduler.hh>
 
 namespace reactor
 {
@@ -9,9 +10,20 @@ namespace reactor
   Barrier::Barrier(const std::string& name)
     : Super(name)
     , _opened(false)
+    , _scheduler(Scheduler::scheduler())
+    , _forwarder(*this)
     , _inverted(*this)
   {}
 
+  Barrier::Barrier(Barrier&& source)
+    : Super(std::move(source))
+    , _opened(source._opened)
+    , _scheduler(source._scheduler)
+    , _forwarder(std::move(source._forwarder), *this)
+    , _inverted(*this)
+    , _changed(std::move(source._changed))
+  {}
+
   Barrier::~Barrier()
   {
     this->_assert_destructible();
@@ -33,6 +45,14 @@ namespace reactor
   void
   Barrier::open()
   {
+    // Anything but our scheduler, including its system thread before it
+    // starts, is foreign.
+    if (this->_scheduler && Scheduler::scheduler() != this->_scheduler)
+    {
+      this->_forwarder.post(this->_scheduler->io_service(),
+                            [] (Barrier& barrier) { barrier.open(); });
+      return;
+    }
     if (!this->_opened)
     {
       this->_opened = true;
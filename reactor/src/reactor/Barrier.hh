@@ -1,5 +1,6 @@
 #pragma once
 
+#include <reactor/Forwarder.hh>
 #include <reactor/signals.hh>
 
 #include <reactor/waitable.hh>
@@ -33,7 +34,7 @@ namespace reactor
     /// Create a closed Barrier with the given name.
     /// @param name The barrier name, for pretty-printing purpose.
     Barrier(const std::string& name = std::string());
-    Barrier(Barrier&&) = default;
+    Barrier(Barrier&& source);
     ~Barrier();
 
   /*---------.
@@ -45,12 +46,19 @@ namespace reactor
   private:
     /// Whether this is opened.
     ELLE_ATTRIBUTE_R(bool, opened);
+    /// The scheduler this was created in, which wakes our waiters.
+    ELLE_ATTRIBUTE_R(Scheduler*, scheduler);
+    /// Openings posted from other system threads.
+    ELLE_ATTRIBUTE(Forwarder<Barrier>, forwarder);
 
   /*--------.
   | Waiting |
   `--------*/
   public:
     /// Open this, letting current and future threads go past it.
+    ///
+    /// From another system thread, the opening is deferred to our scheduler,
+    /// and dropped if this is destroyed in the meantime.
     void open();
     /// Close this, stopping future threads waiting it.
     void close();
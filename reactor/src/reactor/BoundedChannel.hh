@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include <elle/Printable.hh>
+#include <elle/attribute.hh>
+
+#include <reactor/Barrier.hh>
+
+namespace reactor
+{
+  /// Bounded multi-producer multi-consumer queue over a lock-free ring.
+  ///
+  /// Unlike Channel, writers wait for room *before* insertion. Batch
+  /// operations wake the other side once per batch. Values may be put from
+  /// other system threads, which then block on a condition variable while the
+  /// ring is full; values are got from the scheduler that created the channel.
+  template <typename T>
+  class BoundedChannel
+    : public elle::Printable
+  {
+  /*------.
+  | Types |
+  `------*/
+  public:
+    using Self = BoundedChannel<T>;
+
+  /*-------------.
+  | Construction |
+  `-------------*/
+  public:
+    /// Create a channel holding at least \a capacity values, rounded up to a
+    /// power of two.
+    BoundedChannel(std::size_t capacity);
+    BoundedChannel(Self const&) = delete;
+    ~BoundedChannel();
+
+  /*--------.
+  | Content |
+  `--------*/
+  public:
+    /// Push \a value, waiting for room.
+    void
+    put(T value);
+    /// Push \a value if there is room.
+    ///
+    /// \return Whether \a value was pushed, leaving it untouched otherwise.
+    bool
+    try_put(T& value);
+    /// Push all values of [\a begin, \a end), waiting for room as needed.
+    template <typename It>
+    void
+    put_many(It begin, It end);
+    /// Pop a value, waiting for one.
+    T
+    get();
+    /// Pop a value if any.
+    boost::optional<T>
+    try_get();
+    /// Pop between one and \a max values, waiting for one.
+    std::vector<T>
+    get_many(std::size_t max);
+    /// Number of stored values, which may be outdated by other threads.
+    std::size_t
+    size() const;
+    bool
+    empty() const;
+    ELLE_ATTRIBUTE_R(std::size_t, capacity);
+  private:
+    bool
+    _push(T& value);
+    bool
+    _pop(boost::optional<T>& value);
+    /// Pop a value into \a value, waiting for one.
+    void
+    _wait_readable(boost::optional<T>& value);
+    /// Wake readers up after pushing.
+    void
+    _readable();
+    /// Wake writers up after popping.
+    void
+    _writable();
+    /// Wait for room, from any thread.
+    void
+    _wait_writable();
+
+  /*--------.
+  | Storage |
+  `--------*/
+  private:
+    struct Cell
+    {
+      std::atomic<std::size_t> sequence;
+      typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+    ELLE_ATTRIBUTE(std::size_t, mask);
+    ELLE_ATTRIBUTE(std::unique_ptr<Cell[]>, cells);
+    // Keep producers and consumers positions on separate cache lines.
+    alignas(64) std::atomic<std::size_t> _tail;
+    alignas(64) std::atomic<std::size_t> _head;
+
+  /*--------.
+  | Waiting |
+  `--------*/
+  private:
+    ELLE_ATTRIBUTE(Scheduler*, scheduler);
+    /// Whether readers wait for values.
+    ELLE_ATTRIBUTE(std::atomic<bool>, read_waiting);
+    ELLE_ATTRIBUTE(Barrier, read_barrier);
+    /// Whether scheduler writers wait for room.
+    ELLE_ATTRIBUTE(std::atomic<bool>, write_waiting);
+    ELLE_ATTRIBUTE(Barrier, write_barrier);
+    /// Number of system thread writers waiting for room.
+    ELLE_ATTRIBUTE(std::atomic<int>, write_waiters);
+    ELLE_ATTRIBUTE(std::mutex, write_mutex);
+    ELLE_ATTRIBUTE(std::condition_variable, write_condition);
+
+  /*----------.
+  | Printable |
+  `----------*/
+  protected:
+    void
+    print(std::ostream& stream) const override;
+  };
+}
+
+#include <reactor/BoundedChannel.hxx>
@@ -0,0 +1,313 @@
+#pragma once
+
+#include <cstdint>
+#include <new>
+
+#include <elle/assert.hh>
+#include <elle/log.hh>
+#include <elle/printf.hh>
+
+#include <reactor/scheduler.hh>
+
+namespace reactor
+{
+  /*-------------.
+  | Construction |
+  `-------------*/
+
+  namespace details
+  {
+    inline
+    std::size_t
+    ring_capacity(std::size_t capacity)
+    {
+      std::size_t res = 2;
+      while (res < capacity)
+        res <<= 1;
+      return res;
+    }
+  }
+
+  template <typename T>
+  BoundedChannel<T>::BoundedChannel(std::size_t capacity)
+    : _capacity(details::ring_capacity(capacity))
+    , _mask(this->_capacity - 1)
+    , _cells(new Cell[this->_capacity])
+    , _tail(0)
+    , _head(0)
+    , _scheduler(Scheduler::scheduler())
+    , _read_waiting(false)
+    , _read_barrier("bounded channel read")
+    , _write_waiting(false)
+    , _write_barrier("bounded channel write")
+    , _write_waiters(0)
+    , _write_mutex()
+    , _write_condition()
+  {
+    for (std::size_t i = 0; i < this->_capacity; ++i)
+      this->_cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  template <typename T>
+  BoundedChannel<T>::~BoundedChannel()
+  {
+    boost::optional<T> value;
+    while (this->_pop(value))
+      ;
+  }
+
+  /*--------.
+  | Content |
+  `--------*/
+
+  template <typename T>
+  void
+  BoundedChannel<T>::put(T value)
+  {
+    ELLE_LOG_COMPONENT("reactor.BoundedChannel");
+    ELLE_TRACE_SCOPE("%s: put", *this);
+    while (!this->_push(value))
+    {
+      ELLE_DEBUG("at capacity, wait");
+      this->_wait_writable();
+    }
+    this->_readable();
+  }
+
+  template <typename T>
+  bool
+  BoundedChannel<T>::try_put(T& value)
+  {
+    if (!this->_push(value))
+      return false;
+    this->_readable();
+    return true;
+  }
+
+  template <typename T>
+  template <typename It>
+  void
+  BoundedChannel<T>::put_many(It begin, It end)
+  {
+    ELLE_LOG_COMPONENT("reactor.BoundedChannel");
+    ELLE_TRACE_SCOPE("%s: put many", *this);
+    bool pushed = false;
+    for (; begin != end; ++begin)
+    {
+      T value(*begin);
+      while (!this->_push(value))
+      {
+        // Let readers drain what we pushed so far.
+        if (pushed)
+        {
+          this->_readable();
+          pushed = false;
+        }
+        ELLE_DEBUG("at capacity, wait");
+        this->_wait_writable();
+      }
+      pushed = true;
+    }
+    if (pushed)
+      this->_readable();
+  }
+
+  template <typename T>
+  T
+  BoundedChannel<T>::get()
+  {
+    ELLE_LOG_COMPONENT("reactor.BoundedChannel");
+    ELLE_TRACE_SCOPE("%s: get", *this);
+    boost::optional<T> res;
+    this->_wait_readable(res);
+    this->_writable();
+    return std::move(res.get());
+  }
+
+  template <typename T>
+  boost::optional<T>
+  BoundedChannel<T>::try_get()
+  {
+    boost::optional<T> res;
+    if (this->_pop(res))
+      this->_writable();
+    return res;
+  }
+
+  template <typename T>
+  std::vector<T>
+  BoundedChannel<T>::get_many(std::size_t max)
+  {
+    ELLE_LOG_COMPONENT("reactor.BoundedChannel");
+    ELLE_TRACE_SCOPE("%s: get up to %s values", *this, max);
+    ELLE_ASSERT_GT(max, 0u);
+    std::vector<T> res;
+    boost::optional<T> value;
+    this->_wait_readable(value);
+    do
+      res.emplace_back(std::move(value.get()));
+    while (res.size() < max && this->_pop(value));
+    ELLE_DEBUG("got %s values", res.size());
+    this->_writable();
+    return res;
+  }
+
+  template <typename T>
+  std::size_t
+  BoundedChannel<T>::size() const
+  {
+    auto const head = this->_head.load(std::memory_order_acquire);
+    auto const tail = this->_tail.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+  }
+
+  template <typename T>
+  bool
+  BoundedChannel<T>::empty() const
+  {
+    return this->size() == 0;
+  }
+
+  /*--------.
+  | Storage |
+  `--------*/
+
+  template <typename T>
+  bool
+  BoundedChannel<T>::_push(T& value)
+  {
+    auto pos = this->_tail.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true)
+    {
+      cell = &this->_cells[pos & this->_mask];
+      auto const sequence = cell->sequence.load(std::memory_order_acquire);
+      auto const diff =
+        static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+      if (diff == 0)
+      {
+        if (this->_tail.compare_exchange_weak(
+              pos, pos + 1, std::memory_order_relaxed))
+          break;
+      }
+      else if (diff < 0)
+        return false;
+      else
+        pos = this->_tail.load(std::memory_order_relaxed);
+    }
+    new (&cell->storage) T(std::move(value));
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  template <typename T>
+  bool
+  BoundedChannel<T>::_pop(boost::optional<T>& value)
+  {
+    auto pos = this->_head.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true)
+    {
+      cell = &this->_cells[pos & this->_mask];
+      auto const sequence = cell->sequence.load(std::memory_order_acquire);
+      auto const diff = static_cast<std::intptr_t>(sequence) -
+        static_cast<std::intptr_t>(pos + 1);
+      if (diff == 0)
+      {
+        if (this->_head.compare_exchange_weak(
+              pos, pos + 1, std::memory_order_relaxed))
+          break;
+      }
+      else if (diff < 0)
+        return false;
+      else
+        pos = this->_head.load(std::memory_order_relaxed);
+    }
+    auto stored = reinterpret_cast<T*>(&cell->storage);
+    value.emplace(std::move(*stored));
+    stored->~T();
+    cell->sequence.store(pos + this->_mask + 1, std::memory_order_release);
+    return true;
+  }
+
+  /*--------.
+  | Waiting |
+  `--------*/
+
+  template <typename T>
+  void
+  BoundedChannel<T>::_wait_readable(boost::optional<T>& value)
+  {
+    ELLE_LOG_COMPONENT("reactor.BoundedChannel");
+    while (!this->_pop(value))
+    {
+      this->_read_barrier.close();
+      this->_read_waiting = true;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      // Writers may have pushed before seeing us wait.
+      if (this->empty())
+      {
+        ELLE_TRACE_SCOPE("wait for data");
+        reactor::wait(this->_read_barrier);
+      }
+    }
+  }
+
+  template <typename T>
+  void
+  BoundedChannel<T>::_wait_writable()
+  {
+    if (this->_scheduler && Scheduler::scheduler() == this->_scheduler)
+    {
+      this->_write_barrier.close();
+      this->_write_waiting = true;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      // Readers may have popped before seeing us wait.
+      if (this->size() >= this->_capacity)
+        reactor::wait(this->_write_barrier);
+    }
+    else
+    {
+      std::unique_lock<std::mutex> lock(this->_write_mutex);
+      ++this->_write_waiters;
+      this->_write_condition.wait(
+        lock, [this] { return this->size() < this->_capacity; });
+      --this->_write_waiters;
+    }
+  }
+
+  template <typename T>
+  void
+  BoundedChannel<T>::_readable()
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // Barriers defer openings from other system threads to their scheduler.
+    if (this->_read_waiting.exchange(false))
+      this->_read_barrier.open();
+  }
+
+  template <typename T>
+  void
+  BoundedChannel<T>::_writable()
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (this->_write_waiting.exchange(false))
+      this->_write_barrier.open();
+    if (this->_write_waiters)
+    {
+      std::unique_lock<std::mutex> lock(this->_write_mutex);
+      this->_write_condition.notify_all();
+    }
+  }
+
+  /*----------.
+  | Printable |
+  `----------*/
+
+  template <typename T>
+  void
+  BoundedChannel<T>::print(std::ostream& stream) const
+  {
+    elle::fprintf(stream, "BoundedChannel(%x)", (void*)this);
+  }
+}
@@ -8,6 +8,7 @@
 #include <elle/Printable.hh>
 
 #include <reactor/Barrier.hh>
+#include <reactor/Forwarder.hh>
 
 namespace reactor
 {
@@ -33,6 +34,11 @@ namespace reactor
   | Content |
   `--------*/
   public:
+    /// Push \a data, waiting for room if max_size is reached.
+    ///
+    /// From another system thread, the push is deferred to our scheduler
+    /// without waiting for room, and dropped if this is destroyed in the
+    /// meantime.
     void
     put(T data);
     T
@@ -43,6 +49,9 @@ namespace reactor
     empty() const;
     void
     clear();
+  private:
+    void
+    _push(T data);
 
   /*--------.
   | Control |
@@ -69,6 +78,8 @@ namespace reactor
     /// Maximum size, will block writers *after* insertion if reached
     ELLE_ATTRIBUTE_Rw(int, max_size);
     ELLE_ATTRIBUTE_r(int, size);
+    /// Pushes posted from other system threads.
+    ELLE_ATTRIBUTE(Forwarder<Channel>, forwarder);
     enum
     {
       SizeUnlimited = std::numeric_limits<int>::max()
@@ -1,6 +1,8 @@
 #ifndef INFINIT_REACTOR_CHANNEL_HXX
 # define INFINIT_REACTOR_CHANNEL_HXX
 
+# include <elle/utility/Move.hh>
+
 # include <reactor/scheduler.hh>
 
 namespace reactor
@@ -16,6 +18,7 @@ namespace reactor
     , _queue(Container())
     , _opened(true)
     , _max_size(SizeUnlimited)
+    , _forwarder(*this)
   {}
 
   template <typename T, typename Container>
@@ -25,6 +28,7 @@ namespace reactor
     , _queue(std::move(source._queue))
     , _opened(source._opened)
     , _max_size(source._max_size)
+    , _forwarder(std::move(source._forwarder), *this)
   {}
 
   /*--------.
@@ -44,6 +48,16 @@ namespace reactor
   {
     ELLE_LOG_COMPONENT("reactor.Channel");
     ELLE_TRACE_SCOPE("%s: put", this);
+    auto owner = this->_read_barrier.scheduler();
+    if (owner && Scheduler::scheduler() != owner)
+    {
+      ELLE_DEBUG("forward to %s", *owner);
+      auto value = elle::utility::move_on_copy(std::move(data));
+      this->_forwarder.post(
+        owner->io_service(),
+        [value] (Self& channel) { channel._push(std::move(*value)); });
+      return;
+    }
     if (signed(this->_queue.size()) >= this->_max_size)
     {
       ELLE_DEBUG("at capacity, wait");
@@ -55,6 +69,14 @@ namespace reactor
       while (signed(this->_queue.size()) >= this->_max_size);
       ELLE_DEBUG("gained capacity, resume put");
     }
+    this->_push(std::move(data));
+  }
+
+  template <typename T, typename Container>
+  void
+  Channel<T, Container>::_push(T data)
+  {
+    ELLE_LOG_COMPONENT("reactor.Channel");
     this->_queue.push(std::move(data));
     if (this->_opened && !this->_read_barrier.opened())
     {
@@ -1,7 +1,9 @@
+#include <elle/With.hh>
 #include <elle/assert.hh>
 
 #include <reactor/FDStream.hh>
 #include <reactor/scheduler.hh>
+#include <reactor/thread.hh>
 
 namespace reactor
 {
@@ -9,11 +11,56 @@ namespace reactor
                                        Handle handle)
     : _stream(service, handle)
     , _handle(handle)
-  {}
+    , _uring(nullptr)
+  {
+    auto sched = Scheduler::scheduler();
+    if (sched && &service == &sched->io_service())
+      this->_uring = sched->uring();
+  }
+
+#ifdef INFINIT_LINUX
+  static
+  elle::PlainStreamBuffer::Size
+  read_uring(Uring& uring, int fd, char* buffer, std::size_t size)
+  {
+    Uring::Request request;
+    int res = 0;
+    reactor::Barrier done("read done");
+    uring.read(request, fd, buffer, size,
+               [&] (int r)
+               {
+                 res = r;
+                 done.open();
+               });
+    try
+    {
+      reactor::wait(done);
+    }
+    catch (...)
+    {
+      // The kernel must be done with the buffer before we unwind.
+      uring.cancel(request);
+      elle::With<reactor::Thread::NonInterruptible>() << [&]
+      {
+        reactor::wait(done);
+      };
+      throw;
+    }
+    if (res < 0)
+      throw elle::Error(
+        elle::sprintf("unable to read from %s: %s",
+                      fd, Uring::error(res).message()));
+    return res;
+  }
+#endif
 
   elle::PlainStreamBuffer::Size
   FDStream::StreamBuffer::read(char* buffer, elle::PlainStreamBuffer::Size size)
   {
+#ifdef INFINIT_LINUX
+    if (this->_uring)
+      return read_uring(*this->_uring, this->_handle, buffer, size);
+#endif
     elle::Size read = 0;
     boost::system::error_code error;
     reactor::Barrier done("read done");
@@ -7,6 +7,7 @@
 # include <elle/IOStream.hh>
 
 # include <reactor/Barrier.hh>
+# include <reactor/fwd.hh>
 
 namespace reactor
 {
@@ -39,6 +40,8 @@ namespace reactor
       ELLE_ATTRIBUTE(boost::asio::posix::stream_descriptor, stream);
 #endif
       ELLE_ATTRIBUTE_R(Handle, handle);
+      /// Ring of the scheduler owning the service, used to read if any.
+      ELLE_ATTRIBUTE(Uring*, uring);
     };
   };
 }
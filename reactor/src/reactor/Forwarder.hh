@@ -0,0 +1,50 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+
+#include <elle/attribute.hh>
+
+#include <reactor/asio.hh>
+
+namespace reactor
+{
+  /// Deliver actions posted from other system threads to a target living in
+  /// a scheduler, dropping them if the target is destroyed in the meantime.
+  ///
+  /// Nothing is allocated until the first action is posted: targets that are
+  /// only used from their own scheduler pay for one pointer.
+  template <typename T>
+  class Forwarder
+  {
+  public:
+    /// Forward to \a target.
+    Forwarder(T& target);
+    /// Forward what was posted to \a source to \a target from now on.
+    Forwarder(Forwarder&& source, T& target);
+    Forwarder(Forwarder const&) = delete;
+    Forwarder&
+    operator =(Forwarder const&) = delete;
+    /// Drop pending actions.
+    ~Forwarder();
+
+  public:
+    /// Run \a action with the target from \a service, unless the target is
+    /// destroyed first.
+    template <typename Action>
+    void
+    post(boost::asio::io_service& service, Action action);
+
+  private:
+    struct Handle
+    {
+      std::mutex mutex;
+      T* target;
+    };
+    ELLE_ATTRIBUTE(T*, target);
+    /// Accessed atomically, foreign threads may create it concurrently.
+    ELLE_ATTRIBUTE(std::shared_ptr<Handle>, handle);
+  };
+}
+
+#include <reactor/Forwarder.hxx>
@@ -0,0 +1,60 @@
+#include <atomic>
+
+namespace reactor
+{
+  template <typename T>
+  Forwarder<T>::Forwarder(T& target)
+    : _target(&target)
+    , _handle()
+  {}
+
+  template <typename T>
+  Forwarder<T>::Forwarder(Forwarder&& source, T& target)
+    : _target(&target)
+    , _handle(std::atomic_exchange(&source._handle, std::shared_ptr<Handle>()))
+  {
+    if (this->_handle)
+    {
+      std::unique_lock<std::mutex> lock(this->_handle->mutex);
+      this->_handle->target = this->_target;
+    }
+  }
+
+  template <typename T>
+  Forwarder<T>::~Forwarder()
+  {
+    if (auto handle = std::atomic_load(&this->_handle))
+    {
+      std::unique_lock<std::mutex> lock(handle->mutex);
+      handle->target = nullptr;
+    }
+  }
+
+  template <typename T>
+  template <typename Action>
+  void
+  Forwarder<T>::post(boost::asio::io_service& service, Action action)
+  {
+    auto handle = std::atomic_load(&this->_handle);
+    if (!handle)
+    {
+      auto fresh = std::make_shared<Handle>();
+      fresh->target = this->_target;
+      // Another thread may have won the race, use its handle then.
+      if (std::atomic_compare_exchange_strong(&this->_handle, &handle, fresh))
+        handle = std::move(fresh);
+    }
+    service.post(
+      [handle, action] () mutable
+      {
+        T* target;
+        {
+          std::unique_lock<std::mutex> lock(handle->mutex);
+          target = handle->target;
+        }
+        // Unlocked: the action may destroy the target.
+        if (target)
+          action(*target);
+      });
+  }
+}
@@ -1,6 +1,8 @@
 #ifndef REACTOR_GENERATOR_HH
 # define REACTOR_GENERATOR_HH
 
+# include <limits>
+
 # include <elle/Error.hh>
 # include <elle/optional.hh>
 
@@ -34,7 +36,10 @@ namespace reactor
   `-------------*/
   public:
     typedef typename yielder<T>::type yielder;
-    Generator(std::function<void (yielder const&)> const& driver);
+    /// Run \a driver, whose yields block once \a max_size values wait to be
+    /// consumed.
+    Generator(std::function<void (yielder const&)> const& driver,
+              int max_size = std::numeric_limits<int>::max());
     Generator(Generator&&b);
     ~Generator();
 
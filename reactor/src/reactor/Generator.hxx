@@ -17,11 +17,13 @@ namespace reactor
   `-------------*/
 
   template <typename T>
-  Generator<T>::Generator(std::function<void (yielder const&)> const& driver)
+  Generator<T>::Generator(std::function<void (yielder const&)> const& driver,
+                          int max_size)
     : _results()
     , _thread()
   {
     ELLE_LOG_COMPONENT("reactor.Generator");
+    this->_results.max_size(max_size);
     auto yield = [this] (T elt) { this->_results.put(std::move(elt)); };
     this->_thread.reset(
       new Thread("generator",
@@ -31,6 +33,12 @@ namespace reactor
                    {
                      driver(yield);
                    }
+                   catch (reactor::Terminate const&)
+                   {
+                     // Nobody is left to read the end, which would block
+                     // forever on a full channel.
+                     throw;
+                   }
                    catch (...)
                    {
                      ELLE_TRACE("%s: handle exception: %s",
@@ -0,0 +1,157 @@
+#include <reactor/SchedulerGroup.hh>
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+#include <elle/log.hh>
+
+#include <reactor/scheduler.hh>
+#include <reactor/thread.hh>
+
+ELLE_LOG_COMPONENT("reactor.SchedulerGroup");
+
+namespace reactor
+{
+  /*-------------.
+  | Construction |
+  `-------------*/
+
+  SchedulerGroup::SchedulerGroup(int size)
+    : _schedulers()
+    , _next(0)
+    , _threads(0)
+  {
+    if (size <= 0)
+      size = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 0; i < size; ++i)
+    {
+      this->_schedulers.emplace_back(std::make_unique<Scheduler>());
+      this->_schedulers.back()->_group = this;
+    }
+  }
+
+  SchedulerGroup::~SchedulerGroup()
+  {}
+
+  /*----------.
+  | Accessors |
+  `----------*/
+
+  Scheduler&
+  SchedulerGroup::front()
+  {
+    return *this->_schedulers.front();
+  }
+
+  int
+  SchedulerGroup::size() const
+  {
+    return this->_schedulers.size();
+  }
+
+  /*----.
+  | Run |
+  `----*/
+
+  void
+  SchedulerGroup::run()
+  {
+    ELLE_TRACE_SCOPE("%s: run", *this);
+    std::mutex mutex;
+    std::exception_ptr error;
+    auto run = [&] (Scheduler& scheduler)
+      {
+        try
+        {
+          scheduler.run();
+        }
+        catch (...)
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          if (!error)
+            error = std::current_exception();
+        }
+      };
+    std::vector<std::thread> threads;
+    for (auto it = this->_schedulers.begin() + 1;
+         it != this->_schedulers.end(); ++it)
+      threads.emplace_back(run, std::ref(**it));
+    run(this->front());
+    ELLE_TRACE("%s: %s is done, stop the others", *this, this->front());
+    for (auto it = this->_schedulers.begin() + 1;
+         it != this->_schedulers.end(); ++it)
+    {
+      auto& scheduler = **it;
+      scheduler.io_service().post([&scheduler] {scheduler.terminate_later();});
+    }
+    for (auto& thread: threads)
+      thread.join();
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+  void
+  SchedulerGroup::run_later(std::string const& name,
+                            std::function<void ()> const& f)
+  {
+    auto& scheduler = [this] () -> Scheduler&
+      {
+        // Claim idle schedulers so a burst is spread among them.
+        for (auto& scheduler: this->_schedulers)
+          if (scheduler->_idle.exchange(false))
+            return *scheduler;
+        return *this->_schedulers[this->_next++ % this->_schedulers.size()];
+      }();
+    ELLE_DEBUG("%s: run %s on %s", *this, name, scheduler);
+    new Thread(scheduler, name, f,
+               Thread::Options{true, false, 0, true});
+  }
+
+  void
+  SchedulerGroup::_release()
+  {
+    if (--this->_threads == 0)
+    {
+      ELLE_TRACE("%s: no threads left", *this);
+      this->front().io_service().post([] {});
+    }
+  }
+
+  bool
+  SchedulerGroup::_steal(Scheduler& thief)
+  {
+    auto const size = this->_schedulers.size();
+    auto const index = std::find_if(
+      this->_schedulers.begin(), this->_schedulers.end(),
+      [&] (std::unique_ptr<Scheduler> const& s) { return s.get() == &thief; })
+      - this->_schedulers.begin();
+    // Start with our neighbour so victims are spread evenly.
+    for (unsigned i = 1; i < size; ++i)
+    {
+      auto& victim = *this->_schedulers[(index + i) % size];
+      auto threads = victim._steal();
+      if (threads.empty())
+        continue;
+      ELLE_TRACE("%s: %s steals %s threads from %s",
+                 *this, thief, threads.size(), victim);
+      for (auto thread: threads)
+      {
+        thread->_migrate(thief);
+        thief._thread_register(*thread);
+      }
+      return true;
+    }
+    return false;
+  }
+
+  /*----------.
+  | Printable |
+  `----------*/
+
+  void
+  SchedulerGroup::print(std::ostream& s) const
+  {
+    s << "SchedulerGroup " << this;
+  }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <elle/Printable.hh>
+#include <elle/attribute.hh>
+
+#include <reactor/fwd.hh>
+
+namespace reactor
+{
+  /// Schedulers running in parallel, one per system thread.
+  ///
+  /// Each scheduler keeps its own run queues and asio service. Threads spawned
+  /// through the group may be stolen by an idle scheduler before they first
+  /// run, while threads spawned from within a scheduler stay on it since they
+  /// usually share its sockets and timers. A thread may only wait on
+  /// waitables of its own scheduler, but Barrier::open and Channel::put may be
+  /// called from any scheduler of the group.
+  ///
+  /// The first scheduler runs on the thread calling run. The group is done
+  /// once no thread is left on any of its schedulers, frozen ones included.
+  /// The other schedulers are then terminated.
+  class SchedulerGroup
+    : public elle::Printable
+  {
+  /*-------------.
+  | Construction |
+  `-------------*/
+  public:
+    /// Create a group of \a size schedulers, one per core if 0.
+    SchedulerGroup(int size = 0);
+    ~SchedulerGroup();
+
+  /*----------.
+  | Accessors |
+  `----------*/
+  public:
+    /// The scheduler run by the calling thread.
+    Scheduler&
+    front();
+    /// Number of schedulers.
+    int
+    size() const;
+  private:
+    ELLE_ATTRIBUTE(std::vector<std::unique_ptr<Scheduler>>, schedulers);
+
+  /*----.
+  | Run |
+  `----*/
+  public:
+    /// Run all schedulers until no thread is left on any of them.
+    ///
+    /// \throw Whatever escaped a scheduler first.
+    void
+    run();
+    /// Run \a f in a new thread on an idle scheduler if any, the next one in
+    /// line otherwise. Thread safe.
+    ///
+    /// \param name Descriptive name of the thread, for debugging.
+    /// \param f    Action of the thread.
+    void
+    run_later(std::string const& name, std::function<void ()> const& f);
+  private:
+    friend class Scheduler;
+    friend class Thread;
+    /// Forget a thread that is done, waking the first scheduler if it was
+    /// the last one. Thread safe.
+    void
+    _release();
+    /// Move starting threads of other schedulers to \a thief.
+    ///
+    /// \return Whether any thread was stolen.
+    bool
+    _steal(Scheduler& thief);
+    ELLE_ATTRIBUTE(std::atomic<unsigned>, next);
+    /// Threads of all our schedulers that are not done yet.
+    ELLE_ATTRIBUTE(std::atomic<unsigned>, threads);
+
+  /*----------.
+  | Printable |
+  `----------*/
+  public:
+    void
+    print(std::ostream& s) const override;
+  };
+}
@@ -33,7 +33,8 @@ namespace reactor
 
   Thread&
   Scope::run_background(std::string const& name,
-                        Thread::Action a)
+                        Thread::Action a,
+                        std::size_t stack_size)
   {
     if (this->_exception)
     {
@@ -88,7 +89,8 @@ namespace reactor
               ELLE_WARN("%s: exception already caught, losing exception: %s",
                         *this, elle::exception_string());
           }
-        });
+        },
+        reactor::stack_size = stack_size);
     this->_threads.push_back(thread);
     thread->on_signaled().connect([this]
                                   {
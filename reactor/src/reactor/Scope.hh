@@ -43,11 +43,13 @@ namespace reactor
     /// If an exception escapes \a a, all other threads are killed and waiting
     /// the Scope re-throws the exception.
     ///
-    /// \param name The name of the managed thread.
-    /// \param a    The action run by the managed thread.
+    /// \param name       The name of the managed thread.
+    /// \param a          The action run by the managed thread.
+    /// \param stack_size Stack size hint, 0 for the scheduler default.
     Thread&
     run_background(std::string const& name,
-                   Thread::Action a);
+                   Thread::Action a,
+                   std::size_t stack_size = 0);
     void
     terminate_now();
   private:
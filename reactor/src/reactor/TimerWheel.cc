@@ -0,0 +1,218 @@
+#include <reactor/TimerWheel.hh>
+
+#include <algorithm>
+
+#include <elle/assert.hh>
+#include <elle/log.hh>
+
+ELLE_LOG_COMPONENT("reactor.TimerWheel");
+
+namespace reactor
+{
+  /*------.
+  | Entry |
+  `------*/
+
+  TimerWheel::Entry::Entry()
+    : _wheel(nullptr)
+    , _expiration(0)
+    , _action()
+  {}
+
+  TimerWheel::Entry::~Entry()
+  {
+    this->cancel();
+  }
+
+  bool
+  TimerWheel::Entry::armed() const
+  {
+    return this->is_linked();
+  }
+
+  void
+  TimerWheel::Entry::cancel()
+  {
+    if (this->is_linked())
+    {
+      this->unlink();
+      --this->_wheel->_size;
+      this->_action = nullptr;
+    }
+  }
+
+  /*-------------.
+  | Construction |
+  `-------------*/
+
+  TimerWheel::TimerWheel(boost::asio::io_service& service, Duration tick)
+    : _tick(tick)
+    , _size(0)
+    , _origin(Clock::now())
+    , _current(0)
+    , _slots()
+    , _timer(service)
+    , _wakeup()
+  {
+    ELLE_ASSERT_GT(tick.total_microseconds(), 0);
+  }
+
+  TimerWheel::~TimerWheel()
+  {
+    // Leave remaining entries unarmed.
+    for (auto& level: this->_slots)
+      for (auto& slot: level)
+        slot.clear();
+  }
+
+  /*-------.
+  | Timers |
+  `-------*/
+
+  void
+  TimerWheel::arm(Entry& entry, Duration delay, Action action)
+  {
+    entry.cancel();
+    auto const tick = this->_tick.total_microseconds();
+    auto const deadline = std::max<std::int64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - this->_origin).count() + delay.total_microseconds(),
+      0);
+    entry._wheel = this;
+    // Round up: never fire early.
+    entry._expiration = (deadline + tick - 1) / tick;
+    entry._action = std::move(action);
+    this->_insert(entry);
+    ++this->_size;
+  }
+
+  void
+  TimerWheel::expire()
+  {
+    auto const now = this->_now();
+    while (this->_size && this->_current <= now)
+    {
+      auto const index = this->_current & mask;
+      if (!index)
+        for (int level = 1; level < levels; ++level)
+        {
+          auto const slot = (this->_current >> (bits * level)) & mask;
+          this->_cascade(level, slot);
+          if (slot)
+            break;
+        }
+      Slot expired;
+      expired.splice(expired.end(), this->_slots[0][index]);
+      ++this->_current;
+      // Actions may cancel or arm other entries, including expired ones.
+      while (!expired.empty())
+      {
+        auto& entry = expired.front();
+        expired.pop_front();
+        --this->_size;
+        auto action = std::move(entry._action);
+        entry._action = nullptr;
+        ELLE_DUMP("%s: expire entry %s", *this, &entry);
+        action();
+      }
+    }
+    // Slots are relative to the current tick: skip ahead over empty ones.
+    if (!this->_size)
+      this->_current = std::max(this->_current, now + 1);
+  }
+
+  void
+  TimerWheel::wakeup()
+  {
+    auto const next = this->_next();
+    if (!next || (this->_wakeup && *this->_wakeup <= *next))
+      return;
+    this->_wakeup = next;
+    auto const delay = std::chrono::duration_cast<std::chrono::microseconds>(
+      this->_origin +
+      std::chrono::microseconds(*next * this->_tick.total_microseconds()) -
+      Clock::now());
+    ELLE_DEBUG("%s: wake up in %sus", *this, delay.count());
+    this->_timer.expires_from_now(
+      boost::posix_time::microseconds(std::max<std::int64_t>(delay.count(), 0)));
+    this->_timer.async_wait(
+      [this] (boost::system::error_code const& error)
+      {
+        if (error == boost::asio::error::operation_aborted)
+          return;
+        this->_wakeup.reset();
+        this->expire();
+      });
+  }
+
+  std::uint64_t
+  TimerWheel::_now() const
+  {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+      Clock::now() - this->_origin).count() /
+      this->_tick.total_microseconds();
+  }
+
+  void
+  TimerWheel::_insert(Entry& entry)
+  {
+    auto const expiration = std::max(entry._expiration, this->_current);
+    auto const delta = expiration - this->_current;
+    int level = 0;
+    while (level < levels - 1 && delta >> (bits * (level + 1)))
+      ++level;
+    // Entries beyond the wheel span wait on the last slot to be cascaded.
+    auto const slot = delta >> (bits * levels) ?
+      (this->_current >> (bits * level)) + mask :
+      expiration >> (bits * level);
+    this->_slots[level][slot & mask].push_back(entry);
+  }
+
+  void
+  TimerWheel::_cascade(int level, std::uint64_t slot)
+  {
+    Slot cascaded;
+    cascaded.splice(cascaded.end(), this->_slots[level][slot]);
+    while (!cascaded.empty())
+    {
+      auto& entry = cascaded.front();
+      cascaded.pop_front();
+      this->_insert(entry);
+    }
+  }
+
+  boost::optional<std::uint64_t>
+  TimerWheel::_next() const
+  {
+    if (!this->_size)
+      return {};
+    for (int level = 0; level < levels; ++level)
+    {
+      auto const shift = bits * level;
+      auto const base = this->_current >> (shift + bits) << (shift + bits);
+      // Upper slots under the current position were cascaded already, unless
+      // we stand right on their boundary.
+      auto start = (this->_current >> shift) & mask;
+      if (level && this->_current & ((std::uint64_t(1) << shift) - 1))
+        ++start;
+      for (auto slot = start; slot < slots; ++slot)
+        if (!this->_slots[level][slot].empty())
+          return base + (slot << shift);
+      // Wrapped slots are cascaded from the next boundary on.
+      for (std::uint64_t slot = 0; slot < start; ++slot)
+        if (!this->_slots[level][slot].empty())
+          return base + (slots << shift);
+    }
+    return {};
+  }
+
+  /*----------.
+  | Printable |
+  `----------*/
+
+  void
+  TimerWheel::print(std::ostream& s) const
+  {
+    s << "TimerWheel(" << this->_size << " entries)";
+  }
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+#include <boost/intrusive/list.hpp>
+#include <boost/optional.hpp>
+
+#include <elle/Printable.hh>
+#include <elle/attribute.hh>
+
+#include <reactor/asio.hh>
+#include <reactor/duration.hh>
+#include <reactor/fwd.hh>
+
+namespace reactor
+{
+  /// Hierarchical timing wheel.
+  ///
+  /// Deadlines are rounded up to the next tick, so entries never fire early
+  /// but may fire up to a tick late. Each level has 64 slots covering 64
+  /// times the span of a slot of the level below; entries of the upper levels
+  /// are cascaded down as time goes. Arming and cancelling are O(1), and
+  /// expired entries are fired in batch by expire, which the owning Scheduler
+  /// calls once per round.
+  class TimerWheel
+    : public elle::Printable
+  {
+  /*------.
+  | Types |
+  `------*/
+  public:
+    using Clock = std::chrono::steady_clock;
+    using Action = std::function<void ()>;
+    /// Position of a timer in the wheel, cancelled upon destruction.
+    class Entry
+      : public boost::intrusive::list_base_hook<
+          boost::intrusive::link_mode<boost::intrusive::auto_unlink>>
+    {
+    public:
+      Entry();
+      Entry(Entry const&) = delete;
+      ~Entry();
+      /// Whether this waits for expiration.
+      bool
+      armed() const;
+      /// Forget the action unless it already fired.
+      void
+      cancel();
+    private:
+      friend class TimerWheel;
+      ELLE_ATTRIBUTE(TimerWheel*, wheel);
+      ELLE_ATTRIBUTE(std::uint64_t, expiration);
+      ELLE_ATTRIBUTE(Action, action);
+    };
+
+  /*-------------.
+  | Construction |
+  `-------------*/
+  public:
+    /// Create a wheel of resolution \a tick, waking \a service up on
+    /// expirations.
+    TimerWheel(boost::asio::io_service& service, Duration tick);
+    ~TimerWheel();
+    /// Resolution of the wheel.
+    ELLE_ATTRIBUTE_R(Duration, tick);
+    /// Number of armed entries.
+    ELLE_ATTRIBUTE_R(std::size_t, size);
+
+  /*-------.
+  | Timers |
+  `-------*/
+  public:
+    /// Run \a action once \a delay has elapsed, cancelling \a entry first.
+    void
+    arm(Entry& entry, Duration delay, Action action);
+    /// Fire all expired entries.
+    void
+    expire();
+    /// Make the asio service return by the next expiration, for a blocking
+    /// poll not to oversleep.
+    void
+    wakeup();
+  private:
+    /// Current tick.
+    std::uint64_t
+    _now() const;
+    /// Store \a entry in the slot matching its expiration.
+    void
+    _insert(Entry& entry);
+    /// Redispatch entries of \a slot of \a level.
+    void
+    _cascade(int level, std::uint64_t slot);
+    /// Tick by which the next entry must be expired or cascaded.
+    boost::optional<std::uint64_t>
+    _next() const;
+    static int constexpr bits = 6;
+    static int constexpr levels = 4;
+    static std::uint64_t constexpr slots = 1 << bits;
+    static std::uint64_t constexpr mask = slots - 1;
+    using Slot = boost::intrusive::list<
+      Entry, boost::intrusive::constant_time_size<false>>;
+    ELLE_ATTRIBUTE(Clock::time_point, origin);
+    /// Next tick to expire.
+    ELLE_ATTRIBUTE(std::uint64_t, current);
+    ELLE_ATTRIBUTE((std::array<std::array<Slot, slots>, levels>), slots);
+    ELLE_ATTRIBUTE(boost::asio::deadline_timer, timer);
+    /// Tick the timer is armed for.
+    ELLE_ATTRIBUTE(boost::optional<std::uint64_t>, wakeup);
+
+  /*----------.
+  | Printable |
+  `----------*/
+  public:
+    void
+    print(std::ostream& s) const override;
+  };
+}
@@ -0,0 +1,587 @@
+#include <reactor/Uring.hh>
+
+#ifdef INFINIT_LINUX
+# include <algorithm>
+# include <cerrno>
+# include <cstdint>
+# include <cstring>
+# include <deque>
+# include <vector>
+
+# include <linux/io_uring.h>
+# include <sys/mman.h>
+# include <sys/socket.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
+#include <elle/assert.hh>
+#include <elle/log.hh>
+#include <elle/memory.hh>
+
+ELLE_LOG_COMPONENT("reactor.Uring");
+
+// Features we rely on are all in Linux 5.8: poll-driven socket requests, reads
+// at the current file position and no dropped completions.
+#if defined(INFINIT_LINUX) && defined(__NR_io_uring_setup) && \
+  defined(IORING_FEAT_FAST_POLL) && defined(IORING_SQ_CQ_OVERFLOW)
+# define REACTOR_IO_URING
+#endif
+
+namespace reactor
+{
+  /*--------.
+  | Request |
+  `--------*/
+
+  Uring::Request::Request()
+    : _handler()
+    , _uring(nullptr)
+    , _pending(false)
+    , _canceled(false)
+    , _skipped(false)
+    , _fd(-1)
+    , _sqe(nullptr)
+  {}
+
+  Uring::Request::~Request()
+  {
+    ELLE_ASSERT(!this->_pending);
+  }
+
+  bool
+  Uring::Request::pending() const
+  {
+    return this->_pending;
+  }
+
+#ifdef REACTOR_IO_URING
+
+  /*-----.
+  | Impl |
+  `-----*/
+
+  struct Uring::Impl
+  {
+    Impl(boost::asio::io_service& service, int fd)
+      : descriptor(service, fd)
+      , sq_ring(MAP_FAILED)
+      , sq_ring_size(0)
+      , cq_ring(MAP_FAILED)
+      , cq_ring_size(0)
+      , sqes(static_cast<io_uring_sqe*>(MAP_FAILED))
+      , sqes_size(0)
+      , tail(0)
+      , queued()
+      , overflow()
+    {}
+
+    ~Impl()
+    {
+      if (this->sqes != MAP_FAILED)
+        ::munmap(this->sqes, this->sqes_size);
+      if (this->cq_ring != MAP_FAILED && this->cq_ring != this->sq_ring)
+        ::munmap(this->cq_ring, this->cq_ring_size);
+      if (this->sq_ring != MAP_FAILED)
+        ::munmap(this->sq_ring, this->sq_ring_size);
+    }
+
+    template <typename T>
+    static
+    T*
+    at(void* ring, std::size_t offset)
+    {
+      return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+    }
+
+    int
+    fd()
+    {
+      return this->descriptor.native_handle();
+    }
+
+    /// Whether completions await reaping.
+    bool
+    completed() const
+    {
+      return *this->cq_head != __atomic_load_n(this->cq_tail, __ATOMIC_ACQUIRE);
+    }
+
+    /// Whether every submission slot is taken.
+    bool
+    full() const
+    {
+      return this->tail - __atomic_load_n(this->sq_head, __ATOMIC_ACQUIRE)
+        == *this->sq_entries;
+    }
+
+    boost::asio::posix::stream_descriptor descriptor;
+    void* sq_ring;
+    std::size_t sq_ring_size;
+    void* cq_ring;
+    std::size_t cq_ring_size;
+    io_uring_sqe* sqes;
+    std::size_t sqes_size;
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_entries;
+    unsigned* sq_flags;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    io_uring_cqe* cqes;
+    /// Submission tail, published upon submission.
+    unsigned tail;
+    /// Requests whose entries the kernel did not consume yet, in order, null
+    /// for cancellations.
+    std::vector<Request*> queued;
+    /// Entries prepared while every submission slot was taken, moved to the
+    /// ring upon submission.
+    std::deque<io_uring_sqe> overflow;
+  };
+
+  /*-------------.
+  | Construction |
+  `-------------*/
+
+  std::unique_ptr<Uring>
+  Uring::open(boost::asio::io_service& service, unsigned entries)
+  {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof params);
+    int fd = ::syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0)
+    {
+      ELLE_TRACE("io_uring unavailable: %s", std::strerror(errno));
+      return nullptr;
+    }
+    auto required = IORING_FEAT_NODROP | IORING_FEAT_FAST_POLL |
+      IORING_FEAT_RW_CUR_POS;
+    if ((params.features & required) != required)
+    {
+      ELLE_TRACE("io_uring lacks required features: %x", params.features);
+      ::close(fd);
+      return nullptr;
+    }
+    // The descriptor owns the file descriptor from now on.
+    auto impl = std::make_unique<Impl>(service, fd);
+    impl->sq_ring_size =
+      params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    impl->cq_ring_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single)
+      impl->sq_ring_size = impl->cq_ring_size =
+        std::max(impl->sq_ring_size, impl->cq_ring_size);
+    impl->sq_ring = ::mmap(nullptr, impl->sq_ring_size,
+                           PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                           fd, IORING_OFF_SQ_RING);
+    if (impl->sq_ring == MAP_FAILED)
+    {
+      ELLE_WARN("unable to map io_uring submission ring: %s",
+                std::strerror(errno));
+      return nullptr;
+    }
+    if (single)
+      impl->cq_ring = impl->sq_ring;
+    else
+    {
+      impl->cq_ring = ::mmap(nullptr, impl->cq_ring_size,
+                             PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                             fd, IORING_OFF_CQ_RING);
+      if (impl->cq_ring == MAP_FAILED)
+      {
+        ELLE_WARN("unable to map io_uring completion ring: %s",
+                  std::strerror(errno));
+        return nullptr;
+      }
+    }
+    impl->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    impl->sqes = static_cast<io_uring_sqe*>(
+      ::mmap(nullptr, impl->sqes_size,
+             PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+             fd, IORING_OFF_SQES));
+    if (impl->sqes == MAP_FAILED)
+    {
+      ELLE_WARN("unable to map io_uring submission entries: %s",
+                std::strerror(errno));
+      return nullptr;
+    }
+    auto sq = impl->sq_ring;
+    impl->sq_head = Impl::at<unsigned>(sq, params.sq_off.head);
+    impl->sq_tail = Impl::at<unsigned>(sq, params.sq_off.tail);
+    impl->sq_mask = Impl::at<unsigned>(sq, params.sq_off.ring_mask);
+    impl->sq_entries = Impl::at<unsigned>(sq, params.sq_off.ring_entries);
+    impl->sq_flags = Impl::at<unsigned>(sq, params.sq_off.flags);
+    auto cq = impl->cq_ring;
+    impl->cq_head = Impl::at<unsigned>(cq, params.cq_off.head);
+    impl->cq_tail = Impl::at<unsigned>(cq, params.cq_off.tail);
+    impl->cq_mask = Impl::at<unsigned>(cq, params.cq_off.ring_mask);
+    impl->cqes = Impl::at<io_uring_cqe>(cq, params.cq_off.cqes);
+    impl->tail = *impl->sq_tail;
+    // Submission slots map one to one to entries.
+    auto array = Impl::at<unsigned>(sq, params.sq_off.array);
+    for (unsigned i = 0; i < params.sq_entries; ++i)
+      array[i] = i;
+    impl->queued.reserve(params.sq_entries);
+    ELLE_TRACE("io_uring enabled with %s entries", params.sq_entries);
+    return std::unique_ptr<Uring>(new Uring(service, std::move(impl)));
+  }
+
+  Uring::Uring(boost::asio::io_service& service, std::unique_ptr<Impl> impl)
+    : _impl(std::move(impl))
+    , _pending(0)
+    , _service(service)
+    , _waiting(false)
+    , _requests()
+  {}
+
+  Uring::~Uring()
+  {}
+
+  /*---------.
+  | Requests |
+  `---------*/
+
+  io_uring_sqe&
+  Uring::_prepare(Request* request, int opcode, int fd, Handler handler)
+  {
+    auto& impl = *this->_impl;
+    // Submitting or reaping here would run handlers in the middle of the
+    // caller's operation: hold the entry until the scheduler submits.
+    bool const overflow = !impl.overflow.empty() || impl.full();
+    if (overflow)
+      impl.overflow.emplace_back();
+    auto& sqe =
+      overflow ? impl.overflow.back() : impl.sqes[impl.tail++ & *impl.sq_mask];
+    std::memset(&sqe, 0, sizeof sqe);
+    sqe.opcode = opcode;
+    sqe.fd = fd;
+    sqe.user_data = reinterpret_cast<std::uintptr_t>(request);
+    if (request)
+    {
+      ELLE_ASSERT(!request->_pending);
+      request->_handler = std::move(handler);
+      request->_uring = this;
+      request->_pending = true;
+      request->_canceled = false;
+      request->_skipped = false;
+      request->_fd = fd;
+      request->_sqe = &sqe;
+      ++this->_pending;
+      this->_requests.emplace(fd, request);
+    }
+    if (!overflow)
+      impl.queued.push_back(request);
+    return sqe;
+  }
+
+  void
+  Uring::read(Request& request, int fd, void* data, std::size_t size,
+              Handler handler)
+  {
+    auto& sqe = this->_prepare(&request, IORING_OP_READ, fd, std::move(handler));
+    sqe.addr = reinterpret_cast<std::uintptr_t>(data);
+    sqe.len = size;
+    // Read at the current position of files, ignored by sockets.
+    sqe.off = -1;
+  }
+
+  void
+  Uring::write(Request& request, int fd, void const* data, std::size_t size,
+               Handler handler)
+  {
+    auto& sqe =
+      this->_prepare(&request, IORING_OP_WRITE, fd, std::move(handler));
+    sqe.addr = reinterpret_cast<std::uintptr_t>(data);
+    sqe.len = size;
+    sqe.off = -1;
+  }
+
+  void
+  Uring::receive(Request& request, int fd, msghdr* message, Handler handler)
+  {
+    auto& sqe =
+      this->_prepare(&request, IORING_OP_RECVMSG, fd, std::move(handler));
+    sqe.addr = reinterpret_cast<std::uintptr_t>(message);
+    sqe.len = 1;
+  }
+
+  void
+  Uring::send(Request& request, int fd, msghdr const* message,
+              Handler handler)
+  {
+    auto& sqe =
+      this->_prepare(&request, IORING_OP_SENDMSG, fd, std::move(handler));
+    sqe.addr = reinterpret_cast<std::uintptr_t>(message);
+    sqe.len = 1;
+    sqe.msg_flags = MSG_NOSIGNAL;
+  }
+
+  void
+  Uring::cancel(Request& request)
+  {
+    if (!request._pending || request._canceled)
+      return;
+    ELLE_DEBUG("%s: cancel request %s", *this, &request);
+    request._canceled = true;
+    if (request._sqe)
+    {
+      // Not submitted yet: complete it right away instead.
+      auto& sqe = *request._sqe;
+      auto user_data = sqe.user_data;
+      std::memset(&sqe, 0, sizeof sqe);
+      sqe.opcode = IORING_OP_NOP;
+      sqe.user_data = user_data;
+      request._skipped = true;
+    }
+    else
+    {
+      // Completions of cancellations carry no request.
+      auto& sqe =
+        this->_prepare(nullptr, IORING_OP_ASYNC_CANCEL, -1, nullptr);
+      sqe.addr = reinterpret_cast<std::uintptr_t>(&request);
+    }
+  }
+
+  void
+  Uring::cancel(int fd)
+  {
+    auto range = this->_requests.equal_range(fd);
+    if (range.first == range.second)
+      return;
+    ELLE_TRACE("%s: cancel requests on descriptor %s", *this, fd);
+    for (auto it = range.first; it != range.second; ++it)
+      this->cancel(*it->second);
+  }
+
+  void
+  Uring::submit()
+  {
+    auto& impl = *this->_impl;
+    while (this->_submit() && !impl.overflow.empty())
+      ;
+  }
+
+  bool
+  Uring::_submit()
+  {
+    auto& impl = *this->_impl;
+    while (!impl.overflow.empty() && !impl.full())
+    {
+      auto& sqe = impl.sqes[impl.tail++ & *impl.sq_mask];
+      sqe = impl.overflow.front();
+      impl.overflow.pop_front();
+      auto request = reinterpret_cast<Request*>(sqe.user_data);
+      if (request)
+        request->_sqe = &sqe;
+      impl.queued.push_back(request);
+    }
+    auto const count = impl.queued.size();
+    if (!count)
+      return false;
+    ELLE_DEBUG("%s: submit %s requests", *this, count);
+    __atomic_store_n(impl.sq_tail, impl.tail, __ATOMIC_RELEASE);
+    int res;
+    do
+      res = ::syscall(__NR_io_uring_enter, impl.fd(), count, 0, 0,
+                      nullptr, 0);
+    while (res < 0 && errno == EINTR);
+    if (res < 0)
+    {
+      // Out of resources or completion slots: retry next round.
+      if (errno == EAGAIN || errno == EBUSY)
+      {
+        ELLE_DEBUG("%s: submission deferred: %s", *this, std::strerror(errno));
+        return false;
+      }
+      // The ring is unusable for these requests: take them back and fail
+      // them rather than the whole process.
+      auto const error = errno;
+      ELLE_ERR("%s: submission failed: %s", *this, std::strerror(error));
+      impl.tail -= count;
+      __atomic_store_n(impl.sq_tail, impl.tail, __ATOMIC_RELEASE);
+      std::vector<Request*> failed;
+      failed.swap(impl.queued);
+      impl.queued.reserve(failed.capacity());
+      for (auto request: failed)
+        if (request)
+        {
+          request->_sqe = nullptr;
+          this->_complete(*request, -error);
+        }
+      return false;
+    }
+    for (int i = 0; i < res; ++i)
+      if (auto request = impl.queued[i])
+        request->_sqe = nullptr;
+    impl.queued.erase(impl.queued.begin(), impl.queued.begin() + res);
+    return res > 0;
+  }
+
+  std::size_t
+  Uring::reap()
+  {
+    auto& impl = *this->_impl;
+    std::size_t n = 0;
+    while (true)
+    {
+      if (!impl.completed())
+      {
+        // Completions the ring could not hold are kept by the kernel until we
+        // ask for them.
+        if (!(__atomic_load_n(impl.sq_flags, __ATOMIC_ACQUIRE) &
+              IORING_SQ_CQ_OVERFLOW))
+          break;
+        ::syscall(__NR_io_uring_enter, impl.fd(), 0, 0,
+                  IORING_ENTER_GETEVENTS, nullptr, 0);
+        if (!impl.completed())
+          break;
+      }
+      auto head = *impl.cq_head;
+      auto const& cqe = impl.cqes[head & *impl.cq_mask];
+      auto request = reinterpret_cast<Request*>(cqe.user_data);
+      auto res = cqe.res;
+      // Release the slot before running handlers, which may queue requests.
+      __atomic_store_n(impl.cq_head, head + 1, __ATOMIC_RELEASE);
+      if (!request)
+        continue;
+      ++n;
+      this->_complete(*request, res);
+    }
+    return n;
+  }
+
+  void
+  Uring::_complete(Request& request, int res)
+  {
+    --this->_pending;
+    {
+      auto range = this->_requests.equal_range(request._fd);
+      for (auto it = range.first; it != range.second; ++it)
+        if (it->second == &request)
+        {
+          this->_requests.erase(it);
+          break;
+        }
+    }
+    // Requests cancelled before submission were replaced with no-ops.
+    if (request._skipped)
+      res = -ECANCELED;
+    request._pending = false;
+    auto handler = std::move(request._handler);
+    request._handler = nullptr;
+    ELLE_DUMP("%s: request %s completed: %s", *this, &request, res);
+    handler(res);
+  }
+
+  void
+  Uring::wakeup()
+  {
+    if (!this->_pending)
+      return;
+    if (this->_impl->completed())
+    {
+      this->_service.post([this] { this->reap(); });
+      return;
+    }
+    if (this->_waiting)
+      return;
+    this->_waiting = true;
+    this->_impl->descriptor.async_read_some(
+      boost::asio::null_buffers(),
+      [this] (boost::system::error_code const& e, std::size_t)
+      {
+        // Closing the ring aborts the wait, and this may be gone.
+        if (e == boost::asio::error::operation_aborted)
+          return;
+        this->_waiting = false;
+        this->reap();
+      });
+  }
+
+#else
+
+  struct Uring::Impl
+  {};
+
+  std::unique_ptr<Uring>
+  Uring::open(boost::asio::io_service&, unsigned)
+  {
+    return nullptr;
+  }
+
+  Uring::~Uring()
+  {}
+
+  void
+  Uring::read(Request&, int, void*, std::size_t, Handler)
+  {
+    elle::unreachable();
+  }
+
+  void
+  Uring::write(Request&, int, void const*, std::size_t, Handler)
+  {
+    elle::unreachable();
+  }
+
+  void
+  Uring::receive(Request&, int, msghdr*, Handler)
+  {
+    elle::unreachable();
+  }
+
+  void
+  Uring::send(Request&, int, msghdr const*, Handler)
+  {
+    elle::unreachable();
+  }
+
+  void
+  Uring::cancel(Request&)
+  {
+    elle::unreachable();
+  }
+
+  void
+  Uring::cancel(int)
+  {
+    elle::unreachable();
+  }
+
+  void
+  Uring::submit()
+  {}
+
+  std::size_t
+  Uring::reap()
+  {
+    return 0;
+  }
+
+  void
+  Uring::wakeup()
+  {}
+
+#endif
+
+  boost::system::error_code
+  Uring::error(int result)
+  {
+    if (result >= 0)
+      return {};
+    return boost::system::error_code(-result, boost::system::system_category());
+  }
+
+  /*----------.
+  | Printable |
+  `----------*/
+
+  void
+  Uring::print(std::ostream& s) const
+  {
+    s << "Uring(" << this->_pending << " pending)";
+  }
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+#include <elle/Printable.hh>
+#include <elle/attribute.hh>
+
+#include <reactor/asio.hh>
+
+struct io_uring_sqe;
+struct msghdr;
+
+namespace reactor
+{
+  /// io_uring submission and completion rings.
+  ///
+  /// Requests are queued as they are started and submitted in batch by
+  /// submit, which the owning Scheduler calls at the end of each round;
+  /// completions are harvested by reap at the start of the next one. Handlers
+  /// run in the scheduler context, like asio callbacks.
+  class Uring
+    : public elle::Printable
+  {
+  /*------.
+  | Types |
+  `------*/
+  public:
+    /// Completion handler, given a byte count or a negated errno.
+    using Handler = std::function<void (int)>;
+    /// A request, which must outlive its completion.
+    class Request
+    {
+    public:
+      Request();
+      Request(Request const&) = delete;
+      ~Request();
+      /// Whether this waits for completion.
+      bool
+      pending() const;
+    private:
+      friend class Uring;
+      ELLE_ATTRIBUTE(Handler, handler);
+      /// The ring it was last queued on.
+      ELLE_ATTRIBUTE_R(Uring*, uring);
+      ELLE_ATTRIBUTE(bool, pending);
+      ELLE_ATTRIBUTE(bool, canceled);
+      /// Whether it was replaced with a no-op before submission.
+      ELLE_ATTRIBUTE(bool, skipped);
+      ELLE_ATTRIBUTE(int, fd);
+      /// Submission entry, until submitted.
+      ELLE_ATTRIBUTE(io_uring_sqe*, sqe);
+    };
+
+  /*-------------.
+  | Construction |
+  `-------------*/
+  public:
+    /// A ring of \a entries submission slots waking \a service up upon
+    /// completions, or null if the kernel does not support io_uring.
+    static
+    std::unique_ptr<Uring>
+    open(boost::asio::io_service& service, unsigned entries);
+    ~Uring();
+  private:
+    struct Impl;
+    Uring(boost::asio::io_service& service, std::unique_ptr<Impl> impl);
+    ELLE_ATTRIBUTE(std::unique_ptr<Impl>, impl);
+    /// Number of requests awaiting completion.
+    ELLE_ATTRIBUTE_R(std::size_t, pending);
+
+  /*---------.
+  | Requests |
+  `---------*/
+  public:
+    /// Read up to \a size bytes from \a fd.
+    void
+    read(Request& request, int fd, void* data, std::size_t size,
+         Handler handler);
+    /// Write up to \a size bytes to \a fd.
+    void
+    write(Request& request, int fd, void const* data, std::size_t size,
+          Handler handler);
+    /// Receive a message from socket \a fd.
+    void
+    receive(Request& request, int fd, msghdr* message, Handler handler);
+    /// Send a message on socket \a fd.
+    void
+    send(Request& request, int fd, msghdr const* message, Handler handler);
+    /// Complete \a request with -ECANCELED, unless it completes first.
+    void
+    cancel(Request& request);
+    /// Cancel all requests on \a fd.  The kernel holds its own reference to
+    /// descriptors, so closing one does not end its requests.
+    void
+    cancel(int fd);
+    /// Submit queued requests, including those queued while the submission
+    /// ring was full. Should the kernel refuse them for another reason than a
+    /// temporary lack of resources, they complete with its error.
+    void
+    submit();
+    /// Run handlers of completed requests.
+    std::size_t
+    reap();
+    /// Make the asio service return upon completion, for a blocking poll not
+    /// to oversleep.
+    void
+    wakeup();
+    /// The error code matching a negated errno \a result.
+    static
+    boost::system::error_code
+    error(int result);
+  private:
+    /// Queue an entry for \a request, held back if the ring is full: handlers
+    /// only ever run from submit and reap.
+    io_uring_sqe&
+    _prepare(Request* request, int opcode, int fd, Handler handler);
+    /// Move held back entries to the ring and submit it, returning whether
+    /// the kernel consumed any.
+    bool
+    _submit();
+    /// Unregister \a request and run its handler with \a res.
+    void
+    _complete(Request& request, int res);
+    ELLE_ATTRIBUTE(boost::asio::io_service&, service);
+    ELLE_ATTRIBUTE(bool, waiting);
+    /// Pending requests by descriptor.
+    ELLE_ATTRIBUTE((std::unordered_multimap<int, Request*>), requests);
+
+  /*----------.
+  | Printable |
+  `----------*/
+  public:
+    void
+    print(std::ostream& s) const override;
+  };
+}
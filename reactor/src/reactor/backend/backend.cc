@@ -25,6 +25,16 @@ namespace reactor
     Backend::~Backend()
     {}
 
+    /*-------.
+    | Stacks |
+    `-------*/
+
+    StackStatistics
+    Backend::stack_statistics() const
+    {
+      return StackStatistics{0, 0, 0};
+    }
+
     /*-------------.
     | Construction |
     `-------------*/
@@ -52,5 +62,21 @@ namespace reactor
     {
       this->_status = status;
     }
+
+    /*-------.
+    | Stacks |
+    `-------*/
+
+    std::size_t
+    Thread::stack_size() const
+    {
+      return 0;
+    }
+
+    std::size_t
+    Thread::stack_high_water_mark() const
+    {
+      return 0;
+    }
   }
 }
@@ -1,6 +1,7 @@
 #ifndef REACTOR_BACKEND_BACKEND_HH
 # define REACTOR_BACKEND_BACKEND_HH
 
+# include <cstddef>
 # include <functional>
 # include <memory>
 # include <string>
@@ -15,6 +16,20 @@ namespace reactor
   {
     class Thread;
 
+    /// Memory usage of the coroutine stacks of a Backend.
+    struct StackStatistics
+    {
+      /// Number of stacks currently owned by a thread.
+      std::size_t live;
+      /// Number of released stacks kept for reuse.
+      std::size_t pooled;
+      /// Number of stack bytes mapped and not handed back to the kernel.
+      ///
+      /// This bounds the physical memory used by stacks, it does not measure
+      /// it: pages are only committed when first touched.
+      std::size_t reserved;
+    };
+
     /** Pool of thread that can switch execution.
      *
      * All thread are affiliated with a Manager, and can only switch
@@ -36,14 +51,27 @@ namespace reactor
     `--------*/
     public:
       /// Create a new thread.
+      ///
+      /// \param stack_size Size of the thread stack, 0 for the backend
+      ///                   default. It is clamped to the backend bounds.
       virtual
       std::unique_ptr<backend::Thread>
       make_thread(const std::string& name,
-                  Action action) = 0;
+                  Action action,
+                  std::size_t stack_size = 0) = 0;
       /// The currently running thread.
       virtual
       Thread*
       current() const = 0;
+
+    /*-------.
+    | Stacks |
+    `-------*/
+    public:
+      /// Memory usage of our threads stacks, if the backend tracks it.
+      virtual
+      StackStatistics
+      stack_statistics() const;
     };
 
     class Thread
@@ -92,6 +120,19 @@ namespace reactor
       void
       status(Status status);
 
+    /*-------.
+    | Stacks |
+    `-------*/
+    public:
+      /// Size of our stack, 0 if unknown.
+      virtual
+      std::size_t
+      stack_size() const;
+      /// Deepest stack usage observed so far, 0 if stacks are not probed.
+      virtual
+      std::size_t
+      stack_high_water_mark() const;
+
     /*----------.
     | Switching |
     `----------*/
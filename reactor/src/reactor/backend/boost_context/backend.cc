@@ -1,3 +1,14 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
 #include <boost/context/fcontext.hpp>
 
 #ifdef VALGRIND
@@ -5,10 +16,14 @@
 #endif
 
 #include <elle/Backtrace.hh>
+#include <elle/Error.hh>
 #include <elle/assert.hh>
 #include <elle/log.hh>
+#include <elle/os/environ.hh>
+#include <elle/printf.hh>
 
 #include <reactor/backend/boost_context/backend.hh>
+#include <reactor/environ.hh>
 #include <reactor/exception.hh>
 
 ELLE_LOG_COMPONENT("reactor.backend");
@@ -44,47 +59,256 @@ namespace reactor
         {
           return Min;
         }
+      };
 
-        void*
-        allocate(std::size_t size) const
+      /// Default allocator type.
+      typedef TemplatedStackAllocator<
+        8 * 1024 * 1024,  // Max: 8 MiB
+        4 * 128 * 1024,       // Default: 128 kiB
+        8 * 1024          // Min: 8 kiB
+        > StackAllocator;
+
+      /*-----------.
+      | Stack Pool |
+      `-----------*/
+
+      namespace
+      {
+        std::size_t
+        page_size()
         {
-          ELLE_ASSERT(minimum_stack_size() <= size);
-          ELLE_ASSERT(maximum_stack_size() >= size);
+          static std::size_t const res = ::sysconf(_SC_PAGESIZE);
+          return res;
+        }
 
-          void* limit = std::malloc(size);
-          if (!limit)
-            throw std::bad_alloc();
+        /// Maximum number of mappings of the process.
+        std::size_t
+        max_map_count()
+        {
+          std::size_t res = 65530;
+          std::ifstream("/proc/sys/vm/max_map_count") >> res;
+          return res;
+        }
 
-          return static_cast<char*>(limit) + size;
+        /// Stack size to use for a requested \a size, 0 meaning default.
+        std::size_t
+        stack_size(std::size_t size)
+        {
+          if (!size)
+            return StackAllocator::default_stack_size();
+          return std::min(std::max(size, StackAllocator::minimum_stack_size()),
+                          StackAllocator::maximum_stack_size());
         }
 
+        /// Pattern painted on probed stacks.
+        std::uint64_t const canary = 0xdeadbeefcafebabe;
+      }
+
+      /** Recycle mmap'd stacks across the threads of a Backend.
+       *
+       *  Every stack is preceded by a PROT_NONE guard page so an overflow
+       *  faults instead of silently corrupting the neighbouring mapping. Pages
+       *  are only committed by the kernel when first touched. Released stacks
+       *  are kept for reuse: up to the watermark they keep their pages, past it
+       *  the pages are handed back with MADV_DONTNEED, and past the capacity
+       *  the stack is unmapped altogether.
+       *
+       *  A guard page splits its stack in two mappings, which caps the number
+       *  of stacks to about half of vm.max_map_count. Past it, allocation
+       *  fails with an explicit error. Setting REACTOR_STACK_GUARDS to 0 drops
+       *  the guard pages to go further, at the cost of overflow protection.
+       *
+       *  If REACTOR_STACK_PROBE is set, stacks are painted with a canary
+       *  upon allocation so their high-water mark can be measured. This
+       *  commits every page of every stack: use it to size stacks, not in
+       *  production.
+       *
+       *  Threads may be created from other system threads (Scheduler::mt_run,
+       *  SchedulerGroup), hence the locking.
+       */
+      class Backend::StackPool
+      {
+      public:
+        StackPool()
+          : _free()
+          , _live(0)
+          , _pooled(0)
+          , _pooled_hot(0)
+          , _reserved(0)
+          , _capacity(env_number("REACTOR_STACK_POOL_CAPACITY", 1024, 0))
+          , _watermark(env_number("REACTOR_STACK_POOL_WATERMARK", 64, 0))
+          , _probe(elle::os::inenv("REACTOR_STACK_PROBE"))
+          , _guards(elle::os::getenv("REACTOR_STACK_GUARDS", "1") != "0")
+          , _mutex()
+        {}
+
+        ~StackPool()
+        {
+          for (auto& size: this->_free)
+            for (auto const& stack: size.second)
+              this->_unmap(stack.top, size.first);
+        }
+
+        /// Size actually reserved for a requested stack \a size.
+        static
+        std::size_t
+        round(std::size_t size)
+        {
+          auto const page = page_size();
+          return (size + page - 1) / page * page;
+        }
+
+        /// A stack of at least \a size bytes, as a pointer to its top.
+        void*
+        allocate(std::size_t size)
+        {
+          auto top = this->_allocate(size);
+          if (this->_probe)
+          {
+            size = round(size);
+            auto bottom = reinterpret_cast<std::uint64_t*>(
+              static_cast<char*>(top) - size);
+            std::fill(bottom, bottom + size / sizeof(canary), canary);
+          }
+          return top;
+        }
+
+        /// Deepest usage of the stack whose top is \a top, if probed.
+        std::size_t
+        high_water_mark(void* top, std::size_t size) const
+        {
+          if (!this->_probe)
+            return 0;
+          size = round(size);
+          auto end = static_cast<std::uint64_t const*>(top);
+          auto it = end - size / sizeof(canary);
+          while (it != end && *it == canary)
+            ++it;
+          return (end - it) * sizeof(canary);
+        }
+
+        /// Give back the stack whose top is \a top.
         void
-        deallocate(void* vp, std::size_t size) const
+        deallocate(void* top, std::size_t size)
+        {
+          ELLE_ASSERT(top);
+          size = round(size);
+          std::unique_lock<std::mutex> lock(this->_mutex);
+          ELLE_ASSERT_GT(this->_live, 0u);
+          --this->_live;
+          if (this->_pooled >= this->_capacity)
+          {
+            this->_reserved -= size;
+            this->_unmap(top, size);
+            return;
+          }
+          auto& stacks = this->_free[size];
+          if (this->_pooled_hot < this->_watermark)
+          {
+            // Hot stacks are reused first.
+            stacks.push_back(Stack{top, true});
+            ++this->_pooled_hot;
+          }
+          else
+          {
+            ::madvise(static_cast<char*>(top) - size, size, MADV_DONTNEED);
+            this->_reserved -= size;
+            stacks.push_front(Stack{top, false});
+          }
+          ++this->_pooled;
+        }
+
+        StackStatistics
+        statistics() const
         {
-          ELLE_ASSERT(vp);
-          ELLE_ASSERT(minimum_stack_size() <= size);
-          ELLE_ASSERT(maximum_stack_size() >= size);
+          std::unique_lock<std::mutex> lock(this->_mutex);
+          return StackStatistics{this->_live, this->_pooled, this->_reserved};
+        }
 
-          void* limit = static_cast<char*>(vp) - size;
-          std::free(limit);
+      private:
+        void*
+        _allocate(std::size_t size)
+        {
+          ELLE_ASSERT_LTE(StackAllocator::minimum_stack_size(), size);
+          ELLE_ASSERT_GTE(StackAllocator::maximum_stack_size(), size);
+          size = round(size);
+          std::unique_lock<std::mutex> lock(this->_mutex);
+          ++this->_live;
+          auto it = this->_free.find(size);
+          if (it != this->_free.end() && !it->second.empty())
+          {
+            auto stack = it->second.back();
+            it->second.pop_back();
+            --this->_pooled;
+            if (stack.hot)
+              --this->_pooled_hot;
+            else
+              this->_reserved += size;
+            return stack.top;
+          }
+          auto const guard = page_size();
+          void* base = ::mmap(nullptr, size + guard,
+                              PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                              -1, 0);
+          if (base == MAP_FAILED)
+          {
+            --this->_live;
+            throw std::bad_alloc();
+          }
+          if (this->_guards && ::mprotect(base, guard, PROT_NONE) != 0)
+          {
+            auto const error = errno;
+            ::munmap(base, size + guard);
+            --this->_live;
+            if (error == ENOMEM)
+              throw elle::Error(elle::sprintf(
+                "unable to guard stack %s: out of mappings "
+                "(vm.max_map_count = %s), raise vm.max_map_count or set "
+                "REACTOR_STACK_GUARDS=0 to drop stack guard pages",
+                this->_live + this->_pooled + 1, max_map_count()));
+            throw std::bad_alloc();
+          }
+          this->_reserved += size;
+          return static_cast<char*>(base) + guard + size;
+        }
+
+        void
+        _unmap(void* top, std::size_t size)
+        {
+          auto const guard = page_size();
+          ::munmap(static_cast<char*>(top) - size - guard, size + guard);
         }
+
+        struct Stack
+        {
+          void* top;
+          /// Whether its pages were kept rather than handed back.
+          bool hot;
+        };
+        /// Released stacks by size, most recently released last.
+        std::map<std::size_t, std::deque<Stack>> _free;
+        std::size_t _live;
+        std::size_t _pooled;
+        std::size_t _pooled_hot;
+        std::size_t _reserved;
+        /// Maximum number of pooled stacks.
+        std::size_t _capacity;
+        /// Maximum number of pooled stacks keeping their pages.
+        std::size_t _watermark;
+        /// Whether to paint stacks to measure their usage.
+        bool _probe;
+        /// Whether to protect a guard page below each stack.
+        bool _guards;
+        mutable std::mutex _mutex;
       };
 
       /*-------.
       | Thread |
       `-------*/
-      /// Default allocator type.
-      typedef TemplatedStackAllocator<
-        8 * 1024 * 1024,  // Max: 8 MiB
-        4 * 128 * 1024,       // Default: 128 kiB
-        8 * 1024          // Min: 8 kiB
-        > StackAllocator;
       /// Type of context pointer used.
       typedef boost::context::fcontext_t Context;
 
-      /// Allocator.
-      static StackAllocator stack_allocator;
-
       static
       void
       wrapped_run(intptr_t arg);
@@ -107,11 +331,13 @@ namespace reactor
       public:
         Thread(Backend& backend,
                const std::string& name,
-               Action action)
+               Action action,
+               std::size_t stack_size = 0)
           : Super(name, std::move(action))
           , _backend(backend)
-          , _stack_size(StackAllocator::default_stack_size())
-          , _stack_pointer(stack_allocator.allocate(this->_stack_size))
+          , _stacks(backend._stacks)
+          , _stack_size(boost_context::stack_size(stack_size))
+          , _stack_pointer(this->_stacks->allocate(this->_stack_size))
           , _context(
             make_fcontext(this->_stack_pointer, this->_stack_size, wrapped_run))
           , _caller(nullptr)
@@ -134,8 +360,7 @@ namespace reactor
           if (this->_context)
           {
             this->_context = nullptr;
-            stack_allocator.deallocate(this->_stack_pointer,
-                                       StackAllocator::default_stack_size());
+            this->_stacks->deallocate(this->_stack_pointer, this->_stack_size);
           }
           #ifdef VALGRIND
           VALGRIND_STACK_DEREGISTER(this->_valgrind_stack);
@@ -229,6 +454,25 @@ namespace reactor
         }
 
 
+      /*-------.
+      | Stacks |
+      `-------*/
+      public:
+        virtual
+        std::size_t
+        stack_size() const override
+        {
+          return this->_stack_size;
+        }
+
+        virtual
+        std::size_t
+        stack_high_water_mark() const override
+        {
+          return this->_stacks->high_water_mark(this->_stack_pointer,
+                                                this->_stack_size);
+        }
+
       /*--------.
       | Details |
       `--------*/
@@ -280,6 +524,8 @@ namespace reactor
 
         /// Owning backend.
         Backend& _backend;
+        /// Pool our stack is borrowed from.
+        std::shared_ptr<StackPool> _stacks;
         /// Context stack size.
         std::size_t _stack_size;
         /// Context stack pointer.
@@ -309,6 +555,7 @@ namespace reactor
       `--------*/
 
       Backend::Backend():
+        _stacks(std::make_shared<StackPool>()),
         _self(new Thread(*this)),
         _current(this->_self.get())
       {}
@@ -317,10 +564,12 @@ namespace reactor
       {}
 
       std::unique_ptr<backend::Thread>
-      Backend::make_thread(const std::string& name, Action action)
+      Backend::make_thread(const std::string& name,
+                           Action action,
+                           std::size_t stack_size)
       {
         return std::unique_ptr<backend::Thread>(
-          new Thread(*this, name, std::move(action)));
+          new Thread(*this, name, std::move(action), stack_size));
       }
 
       Thread*
@@ -328,6 +577,16 @@ namespace reactor
       {
         return this->_current;
       }
+
+      /*-------.
+      | Stacks |
+      `-------*/
+
+      StackStatistics
+      Backend::stack_statistics() const
+      {
+        return this->_stacks->statistics();
+      }
     }
   }
 }
@@ -21,6 +21,7 @@ namespace reactor
         typedef Backend Self;
         typedef reactor::backend::Backend Super;
         class Thread;
+        class StackPool;
 
       /*-------------.
       | Construction |
@@ -36,17 +37,28 @@ namespace reactor
         virtual
         std::unique_ptr<backend::Thread>
         make_thread(const std::string& name,
-                    Action action) override;
+                    Action action,
+                    std::size_t stack_size) override;
         virtual
         backend::Thread*
         current() const override;
 
+      /*-------.
+      | Stacks |
+      `-------*/
+      public:
+        virtual
+        StackStatistics
+        stack_statistics() const override;
+
       /*--------.
       | Details |
       `--------*/
       private:
         /// Let threads manipulate the current thread and the root thread.
         friend class Thread;
+        /// Stacks of our threads, shared with them since they may outlive us.
+        std::shared_ptr<StackPool> _stacks;
         /// Root thread, which instantiated the Backend.
         std::unique_ptr<Thread> _self;
         /// Current thread.
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include <elle/Backtrace.hh>
 #include <elle/assert.hh>
 #include <elle/log.hh>
@@ -38,13 +40,19 @@ namespace reactor
       public:
         Thread(Backend& backend,
                const std::string& name,
-               Action action):
+               Action action,
+               std::size_t stack_size = 0):
           Super(name, std::move(action)),
           _backend(backend),
           _coro(Coro_new()),
           _caller(nullptr),
           _root(false)
-        {}
+        {
+          if (stack_size)
+            Coro_setStackSize_(
+              this->_coro, std::max<std::size_t>(stack_size,
+                                                 CORO_STACK_SIZE_MIN));
+        }
 
         ~Thread()
         {
@@ -136,6 +144,17 @@ namespace reactor
         }
 
 
+      /*-------.
+      | Stacks |
+      `-------*/
+      public:
+        virtual
+        std::size_t
+        stack_size() const override
+        {
+          return Coro_stackSize(this->_coro);
+        }
+
       /*--------.
       | Details |
       `--------*/
@@ -214,10 +233,12 @@ namespace reactor
       {}
 
       std::unique_ptr<backend::Thread>
-      Backend::make_thread(const std::string& name, Action action)
+      Backend::make_thread(const std::string& name,
+                           Action action,
+                           std::size_t stack_size)
       {
         return std::unique_ptr<backend::Thread>(
-          new Thread(*this, name, std::move(action)));
+          new Thread(*this, name, std::move(action), stack_size));
       }
 
       Thread*
@@ -37,7 +37,9 @@ namespace reactor
       public:
         virtual
         std::unique_ptr<backend::Thread>
-        make_thread(const std::string& name, Action action) override;
+        make_thread(const std::string& name,
+                    Action action,
+                    std::size_t stack_size) override;
         virtual
         backend::Thread*
         current() const override;
@@ -0,0 +1,33 @@
+#include <reactor/environ.hh>
+
+#include <limits>
+#include <stdexcept>
+
+#include <elle/log.hh>
+#include <elle/os/environ.hh>
+
+ELLE_LOG_COMPONENT("reactor.environ");
+
+namespace reactor
+{
+  std::size_t
+  env_number(std::string const& name,
+             std::size_t default_,
+             std::size_t minimum)
+  {
+    auto const repr = elle::os::getenv(name, "");
+    if (repr.empty())
+      return default_;
+    if (repr.find_first_not_of("0123456789") == std::string::npos)
+      try
+      {
+        auto const res = std::stoull(repr);
+        if (res >= minimum && res <= std::numeric_limits<std::size_t>::max())
+          return res;
+      }
+      catch (std::out_of_range const&)
+      {}
+    ELLE_WARN("ignore invalid %s: %s, use %s instead", name, repr, default_);
+    return default_;
+  }
+}
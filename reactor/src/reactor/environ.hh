@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace reactor
+{
+  /// The number in environment variable \a name, or \a default_ if it is
+  /// unset. Malformed values and values below \a minimum are ignored with a
+  /// warning rather than making the reactor unconstructible.
+  std::size_t
+  env_number(std::string const& name,
+             std::size_t default_,
+             std::size_t minimum = 1);
+}
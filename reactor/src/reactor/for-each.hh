@@ -1,6 +1,10 @@
 #ifndef REACTOR_FOR_EACH_HH
 # define REACTOR_FOR_EACH_HH
 
+# include <iterator>
+# include <type_traits>
+# include <vector>
+
 # include <elle/Exception.hh>
 # include <elle/compiler.hh>
 # include <elle/With.hh>
@@ -16,10 +20,32 @@ namespace reactor
     Break();
   };
 
+  /// Run \a f on every element of \a c, each in its own thread.
+  ///
+  /// Elements only appear in thread names when the reactor.for_each log
+  /// component is active at debug level.
   template <typename C, typename F>
   void
   for_each_parallel(C& c, F const& f, std::string const& name = std::string{});
 
+  /// Run \a f on every element of \a c, in order, from at most \a concurrency
+  /// threads, 0 meaning one thread per element.
+  template <typename C, typename F>
+  void
+  for_each_parallel(C& c, F const& f, std::size_t concurrency,
+                    std::string const& name = std::string{});
+
+  /// The results of \a f on every element of \a c, in order, computed from at
+  /// most \a concurrency threads, 0 meaning one thread per element.
+  ///
+  /// \throw Break if \a f breaks.
+  template <typename C, typename F>
+  auto
+  transform_parallel(C& c, F const& f, std::size_t concurrency = 0,
+                     std::string const& name = std::string{})
+    -> std::vector<typename std::decay<
+         decltype(f(*std::begin(c)))>::type>;
+
   ELLE_COMPILER_ATTRIBUTE_NORETURN
   void
   break_parallel();
@@ -1,6 +1,12 @@
 #ifndef REACTOR_FOR_EACH_HXX
 # define REACTOR_FOR_EACH_HXX
 
+# include <algorithm>
+
+# include <boost/optional.hpp>
+
+# include <elle/log.hh>
+
 # include <reactor/Scope.hh>
 # include <reactor/scheduler.hh>
 
@@ -11,18 +17,54 @@ namespace reactor
     : elle::Exception("break")
   {}
 
+  namespace details
+  {
+    inline
+    std::string
+    for_each_prefix(std::string const& name)
+    {
+      return elle::sprintf("%s: %s",
+                           reactor::scheduler().current()->name(),
+                           name.empty() ? "for-each" : name);
+    }
+
+    inline
+    bool
+    for_each_verbose()
+    {
+      return elle::log::logger().component_is_active(
+        "reactor.for_each", elle::log::Logger::Level::debug);
+    }
+
+    /// An element of a transformation and its result, printed as the former.
+    template <typename E, typename R>
+    struct TransformSlot
+    {
+      E* element;
+      boost::optional<R> result;
+
+      friend
+      std::ostream&
+      operator <<(std::ostream& output, TransformSlot const& slot)
+      {
+        return output << *slot.element;
+      }
+    };
+  }
+
   template <typename C, typename F>
   void
   for_each_parallel(C& c, F const& f, std::string const& name)
   {
+    ELLE_LOG_COMPONENT("reactor.for_each");
+    // Format names once, unless someone looks at them.
+    auto const prefix = details::for_each_prefix(name);
+    bool const verbose = details::for_each_verbose();
     elle::With<reactor::Scope>(name) << [&] (reactor::Scope& scope)
     {
       for (auto& elt: c)
         scope.run_background(
-          elle::sprintf("%s: %s: %s",
-                        reactor::scheduler().current()->name(),
-                        name.empty() ? "for-each" : name,
-                        elt),
+          verbose ? elle::sprintf("%s: %s", prefix, elt) : prefix,
           [&]
           {
             try
@@ -38,6 +80,78 @@ namespace reactor
     };
   }
 
+  template <typename C, typename F>
+  void
+  for_each_parallel(C& c, F const& f, std::size_t concurrency,
+                    std::string const& name)
+  {
+    ELLE_LOG_COMPONENT("reactor.for_each");
+    using std::begin;
+    using std::end;
+    auto it = begin(c);
+    auto const last = end(c);
+    auto const size = std::distance(it, last);
+    if (!concurrency || size <= static_cast<decltype(size)>(concurrency))
+      return for_each_parallel(c, f, name);
+    auto const prefix = details::for_each_prefix(name);
+    elle::With<reactor::Scope>(name) << [&] (reactor::Scope& scope)
+    {
+      // Workers pull the next element until there are none left.
+      for (std::size_t i = 0; i < concurrency; ++i)
+        scope.run_background(
+          elle::sprintf("%s #%s", prefix, i),
+          [&]
+          {
+            while (it != last)
+            {
+              auto& elt = *it++;
+              ELLE_DEBUG("%s: run on %s", prefix, elt);
+              try
+              {
+                f(elt);
+              }
+              catch (Break const&)
+              {
+                scope.terminate_now();
+              }
+            }
+          });
+      reactor::wait(scope);
+    };
+  }
+
+  template <typename C, typename F>
+  auto
+  transform_parallel(C& c, F const& f, std::size_t concurrency,
+                     std::string const& name)
+    -> std::vector<typename std::decay<
+         decltype(f(*std::begin(c)))>::type>
+  {
+    using Element = typename std::remove_reference<
+      decltype(*std::begin(c))>::type;
+    using Result = typename std::decay<decltype(f(*std::begin(c)))>::type;
+    std::vector<details::TransformSlot<Element, Result>> slots;
+    for (auto& elt: c)
+      slots.push_back({&elt, boost::none});
+    for_each_parallel(
+      slots,
+      [&] (details::TransformSlot<Element, Result>& slot)
+      {
+        slot.result = f(*slot.element);
+      },
+      concurrency,
+      name);
+    std::vector<Result> res;
+    res.reserve(slots.size());
+    for (auto& slot: slots)
+    {
+      if (!slot.result)
+        throw Break();
+      res.emplace_back(std::move(slot.result.get()));
+    }
+    return res;
+  }
+
   inline
   void
   break_parallel()
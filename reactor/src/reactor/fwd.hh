@@ -15,17 +15,23 @@ namespace reactor
   class Mutex;
   class Operation;
   class Scheduler;
+  class SchedulerGroup;
   class Semaphore;
   class Signal;
   class Sleep;
   class Thread;
   class TimeoutGuard;
+  class Uring;
   template <typename R = void>
   class VThread;
   class Waitable;
 
   typedef std::vector<Signal*> Signals;
   typedef std::vector<Waitable*> Waitables;
+
+  /// The current scheduler.
+  Scheduler&
+  scheduler();
 }
 
 #endif
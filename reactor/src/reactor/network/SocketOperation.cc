@@ -20,7 +20,8 @@ namespace reactor
       AsioSocket& socket):
       Operation(*reactor::Scheduler::scheduler()),
       _socket(socket),
-      _canceled(false)
+      _canceled(false),
+      _request()
     {}
 
     template <typename AsioSocket>
@@ -29,13 +30,18 @@ namespace reactor
     {
       ELLE_TRACE_SCOPE("%s: abort", *this);
       this->_canceled = true;
-      boost::system::error_code ec;
-      this->_socket.cancel(ec);
-      // Cancel may fail if for instance the socket was closed manually. If
-      // cancel fails, assume the operation is de facto cancelled and we can
-      // carry on. I know of no case were we "were not actually able to
-      // cancel the operation".
-      (void) ec;
+      if (this->_request.pending())
+        this->_request.uring()->cancel(this->_request);
+      else
+      {
+        boost::system::error_code ec;
+        this->_socket.cancel(ec);
+        // Cancel may fail if for instance the socket was closed manually. If
+        // cancel fails, assume the operation is de facto cancelled and we can
+        // carry on. I know of no case were we "were not actually able to
+        // cancel the operation".
+        (void) ec;
+      }
       reactor::wait(*this);
     }
 
@@ -3,6 +3,7 @@
 
 # include <boost/asio.hpp>
 
+# include <reactor/Uring.hh>
 # include <reactor/network/exception.hh>
 # include <reactor/network/socket.hh>
 # include <reactor/operation.hh>
@@ -30,6 +31,8 @@ namespace reactor
 
       ELLE_ATTRIBUTE_R(AsioSocket&, socket);
       ELLE_ATTRIBUTE_R(bool, canceled);
+      /// Request in flight when going through io_uring.
+      ELLE_ATTRIBUTE(Uring::Request, request, protected);
     };
 
 
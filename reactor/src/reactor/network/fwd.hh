@@ -12,6 +12,7 @@ namespace reactor
   namespace network
   {
     class Buffer;
+    class HttpServer;
     template <typename AsioSocket, typename EndPoint>
     class PlainSocket;
     class Server;
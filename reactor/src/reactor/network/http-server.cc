@@ -168,7 +168,9 @@ namespace reactor
                          this, elle::exception_string());
                 throw;
               }
-            });
+            },
+            // Leave room for JSON validation and route handlers.
+            64 * 1024);
         }
       };
     }
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cstring>
+
 #include <boost/asio/ssl.hpp>
 #include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
@@ -53,6 +56,32 @@ namespace reactor
 
     namespace
     {
+      /// The io_uring of the scheduler whose service runs \a stream, unless
+      /// \a Stream layers over the socket, as SSL does.
+      template <typename Stream>
+      Uring*
+      plain_uring(Stream& stream)
+      {
+        if (!std::is_same<
+              Stream, typename SocketSpecialization<Stream>::Socket>::value)
+          return nullptr;
+        auto scheduler = Scheduler::scheduler();
+        if (scheduler && &stream.get_io_service() == &scheduler->io_service())
+          return scheduler->uring();
+        return nullptr;
+      }
+
+      /// Cancel io_uring requests on \a socket before closing it: the kernel
+      /// holds its own reference to the descriptor, so closing would not end
+      /// them.
+      template <typename Socket>
+      void
+      cancel_uring(Uring* uring, Socket& socket)
+      {
+        if (uring && socket.is_open())
+          uring->cancel(socket.native_handle());
+      }
+
       size_t constexpr buffer_size = 1 << 16;
 
       class StreamBuffer
@@ -115,6 +144,17 @@ namespace reactor
           return EOF + 1;
         }
 
+        /// Hand over buffered data, which stays valid until the next write.
+        elle::ConstWeakBuffer
+        take()
+        {
+          Size size = pptr() - pbase();
+          setp(0, 0);
+          if (this->_pacified)
+            return {};
+          return elle::ConstWeakBuffer(this->write_buffer, size);
+        }
+
         int
         sync() override
         {
@@ -166,6 +206,33 @@ namespace reactor
       static_cast<StreamBuffer*>(this->rdbuf())->pacified(true);
     }
 
+    /*------.
+    | Write |
+    `------*/
+
+    void
+    Socket::writev(Buffers const& buffers)
+    {
+      Buffers all;
+      all.reserve(buffers.size() + 1);
+      // Coalesce what was streamed so far, typically headers.
+      auto pending = static_cast<StreamBuffer*>(this->rdbuf())->take();
+      if (!pending.empty())
+        all.emplace_back(pending);
+      for (auto const& buffer: buffers)
+        if (!buffer.empty())
+          all.emplace_back(buffer);
+      if (!all.empty())
+        this->_writev(all);
+    }
+
+    void
+    Socket::_writev(Buffers const& buffers)
+    {
+      for (auto const& buffer: buffers)
+        this->write(buffer);
+    }
+
     /*----------------.
     | Pretty printing |
     `----------------*/
@@ -187,6 +254,7 @@ namespace reactor
       : Super()
       , _socket(std::move(socket))
       , _peer()
+      , _uring(plain_uring(*this->_socket))
     {}
 
     template <typename AsioSocket, typename EndPoint>
@@ -197,6 +265,7 @@ namespace reactor
       : Super()
       , _socket(std::move(socket))
       , _peer(peer)
+      , _uring(plain_uring(*this->_socket))
     {
       this->_connect(peer, timeout);
     }
@@ -208,6 +277,7 @@ namespace reactor
       : Super()
       , _socket(std::move(socket))
       , _peer(peer)
+      , _uring(plain_uring(*this->_socket))
     {}
 
     template <typename AsioSocket, typename EndPoint>
@@ -215,6 +285,7 @@ namespace reactor
       : Super() // FIXME: this drops the IOStream buffers !
       , _socket(std::move(src._socket))
       , _peer(std::move(src._peer))
+      , _uring(src._uring)
     {}
 
     template <typename AsioSocket, typename EndPoint>
@@ -303,6 +374,7 @@ namespace reactor
       socket.cancel(e);
       if (e && e != boost::asio::error::bad_descriptor)
         throw Exception(e.message());
+      cancel_uring(this->_uring, socket);
       socket.close();
     }
 
@@ -335,6 +407,7 @@ namespace reactor
             throw Exception(error.message());
           }
         }
+        cancel_uring(this->_uring, Spe::socket(*this->_socket));
         Spe::socket(*this->_socket).close();
       }
     }
@@ -461,7 +534,9 @@ namespace reactor
       _start() override
       {
         // FIXME: be synchronous if enough bytes are available
-        if (this->_some)
+        if (auto uring = this->_socket.uring())
+          this->_uring_read(*uring);
+        else if (this->_some)
           this->_socket.socket()->async_read_some(
             boost::asio::buffer(this->_buffer.mutable_contents(),
                                 this->_buffer.size()),
@@ -475,6 +550,32 @@ namespace reactor
       }
 
     private:
+      void
+      _uring_read(Uring& uring)
+      {
+        auto const size = this->_buffer.size() - this->_read;
+        uring.read(
+          this->_request,
+          this->socket().native_handle(),
+          this->_buffer.mutable_contents() + this->_read,
+          size,
+          [this, size] (int res)
+          {
+            auto error = Uring::error(res);
+            if (res == 0 && size)
+              error = boost::asio::error::eof;
+            auto const read = this->_read + std::max(res, 0);
+            if (!error && !this->canceled() && !this->_some &&
+                read < this->_buffer.size())
+            {
+              this->_read = read;
+              this->_uring_read(*this->_socket.uring());
+            }
+            else
+              this->_wakeup(error, read);
+          });
+      }
+
       void
       _wakeup(const boost::system::error_code& error,
               std::size_t read)
@@ -519,6 +620,9 @@ namespace reactor
                        some ? "up to " : "",
                        buf.size(),
                        timeout ? elle::sprintf(" in %s", timeout.get()): "");
+      // Bytes served from the read_until buffer, reported along with the
+      // ones read from the socket.
+      unsigned cached = 0;
       if (this->_streambuffer.size())
       {
         std::istream s(&this->_streambuffer);
@@ -536,11 +640,12 @@ namespace reactor
         else if (size)
           ELLE_TRACE("%s: read %s cached bytes, carrying on", *this, size);
         buf = buf.range(size);
+        cached = size;
       }
       using Spe = SocketSpecialization<AsioSocket>;
-      auto read = Read<Self, typename Spe::Socket> (*this,
-                                                    Spe::socket(*this->socket()),
-                                                    buf, some);
+      Read<Self, typename Spe::Socket> read(*this,
+                                            Spe::socket(*this->socket()),
+                                            buf, some);
       bool finished;
       try
       {
@@ -550,14 +655,14 @@ namespace reactor
       {
         ELLE_TRACE("%s: read threw: %s", *this, elle::exception_string());
         if (bytes_read)
-          *bytes_read = read.read();
+          *bytes_read = cached + read.read();
         throw;
       }
       if (!finished)
       {
         ELLE_TRACE("%s: read timed out", *this);
         if (bytes_read)
-          *bytes_read = read.read();
+          *bytes_read = cached + read.read();
         throw TimeOut();
       }
       ELLE_TRACE("%s: completed read of %s bytes", *this, read.read());
@@ -571,8 +676,8 @@ namespace reactor
         });
       ELLE_DUMP("%s: data: 0x%s", *this, hex);
       if (bytes_read)
-        *bytes_read = read.read();
-      return read.read();
+        *bytes_read = cached + read.read();
+      return cached + read.read();
     }
 
     template <typename PlainSocket, typename AsioSocket>
@@ -679,24 +784,93 @@ namespace reactor
       Write(PlainSocket& plain,
             AsioSocket& socket,
             elle::ConstWeakBuffer buffer):
+        Write(plain, socket, reactor::network::Socket::Buffers{buffer})
+      {}
+
+      Write(PlainSocket& plain,
+            AsioSocket& socket,
+            reactor::network::Socket::Buffers buffers):
         Super(Spe::socket(socket)),
         _socket(plain),
-        _buffer(buffer),
+        _buffers(std::move(buffers)),
+        _size(0),
         _written(0)
-      {}
+      {
+        for (auto const& buffer: this->_buffers)
+          this->_size += buffer.size();
+      }
 
     protected:
       virtual
       void
       _start() override
       {
-        boost::asio::async_write(
-          *this->_socket.socket(),
-          boost::asio::buffer(this->_buffer.contents(), this->_buffer.size()),
-          boost::bind(&Write::_wakeup, this, _1, _2));
+        if (auto uring = this->_socket.uring())
+          this->_uring_write(*uring);
+        else
+        {
+          std::vector<boost::asio::const_buffer> buffers;
+          buffers.reserve(this->_buffers.size());
+          for (auto const& buffer: this->_buffers)
+            buffers.emplace_back(buffer.contents(), buffer.size());
+          boost::asio::async_write(
+            *this->_socket.socket(),
+            buffers,
+            boost::bind(&Write::_wakeup, this, _1, _2));
+        }
       }
 
     private:
+      void
+      _uring_write(Uring& uring)
+      {
+        auto handler = [this] (int res)
+          {
+            auto const written = this->_written + std::max(res, 0);
+            if (res >= 0 && !this->canceled() && written < this->_size)
+            {
+              this->_written = written;
+              this->_uring_write(*this->_socket.uring());
+            }
+            else
+              this->_wakeup(Uring::error(res), written);
+          };
+        if (this->_buffers.size() == 1)
+        {
+          auto const& buffer = this->_buffers.front();
+          uring.write(this->_request,
+                      this->socket().native_handle(),
+                      buffer.contents() + this->_written,
+                      buffer.size() - this->_written,
+                      std::move(handler));
+          return;
+        }
+#ifdef INFINIT_LINUX
+        // Gather the bytes left to write.
+        this->_iovs.clear();
+        auto skip = this->_written;
+        for (auto const& buffer: this->_buffers)
+          if (skip >= buffer.size())
+            skip -= buffer.size();
+          else
+          {
+            this->_iovs.push_back(
+              iovec{const_cast<elle::Byte*>(buffer.contents()) + skip,
+                    buffer.size() - skip});
+            skip = 0;
+          }
+        std::memset(&this->_message, 0, sizeof this->_message);
+        this->_message.msg_iov = this->_iovs.data();
+        this->_message.msg_iovlen = this->_iovs.size();
+        uring.send(this->_request,
+                   this->socket().native_handle(),
+                   &this->_message,
+                   std::move(handler));
+#else
+        elle::unreachable();
+#endif
+      }
+
       void
       _wakeup(const boost::system::error_code& error, std::size_t written)
       {
@@ -712,8 +886,13 @@ namespace reactor
       }
 
       ELLE_ATTRIBUTE(PlainSocket const&, socket);
-      ELLE_ATTRIBUTE(elle::ConstWeakBuffer, buffer);
+      ELLE_ATTRIBUTE(reactor::network::Socket::Buffers, buffers);
+      ELLE_ATTRIBUTE(Size, size);
       ELLE_ATTRIBUTE_R(Size, written);
+#ifdef INFINIT_LINUX
+      ELLE_ATTRIBUTE(std::vector<iovec>, iovs);
+      ELLE_ATTRIBUTE(msghdr, message);
+#endif
     };
 
     template <typename AsioSocket, typename EndPoint>
@@ -726,6 +905,16 @@ namespace reactor
       write.run();
     }
 
+    template <typename AsioSocket, typename EndPoint>
+    void
+    StreamSocket<AsioSocket, EndPoint>::_writev(Socket::Buffers const& buffers)
+    {
+      Lock lock(this->_write_mutex);
+      ELLE_TRACE_SCOPE("%s: write %s buffers", *this, buffers.size());
+      Write<Self, AsioSocket> write(*this, *this->socket(), buffers);
+      write.run();
+    }
+
     /*------------------------.
     | Explicit instantiations |
     `------------------------*/
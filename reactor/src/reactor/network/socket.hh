@@ -1,6 +1,8 @@
 #ifndef INFINIT_REACTOR_NETWORK_SOCKET_HH
 # define INFINIT_REACTOR_NETWORK_SOCKET_HH
 
+# include <vector>
+
 # include <elle/Buffer.hh>
 # include <elle/IOStream.hh>
 # include <elle/attribute.hh>
@@ -27,6 +29,8 @@ namespace reactor
     public:
       /// Self type.
       using Self = Socket;
+      /// Buffers written as their concatenation.
+      using Buffers = std::vector<elle::ConstWeakBuffer>;
 
     /*----------.
     | Constants |
@@ -70,6 +74,16 @@ namespace reactor
       virtual
       void
       write(elle::ConstWeakBuffer buffer) = 0;
+      /// Write data pending in the stream followed by \a buffers, in a single
+      /// gather operation where the socket supports it.
+      void
+      writev(Buffers const& buffers);
+    protected:
+      /// Write \a buffers, none of which is empty. Write them in turn by
+      /// default.
+      virtual
+      void
+      _writev(Buffers const& buffers);
 
     /*-----.
     | Read |
@@ -185,6 +199,9 @@ namespace reactor
       friend class SocketOperation;
       ELLE_ATTRIBUTE_R(std::unique_ptr<AsioSocket>, socket);
       EndPoint _peer;
+      /// The io_uring of the scheduler serving the socket, if any and unless
+      /// the stream layers over the socket, as SSL does.
+      ELLE_ATTRIBUTE_R(Uring*, uring);
     };
 
     template <typename AsioSocket,
@@ -260,6 +277,8 @@ namespace reactor
       void
       write(elle::ConstWeakBuffer buffer) override;
     protected:
+      void
+      _writev(Socket::Buffers const& buffers) override;
       void
       _final_flush();
     private:
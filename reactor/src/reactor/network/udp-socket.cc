@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cstring>
+
 #include <boost/lexical_cast.hpp>
 
 #include <reactor/network/exception.hh>
@@ -146,7 +149,7 @@ namespace reactor
       else
         ELLE_TRACE("%s: read at most %s bytes",
                        *this, buffer.size());
-      auto read = UDPRead(scheduler(), this, buffer);
+      UDPRead read(scheduler(), this, buffer);
       if (!read.run(timeout))
         throw TimeOut();
       if (bytes_read)
@@ -169,6 +172,7 @@ namespace reactor
           , _buffer(buffer)
           , _read(0)
           , _endpoint(endpoint)
+          , _uring(socket->uring())
         {}
 
         virtual const char* type_name() const
@@ -190,7 +194,27 @@ namespace reactor
           auto wake = [&] (boost::system::error_code const e, std::size_t w) {
             this->_wakeup(e, w);
           };
-
+#ifdef INFINIT_LINUX
+          if (auto uring = this->_uring)
+          {
+            this->_iov.iov_base = this->_buffer.mutable_contents();
+            this->_iov.iov_len = this->_buffer.size();
+            std::memset(&this->_message, 0, sizeof this->_message);
+            this->_message.msg_name = this->_endpoint.data();
+            this->_message.msg_namelen = this->_endpoint.capacity();
+            this->_message.msg_iov = &this->_iov;
+            this->_message.msg_iovlen = 1;
+            uring->receive(
+              this->_request, this->socket().native_handle(), &this->_message,
+              [this, wake] (int res)
+              {
+                if (res >= 0)
+                  this->_endpoint.resize(this->_message.msg_namelen);
+                wake(Uring::error(res), std::max(res, 0));
+              });
+            return;
+          }
+#endif
           this->socket().async_receive_from(
             boost::asio::buffer(_buffer.mutable_contents(), _buffer.size()),
             this->_endpoint,
@@ -218,6 +242,11 @@ namespace reactor
         elle::WeakBuffer& _buffer;
         Size _read;
         boost::asio::ip::udp::endpoint &_endpoint;
+        Uring* _uring;
+#ifdef INFINIT_LINUX
+        iovec _iov;
+        msghdr _message;
+#endif
     };
 
     Size
@@ -231,7 +260,7 @@ namespace reactor
       else
         ELLE_TRACE("%s: read at most %s bytes",
                        *this, buffer.size());
-      auto recvfrom = UDPRecvFrom(scheduler(), this, buffer, endpoint);
+      UDPRecvFrom recvfrom(scheduler(), this, buffer, endpoint);
       if (!recvfrom.run(timeout))
         throw TimeOut();
       return recvfrom.read();
@@ -294,7 +323,8 @@ namespace reactor
           Super(*socket->socket()),
           _buffer(buffer),
           _written(0),
-          _endpoint(endpoint)
+          _endpoint(endpoint),
+          _uring(socket->uring())
         {}
 
       protected:
@@ -303,6 +333,25 @@ namespace reactor
           auto wake = [&] (boost::system::error_code const e, std::size_t w) {
             this->_wakeup(e, w);
           };
+#ifdef INFINIT_LINUX
+          if (auto uring = this->_uring)
+          {
+            this->_iov.iov_base = const_cast<elle::Byte*>(_buffer.contents());
+            this->_iov.iov_len = _buffer.size();
+            std::memset(&this->_message, 0, sizeof this->_message);
+            this->_message.msg_name = this->_endpoint.data();
+            this->_message.msg_namelen = this->_endpoint.size();
+            this->_message.msg_iov = &this->_iov;
+            this->_message.msg_iovlen = 1;
+            uring->send(
+              this->_request, this->socket().native_handle(), &this->_message,
+              [wake] (int res)
+              {
+                wake(Uring::error(res), std::max(res, 0));
+              });
+            return;
+          }
+#endif
           auto buffer = boost::asio::buffer(_buffer.contents(), _buffer.size());
           this->socket().async_send_to(buffer, this->_endpoint, wake);
         }
@@ -323,6 +372,11 @@ namespace reactor
         elle::ConstWeakBuffer& _buffer;
         Size _written;
         EndPoint _endpoint;
+        Uring* _uring;
+#ifdef INFINIT_LINUX
+        iovec _iov;
+        msghdr _message;
+#endif
     };
 
     void
@@ -344,7 +398,7 @@ namespace reactor
       if (endpoint.address().is_v4() && this->local_endpoint().address().is_v6())
         endpoint = EndPoint(boost::asio::ip::address_v6::v4_mapped(endpoint.address().to_v4()), endpoint.port());
 
-      auto sendto = UDPSendTo(scheduler(), this, buffer, endpoint);
+      UDPSendTo sendto(scheduler(), this, buffer, endpoint);
       sendto.run();
     }
 
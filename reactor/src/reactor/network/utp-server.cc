@@ -537,7 +537,9 @@ namespace reactor
               // with.
             }
           }
-        });
+        },
+        // The datagram buffer lives on the heap, libutp callbacks are shallow.
+        reactor::stack_size = 32 * 1024);
       this->_checker.reset(new Thread("checker", [this] {
             try
             {
@@ -1,22 +1,25 @@
 #include <reactor/scheduler.hh>
 
+#include <algorithm>
+
 #include <elle/Measure.hh>
 #include <elle/Plugin.hh>
 #include <elle/assert.hh>
 #include <elle/attribute.hh>
 #include <elle/finally.hh>
 #include <elle/log.hh>
-#include <elle/make-vector.hh>
 #include <elle/memory.hh>
 #include <elle/os/environ.hh>
 
 #include <reactor/BackgroundOperation.hh>
+#include <reactor/SchedulerGroup.hh>
 #include <reactor/backend/backend.hh>
 #if defined REACTOR_CORO_BACKEND_IO
 # include <reactor/backend/coro_io/backend.hh>
 #elif defined REACTOR_CORO_BACKEND_BOOST_CONTEXT
 # include <reactor/backend/boost_context/backend.hh>
 #endif
+#include <reactor/environ.hh>
 #include <reactor/exception.hh>
 #include <reactor/operation.hh>
 #include <reactor/thread.hh>
@@ -42,12 +45,18 @@ namespace reactor
 
   Scheduler::Scheduler()
     : _done(false)
+    // Anything below a page cannot be a stack.
+    , _default_stack_size(env_number("REACTOR_STACK_SIZE", 0, 4096))
     , _shallstop(false)
     , _current(0)
     , _starting()
     , _starting_mtx()
+    , _starting_pending(false)
     , _running()
     , _frozen()
+    , _round(0)
+    , _group(nullptr)
+    , _idle(false)
     , _background_service()
     , _background_service_work(
         new boost::asio::io_service::work(this->_background_service))
@@ -55,6 +64,14 @@ namespace reactor
     , _background_pool_free(0)
     , _io_service()
     , _io_service_work(new boost::asio::io_service::work(this->_io_service))
+    , _timers(this->_io_service,
+              boost::posix_time::milliseconds(
+                env_number("REACTOR_TIMER_TICK", 1)))
+    , _uring(elle::os::getenv("REACTOR_IO_URING", "0") != "0" ?
+             Uring::open(
+               this->_io_service,
+               env_number("REACTOR_IO_URING_ENTRIES", 256))
+             : nullptr)
 #if defined(REACTOR_CORO_BACKEND_IO)
     , _manager(new backend::coro_io::Backend())
 #elif defined(REACTOR_CORO_BACKEND_BOOST_CONTEXT)
@@ -62,7 +79,7 @@ namespace reactor
 #else
 # error "REACTOR_CORO_BACKEND not defined"
 #endif
-    , _running_thread()
+    , _running_thread(std::thread::id())
   {
     this->_eptr = nullptr;
     plugins::logger_indentation.load();
@@ -162,6 +179,13 @@ namespace reactor
         if (thread.terminating())
           std::cerr << " (terminating)";
         std::cerr << std::endl;
+        if (auto size = thread._thread->stack_size())
+        {
+          std::cerr << "    stack: ";
+          if (auto used = thread._thread->stack_high_water_mark())
+            std::cerr << used << " of ";
+          std::cerr << size << " bytes" << std::endl;
+        }
         std::cerr << "    waiting:" << std::endl;
         for (auto t: thread.waited())
           std::cerr << "      " << *t << std::endl;
@@ -172,23 +196,32 @@ namespace reactor
         // FIXME: Indent the backtrace
         std::cerr << thread.backtrace() << std::endl;
       };
+    {
+      auto const stacks = this->_manager->stack_statistics();
+      std::cerr << "== STACKS ==" << std::endl;
+      std::cerr << "  live: " << stacks.live << std::endl;
+      std::cerr << "  pooled: " << stacks.pooled << std::endl;
+      std::cerr << "  reserved: " << stacks.reserved << " bytes" << std::endl;
+    }
     if (!this->_frozen.empty())
     {
       std::cerr << "== FROZEN THREADS ==" << std::endl;
-      for (auto thread: this->_frozen)
-        print_thread(*thread);
+      for (auto const& thread: this->_frozen)
+        print_thread(thread);
     }
     if (!this->_running.empty())
     {
       std::cerr << "== RUNNING THREADS ==" << std::endl;
-      for (auto thread: this->_running)
-        print_thread(*thread);
+      for (auto const& thread: this->_running)
+        print_thread(thread);
     }
+    // Threads may be started from other system threads.
+    std::unique_lock<std::mutex> lock(this->_starting_mtx);
     if (!this->_starting.empty())
     {
       std::cerr << "== STARTING THREADS ==" << std::endl;
-      for (auto thread: this->_starting)
-        print_thread(*thread);
+      for (auto const& thread: this->_starting)
+        print_thread(thread);
     }
   }
 
@@ -249,54 +282,64 @@ namespace reactor
     std::rethrow_exception(this->_eptr);
   }
 
-  namespace
+  static
+  std::ostream&
+  operator <<(std::ostream& output, Scheduler::ThreadList const& threads)
   {
-    std::ostream&
-    operator <<(std::ostream& output, Scheduler::Threads const& threads)
+    bool first = true;
+    output << "[";
+    for (auto const& thread: threads)
     {
-      bool first = true;
-      output << "[";
-      for (auto thread: threads)
-      {
-        if (first)
-          first = false;
-        else
-          output << ", ";
-        output << *thread;
-      }
-      output << "]";
-      return output;
+      if (first)
+        first = false;
+      else
+        output << ", ";
+      output << thread;
     }
+    output << "]";
+    return output;
   }
 
   bool
   Scheduler::step()
   {
     PushScheduler p(this);
-    // Could avoid locking if no jobs are pending with a boolean.
+    if (this->_starting_pending.exchange(false))
     {
       std::unique_lock<std::mutex> lock(this->_starting_mtx);
-      auto& ordered = this->_starting.get<1>();
-      this->_running.insert(ordered.begin(), ordered.end());
-      this->_starting.clear();
+      for (auto& thread: this->_starting)
+        thread._starting = false;
+      this->_running.splice(this->_running.end(), this->_starting);
     }
-    auto& ordered = this->_running.get<1>();
-    auto running = make_vector(ordered);
-    ELLE_TRACE_SCOPE("Scheduler: new round with %s jobs", running.size());
+    // Reap before starting the round: woken threads are stamped with the
+    // current round, and would otherwise wait for the next one.
+    if (this->_uring)
+      if (auto n = this->_uring->reap())
+        ELLE_DEBUG("%s: %s io_uring requests completed", *this, n);
+    ++this->_round;
+    ELLE_TRACE_SCOPE("Scheduler: new round with %s jobs",
+                     this->_running.size());
 
     ELLE_DUMP("%s: starting: %s", *this, this->_starting);
     ELLE_DUMP("%s: running: %s", *this, this->_running);
     ELLE_DUMP("%s: frozen: %s", *this, this->_frozen);
     ELLE_MEASURE("Scheduler round")
-      for (Thread* t: running)
+      while (!this->_running.empty())
       {
-        // If the thread was stopped during this round, skip. Can be caused by
-        // terminate_now, for instance.
-        if (this->_running.find(t) == this->_running.end())
-          continue;
-        ELLE_TRACE("Scheduler: schedule %s", *t);
-        this->_step(t);
+        auto& t = this->_running.front();
+        // Threads queued during this round, including the ones we already
+        // stepped, come last.
+        if (t._round == this->_round)
+          break;
+        // Requeue beforehand: freezing or finishing merely unlinks it.
+        this->_running.pop_front();
+        t._round = this->_round;
+        this->_running.push_back(t);
+        ELLE_TRACE("Scheduler: schedule %s", t);
+        this->_step(&t);
       }
+    if (this->_uring)
+      this->_uring->submit();
     ELLE_TRACE("%s: run asynchronous jobs", *this)
     {
       ELLE_MEASURE_SCOPE("Asio callbacks");
@@ -305,6 +348,7 @@ namespace reactor
         this->_io_service.reset();
         auto n = this->_io_service.poll();
         ELLE_DEBUG("%s: %s callback called", *this, n);
+        this->_timers.expire();
       }
       catch (std::exception const& e)
       {
@@ -320,21 +364,35 @@ namespace reactor
         this->terminate();
       }
     }
-    if (this->_running.empty() && this->_starting.empty())
+    if (this->_running.empty() && !this->_starting_pending)
     {
-      if (this->_frozen.empty())
+      if (this->_group && !this->_shallstop && this->_group->_steal(*this))
+        ELLE_TRACE("%s: stole threads from %s", *this, *this->_group);
+      // Other members of a group wait for work until the group stops them,
+      // the first one until no thread is left on any member.
+      else if (this->_frozen.empty() &&
+               (!this->_group || this->_shallstop || this->_group_done()))
       {
         ELLE_TRACE_SCOPE("%s: no threads left, we're done", *this);
         return false;
       }
       else
-        while (this->_running.empty() && this->_starting.empty())
+        while (this->_running.empty() && !this->_starting_pending)
         {
           ELLE_TRACE_SCOPE("%s: nothing to do, "
                      "polling asio in a blocking fashion", *this);
           this->_io_service.reset();
           boost::system::error_code err;
+          this->_timers.wakeup();
+          if (this->_uring)
+          {
+            // Asio callbacks may have queued requests.
+            this->_uring->submit();
+            this->_uring->wakeup();
+          }
+          this->_idle = true;
           std::size_t run = this->_io_service.run_one(err);
+          this->_idle = false;
           ELLE_DEBUG("%s: %s callback called", *this, run);
           if (err)
           {
@@ -346,7 +404,10 @@ namespace reactor
             std::cerr << "ASIO service is dead." << std::endl;
             std::abort();
           }
-          if (this->_shallstop)
+          if (this->_shallstop || this->_group_done())
+            break;
+          if (this->_group && !this->_starting_pending &&
+              this->_group->_steal(*this))
             break;
         }
     }
@@ -382,7 +443,7 @@ namespace reactor
     if (thread->state() == Thread::state::done)
     {
       ELLE_TRACE("%s: %s finished", *this, *thread);
-      this->_running.erase(thread);
+      this->_running.erase(this->_running.iterator_to(*thread));
       thread->_scheduler_release();
     }
   }
@@ -401,9 +462,9 @@ namespace reactor
   Scheduler::_freeze(Thread& thread)
   {
     ELLE_ASSERT_EQ(thread.state(), Thread::state::running);
-    ELLE_ASSERT_NEQ(this->_running.find(&thread), this->_running.end());
-    this->_running.erase(&thread);
-    this->_frozen.insert(&thread);
+    ELLE_ASSERT(thread.SchedulerHook::is_linked());
+    this->_running.erase(this->_running.iterator_to(thread));
+    this->_frozen.push_back(thread);
     thread.frozen()();
   }
 
@@ -420,7 +481,9 @@ namespace reactor
     // FIXME: be thread safe only if needed
     {
       std::unique_lock<std::mutex> lock(this->_starting_mtx);
-      this->_starting.insert(&thread);
+      thread._starting = true;
+      this->_starting.push_back(thread);
+      this->_starting_pending = true;
       // Wake the scheduler.
       this->_io_service.post(nothing);
     }
@@ -430,13 +493,41 @@ namespace reactor
   Scheduler::_unfreeze(Thread& thread, std::string const& reason)
   {
     ELLE_ASSERT_EQ(thread.state(), Thread::state::frozen);
-    this->_frozen.erase(&thread);
-    this->_running.insert(&thread);
+    this->_frozen.erase(this->_frozen.iterator_to(thread));
+    thread._round = this->_round;
+    this->_running.push_back(thread);
     thread.unfrozen()(reason);
     if (this->_running.size() == 1)
       this->_io_service.post(nothing);
   }
 
+  std::vector<Thread*>
+  Scheduler::_steal()
+  {
+    std::vector<Thread*> res;
+    std::unique_lock<std::mutex> lock(this->_starting_mtx);
+    std::size_t const count = std::count_if(
+      this->_starting.begin(), this->_starting.end(),
+      [] (Thread const& t) { return t._stealable; });
+    // Give away the most recent ones, the oldest are about to run here.
+    for (auto it = this->_starting.end();
+         res.size() * 2 < count && it != this->_starting.begin();)
+      if ((--it)->_stealable)
+      {
+        res.emplace_back(&*it);
+        it->_starting = false;
+        it = this->_starting.erase(it);
+      }
+    return res;
+  }
+
+  bool
+  Scheduler::_group_done() const
+  {
+    return this->_group && this == &this->_group->front() &&
+      this->_group->_threads == 0;
+  }
+
   void
   Scheduler::terminate_later()
   {
@@ -449,21 +540,28 @@ namespace reactor
   {
     ELLE_TRACE_SCOPE("%s: terminate", *this);
     Threads terminated;
-    for(Thread* t: this->_starting)
+    ThreadList starting;
     {
+      std::unique_lock<std::mutex> lock(this->_starting_mtx);
+      starting.swap(this->_starting);
+    }
+    while (!starting.empty())
+    {
+      auto& t = starting.front();
+      starting.pop_front();
+      t._starting = false;
       // Threads expect to be done when deleted. For this very
       // particuliar case, hack the state before deletion.
-      t->_state = Thread::state::done;
-      t->_scheduler_release();
+      t._state = Thread::state::done;
+      t._scheduler_release();
     }
-    this->_starting.clear();
-    for(Thread* t: Threads(this->_running))
-      if (t != this->_current)
-      {
-        t->terminate();
-        terminated.insert(t);
-      }
-    for(Thread* t: Threads(this->_frozen))
+    Threads running;
+    for (auto& t: this->_running)
+      if (&t != this->_current)
+        running.insert(&t);
+    for (auto& t: this->_frozen)
+      running.insert(&t);
+    for (Thread* t: running)
     {
       t->terminate();
       terminated.insert(t);
@@ -490,7 +588,16 @@ namespace reactor
       throw Terminate(thread->name());
     }
     // If the underlying coroutine was never run, nothing to do.
-    if (this->_starting.erase(thread))
+    bool starting = false;
+    {
+      std::unique_lock<std::mutex> lock(this->_starting_mtx);
+      if ((starting = thread->_starting))
+      {
+        this->_starting.erase(this->_starting.iterator_to(*thread));
+        thread->_starting = false;
+      }
+    }
+    if (starting)
     {
       ELLE_DEBUG("%s: %s was starting, discard it", *this, *thread);
       thread->_state = Thread::state::done;
@@ -705,6 +812,26 @@ namespace reactor
     return this->_io_service;
   }
 
+  /*-------.
+  | Timers |
+  `-------*/
+
+  TimerWheel&
+  Scheduler::timers()
+  {
+    return this->_timers;
+  }
+
+  /*---------.
+  | io_uring |
+  `---------*/
+
+  Uring*
+  Scheduler::uring()
+  {
+    return this->_uring.get();
+  }
+
   /*----------------.
   | Multithread API |
   `----------------*/
@@ -714,7 +841,7 @@ namespace reactor
   Scheduler::mt_run<void>(const std::string& name,
                           const std::function<void ()>& action)
   {
-    ELLE_ASSERT_NEQ(this->_running_thread, std::this_thread::get_id());
+    ELLE_ASSERT_NEQ(this->_running_thread.load(), std::this_thread::get_id());
     // Bounce on the non-void case with a dummy int value.
     this->mt_run<int>(name, [&] () { action(); return 42; });
   }
@@ -889,6 +1016,8 @@ namespace __cxxabiv1
         t = sched->manager().current();
       if (sched == nullptr)
       {
+        static std::mutex mutex;
+        std::unique_lock<std::mutex> lock(mutex);
         auto &res = map[std::this_thread::get_id()];
         if (!res)
           res.reset(new __cxa_eh_globals());
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 
+#include <boost/intrusive/list.hpp>
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/identity.hpp>
@@ -17,6 +20,8 @@
 #include <elle/Printable.hh>
 #include <elle/attribute.hh>
 
+#include <reactor/TimerWheel.hh>
+#include <reactor/Uring.hh>
 #include <reactor/asio.hh>
 #include <reactor/duration.hh>
 #include <reactor/fwd.hh>
@@ -77,10 +82,18 @@ namespace reactor
       boost::multi_index::sequenced<>
       >
     >;
+    /// Threads linked through their SchedulerHook, in scheduling order.
+    using ThreadList = boost::intrusive::list<
+      Thread,
+      boost::intrusive::base_hook<
+        boost::intrusive::list_base_hook<boost::intrusive::tag<Scheduler>>>>;
     Thread* current() const;
     Threads terminate();
     void terminate_now();
     void terminate_later();
+    /// Stack size of threads that do not request one, 0 for the backend
+    /// default. Initialized from REACTOR_STACK_SIZE.
+    ELLE_ATTRIBUTE_RW(std::size_t, default_stack_size);
   private:
     bool _shallstop;
 
@@ -88,16 +101,36 @@ namespace reactor
     void _freeze(Thread& thread);
     void _thread_register(Thread& thread);
     void _unfreeze(Thread& thread, std::string const& reason);
+    /// Hand over up to half of our stealable threads that did not start yet.
+    std::vector<Thread*> _steal();
   private:
     // return true if terminate_now or wait will noop
     bool _terminate(Thread* thread);
     void _terminate_now(Thread* thread,
                         bool suicide);
     Thread* _current;
-    Threads _starting;
+    ThreadList _starting;
     std::mutex _starting_mtx;
-    Threads _running;
-    Threads _frozen;
+    /// Whether _starting may be non-empty, to skip locking otherwise.
+    std::atomic<bool> _starting_pending;
+    ThreadList _running;
+    ThreadList _frozen;
+    /// Current round, threads queued during it wait for the next one.
+    std::size_t _round;
+
+  /*------.
+  | Group |
+  `------*/
+  private:
+    friend class SchedulerGroup;
+    /// The group we belong to, if any.
+    ELLE_ATTRIBUTE(SchedulerGroup*, group);
+    /// Whether we are blocked waiting for asio events.
+    ELLE_ATTRIBUTE(std::atomic<bool>, idle);
+    /// Whether we are the first scheduler of our group and no thread is left
+    /// on any of its members.
+    bool
+    _group_done() const;
 
   /*-------------------------.
   | Thread Exception Handler |
@@ -193,6 +226,25 @@ namespace reactor
       boost::asio::io_service _io_service;
       boost::asio::io_service::work* _io_service_work;
 
+    /*-------.
+    | Timers |
+    `-------*/
+    public:
+      /// Coarse timers, expired once per round.
+      TimerWheel& timers();
+    private:
+      TimerWheel _timers;
+
+    /*---------.
+    | io_uring |
+    `---------*/
+    public:
+      /// Ring batching socket and file I/O, submitted once per round, or
+      /// null to use asio. Enabled by REACTOR_IO_URING=1.
+      Uring* uring();
+    private:
+      std::unique_ptr<Uring> _uring;
+
     /*--------.
     | Details |
     `--------*/
@@ -201,7 +253,8 @@ namespace reactor
     private:
       friend class Thread;
       std::unique_ptr<backend::Backend> _manager;
-      std::thread::id _running_thread;
+      /// The system thread running this, read from other ones.
+      std::atomic<std::thread::id> _running_thread;
   };
 
   /*---------------.
@@ -7,7 +7,8 @@ namespace reactor
   Sleep::Sleep(Scheduler& scheduler, Duration d)
     : Operation(scheduler)
     , _duration(d)
-    , _timer(scheduler.io_service(), d)
+    , _timer(scheduler.io_service())
+    , _entry()
   {}
 
   /*----------.
@@ -24,6 +25,7 @@ namespace reactor
   Sleep::_abort()
   {
     _timer.cancel();
+    _entry.cancel();
     _signal();
   }
 
@@ -40,6 +42,13 @@ namespace reactor
   void
   Sleep::_start()
   {
-    _timer.async_wait(boost::bind(&Sleep::_wakeup, this, _1));
+    auto& timers = this->scheduler().timers();
+    if (this->_duration < timers.tick())
+    {
+      _timer.expires_from_now(this->_duration);
+      _timer.async_wait(boost::bind(&Sleep::_wakeup, this, _1));
+    }
+    else
+      timers.arm(this->_entry, this->_duration, [this] { this->_signal(); });
   }
 }
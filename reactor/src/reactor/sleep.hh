@@ -1,6 +1,7 @@
 #ifndef REACTOR_SLEEP_HH
 # define REACTOR_SLEEP_HH
 
+# include <reactor/TimerWheel.hh>
 # include <reactor/asio.hh>
 
 # include <reactor/operation.hh>
@@ -27,7 +28,9 @@ namespace reactor
     private:
       void _wakeup(const boost::system::error_code& error);
       Duration _duration;
+      /// Precise timer, for sub-tick sleeps.
       boost::asio::deadline_timer _timer;
+      TimerWheel::Entry _entry;
   };
 }
 
@@ -5,6 +5,7 @@
 #include <elle/optional.hh>
 #include <elle/os/environ.hh>
 
+#include <reactor/SchedulerGroup.hh>
 #include <reactor/backend/backend.hh>
 #include <reactor/exception.hh>
 #include <reactor/scheduler.hh>
@@ -28,22 +29,37 @@ namespace reactor
                  std::string const& name,
                  Action action,
                  bool dispose)
-    : _dispose(dispose)
-    , _managed(false)
+    : Thread(scheduler, name, std::move(action), Options{dispose, false, 0, false})
+  {}
+
+  Thread::Thread(Scheduler& scheduler,
+                 std::string const& name,
+                 Action action,
+                 Options options)
+    : _dispose(options.dispose)
+    , _managed(options.managed)
     , _state(state::running)
     , _injection()
     , _exception()
     , _waited()
     , _timeout(false)
     , _timeout_timer(scheduler.io_service())
+    , _timeout_entry()
     , _thread(scheduler._manager->make_thread(
                 name,
-                std::bind(&Thread::_action_wrapper, this, std::move(action))))
-    , _scheduler(scheduler)
+                std::bind(&Thread::_action_wrapper, this, std::move(action)),
+                options.stack_size ?
+                options.stack_size : scheduler.default_stack_size()))
+    , _scheduler(&scheduler)
+    , _stealable(options.stealable)
+    , _starting(false)
+    , _round(0)
     , _terminating(false)
     , _interruptible(true)
   {
-    _scheduler._thread_register(*this);
+    if (auto group = this->_scheduler->_group)
+      ++group->_threads;
+    this->_scheduler->_thread_register(*this);
   }
 
   Thread::Thread(std::string const& name,
@@ -87,6 +103,8 @@ namespace reactor
   Thread::_scheduler_release()
   {
     ELLE_DUMP("%s: scheduler_release, dispose=%s", *this, this->_dispose);
+    if (auto group = this->_scheduler->_group)
+      group->_release();
     this->_released();
     this->_released.disconnect_all_slots();
     this->_released();
@@ -222,7 +240,7 @@ namespace reactor
       ELLE_TRACE("%s: step: re-raise exception: %s",
                  *this, elle::exception_string(this->_exception_thrown));
       // Do not reraise in the context of this thread
-      this->_scheduler._current = nullptr;
+      this->_scheduler->_current = nullptr;
       std::rethrow_exception(this->_exception_thrown);
     }
   }
@@ -305,7 +323,7 @@ namespace reactor
   void
   Thread::sleep(Duration d)
   {
-    Sleep sleep(_scheduler, d);
+    Sleep sleep(*this->_scheduler, d);
     sleep.run();
   }
 
@@ -359,20 +377,34 @@ namespace reactor
     {
       if (timeout)
       {
-        this->_timeout_timer.expires_from_now(timeout.get());
         this->_timeout = false;
         auto repr = elle::sprintf("%s", waitables);
-        this->_timeout_timer.async_wait(
-          [this, repr]
-          (boost::system::error_code const& e)
-          {
-            this->_wait_timeout(e, repr);
-          });
+        auto& timers = this->_scheduler->timers();
+        if (timeout.get() < timers.tick())
+        {
+          this->_timeout_timer.expires_from_now(timeout.get());
+          this->_timeout_timer.async_wait(
+            [this, repr]
+            (boost::system::error_code const& e)
+            {
+              this->_wait_timeout(e, repr);
+            });
+        }
+        else
+          timers.arm(
+            this->_timeout_entry, timeout.get(),
+            [this, repr]
+            {
+              this->_wait_timeout(boost::system::error_code(), repr);
+            });
         auto cancel_timeout = [this]
           {
             ELLE_DUMP("%s: cancel timeout", *this);
             if (!this->_timeout)
+            {
               this->_timeout_timer.cancel();
+              this->_timeout_entry.cancel();
+            }
           };
         return elle::With<elle::Finally>(cancel_timeout) << [&]
         {
@@ -392,12 +424,12 @@ namespace reactor
 
   void Thread::terminate()
   {
-    _scheduler._terminate(this);
+    this->_scheduler->_terminate(this);
   }
 
   void Thread::terminate_now(bool suicide)
   {
-    _scheduler._terminate_now(this, suicide);
+    this->_scheduler->_terminate_now(this, suicide);
   }
 
   bool
@@ -463,7 +495,8 @@ namespace reactor
       waitable->_unwait(this);
     this->_waited.clear();
     this->_timeout_timer.cancel();
-    this->_scheduler._unfreeze(*this, reason);
+    this->_timeout_entry.cancel();
+    this->_scheduler->_unfreeze(*this, reason);
     this->_state = Thread::state::running;
   }
 
@@ -471,7 +504,7 @@ namespace reactor
   Thread::_freeze()
   {
     ELLE_TRACE_SCOPE("%s: freeze", *this);
-    _scheduler._freeze(*this);
+    this->_scheduler->_freeze(*this);
     _state = Thread::state::frozen;
     yield();
   }
@@ -490,7 +523,7 @@ namespace reactor
       if (this->_waited.empty())
       {
         ELLE_TRACE("%s: nothing to wait on, waking up", *this);
-        this->_scheduler._unfreeze(
+        this->_scheduler->_unfreeze(
           *this, elle::sprintf("wait for %s ended", *waitable));
         this->_state = Thread::state::running;
       }
@@ -507,7 +540,21 @@ namespace reactor
   Scheduler&
   Thread::scheduler()
   {
-    return _scheduler;
+    return *this->_scheduler;
+  }
+
+  void
+  Thread::_migrate(Scheduler& scheduler)
+  {
+    ELLE_TRACE_SCOPE("%s: migrate to %s", *this, scheduler);
+    ELLE_ASSERT_EQ(this->_thread->status(), backend::Thread::Status::starting);
+    // The coroutine never ran: recreate it on the new scheduler's backend.
+    this->_thread = scheduler._manager->make_thread(
+      this->_thread->name(),
+      this->_thread->action(),
+      this->_thread->stack_size());
+    this->_timeout_timer = boost::asio::deadline_timer(scheduler.io_service());
+    this->_scheduler = &scheduler;
   }
 
   void
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <boost/intrusive/list_hook.hpp>
 #include <boost/signals2.hpp>
 #include <boost/system/error_code.hpp>
 
@@ -9,6 +10,7 @@
 #include <das/Symbol.hh>
 #include <das/named.hh>
 
+#include <reactor/TimerWheel.hh>
 #include <reactor/asio.hh>
 #include <reactor/backend/fwd.hh>
 #include <reactor/duration.hh>
@@ -22,9 +24,15 @@ namespace reactor
 
   DAS_SYMBOL(dispose);
   DAS_SYMBOL(managed);
+  DAS_SYMBOL(stack_size);
 
-  class Thread:
-    public Waitable
+  /// Hook of threads in the scheduler starting, running and frozen lists.
+  using SchedulerHook =
+    boost::intrusive::list_base_hook<boost::intrusive::tag<Scheduler>>;
+
+  class Thread
+    : public Waitable
+    , public SchedulerHook
   {
   /*------.
   | Types |
@@ -61,6 +69,16 @@ namespace reactor
     Thread(const std::string& name,
            Action action,
            bool dispose = false);
+    /// Create a thread with named arguments:
+    ///
+    /// - dispose: whether to delete the thread once it is done.
+    /// - managed: whether to rethrow escaping exceptions to joiners.
+    /// - stack_size: stack size hint in bytes, 0 for the scheduler default.
+    template <typename ... Args>
+    Thread(Scheduler& scheduler,
+           const std::string& name,
+           Action action,
+           Args&& ... args);
     template <typename ... Args>
     Thread(const std::string& name,
            Action action,
@@ -79,6 +97,23 @@ namespace reactor
                  Action action);
     virtual
     ~Thread();
+  private:
+    struct Options
+    {
+      bool dispose;
+      bool managed;
+      std::size_t stack_size;
+      /// Whether another scheduler of the group may run it.
+      bool stealable;
+    };
+    template <typename ... Args>
+    static
+    Options
+    _options(Args&& ... args);
+    Thread(Scheduler& scheduler,
+           const std::string& name,
+           Action action,
+           Options options);
   protected:
     /// Called by the scheduler when it doesn't reference this anymore.
     virtual
@@ -226,7 +261,9 @@ namespace reactor
       void _wake(Waitable* waitable);
       ELLE_ATTRIBUTE_R(std::set<Waitable*>, waited);
       bool _timeout;
+      /// Precise timeout, for sub-tick delays.
       boost::asio::deadline_timer _timeout_timer;
+      TimerWheel::Entry _timeout_entry;
 
   /*------.
   | Hooks |
@@ -281,8 +318,17 @@ namespace reactor
     Scheduler& scheduler();
   private:
     friend class Scheduler;
+    friend class SchedulerGroup;
+    /// Move this not yet started thread to \a scheduler.
+    void
+    _migrate(Scheduler& scheduler);
     ELLE_ATTRIBUTE(std::unique_ptr<backend::Thread>, thread);
-    ELLE_ATTRIBUTE(Scheduler&, scheduler);
+    ELLE_ATTRIBUTE(Scheduler*, scheduler);
+    ELLE_ATTRIBUTE(bool, stealable);
+    /// Whether this waits in the scheduler starting list.
+    ELLE_ATTRIBUTE(bool, starting);
+    /// Scheduler round this was last queued for.
+    ELLE_ATTRIBUTE(std::size_t, round);
     ELLE_ATTRIBUTE_R(bool, terminating);
         /// If set to false, do not rethrow Terminate exception.
     ELLE_ATTRIBUTE_Rw(bool, interruptible);
@@ -7,19 +7,35 @@ namespace reactor
   `-------------*/
 
   template <typename ... Args>
-  Thread::Thread(const std::string& name,
-                 Action action,
-                 Args&& ... args)
-    : Thread(name, std::move(action))
+  Thread::Options
+  Thread::_options(Args&& ... args)
   {
-    das::named::prototype(reactor::dispose = false, reactor::managed = false)
-      .call([&] (bool dispose, bool managed)
+    return das::named::prototype(reactor::dispose = false,
+                                 reactor::managed = false,
+                                 reactor::stack_size = std::size_t(0))
+      .call([] (bool dispose, bool managed, std::size_t stack_size)
             {
-              this->_dispose = dispose;
-              this->_managed = managed;
+              return Options{dispose, managed, stack_size, false};
             }, std::forward<Args>(args)...);
   }
 
+  template <typename ... Args>
+  Thread::Thread(Scheduler& scheduler,
+                 const std::string& name,
+                 Action action,
+                 Args&& ... args)
+    : Thread(scheduler, name, std::move(action),
+             Thread::_options(std::forward<Args>(args)...))
+  {}
+
+  template <typename ... Args>
+  Thread::Thread(const std::string& name,
+                 Action action,
+                 Args&& ... args)
+    : Thread(reactor::scheduler(), name, std::move(action),
+             Thread::_options(std::forward<Args>(args)...))
+  {}
+
   template <typename R>
   static void vthread_catcher(const typename VThread<R>::Action& action,
                               R& result)
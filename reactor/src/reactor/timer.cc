@@ -29,11 +29,19 @@ namespace reactor
     , _name(name)
     , _action(action)
     , _timer(s.io_service())
+    , _entry()
     , _finished(false)
   {
-    _timer.expires_from_now(d);
     ELLE_TRACE_SCOPE("%s: trigger in %s", *this, d);
-    _timer.async_wait(std::bind(&Timer::_on_timer, this, std::placeholders::_1));
+    if (d < s.timers().tick())
+    {
+      _timer.expires_from_now(d);
+      _timer.async_wait(
+        std::bind(&Timer::_on_timer, this, std::placeholders::_1));
+    }
+    else
+      s.timers().arm(this->_entry, d,
+                     [this] { this->_on_timer(boost::system::error_code()); });
   }
 
   Timer::~Timer()
@@ -73,6 +81,12 @@ namespace reactor
   Timer::cancel()
   {
     this->_timer.cancel();
+    // Unlike asio, the wheel does not notify cancellation.
+    if (this->_entry.armed())
+    {
+      this->_entry.cancel();
+      this->_on_timer(boost::asio::error::operation_aborted);
+    }
   }
 
   void
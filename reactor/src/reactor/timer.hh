@@ -5,6 +5,7 @@
 
 # include <elle/Printable.hh>
 
+# include <reactor/TimerWheel.hh>
 # include <reactor/fwd.hh>
 # include <reactor/duration.hh>
 # include <reactor/thread.hh>
@@ -46,7 +47,9 @@ namespace reactor
     std::string _name;
     Action _action;
     std::unique_ptr<Thread> _thread;
+    /// Precise timer, for sub-tick delays.
     boost::asio::deadline_timer _timer;
+    TimerWheel::Entry _entry;
     bool _finished;
   };
 }
@@ -1,3 +1,4 @@
+#include <elle/os/environ.hh>
 #include <elle/test.hh>
 
 #if defined(REACTOR_CORO_BACKEND_IO)
@@ -102,27 +103,131 @@ test_status()
   delete m;
 }
 
+template <typename Backend>
+static
+void
+test_stacks_recycled()
+{
+  m = new Backend;
+  auto const before = m->stack_statistics();
+  {
+    auto t = m->make_thread("stacks", &one_yield);
+    BOOST_CHECK_EQUAL(m->stack_statistics().live, before.live + 1);
+    t->step();
+    t->step();
+  }
+  auto const after = m->stack_statistics();
+  BOOST_CHECK_EQUAL(after.live, before.live);
+#if defined(REACTOR_CORO_BACKEND_BOOST_CONTEXT)
+  BOOST_CHECK_EQUAL(after.pooled, before.pooled + 1);
+  {
+    // The released stack is reused rather than allocated anew.
+    auto t = m->make_thread("stacks", &empty);
+    BOOST_CHECK_EQUAL(m->stack_statistics().pooled, before.pooled);
+    BOOST_CHECK_EQUAL(m->stack_statistics().reserved, after.reserved);
+    t->step();
+  }
+#endif
+  delete m;
+}
+
+static
+void
+deep(int depth)
+{
+  volatile char frame[1024];
+  frame[0] = depth;
+  if (depth > 0)
+    deep(depth - 1);
+  else
+    m->current()->yield();
+  (void)frame[0];
+}
+
+template <typename Backend>
+static
+void
+test_stack_size()
+{
+#if defined(REACTOR_CORO_BACKEND_BOOST_CONTEXT)
+  elle::os::setenv("REACTOR_STACK_PROBE", "1", true);
+#endif
+  m = new Backend;
+  {
+    auto t = m->make_thread("default", &empty);
+    auto small = m->make_thread("small", std::bind(deep, 16), 64 * 1024);
+    BOOST_CHECK_GE(small->stack_size(), 64 * 1024);
+    BOOST_CHECK_LT(small->stack_size(), t->stack_size());
+    small->step();
+#if defined(REACTOR_CORO_BACKEND_BOOST_CONTEXT)
+    // The sixteen 1KiB frames are accounted for while suspended.
+    BOOST_CHECK_GE(small->stack_high_water_mark(), 16 * 1024);
+    BOOST_CHECK_LT(small->stack_high_water_mark(), small->stack_size());
+#endif
+    small->step();
+    t->step();
+  }
+#if defined(REACTOR_CORO_BACKEND_BOOST_CONTEXT)
+  {
+    // Hints are clamped to the backend bounds.
+    auto t = m->make_thread("tiny", &empty, 1);
+    BOOST_CHECK_GE(t->stack_size(), 8 * 1024);
+    t->step();
+  }
+  elle::os::unsetenv("REACTOR_STACK_PROBE");
+#endif
+  delete m;
+}
+
+/// Spawn and join short-lived threads, the typical one-per-request pattern.
+template <typename Backend>
+static
+void
+bench_spawn_join()
+{
+  m = new Backend;
+  int const n = RUNNING_ON_VALGRIND ? 1000 : 100000;
+  int i = 0;
+  auto const seconds = elapsed(
+    [&]
+    {
+      for (int c = 0; c < n; ++c)
+      {
+        auto t = m->make_thread("bench", std::bind(inc, &i));
+        t->step();
+      }
+    });
+  BOOST_CHECK_EQUAL(i, n);
+  BOOST_TEST_MESSAGE("spawn/join: " << n / seconds << " threads/s");
+  delete m;
+}
+
 ELLE_TEST_SUITE()
 {
   boost::unit_test::test_suite* backend = BOOST_TEST_SUITE("Backend");
   boost::unit_test::framework::master_test_suite().add(backend);
 #if defined(REACTOR_CORO_BACKEND_IO)
-# define TEST(Name)                                                     \
+# define TEST_IN(Suite, Name)                                           \
   {                                                                     \
-    backend->add(                                                       \
+    Suite->add(                                                         \
       BOOST_TEST_CASE(Name<reactor::backend::coro_io::Backend>),        \
       0, 10);                                                           \
   }
 #elif defined(REACTOR_CORO_BACKEND_BOOST_CONTEXT)
-# define TEST(Name)                                                     \
+# define TEST_IN(Suite, Name)                                           \
   {                                                                     \
-    backend->add(                                                       \
+    Suite->add(                                                         \
       BOOST_TEST_CASE(Name<reactor::backend::boost_context::Backend>),  \
       0, 10);                                                           \
   }
 #endif
+#define TEST(Name) TEST_IN(backend, Name)
   TEST(test_die);
   TEST(test_deadlock_creation);
   TEST(test_deadlock_switch);
   TEST(test_status);
+  TEST(test_stacks_recycled);
+  TEST(test_stack_size);
+  auto benchmark = benchmark_suite(*backend);
+  TEST_IN(benchmark, bench_spawn_join);
 }
@@ -1,8 +1,10 @@
 /// Crash on OS X when using: echo "something" | /path/to/fdstream
 
+#include <elle/os/environ.hh>
 #include <elle/test.hh>
 
 #include <reactor/FDStream.hh>
+#include <reactor/Scope.hh>
 #include <reactor/scheduler.hh>
 
 ELLE_LOG_COMPONENT("reactor.FDStream.test");
@@ -42,9 +44,51 @@ ELLE_TEST_SCHEDULED(destruction_segv)
   reader.terminate_now();
 }
 
+ELLE_TEST_SCHEDULED(batch)
+{
+  // Reads of a round are submitted together, through io_uring if available.
+  static int const count = 64;
+  std::vector<std::array<int, 2>> pipes(count);
+  std::vector<std::unique_ptr<reactor::FDStream>> streams;
+  for (auto& fds: pipes)
+  {
+    BOOST_CHECK_EQUAL(::pipe(fds.data()), 0);
+    streams.emplace_back(std::make_unique<reactor::FDStream>(fds[0]));
+  }
+  int read = 0;
+  elle::With<reactor::Scope>() << [&] (reactor::Scope& scope)
+  {
+    for (int i = 0; i < count; ++i)
+      scope.run_background(
+        elle::sprintf("reader %s", i),
+        [&, i]
+        {
+          char content[16] = {0};
+          streams[i]->read(content, sizeof(content));
+          BOOST_CHECK_EQUAL(std::string(content), std::to_string(i));
+          ++read;
+        });
+    reactor::yield();
+    for (int i = 0; i < count; ++i)
+    {
+      auto data = std::to_string(i);
+      BOOST_CHECK_EQUAL(::write(pipes[i][1], data.c_str(), data.size()),
+                        data.size());
+      BOOST_CHECK_EQUAL(::close(pipes[i][1]), 0);
+    }
+    reactor::wait(scope);
+  };
+  BOOST_CHECK_EQUAL(read, count);
+  if (auto uring = reactor::scheduler().uring())
+    BOOST_CHECK_EQUAL(uring->pending(), 0u);
+}
+
 ELLE_TEST_SUITE()
 {
+  // Exercise io_uring where the kernel supports it, asio otherwise.
+  elle::os::setenv("REACTOR_IO_URING", "1", true);
   auto& suite = boost::unit_test::framework::master_test_suite();
   suite.add(BOOST_TEST_CASE(basics), 0, 1);
   suite.add(BOOST_TEST_CASE(destruction_segv), 0, 1);
+  suite.add(BOOST_TEST_CASE(batch), 0, 3);
 }
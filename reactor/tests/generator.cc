@@ -116,6 +116,48 @@ ELLE_TEST_SCHEDULED(destruct)
   BOOST_CHECK_EQUAL(*it, 0);
 }
 
+ELLE_TEST_SCHEDULED(bounded)
+{
+  int produced = 0;
+  auto f = [&] (reactor::yielder<int>::type const& yield)
+    {
+      for (int i = 0; i < 10; ++i)
+      {
+        ++produced;
+        yield(i);
+      }
+    };
+  reactor::Generator<int> g(f, 2);
+  auto it = g.begin();
+  BOOST_CHECK(it != g.end());
+  BOOST_CHECK_EQUAL(*it, 0);
+  for (int i = 0; i < 5; ++i)
+    reactor::yield();
+  // The driver blocks on its next value once two wait to be consumed.
+  BOOST_CHECK_LE(produced, 4);
+  int expected = 1;
+  for (++it; it != g.end(); ++it)
+    BOOST_CHECK_EQUAL(*it, expected++);
+  BOOST_CHECK_EQUAL(expected, 10);
+}
+
+ELLE_TEST_SCHEDULED(bounded_destruct)
+{
+  auto f = [&] (reactor::yielder<int>::type const& yield)
+    {
+      for (int i = 0; ; ++i)
+        yield(i);
+    };
+  reactor::Generator<int> g(f, 2);
+  auto it = g.begin();
+  BOOST_CHECK(it != g.end());
+  BOOST_CHECK_EQUAL(*it, 0);
+  // Let the driver block on a full generator, which must not hang its
+  // destruction.
+  for (int i = 0; i < 5; ++i)
+    reactor::yield();
+}
+
 ELLE_TEST_SUITE()
 {
   auto& master = boost::unit_test::framework::master_test_suite();
@@ -125,4 +167,6 @@ ELLE_TEST_SUITE()
   master.add(BOOST_TEST_CASE(interleave));
   master.add(BOOST_TEST_CASE(exception));
   master.add(BOOST_TEST_CASE(destruct));
+  master.add(BOOST_TEST_CASE(bounded));
+  master.add(BOOST_TEST_CASE(bounded_destruct), 0, 10);
 }
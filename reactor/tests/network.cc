@@ -5,6 +5,7 @@
 #include <elle/Buffer.hh>
 #include <elle/log.hh>
 #include <elle/memory.hh>
+#include <elle/os/environ.hh>
 #include <elle/test.hh>
 #include <elle/utility/Move.hh>
 
@@ -361,6 +362,46 @@ socket_close()
   sched.run();
 }
 
+// Closing must end reads the kernel performs through io_uring, which holds its
+// own reference to the descriptor.
+ELLE_TEST_SCHEDULED(socket_close_blocked_read)
+{
+  SilentServer<TCPServer, TCPSocket> server;
+  reactor::network::TCPSocket socket(server.local_endpoint());
+  elle::With<reactor::Scope>() << [&] (reactor::Scope& scope)
+  {
+    scope.run_background(
+      "read",
+      [&]
+      {
+        BOOST_CHECK_THROW(socket.read_some(1),
+                          reactor::network::ConnectionClosed);
+      });
+    scope.run_background(
+      "close",
+      [&]
+      {
+        // Let the read be submitted and block in the kernel.
+        reactor::yield();
+        reactor::yield();
+        socket.close();
+      });
+    reactor::wait(scope);
+  };
+}
+
+// Reads past the end of a connection must keep failing, not hang.
+ELLE_TEST_SCHEDULED(read_after_eof)
+{
+  reactor::network::TCPServer server;
+  server.listen();
+  reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  server.accept();
+  for (int i = 0; i < 3; ++i)
+    BOOST_CHECK_THROW(socket.read_some(1024),
+                      reactor::network::ConnectionClosed);
+}
+
 /*-------------------.
 | Resolution failure |
 `-------------------*/
@@ -753,6 +794,8 @@ ELLE_TEST_SCHEDULED(read_terminate_deadlock)
 
 ELLE_TEST_SUITE()
 {
+  // Exercise io_uring where the kernel supports it, asio otherwise.
+  elle::os::setenv("REACTOR_IO_URING", "1", true);
   auto& suite = boost::unit_test::framework::master_test_suite();
 #ifndef INFINIT_WINDOWS
   suite.add(BOOST_TEST_CASE(destroy_socket), 0, 10);
@@ -777,6 +820,8 @@ ELLE_TEST_SUITE()
   suite.add(BOOST_TEST_CASE(socket_destruction), 0, 10);
   suite.add(BOOST_TEST_CASE(connection_refused), 0, 1);
   suite.add(BOOST_TEST_CASE(socket_close), 0, 10);
+  suite.add(BOOST_TEST_CASE(socket_close_blocked_read), 0, 10);
+  suite.add(BOOST_TEST_CASE(read_after_eof), 0, 10);
   suite.add(BOOST_TEST_CASE(resolution_failure), 0, 10);
   suite.add(BOOST_TEST_CASE(read_until), 0, 10);
   suite.add(BOOST_TEST_CASE(underflow), 0, 10);
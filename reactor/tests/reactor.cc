@@ -1,17 +1,25 @@
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <numeric>
+#include <set>
+#include <thread>
 
 #include "reactor.hh"
 
 #include <elle/finally.hh>
+#include <elle/os/environ.hh>
 #include <elle/test.hh>
 
 #include <reactor/BackgroundFuture.hh>
 #include <reactor/Barrier.hh>
+#include <reactor/BoundedChannel.hh>
 #include <reactor/Channel.hh>
 #include <reactor/MultiLockBarrier.hh>
 #include <reactor/OrWaitable.hh>
+#include <reactor/SchedulerGroup.hh>
 #include <reactor/Scope.hh>
 #include <reactor/TimeoutGuard.hh>
 #include <reactor/asio.hh>
@@ -280,6 +288,45 @@ ELLE_TEST_SCHEDULED(deadlock)
   reactor::wait(*starting);
 }
 
+static
+void
+environment()
+{
+  elle::SafeFinally unset([] { elle::os::unsetenv("REACTOR_STACK_SIZE"); });
+  // Invalid settings are ignored rather than making schedulers throw.
+  for (auto value: {"", "big", "-1", "64k", "0", "1024",
+                    "99999999999999999999999"})
+  {
+    elle::os::setenv("REACTOR_STACK_SIZE", value, true);
+    BOOST_CHECK_EQUAL(reactor::Scheduler().default_stack_size(), 0);
+  }
+  elle::os::setenv("REACTOR_STACK_SIZE", "65536", true);
+  BOOST_CHECK_EQUAL(reactor::Scheduler().default_stack_size(), 65536);
+  elle::SafeFinally unset_tick(
+    [] { elle::os::unsetenv("REACTOR_TIMER_TICK"); });
+  for (auto value: {"fast", "-5", "0"})
+  {
+    elle::os::setenv("REACTOR_TIMER_TICK", value, true);
+    BOOST_CHECK_EQUAL(reactor::Scheduler().timers().tick(),
+                      boost::posix_time::milliseconds(1));
+  }
+  elle::os::setenv("REACTOR_TIMER_TICK", "10", true);
+  BOOST_CHECK_EQUAL(reactor::Scheduler().timers().tick(),
+                    boost::posix_time::milliseconds(10));
+  elle::SafeFinally unset_entries(
+    []
+    {
+      elle::os::unsetenv("REACTOR_IO_URING");
+      elle::os::unsetenv("REACTOR_IO_URING_ENTRIES");
+    });
+  elle::os::setenv("REACTOR_IO_URING", "1", true);
+  for (auto value: {"many", "-256", "0"})
+  {
+    elle::os::setenv("REACTOR_IO_URING_ENTRIES", value, true);
+    BOOST_CHECK_NO_THROW(reactor::Scheduler());
+  }
+}
+
 /*-----.
 | Wait |
 `-----*/
@@ -1085,6 +1132,43 @@ ELLE_TEST_SCHEDULED(test_sleep_timing)
   }
 }
 
+ELLE_TEST_SCHEDULED(test_sleep_wheel)
+{
+  // Sub-tick, first and second level of the wheel, and across cascades.
+  std::vector<reactor::Duration> const delays = {
+    boost::posix_time::microseconds(500), 1_ms, 3_ms, 63_ms, 64_ms, 65_ms, 130_ms, 300_ms};
+  std::vector<reactor::Duration> woken;
+  reactor::Barrier opened;
+  elle::With<reactor::Scope>() << [&] (reactor::Scope& scope)
+  {
+    for (auto delay: delays)
+      scope.run_background(
+        elle::sprintf("sleep %s", delay),
+        [&, delay]
+        {
+          auto const start = std::chrono::steady_clock::now();
+          reactor::sleep(delay);
+          BOOST_CHECK_GE(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - start).count(),
+            delay.total_microseconds());
+          woken.emplace_back(delay);
+        });
+    // Cancelled timeouts leave the wheel.
+    scope.run_background(
+      "wait",
+      [&]
+      {
+        BOOST_CHECK(reactor::wait(opened, 10_sec));
+      });
+    reactor::sleep(10_ms);
+    opened.open();
+    reactor::wait(scope);
+  };
+  BOOST_CHECK(woken == delays);
+  BOOST_CHECK_EQUAL(reactor::scheduler().timers().size(), 0u);
+}
+
 /*------.
 | Every |
 `------*/
@@ -1464,6 +1548,212 @@ test_multithread_deadlock_assert()
   sched.run();
 }
 
+static
+void
+test_multithread_group()
+{
+  reactor::SchedulerGroup group(4);
+  int const n = 256;
+  std::atomic<int> count(0);
+  std::mutex mutex;
+  std::set<std::thread::id> ids;
+  reactor::Thread main(
+    group.front(), "main",
+    [&]
+    {
+      // Owned by the front scheduler, fed from the other ones.
+      reactor::Channel<int> results;
+      for (int i = 0; i < n; ++i)
+        group.run_later(
+          elle::sprintf("worker %s", i),
+          [&, i]
+          {
+            reactor::yield();
+            {
+              std::unique_lock<std::mutex> lock(mutex);
+              ids.insert(std::this_thread::get_id());
+            }
+            results.put(i);
+            ++count;
+          });
+      // Keep the front scheduler busy so the others do all the work.
+      auto const deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(10);
+      while (count != n && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::yield();
+      BOOST_CHECK_EQUAL(count, n);
+      BOOST_CHECK(!ids.count(std::this_thread::get_id()));
+      int sum = 0;
+      for (int i = 0; i < n; ++i)
+        sum += results.get();
+      BOOST_CHECK_EQUAL(sum, n * (n - 1) / 2);
+    });
+  group.run();
+}
+
+static
+void
+test_multithread_group_steal()
+{
+  reactor::SchedulerGroup group(2);
+  int const n = 64;
+  std::atomic<int> count(0);
+  reactor::Thread main(
+    group.front(), "main",
+    [&]
+    {
+      for (int i = 0; i < n; ++i)
+        group.run_later("worker", [&] { ++count; });
+      // Never yield: threads given to the front scheduler can only run if
+      // the other one steals them.
+      auto const deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(10);
+      while (count != n && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::yield();
+      BOOST_CHECK_EQUAL(count, n);
+    });
+  group.run();
+}
+
+// Operations posted from other system threads are dropped with their target.
+static
+void
+test_multithread_posted_dropped()
+{
+  reactor::Scheduler sched;
+  reactor::Thread main(
+    sched, "main",
+    [&]
+    {
+      {
+        reactor::Barrier barrier;
+        reactor::Channel<int> channel;
+        std::thread(
+          [&]
+          {
+            barrier.open();
+            channel.put(42);
+          }).join();
+        BOOST_CHECK(!barrier.opened());
+        BOOST_CHECK(channel.empty());
+      }
+      // Run the posted operations.
+      reactor::sleep(10_ms);
+    });
+  sched.run();
+}
+
+// Stolen threads must time out and be woken up on their new scheduler: the
+// front one never yields, so nothing bound to it would ever fire.
+static
+void
+test_multithread_group_steal_wait()
+{
+  reactor::SchedulerGroup group(2);
+  int const n = 16;
+  std::atomic<reactor::Channel<int>*> inboxes[n];
+  for (auto& inbox: inboxes)
+    inbox = nullptr;
+  std::atomic<int> timeouts(0);
+  std::atomic<int> sum(0);
+  std::atomic<int> count(0);
+  std::mutex mutex;
+  std::set<std::thread::id> ids;
+  reactor::Thread main(
+    group.front(), "main",
+    [&]
+    {
+      for (int i = 0; i < n; ++i)
+        group.run_later(
+          elle::sprintf("worker %s", i),
+          [&, i]
+          {
+            {
+              std::unique_lock<std::mutex> lock(mutex);
+              ids.insert(std::this_thread::get_id());
+            }
+            reactor::Barrier never;
+            if (!reactor::wait(never, 10_ms))
+              ++timeouts;
+            reactor::Channel<int> inbox;
+            inboxes[i] = &inbox;
+            sum += inbox.get();
+            ++count;
+          });
+      auto const deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(10);
+      for (int i = 0; i < n; ++i)
+      {
+        while (!inboxes[i] && std::chrono::steady_clock::now() < deadline)
+          std::this_thread::yield();
+        if (!inboxes[i])
+          break;
+        inboxes[i].load()->put(i);
+      }
+      while (count != n && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::yield();
+      BOOST_CHECK_EQUAL(timeouts, n);
+      BOOST_CHECK_EQUAL(count, n);
+      BOOST_CHECK_EQUAL(sum, n * (n - 1) / 2);
+      BOOST_CHECK(!ids.count(std::this_thread::get_id()));
+    });
+  group.run();
+}
+
+static
+void
+test_multithread_group_barrier()
+{
+  reactor::SchedulerGroup group(2);
+  reactor::Thread main(
+    group.front(), "main",
+    [&]
+    {
+      reactor::Barrier barrier;
+      std::atomic<bool> opener_done(false);
+      group.run_later("opener",
+                      [&]
+                      {
+                        barrier.open();
+                        opener_done = true;
+                      });
+      reactor::wait(barrier);
+      BOOST_CHECK(barrier.opened());
+      while (!opener_done)
+        reactor::yield();
+    });
+  group.run();
+}
+
+// The group lasts as long as any member has threads, even frozen ones the
+// first scheduler has no way to know of.
+static
+void
+test_multithread_group_sleeping_member()
+{
+  reactor::SchedulerGroup group(2);
+  std::atomic<bool> started(false);
+  std::atomic<bool> woken(false);
+  reactor::Thread main(
+    group.front(), "main",
+    [&]
+    {
+      group.run_later("sleeper",
+                      [&]
+                      {
+                        started = true;
+                        reactor::sleep(10_ms);
+                        woken = true;
+                      });
+      // Never yield: the other scheduler takes the sleeper, and the first
+      // one runs out of work while it sleeps.
+      while (!started)
+        std::this_thread::yield();
+    });
+  group.run();
+  BOOST_CHECK(woken);
+}
+
 /*----------.
 | Semaphore |
 `----------*/
@@ -2886,6 +3176,78 @@ namespace channel
     reactor::wait(s);
     };
   }
+
+  ELLE_TEST_SCHEDULED(bounded)
+  {
+    reactor::BoundedChannel<std::unique_ptr<int>> channel(2);
+    BOOST_CHECK_EQUAL(channel.capacity(), 2u);
+    BOOST_CHECK(!channel.try_get());
+    elle::With<reactor::Scope>() << [&](reactor::Scope &s)
+    {
+      s.run_background(
+        "writer",
+        [&]
+        {
+          for (int i = 0; i < 4; ++i)
+            channel.put(std::make_unique<int>(i));
+        });
+      reactor::yield();
+      reactor::yield();
+      // The writer waits for room before inserting its third value.
+      BOOST_CHECK_EQUAL(channel.size(), 2u);
+      for (int i = 0; i < 4; ++i)
+        BOOST_CHECK_EQUAL(*channel.get(), i);
+      reactor::wait(s);
+    };
+    BOOST_CHECK(channel.empty());
+  }
+
+  ELLE_TEST_SCHEDULED(bounded_batch)
+  {
+    reactor::BoundedChannel<int> channel(4);
+    std::vector<int> got;
+    elle::With<reactor::Scope>() << [&](reactor::Scope &s)
+    {
+      s.run_background(
+        "writer",
+        [&]
+        {
+          std::vector<int> values(10);
+          std::iota(values.begin(), values.end(), 0);
+          channel.put_many(values.begin(), values.end());
+        });
+      while (got.size() < 10)
+        for (auto i: channel.get_many(3))
+          got.push_back(i);
+      reactor::wait(s);
+    };
+    std::vector<int> expected(10);
+    std::iota(expected.begin(), expected.end(), 0);
+    BOOST_CHECK_EQUAL(got, expected);
+    int value = 42;
+    BOOST_CHECK(channel.try_put(value));
+    BOOST_CHECK_EQUAL(channel.try_get().get(), 42);
+  }
+
+  ELLE_TEST_SCHEDULED(bounded_system_threads)
+  {
+    static int const count = 1000;
+    reactor::BoundedChannel<int> channel(16);
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t)
+      writers.emplace_back(
+        [&]
+        {
+          for (int i = 0; i < count; ++i)
+            channel.put(i);
+        });
+    long sum = 0;
+    for (int i = 0; i < 4 * count; ++i)
+      sum += channel.get();
+    for (auto& t: writers)
+      t.join();
+    BOOST_CHECK_EQUAL(sum, 4l * count * (count - 1) / 2);
+  }
 }
 
 ELLE_TEST_SCHEDULED(test_released_signal)
@@ -3327,6 +3689,97 @@ namespace for_each
       });
     BOOST_CHECK_EQUAL(c, std::vector<int>({1, 1, 2}));
   }
+
+  ELLE_TEST_SCHEDULED(parallel_bounded)
+  {
+    std::vector<int> c(10);
+    int running = 0;
+    int max = 0;
+    reactor::for_each_parallel(
+      c,
+      [&] (int& c)
+      {
+        max = std::max(max, ++running);
+        reactor::yield();
+        ++c;
+        --running;
+      },
+      3);
+    BOOST_CHECK_EQUAL(max, 3);
+    BOOST_CHECK_EQUAL(c, std::vector<int>(10, 1));
+  }
+
+  ELLE_TEST_SCHEDULED(transform)
+  {
+    std::vector<int> c{0, 1, 2, 3, 4};
+    auto res = reactor::transform_parallel(
+      c,
+      [&] (int c)
+      {
+        // Finish in reverse order.
+        for (int i = c; i < 5; ++i)
+          reactor::yield();
+        return std::to_string(c);
+      },
+      2);
+    BOOST_CHECK_EQUAL(
+      res, std::vector<std::string>({"0", "1", "2", "3", "4"}));
+    BOOST_CHECK_THROW(
+      reactor::transform_parallel(
+        c,
+        [&] (int c)
+        {
+          if (c == 2)
+            reactor::break_parallel();
+          return c;
+        }),
+      reactor::Break);
+  }
+}
+
+/*----------.
+| Benchmark |
+`----------*/
+
+namespace benchmark
+{
+  /// Context switches per second with \a threads runnable threads.
+  static
+  void
+  switches(int threads)
+  {
+    if (RUNNING_ON_VALGRIND)
+      threads = std::min(threads, 1000);
+    int const rounds =
+      std::max(1, (RUNNING_ON_VALGRIND ? 10000 : 1000000) / threads);
+    // Guard pages cap the number of stacks below vm.max_map_count / 2.
+    bool const unguarded = threads > 10000;
+    if (unguarded)
+      elle::os::setenv("REACTOR_STACK_GUARDS", "0", true);
+    elle::SafeFinally guards(
+      [unguarded]
+      {
+        if (unguarded)
+          elle::os::unsetenv("REACTOR_STACK_GUARDS");
+      });
+    reactor::Scheduler sched;
+    std::vector<std::unique_ptr<reactor::Thread>> spawned;
+    spawned.reserve(threads);
+    for (int i = 0; i < threads; ++i)
+      spawned.emplace_back(
+        new reactor::Thread(
+          sched, "switcher",
+          [rounds]
+          {
+            for (int r = 0; r < rounds; ++r)
+              reactor::yield();
+          },
+          reactor::stack_size = 16 * 1024));
+    auto const seconds = elapsed([&] { sched.run(); });
+    BOOST_TEST_MESSAGE(
+      threads << " threads: " << double(threads) * (rounds + 1) / seconds
+      << " switches/s");
+  }
 }
 
 /*-----.
@@ -3345,6 +3798,7 @@ ELLE_TEST_SUITE()
     basics->add(BOOST_TEST_CASE(non_managed), 0, valgrind(1, 5));
     basics->add(BOOST_TEST_CASE(unique_ptr), 0, valgrind(1, 5));
     basics->add(BOOST_TEST_CASE(deadlock), 0, valgrind(1, 5));
+    basics->add(BOOST_TEST_CASE(environment), 0, valgrind(1, 5));
   }
 
   {
@@ -3357,6 +3811,12 @@ ELLE_TEST_SUITE()
     channels->add(BOOST_TEST_CASE(wake_clear), 0, valgrind(1, 5));
     auto open_close = &channel::open_close;
     channels->add(BOOST_TEST_CASE(open_close), 0, valgrind(1, 5));
+    auto bounded = &channel::bounded;
+    channels->add(BOOST_TEST_CASE(bounded), 0, valgrind(1, 5));
+    auto bounded_batch = &channel::bounded_batch;
+    channels->add(BOOST_TEST_CASE(bounded_batch), 0, valgrind(1, 5));
+    auto bounded_system_threads = &channel::bounded_system_threads;
+    channels->add(BOOST_TEST_CASE(bounded_system_threads), 0, valgrind(5, 5));
   }
 
   {
@@ -3444,6 +3904,7 @@ ELLE_TEST_SUITE()
     boost::unit_test::framework::master_test_suite().add(sleep);
     sleep->add(BOOST_TEST_CASE(test_sleep_interleave), 0, valgrind(1, 5));
     sleep->add(BOOST_TEST_CASE(test_sleep_timing), 0, valgrind(10, 3));
+    sleep->add(BOOST_TEST_CASE(test_sleep_wheel), 0, valgrind(3, 5));
   }
 
   {
@@ -3505,6 +3966,15 @@ ELLE_TEST_SUITE()
   mt->add(BOOST_TEST_CASE(test_multithread_run), 0, valgrind(1, 5));
   mt->add(BOOST_TEST_CASE(test_multithread_run_exception), 0, valgrind(1, 5));
   mt->add(BOOST_TEST_CASE(test_multithread_deadlock_assert), 0, valgrind(1, 5));
+  mt->add(BOOST_TEST_CASE(test_multithread_posted_dropped), 0,
+          valgrind(1, 5));
+  mt->add(BOOST_TEST_CASE(test_multithread_group), 0, valgrind(5, 5));
+  mt->add(BOOST_TEST_CASE(test_multithread_group_steal), 0, valgrind(15, 5));
+  mt->add(BOOST_TEST_CASE(test_multithread_group_steal_wait), 0,
+          valgrind(15, 5));
+  mt->add(BOOST_TEST_CASE(test_multithread_group_barrier), 0, valgrind(1, 5));
+  mt->add(BOOST_TEST_CASE(test_multithread_group_sleeping_member), 0,
+          valgrind(1, 5));
 #endif
 
   boost::unit_test::test_suite* sem = BOOST_TEST_SUITE("Semaphore");
@@ -3597,5 +4067,19 @@ ELLE_TEST_SUITE()
     s->add(BOOST_TEST_CASE(parallel));
     auto parallel_break = &for_each::parallel_break;
     s->add(BOOST_TEST_CASE(parallel_break));
+    auto parallel_bounded = &for_each::parallel_bounded;
+    s->add(BOOST_TEST_CASE(parallel_bounded));
+    auto transform = &for_each::transform;
+    s->add(BOOST_TEST_CASE(transform));
+  }
+
+  {
+    auto s = benchmark_suite();
+    auto switches_10 = std::bind(&benchmark::switches, 10);
+    s->add(BOOST_TEST_CASE(switches_10), 0, valgrind(10, 5));
+    auto switches_1k = std::bind(&benchmark::switches, 1000);
+    s->add(BOOST_TEST_CASE(switches_1k), 0, valgrind(10, 5));
+    auto switches_100k = std::bind(&benchmark::switches, 100000);
+    s->add(BOOST_TEST_CASE(switches_100k), 0, valgrind(10, 5));
   }
 }